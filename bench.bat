@@ -0,0 +1,21 @@
+@echo off
+
+REM builds every benchmark in benchmarks\ against the engine sources, run them from this directory
+call "C:\Program Files\Microsoft Visual Studio\2022\Community\VC\Auxiliary\Build\vcvars64.bat"
+
+SET includes=/I. /I%VULKAN_SDK%/Include /I"C:/Users/Matthew/glfw-3.3.9.bin.WIN64/glfw-3.3.9.bin.WIN64/include" /I"C:/Users/Matthew/tinyobjloader"
+SET links=/link /LIBPATH:%VULKAN_SDK%/Lib /LIBPATH:"C:/Users/Matthew/glfw-3.3.9.bin.WIN64/glfw-3.3.9.bin.WIN64/lib-vc2022" vulkan-1.lib glfw3.lib User32.lib Gdi32.lib Shell32.lib
+SET defines=/D NDEBUG
+
+if not exist benchmarks\obj mkdir benchmarks\obj
+
+echo "Building engine objects..."
+REM optimized build, timings from a debug build are meaningless
+cl /c /O2 /EHsc /MD /std:c++17 %includes% %defines% *.cpp /Fobenchmarks\obj\
+REM benchmarks have their own main
+del benchmarks\obj\main.obj
+
+for %%f in (benchmarks\*.cpp) do (
+   echo "Building %%~nf..."
+   cl /O2 /EHsc /MD /std:c++17 %includes% %defines% %%f benchmarks\obj\*.obj /Fobenchmarks\obj\%%~nf.obj %links% /OUT:benchmarks\%%~nf.exe
+)
@@ -0,0 +1,122 @@
+//loose files vs the packed archive: models/ and shaders/ copied [copies] times (default 16) so there is enough data to spread over threads.
+//loose: one ifstream read per file, like LvePipeline::readFile did. archive: LveArchive::read per entry on one thread, then readAll on every hardware thread.
+//also reports the LZ4 ratio and raw compress / decompress throughput on the same data.
+//run from the repository root so models/ and shaders/ resolve
+#include "vulkan_archive.hpp"
+#include "vulkan_lz4.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace {
+   using Clock = std::chrono::high_resolution_clock;
+
+   double millisecondsSince(Clock::time_point start) {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+   }
+
+   std::vector<char> readWholeFile(const std::filesystem::path &path) {
+      std::ifstream file(path, std::ios::binary | std::ios::ate);
+      std::vector<char> contents(static_cast<size_t>(file.tellg()));
+      file.seekg(0);
+      file.read(contents.data(), contents.size());
+      return contents;
+   }
+}
+
+int main(int argc, char **argv) {
+   const int copies = argc > 1 ? std::max(1, std::atoi(argv[1])) : 16;
+   constexpr int RUNS = 5;
+   const auto directory = std::filesystem::temp_directory_path() / "lve_archive_benchmark";
+   std::filesystem::remove_all(directory);
+   std::filesystem::create_directories(directory);
+
+   //the same files under copy<i>/, loose on disk and as archive sources
+   std::vector<lve::LveArchive::Source> sources{};
+   std::vector<std::filesystem::path> loosePaths{};
+   uint64_t totalBytes = 0;
+   for (const char *root : {"models", "shaders"}) {
+      for (const auto &entry : std::filesystem::recursive_directory_iterator(root)) {
+         if (!entry.is_regular_file() || entry.path().extension() == ".tmp") continue;
+         const std::vector<char> contents = readWholeFile(entry.path());
+         for (int c = 0; c < copies; c++) {
+            const std::string path = "copy" + std::to_string(c) + "/" + entry.path().generic_string();
+            const auto loose = directory / path;
+            std::filesystem::create_directories(loose.parent_path());
+            std::ofstream(loose, std::ios::binary).write(contents.data(), contents.size());
+            loosePaths.push_back(loose);
+            sources.push_back({path, contents});
+            totalBytes += contents.size();
+         }
+      }
+   }
+   std::vector<std::string> names{};
+   for (const auto &source : sources) names.push_back(source.path);
+
+   const std::string archivePath = (directory / "assets.lvepak").string();
+   auto start = Clock::now();
+   lve::LveArchive::write(archivePath, sources);
+   const double packMs = millisecondsSince(start);
+   const uint64_t archiveBytes = std::filesystem::file_size(archivePath);
+
+   lve::LveArchive archive{archivePath};
+   std::vector<const lve::LveArchiveEntry *> entries{};
+   for (const auto &name : names) entries.push_back(archive.find(name));
+
+   double looseMs = 0.0, serialMs = 0.0, parallelMs = 0.0;
+   bool verified = true;
+   for (int run = 0; run < RUNS; run++) {
+      start = Clock::now();
+      size_t bytes = 0;
+      for (const auto &path : loosePaths) bytes += readWholeFile(path).size();
+      looseMs += millisecondsSince(start);
+
+      start = Clock::now();
+      for (const auto &name : names) bytes += archive.read(name, 1).size();
+      serialMs += millisecondsSince(start);
+
+      start = Clock::now();
+      const auto contents = archive.readAll(entries);
+      parallelMs += millisecondsSince(start);
+      for (size_t e = 0; e < entries.size(); e++) verified = verified && lve::LveArchive::verify(*entries[e], contents[e]);
+      if (bytes == 0) return 1;
+   }
+   looseMs /= RUNS;
+   serialMs /= RUNS;
+   parallelMs /= RUNS;
+
+   //raw LZ4 on one concatenated buffer, single threaded
+   std::vector<char> all{};
+   for (const auto &source : sources) all.insert(all.end(), source.contents.begin(), source.contents.end());
+   std::vector<char> compressed(lve::LveLz4::compressBound(all.size()));
+   start = Clock::now();
+   compressed.resize(lve::LveLz4::compress(all.data(), all.size(), compressed.data(), compressed.size()));
+   const double compressMs = millisecondsSince(start);
+   std::vector<char> roundTrip(all.size());
+   start = Clock::now();
+   const bool decoded = lve::LveLz4::decompress(compressed.data(), compressed.size(), roundTrip.data(), roundTrip.size());
+   const double decompressMs = millisecondsSince(start);
+
+   auto mbPerSecond = [totalBytes](double ms) { return totalBytes / (ms * 1000.0); };
+   std::cout << std::fixed << std::setprecision(1)
+             << sources.size() << " files, " << totalBytes / 1e6 << " MB -> " << archiveBytes / 1e6 << " MB archive ("
+             << 100.0 * archiveBytes / totalBytes << "%), packed in " << packMs << " ms\n\n"
+             << std::left << std::setw(36) << "read" << std::right << std::setw(10) << "ms" << std::setw(10) << "MB/s" << '\n'
+             << std::left << std::setw(36) << "loose files" << std::right << std::setw(10) << looseMs << std::setw(10) << mbPerSecond(looseMs) << '\n'
+             << std::left << std::setw(36) << "archive, 1 thread" << std::right << std::setw(10) << serialMs << std::setw(10) << mbPerSecond(serialMs) << '\n'
+             << std::left << std::setw(36) << ("archive readAll, " + std::to_string(std::thread::hardware_concurrency()) + " threads") << std::right
+             << std::setw(10) << parallelMs << std::setw(10) << mbPerSecond(parallelMs) << '\n'
+             << "\nlz4 single buffer: ratio " << 100.0 * compressed.size() / all.size() << "%, compress " << mbPerSecond(compressMs)
+             << " MB/s, decompress " << mbPerSecond(decompressMs) << " MB/s, round trip " << (decoded && roundTrip == all ? "ok" : "FAILED")
+             << "\ncontent hashes " << (verified ? "ok" : "FAILED") << '\n';
+
+   std::filesystem::remove_all(directory);
+   return verified && decoded ? 0 : 1;
+}
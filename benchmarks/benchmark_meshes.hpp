@@ -0,0 +1,64 @@
+#pragma once
+
+//generated meshes shared by the benchmarks. Header only: bench.bat builds every .cpp in benchmarks/ into its own executable
+#include "vulkan_model.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+namespace benchmarks {
+
+   //resolution x resolution grid bent into an open cylinder of radius 1 around the y axis (-1 to 1), white, with normals and
+   //texture coordinates on every vertex. Rows of quads in order, so the index order already has some locality
+   inline lve::LveModel::Builder makeGrid(int resolution) {
+      lve::LveModel::Builder builder{};
+      for (int y = 0; y < resolution; y++) {
+         for (int x = 0; x < resolution; x++) {
+            lve::LveModel::Vertex vertex{};
+            const float angle = 6.2831853f * x / resolution;
+            vertex.position = {std::cos(angle), 2.f * y / resolution - 1.f, std::sin(angle)};
+            vertex.color = {1.f, 1.f, 1.f};
+            vertex.normal = {std::cos(angle), 0.f, std::sin(angle)};
+            vertex.uv = {static_cast<float>(x) / resolution, static_cast<float>(y) / resolution};
+            builder.vertices.push_back(vertex);
+         }
+      }
+      for (int y = 0; y + 1 < resolution; y++) {
+         for (int x = 0; x + 1 < resolution; x++) {
+            const uint32_t a = y * resolution + x, b = a + 1, c = a + resolution, d = c + 1;
+            builder.indices.insert(builder.indices.end(), {a, b, d, a, d, c});
+         }
+      }
+      return builder;
+   }
+
+   //the same grid as an OBJ in the temp directory (lve_grid_<resolution>.obj), written on first use, with separate v / vn / vt
+   //entries per vertex like an exporter would. Left there for the next run
+   inline std::string gridObjPath(int resolution) {
+      const std::string path = (std::filesystem::temp_directory_path() / ("lve_grid_" + std::to_string(resolution) + ".obj")).string();
+      if (std::filesystem::exists(path)) return path;
+
+      std::ofstream out(path, std::ios::binary);
+      out << std::fixed << std::setprecision(6);
+      for (int y = 0; y < resolution; y++) {
+         for (int x = 0; x < resolution; x++) {
+            const float angle = 6.2831853f * x / resolution;
+            out << "v " << std::cos(angle) << ' ' << (2.f * y / resolution - 1.f) << ' ' << std::sin(angle) << '\n';
+            out << "vn " << std::cos(angle) << " 0.000000 " << std::sin(angle) << '\n';
+            out << "vt " << float(x) / resolution << ' ' << float(y) / resolution << '\n';
+         }
+      }
+      for (int y = 0; y + 1 < resolution; y++) {
+         for (int x = 0; x + 1 < resolution; x++) {
+            const int a = y * resolution + x + 1, b = a + 1, c = a + resolution, d = c + 1;
+            out << "f " << a << '/' << a << '/' << a << ' ' << b << '/' << b << '/' << b << ' ' << d << '/' << d << '/' << d << '\n';
+            out << "f " << a << '/' << a << '/' << a << ' ' << d << '/' << d << '/' << d << ' ' << c << '/' << c << '/' << c << '\n';
+         }
+      }
+      return path;
+   }
+}
@@ -0,0 +1,250 @@
+//load time of every model in models/ as OBJ vs the same mesh written out as .glb, in two layouts:
+//mapped: one buffer view interleaved like LveModel::Vertex plus uint32 indices, used in place.
+//converted: separate tightly packed streams with unorm8 colors and uint16 indices, the way most exporters write them.
+//every load ends with a memcpy into a staging-sized buffer. Also checks both layouts give back the OBJ's vertices,
+//and that node transforms survive as TransformComponents.
+//run from the repository root so models/ resolves
+#include "vulkan_gltf_loader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+namespace {
+   using Clock = std::chrono::high_resolution_clock;
+   using Vertex = lve::LveModel::Vertex;
+
+   double millisecondsSince(Clock::time_point start) {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+   }
+
+   struct View {
+      size_t offset;
+      size_t length;
+      size_t stride;
+   };
+
+   void pad(std::vector<unsigned char> &bin) {
+      while (bin.size() % 4 != 0) bin.push_back(0);
+   }
+
+   size_t append(std::vector<unsigned char> &bin, const void *data, size_t size) {
+      pad(bin);
+      const size_t offset = bin.size();
+      bin.insert(bin.end(), static_cast<const unsigned char *>(data), static_cast<const unsigned char *>(data) + size);
+      return offset;
+   }
+
+   void writeGlb(const std::string &path, const std::string &json, std::vector<unsigned char> bin) {
+      std::string text = json;
+      while (text.size() % 4 != 0) text += ' ';
+      pad(bin);
+
+      auto u32 = [](std::ofstream &out, uint32_t value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+      std::ofstream out{path, std::ios::binary};
+      u32(out, 0x46546C67);
+      u32(out, 2);
+      u32(out, static_cast<uint32_t>(12 + 8 + text.size() + 8 + bin.size()));
+      u32(out, static_cast<uint32_t>(text.size()));
+      u32(out, 0x4E4F534A);
+      out.write(text.data(), text.size());
+      u32(out, static_cast<uint32_t>(bin.size()));
+      u32(out, 0x004E4942);
+      out.write(reinterpret_cast<const char *>(bin.data()), bin.size());
+   }
+
+   std::string viewsJson(const std::vector<View> &views) {
+      std::ostringstream json;
+      json << "\"bufferViews\":[";
+      for (size_t i = 0; i < views.size(); i++) {
+         json << (i ? "," : "") << "{\"buffer\":0,\"byteOffset\":" << views[i].offset << ",\"byteLength\":" << views[i].length;
+         if (views[i].stride) json << ",\"byteStride\":" << views[i].stride;
+         json << "}";
+      }
+      json << "]";
+      return json.str();
+   }
+
+   //one buffer view holding the vertices exactly as LveModel::Vertex, uint32 indices
+   void writeInterleaved(const std::string &path, const lve::LveModel::Builder &builder) {
+      std::vector<unsigned char> bin{};
+      const size_t vertexBytes = builder.vertices.size() * sizeof(Vertex);
+      const size_t indexBytes = builder.indices.size() * sizeof(uint32_t);
+      const std::vector<View> views = {
+         {append(bin, builder.vertices.data(), vertexBytes), vertexBytes, sizeof(Vertex)},
+         {append(bin, builder.indices.data(), indexBytes), indexBytes, 0}};
+
+      const size_t count = builder.vertices.size();
+      std::ostringstream json;
+      json << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+           << "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"COLOR_0\":1,\"NORMAL\":2,\"TEXCOORD_0\":3},\"indices\":4}]}],"
+           << "\"accessors\":["
+           << "{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\"},"
+           << "{\"bufferView\":0,\"byteOffset\":12,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\"},"
+           << "{\"bufferView\":0,\"byteOffset\":24,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\"},"
+           << "{\"bufferView\":0,\"byteOffset\":36,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC2\"},"
+           << "{\"bufferView\":1,\"componentType\":5125,\"count\":" << builder.indices.size() << ",\"type\":\"SCALAR\"}],"
+           << viewsJson(views) << ",\"buffers\":[{\"byteLength\":" << bin.size() << "}]}";
+      writeGlb(path, json.str(), bin);
+   }
+
+   //a stream per attribute, unorm8 colors, the narrowest index type. nodes is a json array of nodes, mesh 0 is the model
+   void writeSeparate(const std::string &path, const lve::LveModel::Builder &builder, const std::string &nodes = "[{\"mesh\":0}]", const std::string &roots = "[0]") {
+      const size_t count = builder.vertices.size();
+      std::vector<float> positions{}, normals{}, uvs{};
+      std::vector<uint8_t> colors{};
+      for (const auto &vertex : builder.vertices) {
+         for (int i = 0; i < 3; i++) positions.push_back(vertex.position[i]);
+         for (int i = 0; i < 3; i++) normals.push_back(vertex.normal[i]);
+         for (int i = 0; i < 2; i++) uvs.push_back(vertex.uv[i]);
+         for (int i = 0; i < 3; i++) colors.push_back(static_cast<uint8_t>(std::lround(std::clamp(vertex.color[i], 0.f, 1.f) * 255.f)));
+         colors.push_back(255);
+      }
+
+      const bool narrow = count <= 65536;
+      std::vector<uint16_t> narrowIndices(builder.indices.begin(), builder.indices.end());
+      const void *indexData = narrow ? static_cast<const void *>(narrowIndices.data()) : static_cast<const void *>(builder.indices.data());
+      const size_t indexBytes = builder.indices.size() * (narrow ? 2 : 4);
+
+      std::vector<unsigned char> bin{};
+      const std::vector<View> views = {
+         {append(bin, positions.data(), positions.size() * 4), positions.size() * 4, 0},
+         {append(bin, normals.data(), normals.size() * 4), normals.size() * 4, 0},
+         {append(bin, uvs.data(), uvs.size() * 4), uvs.size() * 4, 0},
+         {append(bin, colors.data(), colors.size()), colors.size(), 0},
+         {append(bin, indexData, indexBytes), indexBytes, 0}};
+
+      std::ostringstream json;
+      json << "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":" << roots << "}],\"nodes\":" << nodes << ","
+           << "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0,\"NORMAL\":1,\"TEXCOORD_0\":2,\"COLOR_0\":3},\"indices\":4}]}],"
+           << "\"accessors\":["
+           << "{\"bufferView\":0,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\"},"
+           << "{\"bufferView\":1,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC3\"},"
+           << "{\"bufferView\":2,\"componentType\":5126,\"count\":" << count << ",\"type\":\"VEC2\"},"
+           << "{\"bufferView\":3,\"componentType\":5121,\"normalized\":true,\"count\":" << count << ",\"type\":\"VEC4\"},"
+           << "{\"bufferView\":4,\"componentType\":" << (narrow ? 5123 : 5125) << ",\"count\":" << builder.indices.size() << ",\"type\":\"SCALAR\"}],"
+           << viewsJson(views) << ",\"buffers\":[{\"byteLength\":" << bin.size() << "}]}";
+      writeGlb(path, json.str(), bin);
+   }
+
+   //largest difference between the OBJ's vertices and the loaded ones, matched through the indices
+   float compare(const lve::LveModel::Builder &expected, const Vertex *vertices, const uint32_t *indices, size_t indexCount) {
+      if (indexCount != expected.indices.size()) return INFINITY;
+      float error = 0.f;
+      for (size_t i = 0; i < indexCount; i++) {
+         const Vertex &a = expected.vertices[expected.indices[i]];
+         const Vertex &b = vertices[indices[i]];
+         for (int c = 0; c < 3; c++) {
+            error = std::max(error, std::abs(a.position[c] - b.position[c]));
+            error = std::max(error, std::abs(a.normal[c] - b.normal[c]));
+            error = std::max(error, std::abs(a.color[c] - b.color[c]));
+         }
+         for (int c = 0; c < 2; c++) error = std::max(error, std::abs(a.uv[c] - b.uv[c]));
+      }
+      return error;
+   }
+}
+
+int main() {
+   constexpr int RUNS = 20;
+   const auto directory = std::filesystem::temp_directory_path() / "lve_gltf_benchmark";
+   std::filesystem::create_directories(directory);
+
+   std::cout << std::left << std::setw(24) << "model" << std::right << std::setw(10) << "vertices" << std::setw(11) << "obj (ms)"
+             << std::setw(14) << "mapped (ms)" << std::setw(16) << "converted (ms)" << std::setw(10) << "mapped" << std::setw(11) << "converted"
+             << std::setw(12) << "max error" << '\n';
+
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() != ".obj") continue;
+      const std::string objPath = entry.path().string();
+      const std::string stem = entry.path().stem().string();
+      const std::string mappedPath = (directory / (stem + "_interleaved.glb")).string();
+      const std::string convertedPath = (directory / (stem + "_separate.glb")).string();
+
+      lve::LveModel::Builder reference{};
+      reference.loadModel(objPath);
+      writeInterleaved(mappedPath, reference);
+      writeSeparate(convertedPath, reference);
+      std::vector<char> staging(reference.vertices.size() * sizeof(Vertex) + reference.indices.size() * sizeof(uint32_t));
+
+      double obj = 0.0, mapped = 0.0, converted = 0.0;
+      float error = 0.f;
+      for (int run = 0; run < RUNS; run++) {
+         auto start = Clock::now();
+         lve::LveModel::Builder builder{};
+         builder.loadModel(objPath);
+         std::memcpy(staging.data(), builder.vertices.data(), builder.vertices.size() * sizeof(Vertex));
+         std::memcpy(staging.data() + builder.vertices.size() * sizeof(Vertex), builder.indices.data(), builder.indices.size() * sizeof(uint32_t));
+         obj += millisecondsSince(start);
+
+         start = Clock::now();
+         {
+            lve::LveGltfFile file{mappedPath};
+            lve::LveGltfFile::MappedMesh mesh{};
+            if (!file.mapMesh(0, mesh)) {
+               std::cerr << mappedPath << " was not mapped\n";
+               return 1;
+            }
+            std::memcpy(staging.data(), mesh.vertices, mesh.vertexCount * sizeof(Vertex));
+            std::memcpy(staging.data() + mesh.vertexCount * sizeof(Vertex), mesh.indices, mesh.indexCount * sizeof(uint32_t));
+            mapped += millisecondsSince(start);
+            if (run == 0) error = std::max(error, compare(reference, mesh.vertices, mesh.indices, mesh.indexCount));
+         }
+
+         start = Clock::now();
+         {
+            lve::LveGltfFile file{convertedPath};
+            lve::LveModel::Builder mesh{};
+            file.appendMesh(0, glm::mat4{1.f}, mesh);
+            std::memcpy(staging.data(), mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+            std::memcpy(staging.data() + mesh.vertices.size() * sizeof(Vertex), mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+            converted += millisecondsSince(start);
+            //colors went through unorm8
+            if (run == 0) error = std::max(error, std::max(0.f, compare(reference, mesh.vertices.data(), mesh.indices.data(), mesh.indices.size()) - 0.5f / 255.f));
+         }
+      }
+      obj /= RUNS;
+      mapped /= RUNS;
+      converted /= RUNS;
+
+      std::cout << std::left << std::setw(24) << entry.path().filename().string() << std::right << std::setw(10) << reference.vertices.size()
+                << std::fixed << std::setprecision(3) << std::setw(11) << obj << std::setw(14) << mapped << std::setw(16) << converted
+                << std::setprecision(1) << std::setw(9) << obj / mapped << "x" << std::setw(10) << obj / converted << "x"
+                << std::scientific << std::setprecision(1) << std::setw(12) << error << std::defaultfloat << '\n';
+   }
+
+   //node transforms: a rotated, scaled parent with a translated child. The flattened mesh has to match the matrices,
+   //and the decomposed TransformComponent has to rebuild the same world matrix
+   lve::LveModel::Builder triangle{};
+   triangle.vertices = {Vertex{{0.f, 0.f, 0.f}, {1.f, 1.f, 1.f}, {0.f, 0.f, 1.f}, {}}, Vertex{{1.f, 0.f, 0.f}, {1.f, 1.f, 1.f}, {0.f, 0.f, 1.f}, {}}, Vertex{{0.f, 1.f, 0.f}, {1.f, 1.f, 1.f}, {0.f, 0.f, 1.f}, {}}};
+   triangle.indices = {0, 1, 2};
+   const std::string hierarchyPath = (directory / "hierarchy.glb").string();
+   writeSeparate(hierarchyPath, triangle,
+      "[{\"children\":[1],\"rotation\":[0.2,0.5,-0.1,0.8366600265],\"scale\":[2,2,2],\"translation\":[1,-2,3]},{\"mesh\":0,\"translation\":[0.5,0,1]}]");
+
+   lve::LveGltfFile file{hierarchyPath};
+   float matrixError = 0.f;
+   for (const auto &instance : file.instances()) {
+      lve::TransformComponent transform = lve::LveGltfLoader::decompose(instance.world);
+      const glm::mat4 rebuilt = transform.mat4();
+      for (int c = 0; c < 4; c++) {
+         for (int r = 0; r < 4; r++) matrixError = std::max(matrixError, std::abs(rebuilt[c][r] - instance.world[c][r]));
+      }
+
+      lve::LveModel::Builder flattened{};
+      file.appendMesh(instance.mesh, instance.world, flattened);
+      for (size_t v = 0; v < triangle.vertices.size(); v++) {
+         const glm::vec3 expected = glm::vec3{instance.world * glm::vec4{triangle.vertices[v].position, 1.f}};
+         for (int c = 0; c < 3; c++) matrixError = std::max(matrixError, std::abs(flattened.vertices[v].position[c] - expected[c]));
+      }
+   }
+   std::cout << "\nnode hierarchy: " << file.instances().size() << " instance(s), max transform error " << matrixError << '\n';
+   return 0;
+}
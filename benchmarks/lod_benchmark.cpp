@@ -0,0 +1,121 @@
+//LOD chains generated by Builder::generateLods for models/ and generated spheres, then the triangles a field of N x N vases
+//submits per frame with and without screen space error LOD selection (1 pixel at 1080p, 50 degree fov, vases 1 unit apart).
+//usage: lod_benchmark [field size] [sphere resolution ...]   (default 100, 128 512)
+//run from the repository root so models/ resolves
+#include "vulkan_camera.hpp"
+#include "vulkan_model.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+   using Vertex = lve::LveModel::Vertex;
+   using Clock = std::chrono::high_resolution_clock;
+
+   //uv sphere, the kind of smooth dense mesh LODs are for
+   lve::LveModel::Builder makeSphere(int resolution) {
+      lve::LveModel::Builder builder{};
+      for (int y = 0; y <= resolution; y++) {
+         for (int x = 0; x <= resolution; x++) {
+            const float theta = 3.14159265f * y / resolution;
+            const float phi = 6.2831853f * x / resolution;
+            Vertex vertex{};
+            vertex.normal = {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+            vertex.position = vertex.normal;
+            vertex.uv = {static_cast<float>(x) / resolution, static_cast<float>(y) / resolution};
+            builder.vertices.push_back(vertex);
+         }
+      }
+      for (int y = 0; y < resolution; y++) {
+         for (int x = 0; x < resolution; x++) {
+            const uint32_t a = y * (resolution + 1) + x, b = a + 1, c = a + resolution + 1, d = c + 1;
+            builder.indices.insert(builder.indices.end(), {a, b, d, a, d, c});
+         }
+      }
+      return builder;
+   }
+
+   void reportChain(const std::string &name, lve::LveModel::Builder &builder) {
+      builder.optimize();
+      const auto start = Clock::now();
+      builder.generateLods();
+      const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+      std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(1) << std::setw(10) << ms << "  ";
+      for (const auto &lod : builder.lods) {
+         std::cout << lod.indexCount / 3 << " (" << std::setprecision(4) << lod.error << ")  ";
+      }
+      std::cout << '\n';
+   }
+
+   //same selection as SimpleRenderSystem
+   uint32_t selectLod(const lve::LveModel::Builder &builder, float projectedScale, float maxError) {
+      uint32_t lod = 0;
+      while (lod + 1 < builder.lods.size() && builder.lods[lod + 1].error * projectedScale <= maxError) lod++;
+      return lod;
+   }
+}
+
+int main(int argc, char **argv) {
+   const int field = argc > 1 ? std::atoi(argv[1]) : 100;
+   std::vector<int> resolutions{};
+   for (int i = 2; i < argc; i++) resolutions.push_back(std::atoi(argv[i]));
+   if (resolutions.empty()) resolutions = {128, 512};
+
+   std::cout << std::left << std::setw(20) << "mesh" << std::right << std::setw(10) << "ms" << "  triangles (error) per level\n";
+   lve::LveModel::Builder vase{};
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() != ".obj") continue;
+      lve::LveModel::Builder builder{};
+      builder.loadModel(entry.path().string());
+      reportChain(entry.path().filename().string(), builder);
+      if (entry.path().filename() == "smooth_vase.obj") vase = builder;
+   }
+   for (int resolution : resolutions) {
+      lve::LveModel::Builder sphere = makeSphere(resolution);
+      reportChain("sphere " + std::to_string(resolution), sphere);
+   }
+   if (vase.lods.empty()) return 0;
+
+   //camera at the front edge of the field, looking into it
+   lve::LveCamera camera{};
+   camera.setPerspectiveProjection(glm::radians(50.f), 16.f / 9.f, 0.1f, 1000.f);
+   camera.setViewYXZ({0.f, -1.f, -2.f}, {0.f, 0.f, 0.f});
+   const glm::mat4 &projection = camera.getProjection();
+   const glm::mat4 &view = camera.getView();
+   const float screenError = 2.f * 1.f / 1080.f;
+
+   glm::vec3 boundsMin{vase.vertices[0].position}, boundsMax{vase.vertices[0].position};
+   for (const auto &vertex : vase.vertices) {
+      boundsMin = glm::min(boundsMin, vertex.position);
+      boundsMax = glm::max(boundsMax, vertex.position);
+   }
+   const glm::vec3 boundsCenter = (boundsMin + boundsMax) * 0.5f;
+   const float boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f;
+
+   size_t fullTriangles = 0, lodTriangles = 0;
+   std::vector<size_t> histogram(vase.lods.size(), 0);
+   for (int z = 0; z < field; z++) {
+      for (int x = 0; x < field; x++) {
+         const glm::vec3 translation{x - field * 0.5f, 0.f, static_cast<float>(z)};
+         const glm::vec4 center = view * glm::vec4{boundsCenter + translation, 1.f};
+         const float w = projection[2][3] * (center.z - boundsRadius) + projection[3][3];
+         const uint32_t lod = w <= 0.f ? 0 : selectLod(vase, std::abs(projection[1][1]) / w, screenError);
+         histogram[lod]++;
+         fullTriangles += vase.lods[0].indexCount / 3;
+         lodTriangles += vase.lods[lod].indexCount / 3;
+      }
+   }
+
+   std::cout << "\n" << field * field << " vases, triangles per frame: " << fullTriangles << " full, " << lodTriangles << " with LOD ("
+             << std::setprecision(1) << static_cast<double>(fullTriangles) / lodTriangles << "x fewer)\nobjects per level:";
+   for (size_t count : histogram) std::cout << " " << count;
+   std::cout << '\n';
+   return 0;
+}
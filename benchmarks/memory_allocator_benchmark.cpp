@@ -0,0 +1,95 @@
+//CPU side of LveMemoryAllocator: the LveTlsf bookkeeping behind every buffer and image, on a churn of [resources] (default 4096)
+//live buffers of 256 B to 4 MiB, freed and replaced at random like models streaming in and out.
+//reports ns per allocate / free, how many vkAllocateMemory calls one allocation per resource would have made vs the blocks
+//needed, and how full and fragmented the blocks end up
+#include "vulkan_memory_allocator.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+   using Clock = std::chrono::high_resolution_clock;
+
+   struct Resource {
+      size_t block;
+      uint32_t range;
+   };
+
+   //blocks of LveMemoryAllocator::BLOCK_SIZE, first one with room wins, like LveMemoryAllocator::allocate
+   struct Blocks {
+      std::vector<std::unique_ptr<lve::LveTlsf>> tlsfs{};
+
+      Resource allocate(VkDeviceSize size, VkDeviceSize alignment) {
+         VkDeviceSize offset = 0;
+         for (size_t i = 0; i < tlsfs.size(); i++) {
+            const uint32_t range = tlsfs[i]->allocate(size, alignment, offset);
+            if (range != lve::LveTlsf::INVALID) return {i, range};
+         }
+         tlsfs.push_back(std::make_unique<lve::LveTlsf>(lve::LveMemoryAllocator::BLOCK_SIZE));
+         return {tlsfs.size() - 1, tlsfs.back()->allocate(size, alignment, offset)};
+      }
+
+      void free(const Resource &resource) {
+         tlsfs[resource.block]->free(resource.range);
+      }
+   };
+}
+
+int main(int argc, char **argv) {
+   const size_t resources = argc > 1 ? std::max(1, std::atoi(argv[1])) : 4096;
+   constexpr size_t CHURN = 1000000;
+
+   std::mt19937 random{42};
+   //log uniform, most buffers small and a few big ones
+   std::uniform_real_distribution<double> logSize{std::log2(256.0), std::log2(4.0 * 1024 * 1024)};
+   auto nextSize = [&]() { return static_cast<VkDeviceSize>(std::exp2(logSize(random))); };
+
+   Blocks blocks{};
+   std::vector<Resource> live{};
+   live.reserve(resources);
+   uint64_t deviceAllocationsPerResource = 0;
+
+   auto start = Clock::now();
+   for (size_t i = 0; i < resources; i++) live.push_back(blocks.allocate(nextSize(), 256));
+   deviceAllocationsPerResource += resources;
+   const double fillNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / resources;
+
+   //pairs of free + allocate, indices and sizes drawn up front so only the allocator is timed
+   std::vector<size_t> victims(CHURN);
+   std::vector<VkDeviceSize> sizes(CHURN);
+   for (size_t i = 0; i < CHURN; i++) {
+      victims[i] = random() % resources;
+      sizes[i] = nextSize();
+   }
+   start = Clock::now();
+   for (size_t i = 0; i < CHURN; i++) {
+      blocks.free(live[victims[i]]);
+      live[victims[i]] = blocks.allocate(sizes[i], 256);
+   }
+   const double churnNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / CHURN;
+   deviceAllocationsPerResource += CHURN;
+
+   VkDeviceSize blockBytes = 0;
+   VkDeviceSize usedBytes = 0;
+   uint32_t freeRanges = 0;
+   for (const auto &tlsf : blocks.tlsfs) {
+      blockBytes += tlsf->size();
+      usedBytes += tlsf->size() - tlsf->freeBytes();
+      freeRanges += tlsf->freeRangeCount();
+   }
+
+   std::cout << std::fixed << std::setprecision(1);
+   std::cout << resources << " live resources, " << CHURN << " free + allocate pairs\n";
+   std::cout << "  fill:  " << fillNs << " ns per allocate\n";
+   std::cout << "  churn: " << churnNs << " ns per free + allocate\n";
+   std::cout << "  vkAllocateMemory calls: " << deviceAllocationsPerResource << " one per resource vs " << blocks.tlsfs.size()
+             << " blocks of " << lve::LveMemoryAllocator::BLOCK_SIZE / (1024 * 1024) << " MiB\n";
+   std::cout << "  blocks " << 100.0 * usedBytes / blockBytes << "% used, " << freeRanges << " free ranges\n";
+   return 0;
+}
@@ -0,0 +1,88 @@
+//cold vs warm load time of every model in models/
+//cold: tinyobj parse + vertex dedup + cache write. warm: map the cache and memcpy into a staging-sized buffer, for a raw cache and
+//for one encoded with LveMeshCodec (decode included), next to both file sizes. The import columns are what a device with
+//VK_EXT_external_memory_host uploads straight from the mapped raw cache (LveModel::importMappedFile) instead of staging it, for
+//models created in the fp32 layout and in CompactSplit, 0 where it isn't worth an import.
+//these caches skip the optimize / LOD / meshlet steps, so they are deleted at the end for the engine to rebuild its own
+//run from the repository root so models/ resolves
+#include "vulkan_mesh_cache.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+   using Clock = std::chrono::high_resolution_clock;
+
+   double millisecondsSince(Clock::time_point start) {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+   }
+
+   //average time to open the cache and copy it into staging, negative on a cache miss
+   double warmLoad(const std::string &path, std::vector<char> &staging, int runs) {
+      double total = 0.0;
+      for (int run = 0; run < runs; run++) {
+         const auto start = Clock::now();
+         lve::LveMeshCache cache{};
+         if (!cache.open(path)) return -1.0;
+         const size_t vertexBytes = cache.vertexCount() * sizeof(lve::LveModel::Vertex);
+         memcpy(staging.data(), cache.vertices(), vertexBytes);
+         memcpy(staging.data() + vertexBytes, cache.indices(), cache.indexCount() * sizeof(uint32_t));
+         total += millisecondsSince(start);
+      }
+      return total / runs;
+   }
+}
+
+int main() {
+   constexpr int WARM_RUNS = 20;
+
+   std::cout << std::left << std::setw(28) << "model" << std::right << std::setw(12) << "vertices"
+             << std::setw(14) << "cold (ms)" << std::setw(14) << "warm (ms)" << std::setw(10) << "speedup"
+             << std::setw(14) << "raw (KB)" << std::setw(16) << "encoded (ms)" << std::setw(14) << "encoded (KB)"
+             << std::setw(18) << "fp32 import (KB)" << std::setw(20) << "compact import (KB)" << '\n';
+
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() != ".obj") continue;
+      const std::string path = entry.path().string();
+
+      std::filesystem::remove(lve::LveMeshCache::cachePathFor(path));
+
+      auto start = Clock::now();
+      lve::LveModel::Builder builder{};
+      builder.loadModel(path);
+      lve::LveMeshCache::write(path, builder, lve::LveMeshEncoding::Raw);
+      const double cold = millisecondsSince(start);
+
+      //stands in for the mapped staging buffer, allocated up front like vkMapMemory would hand it to us
+      std::vector<char> staging(builder.vertices.size() * sizeof(lve::LveModel::Vertex) + builder.indices.size() * sizeof(uint32_t));
+
+      const double warm = warmLoad(path, staging, WARM_RUNS);
+      const uint64_t rawBytes = std::filesystem::file_size(lve::LveMeshCache::cachePathFor(path));
+      lve::LveMeshCache::write(path, builder, lve::LveMeshEncoding::Codec);
+      const double encoded = warmLoad(path, staging, WARM_RUNS);
+      const uint64_t encodedBytes = std::filesystem::file_size(lve::LveMeshCache::cachePathFor(path));
+      auto importedBytes = [&](lve::LveModel::VertexFormat vertexFormat) {
+         const VkDeviceSize bytes = lve::LveModel::importableBytes(
+            vertexFormat, static_cast<uint32_t>(builder.vertices.size()), static_cast<uint32_t>(builder.indices.size()));
+         return bytes >= lve::LveModel::HOST_IMPORT_MIN_BYTES ? bytes : 0;
+      };
+      const VkDeviceSize floatImport = importedBytes(lve::LveModel::VertexFormat::Float32);
+      const VkDeviceSize compactImport = importedBytes(lve::LveModel::VertexFormat::CompactSplit);
+      if (warm < 0.0 || encoded < 0.0) {
+         std::cerr << "cache miss on warm load of " << path << '\n';
+         return 1;
+      }
+
+      std::cout << std::left << std::setw(28) << entry.path().filename().string() << std::right << std::setw(12) << builder.vertices.size()
+                << std::fixed << std::setprecision(3) << std::setw(14) << cold << std::setw(14) << warm
+                << std::setprecision(1) << std::setw(9) << cold / warm << "x" << std::setw(14) << rawBytes / 1024.0
+                << std::setprecision(3) << std::setw(16) << encoded << std::setprecision(1) << std::setw(14) << encodedBytes / 1024.0
+                << std::setw(18) << floatImport / 1024.0 << std::setw(20) << compactImport / 1024.0 << '\n';
+      std::filesystem::remove(lve::LveMeshCache::cachePathFor(path));
+   }
+   return 0;
+}
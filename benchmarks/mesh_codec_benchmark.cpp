@@ -0,0 +1,132 @@
+//LveMeshCodec on every model in models/ and on grids of the given resolutions, all after the same processing the mesh cache gets
+//(optimize, LODs, meshlets, progressive order): compressed size of the vertex and index blobs, with and without LZ4 on top, and single threaded
+//encode / decode throughput measured on the raw size. Decoded indices are checked triangle by triangle, allowing the rotation the codec may apply.
+//usage: mesh_codec_benchmark [grid resolution ...]   (default 256 512)
+//run from the repository root so models/ resolves
+#include "benchmark_meshes.hpp"
+#include "vulkan_lz4.hpp"
+#include "vulkan_mesh_codec.hpp"
+#include "vulkan_model.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+   using Vertex = lve::LveModel::Vertex;
+   using Clock = std::chrono::high_resolution_clock;
+
+   double millisecondsSince(Clock::time_point start) {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+   }
+
+   //same triangles in the same order and winding, any starting corner
+   bool sameTriangles(const std::vector<uint32_t> &expected, const std::vector<uint32_t> &actual) {
+      if (expected.size() != actual.size()) return false;
+      for (size_t i = 0; i < expected.size(); i += 3) {
+         bool match = false;
+         for (int rotation = 0; rotation < 3 && !match; rotation++) {
+            match = expected[i] == actual[i + rotation] &&
+               expected[i + 1] == actual[i + (rotation + 1) % 3] &&
+               expected[i + 2] == actual[i + (rotation + 2) % 3];
+         }
+         if (!match) return false;
+      }
+      return true;
+   }
+
+   size_t lz4Size(const std::vector<unsigned char> &data) {
+      std::vector<char> compressed(lve::LveLz4::compressBound(data.size()));
+      return lve::LveLz4::compress(reinterpret_cast<const char *>(data.data()), data.size(), compressed.data(), compressed.size());
+   }
+
+   bool report(const std::string &name, lve::LveModel::Builder builder) {
+      builder.optimize();
+      builder.generateLods();
+      builder.buildMeshlets();
+      builder.makeProgressive();
+      const size_t vertexBytes = builder.vertices.size() * sizeof(Vertex);
+      const size_t indexBytes = builder.indices.size() * sizeof(uint32_t);
+      //enough repetitions that even the cube takes measurable time
+      const int runs = static_cast<int>(std::max<size_t>(4, (64u << 20) / (vertexBytes + indexBytes)));
+
+      std::vector<unsigned char> vertexBlob{}, indexBlob{};
+      auto start = Clock::now();
+      for (int run = 0; run < runs; run++) {
+         vertexBlob.clear();
+         indexBlob.clear();
+         lve::LveMeshCodec::encodeVertices(builder.vertices.data(), builder.vertices.size(), sizeof(Vertex), vertexBlob);
+         lve::LveMeshCodec::encodeIndices(builder.indices.data(), builder.indices.size(), indexBlob);
+      }
+      const double encodeMs = millisecondsSince(start) / runs;
+
+      std::vector<Vertex> vertices(builder.vertices.size());
+      std::vector<uint32_t> indices(builder.indices.size());
+      //untimed first pass so page faults on the fresh output arrays don't count as decode time
+      bool decoded = lve::LveMeshCodec::decodeVertices(vertexBlob.data(), vertexBlob.size(), vertices.data(), vertices.size(), sizeof(Vertex)) &&
+         lve::LveMeshCodec::decodeIndices(indexBlob.data(), indexBlob.size(), indices.data(), indices.size());
+      start = Clock::now();
+      for (int run = 0; run < runs; run++) {
+         decoded = decoded && lve::LveMeshCodec::decodeVertices(vertexBlob.data(), vertexBlob.size(), vertices.data(), vertices.size(), sizeof(Vertex));
+      }
+      const double vertexMs = millisecondsSince(start) / runs;
+      start = Clock::now();
+      for (int run = 0; run < runs; run++) {
+         decoded = decoded && lve::LveMeshCodec::decodeIndices(indexBlob.data(), indexBlob.size(), indices.data(), indices.size());
+      }
+      const double indexMs = millisecondsSince(start) / runs;
+
+      const bool ok = decoded && std::memcmp(vertices.data(), builder.vertices.data(), vertexBytes) == 0 && sameTriangles(builder.indices, indices);
+      auto mbPerSecond = [](size_t bytes, double ms) { return bytes / (ms * 1000.0); };
+      auto percent = [](size_t part, size_t whole) { return 100.0 * part / std::max<size_t>(whole, 1); };
+
+      std::vector<unsigned char> raw(vertexBytes + indexBytes);
+      std::memcpy(raw.data(), builder.vertices.data(), vertexBytes);
+      std::memcpy(raw.data() + vertexBytes, builder.indices.data(), indexBytes);
+      std::vector<unsigned char> encoded = vertexBlob;
+      encoded.insert(encoded.end(), indexBlob.begin(), indexBlob.end());
+
+      std::cout << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+                << std::setw(10) << builder.indices.size() / 3
+                << std::setw(9) << percent(vertexBlob.size(), vertexBytes) << '%'
+                << std::setw(9) << percent(indexBlob.size(), indexBytes) << '%'
+                << std::setw(9) << percent(lz4Size(raw), raw.size()) << '%'
+                << std::setw(9) << percent(lz4Size(encoded), raw.size()) << '%'
+                << std::setprecision(0)
+                << std::setw(10) << mbPerSecond(raw.size(), encodeMs)
+                << std::setw(10) << mbPerSecond(vertexBytes, vertexMs)
+                << std::setw(10) << mbPerSecond(indexBytes, indexMs)
+                << std::setw(10) << mbPerSecond(raw.size(), vertexMs + indexMs)
+                << "  " << (ok ? "ok" : "FAILED") << '\n';
+      return ok;
+   }
+}
+
+int main(int argc, char **argv) {
+   std::vector<int> resolutions{};
+   for (int i = 1; i < argc; i++) resolutions.push_back(std::max(2, std::atoi(argv[i])));
+   if (resolutions.empty()) resolutions = {256, 512};
+
+   std::cout << std::left << std::setw(22) << "mesh" << std::right << std::setw(10) << "triangles"
+             << std::setw(10) << "vertices" << std::setw(10) << "indices" << std::setw(10) << "lz4"
+             << std::setw(10) << "codec+lz4" << std::setw(10) << "enc MB/s" << std::setw(10) << "vtx MB/s"
+             << std::setw(10) << "idx MB/s" << std::setw(10) << "dec MB/s" << '\n';
+
+   bool ok = true;
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() != ".obj") continue;
+      lve::LveModel::Builder builder{};
+      builder.loadModel(entry.path().string());
+      ok = report(entry.path().filename().string(), std::move(builder)) && ok;
+   }
+   for (int resolution : resolutions) {
+      ok = report("grid " + std::to_string(resolution), benchmarks::makeGrid(resolution)) && ok;
+   }
+   return ok ? 0 : 1;
+}
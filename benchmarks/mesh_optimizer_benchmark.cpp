@@ -0,0 +1,91 @@
+//ACMR / ATVR (16 entry FIFO) of the index order loadModel produces, after the vertex cache pass and after the overdraw pass.
+//shuffled grids stand in for large scanned meshes whose triangle order carries no locality at all.
+//usage: mesh_optimizer_benchmark [grid resolution ...]   (default 256 512)
+//run from the repository root so models/ resolves
+#include "benchmark_meshes.hpp"
+#include "vulkan_model.hpp"
+#include "vulkan_mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+   using Vertex = lve::LveModel::Vertex;
+   using Clock = std::chrono::high_resolution_clock;
+   using Statistics = lve::LveMeshOptimizer::VertexCacheStatistics;
+
+   lve::LveModel::Builder makeGrid(int resolution, bool shuffled) {
+      lve::LveModel::Builder builder = benchmarks::makeGrid(resolution);
+      if (!shuffled) return builder;
+      //shuffle whole triangles and the vertex array, keeping the mesh itself intact
+      const std::vector<uint32_t> triangles = std::move(builder.indices);
+      builder.indices.clear();
+      std::mt19937 random{1234};
+      std::vector<size_t> order(triangles.size() / 3);
+      for (size_t i = 0; i < order.size(); i++) order[i] = i;
+      std::shuffle(order.begin(), order.end(), random);
+      std::vector<uint32_t> vertexOrder(builder.vertices.size());
+      for (uint32_t i = 0; i < vertexOrder.size(); i++) vertexOrder[i] = i;
+      std::shuffle(vertexOrder.begin(), vertexOrder.end(), random);
+      std::vector<Vertex> vertices(builder.vertices.size());
+      for (size_t i = 0; i < vertices.size(); i++) vertices[vertexOrder[i]] = builder.vertices[i];
+      builder.vertices = vertices;
+      for (size_t t : order) {
+         for (int k = 0; k < 3; k++) builder.indices.push_back(vertexOrder[triangles[3 * t + k]]);
+      }
+      return builder;
+   }
+
+   void report(const std::string &name, lve::LveModel::Builder builder) {
+      const Statistics original = lve::LveMeshOptimizer::analyzeVertexCache(builder.indices, builder.vertices.size());
+
+      auto start = Clock::now();
+      lve::LveMeshOptimizer::optimizeVertexCache(builder.indices, builder.vertices.size());
+      const double cacheMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+      const Statistics cache = lve::LveMeshOptimizer::analyzeVertexCache(builder.indices, builder.vertices.size());
+
+      start = Clock::now();
+      lve::LveMeshOptimizer::optimizeOverdraw(builder.indices, &builder.vertices[0].position, sizeof(Vertex), builder.vertices.size());
+      lve::LveMeshOptimizer::optimizeVertexFetch(builder.vertices, builder.indices);
+      const double overdrawMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+      const Statistics overdraw = lve::LveMeshOptimizer::analyzeVertexCache(builder.indices, builder.vertices.size());
+
+      std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setw(10) << builder.indices.size() / 3
+                << std::setprecision(3)
+                << std::setw(8) << original.acmr << std::setw(8) << original.atvr
+                << std::setw(8) << cache.acmr << std::setw(8) << cache.atvr
+                << std::setw(8) << overdraw.acmr << std::setw(8) << overdraw.atvr
+                << std::setprecision(1) << std::setw(10) << cacheMs << std::setw(10) << overdrawMs << '\n';
+   }
+}
+
+int main(int argc, char **argv) {
+   std::vector<int> resolutions{};
+   for (int i = 1; i < argc; i++) resolutions.push_back(std::atoi(argv[i]));
+   if (resolutions.empty()) resolutions = {256, 512};
+
+   std::cout << std::left << std::setw(24) << "mesh" << std::right << std::setw(10) << "triangles"
+             << std::setw(16) << "file order" << std::setw(16) << "vertex cache" << std::setw(16) << "+ overdraw"
+             << std::setw(10) << "vc (ms)" << std::setw(10) << "od (ms)" << '\n';
+   std::cout << std::setw(34) << "" << std::setw(8) << "ACMR" << std::setw(8) << "ATVR" << std::setw(8) << "ACMR" << std::setw(8) << "ATVR"
+             << std::setw(8) << "ACMR" << std::setw(8) << "ATVR" << '\n';
+
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() != ".obj") continue;
+      lve::LveModel::Builder builder{};
+      builder.loadModel(entry.path().string());
+      report(entry.path().filename().string(), builder);
+   }
+   for (int resolution : resolutions) {
+      report("grid " + std::to_string(resolution), makeGrid(resolution, false));
+      report("shuffled grid " + std::to_string(resolution), makeGrid(resolution, true));
+   }
+   return 0;
+}
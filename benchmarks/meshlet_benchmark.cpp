@@ -0,0 +1,92 @@
+//meshlet statistics per model, then the triangles and draws submitted from cameras around each vase:
+//everything (one vkCmdDrawIndexed), frustum culled meshlets, and frustum + normal cone culled meshlets.
+//run from the repository root so models/ resolves
+#include "vulkan_camera.hpp"
+#include "vulkan_meshlets.hpp"
+#include "vulkan_mesh_optimizer.hpp"
+#include "vulkan_model.hpp"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+   struct View {
+      std::string name;
+      //yaw around the vase and pitch above (negative, y points down) or below it
+      float yaw;
+      float pitch;
+      //distance from the center in bounding radii, close views put part of the vase off screen
+      float distance;
+   };
+
+   size_t triangles(const std::vector<lve::LveMeshletCuller::DrawRange> &ranges) {
+      size_t count = 0;
+      for (const auto &range : ranges) count += range.indexCount / 3;
+      return count;
+   }
+}
+
+int main() {
+   const std::vector<std::string> models{"models/smooth_vase.obj", "models/flat_vase.obj"};
+   const std::vector<View> views{
+      {"front", 0.f, 0.f, 3.f},
+      {"side", 90.f, 0.f, 3.f},
+      {"back", 180.f, 0.f, 3.f},
+      {"above", 0.f, -80.f, 3.f},
+      {"below", 0.f, 80.f, 3.f},
+      {"front, close", 0.f, 0.f, 1.2f},
+      {"above, close", 30.f, -45.f, 1.2f},
+   };
+
+   for (const auto &path : models) {
+      lve::LveModel::Builder builder{};
+      builder.loadModel(path);
+      builder.optimize();
+      const auto before = lve::LveMeshOptimizer::analyzeVertexCache(builder.indices, builder.vertices.size());
+      builder.buildMeshlets();
+      const auto after = lve::LveMeshOptimizer::analyzeVertexCache(builder.indices, builder.vertices.size());
+
+      size_t vertices = 0, triangleCount = 0;
+      for (const auto &meshlet : builder.meshlets) {
+         vertices += meshlet.vertexCount;
+         triangleCount += meshlet.triangleCount;
+      }
+      const size_t meshletCount = builder.meshlets.size();
+      std::cout << "\n" << path << ": " << meshletCount << " meshlets, " << std::fixed << std::setprecision(1)
+                << static_cast<double>(vertices) / meshletCount << " vertices / " << static_cast<double>(triangleCount) / meshletCount
+                << " triangles on average, ACMR " << std::setprecision(3) << before.acmr << " -> " << after.acmr << "\n";
+
+      glm::vec3 boundsMin{builder.vertices[0].position}, boundsMax{builder.vertices[0].position};
+      for (const auto &vertex : builder.vertices) {
+         boundsMin = glm::min(boundsMin, vertex.position);
+         boundsMax = glm::max(boundsMax, vertex.position);
+      }
+      const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+      const float radius = glm::length(boundsMax - boundsMin) * 0.5f;
+
+      std::cout << std::left << std::setw(16) << "view" << std::right << std::setw(10) << "all"
+                << std::setw(10) << "frustum" << std::setw(8) << "draws" << std::setw(10) << "+ cone" << std::setw(8) << "draws" << '\n';
+      for (const auto &view : views) {
+         const float yaw = glm::radians(view.yaw);
+         const float pitch = glm::radians(view.pitch);
+         const glm::vec3 offset{std::sin(yaw) * std::cos(pitch), std::sin(pitch), -std::cos(yaw) * std::cos(pitch)};
+
+         lve::LveCamera camera{};
+         camera.setPerspectiveProjection(glm::radians(50.f), 16.f / 9.f, 0.01f, 100.f);
+         camera.setViewTarget(center + offset * radius * view.distance, center);
+         const lve::LveFrustum frustum = lve::LveFrustum::fromMatrix(camera.getProjection() * camera.getView());
+
+         std::vector<lve::LveMeshletCuller::DrawRange> frustumRanges{}, coneRanges{};
+         lve::LveMeshletCuller::cull(builder.meshlets, frustum, camera.getPosition(), false, frustumRanges);
+         lve::LveMeshletCuller::cull(builder.meshlets, frustum, camera.getPosition(), true, coneRanges);
+
+         std::cout << std::left << std::setw(16) << view.name << std::right << std::setw(10) << triangleCount
+                   << std::setw(10) << triangles(frustumRanges) << std::setw(8) << frustumRanges.size()
+                   << std::setw(10) << triangles(coneRanges) << std::setw(8) << coneRanges.size() << '\n';
+      }
+   }
+   return 0;
+}
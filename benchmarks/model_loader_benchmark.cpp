@@ -0,0 +1,97 @@
+//CPU side of LveModelLoader: every model in models/ loaded [copies] times (default 8) through LveModel::loadMeshData,
+//serially and spread over LveThreadPool with 1, 2, 4, ... threads up to the core count.
+//cold: caches deleted before each run (OBJ import, optimize, LODs, meshlets, cache write). warm: mesh cache decode only.
+//the GPU half (one batched upload per frame) needs a device and isn't measured here.
+//usage: model_loader_benchmark [copies]
+//run from the repository root so models/ resolves
+#include "vulkan_mesh_cache.hpp"
+#include "vulkan_model.hpp"
+#include "vulkan_thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+   using Clock = std::chrono::high_resolution_clock;
+
+   double millisecondsSince(Clock::time_point start) {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+   }
+
+   void removeCaches(const std::vector<std::string> &paths) {
+      for (const auto &path : paths) std::filesystem::remove(lve::LveMeshCache::cachePathFor(path));
+   }
+
+   //0 threads: everything on the calling thread
+   double loadAll(const std::vector<std::string> &paths, unsigned threads) {
+      const auto start = Clock::now();
+      if (threads == 0) {
+         for (const auto &path : paths) {
+            lve::LveModel::MeshData data{};
+            lve::LveModel::loadMeshData(path, data);
+         }
+         return millisecondsSince(start);
+      }
+
+      lve::LveThreadPool pool{threads};
+      std::mutex mutex{};
+      std::condition_variable done{};
+      size_t remaining = paths.size();
+      for (const auto &path : paths) {
+         pool.submit([&, path]() {
+            lve::LveModel::MeshData data{};
+            lve::LveModel::loadMeshData(path, data);
+            std::lock_guard<std::mutex> lock{mutex};
+            if (--remaining == 0) done.notify_one();
+         });
+      }
+      std::unique_lock<std::mutex> lock{mutex};
+      done.wait(lock, [&]() { return remaining == 0; });
+      return millisecondsSince(start);
+   }
+}
+
+int main(int argc, char **argv) {
+   const int copies = argc > 1 ? std::max(1, std::atoi(argv[1])) : 8;
+   std::vector<std::string> models{};
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() == ".obj") models.push_back(entry.path().string());
+   }
+   std::vector<std::string> paths{};
+   for (int c = 0; c < copies; c++) paths.insert(paths.end(), models.begin(), models.end());
+
+   std::vector<unsigned> threadCounts{0};
+   const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+   for (unsigned threads = 1; threads < cores; threads *= 2) threadCounts.push_back(threads);
+   threadCounts.push_back(cores);
+
+   //loads print a line each, collect the table first
+   std::vector<std::pair<double, double>> results{};
+   for (unsigned threads : threadCounts) {
+      removeCaches(models);
+      const double cold = loadAll(paths, threads);
+      const double warm = loadAll(paths, threads);
+      results.push_back({cold, warm});
+   }
+
+   std::cout << '\n' << paths.size() << " loads\n"
+             << std::left << std::setw(16) << "threads" << std::right << std::setw(12) << "cold (ms)" << std::setw(12) << "warm (ms)"
+             << std::setw(12) << "cold x" << std::setw(12) << "warm x" << '\n';
+   for (size_t i = 0; i < threadCounts.size(); i++) {
+      const std::string name = threadCounts[i] == 0 ? "serial" : std::to_string(threadCounts[i]);
+      std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+                << std::setw(12) << results[i].first << std::setw(12) << results[i].second
+                << std::setw(11) << results[0].first / results[i].first << 'x'
+                << std::setw(11) << results[0].second / results[i].second << "x\n";
+   }
+   return 0;
+}
@@ -0,0 +1,129 @@
+//throughput of the threaded OBJ importer against the previous tinyobj path, on models/ and on generated grids.
+//both paths run the same vertex dedup, and the output is compared byte for byte.
+//usage: obj_loader_benchmark [grid resolution ...]   (default 256 1024, a 1024 grid is ~190 MB of OBJ text)
+//run from the repository root so models/ resolves
+#include "benchmark_meshes.hpp"
+#include "vulkan_model.hpp"
+#include "vulkan_obj_loader.hpp"
+#include "vulkan_utils.hpp"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace std {
+   template<>
+   struct hash<lve::LveModel::Vertex> {
+      size_t operator()(lve::LveModel::Vertex const &vertex) const {
+         size_t seed = 0;
+         lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+         return seed;
+      }
+   };
+}
+
+namespace {
+   using Clock = std::chrono::high_resolution_clock;
+
+   //the Builder::loadModel implementation before the threaded importer, kept here as the reference output
+   void loadModelTinyObj(const std::string &filepath, lve::LveModel::Builder &builder) {
+      tinyobj::attrib_t attrib;
+      std::vector<tinyobj::shape_t> shapes;
+      std::vector<tinyobj::material_t> materials;
+      std::string warn, err;
+
+      if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
+         throw std::runtime_error(warn + err);
+      }
+
+      builder.vertices.clear();
+      builder.indices.clear();
+
+      std::unordered_map<lve::LveModel::Vertex, uint32_t> uniqueVertices{};
+      for (const auto &shape : shapes) {
+         for (const auto &index : shape.mesh.indices) {
+            lve::LveModel::Vertex vertex{};
+            if (index.vertex_index >= 0) {
+               vertex.position = {attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1], attrib.vertices[3 * index.vertex_index + 2]};
+               vertex.color = {attrib.colors[3 * index.vertex_index + 0], attrib.colors[3 * index.vertex_index + 1], attrib.colors[3 * index.vertex_index + 2]};
+            }
+            if (index.normal_index >= 0) {
+               vertex.normal = {attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1], attrib.normals[3 * index.normal_index + 2]};
+            }
+            if (index.texcoord_index >= 0) {
+               vertex.uv = {attrib.texcoords[2 * index.texcoord_index + 0], attrib.texcoords[2 * index.texcoord_index + 1]};
+            }
+            if (uniqueVertices.count(vertex) == 0) {
+               uniqueVertices[vertex] = static_cast<uint32_t>(builder.vertices.size());
+               builder.vertices.push_back(vertex);
+            }
+            builder.indices.push_back(uniqueVertices[vertex]);
+         }
+      }
+   }
+
+   template <typename Fn>
+   double secondsFor(Fn fn) {
+      const auto start = Clock::now();
+      fn();
+      return std::chrono::duration<double>(Clock::now() - start).count();
+   }
+
+   bool sameOutput(const lve::LveModel::Builder &a, const lve::LveModel::Builder &b) {
+      return a.vertices.size() == b.vertices.size() && a.indices == b.indices &&
+             memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(lve::LveModel::Vertex)) == 0;
+   }
+
+   void benchmark(const std::string &path) {
+      const double megabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+
+      lve::LveModel::Builder reference{};
+      const double referenceSeconds = secondsFor([&] { loadModelTinyObj(path, reference); });
+
+      lve::LveModel::Builder builder{};
+      const double builderSeconds = secondsFor([&] { builder.loadModel(path); });
+
+      //parse alone, without the serial dedup that both paths share
+      lve::LveObjData obj{};
+      const double parseSeconds = secondsFor([&] { obj = lve::LveObjLoader::load(path); });
+
+      std::cout << std::left << std::setw(26) << std::filesystem::path(path).filename().string() << std::right << std::fixed
+                << std::setprecision(1) << std::setw(9) << megabytes
+                << std::setw(12) << megabytes / referenceSeconds
+                << std::setw(12) << megabytes / builderSeconds
+                << std::setw(12) << megabytes / parseSeconds
+                << std::setw(14) << (obj.positions.size() / 3) / parseSeconds / 1e6
+                << std::setw(8) << (sameOutput(reference, builder) ? "yes" : "NO") << '\n';
+   }
+}
+
+int main(int argc, char **argv) {
+   std::vector<int> resolutions{};
+   for (int i = 1; i < argc; i++) resolutions.push_back(std::atoi(argv[i]));
+   if (resolutions.empty()) resolutions = {256, 1024};
+
+   std::cout << "threads: " << lve::LveObjLoader::chooseThreadCount(SIZE_MAX, 0) << '\n';
+   std::cout << std::left << std::setw(26) << "file" << std::right << std::setw(9) << "MB"
+             << std::setw(12) << "tinyobj" << std::setw(12) << "loadModel" << std::setw(12) << "parse"
+             << std::setw(14) << "parse Mv/s" << std::setw(8) << "same" << '\n';
+   std::cout << std::setw(26 + 9 + 36) << "(MB/s)" << '\n';
+
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() == ".obj") benchmark(entry.path().string());
+   }
+   for (int resolution : resolutions) {
+      benchmark(benchmarks::gridObjPath(resolution));
+   }
+   return 0;
+}
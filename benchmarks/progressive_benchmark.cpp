@@ -0,0 +1,128 @@
+//time to the first drawable level of a progressive mesh vs the whole mesh, on models/ and on generated grids written out as OBJ.
+//each mesh goes through the import steps (optimize, LODs, meshlets, makeProgressive) and gets an encoded cache, then the cache
+//is opened decoding only its coarsest segment (what LveModelLoader hands out first) and decoding all of them. Upload bytes are
+//for the fp32 layout with 32 bit indices. The fully decoded cache is checked against the builder.
+//usage: progressive_benchmark [grid resolution ...]   (default 256 512 1024)
+//run from the repository root so models/ resolves
+#include "vulkan_mesh_cache.hpp"
+#include "vulkan_model.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+   using Clock = std::chrono::high_resolution_clock;
+
+   double millisecondsSince(Clock::time_point start) {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+   }
+
+   //wavy grid, so the simplifier has curvature to keep and the LOD chain stops somewhere realistic
+   void writeGrid(const std::string &path, int resolution) {
+      std::ofstream out(path);
+      for (int y = 0; y < resolution; y++) {
+         for (int x = 0; x < resolution; x++) {
+            const float u = static_cast<float>(x) / (resolution - 1), v = static_cast<float>(y) / (resolution - 1);
+            out << "v " << u << ' ' << 0.05f * std::sin(u * 25.f) * std::cos(v * 17.f) << ' ' << v << '\n';
+         }
+      }
+      for (int y = 0; y + 1 < resolution; y++) {
+         for (int x = 0; x + 1 < resolution; x++) {
+            const int a = y * resolution + x + 1, b = a + 1, c = a + resolution, d = c + 1;
+            out << "f " << a << ' ' << d << ' ' << b << "\nf " << a << ' ' << c << ' ' << d << '\n';
+         }
+      }
+   }
+
+   //same triangles in the same order and winding, any starting corner
+   bool sameTriangles(const uint32_t *expected, const uint32_t *actual, size_t count) {
+      for (size_t i = 0; i < count; i += 3) {
+         bool match = false;
+         for (int rotation = 0; rotation < 3 && !match; rotation++) {
+            match = expected[i] == actual[i + rotation] &&
+               expected[i + 1] == actual[i + (rotation + 1) % 3] &&
+               expected[i + 2] == actual[i + (rotation + 2) % 3];
+         }
+         if (!match) return false;
+      }
+      return true;
+   }
+
+   bool report(const std::string &name, const std::string &path) {
+      lve::LveModel::Builder builder{};
+      builder.loadModel(path);
+      builder.optimize();
+      builder.generateLods();
+      builder.buildMeshlets();
+      builder.makeProgressive();
+      lve::LveMeshCache::write(path, builder);
+
+      constexpr int RUNS = 5;
+      lve::LveMeshCache cache{};
+      //untimed first open so the file is in the page cache for both
+      bool ok = cache.open(path);
+      auto start = Clock::now();
+      for (int run = 0; run < RUNS; run++) ok = cache.open(path, false) && ok;
+      const double baseMs = millisecondsSince(start) / RUNS;
+      const uint32_t baseVertices = cache.decodedVertexCount(), baseIndices = cache.decodedIndexCount();
+      start = Clock::now();
+      for (int run = 0; run < RUNS; run++) ok = cache.open(path) && ok;
+      const double fullMs = millisecondsSince(start) / RUNS;
+
+      ok = ok && cache.vertexCount() == builder.vertices.size() && cache.indexCount() == builder.indices.size() &&
+         std::memcmp(cache.vertices(), builder.vertices.data(), sizeof(lve::LveModel::Vertex) * builder.vertices.size()) == 0 &&
+         sameTriangles(builder.indices.data(), cache.indices(), builder.indices.size());
+      std::filesystem::remove(lve::LveMeshCache::cachePathFor(path));
+
+      auto uploadBytes = [](uint32_t vertices, uint32_t indices) {
+         return vertices * sizeof(lve::LveModel::Vertex) + indices * sizeof(uint32_t);
+      };
+      std::cout << std::left << std::setw(22) << name << std::right << std::fixed
+                << std::setw(10) << builder.lods[0].indexCount / 3
+                << std::setw(8) << builder.lods.size()
+                << std::setw(10) << baseIndices / 3
+                << std::setprecision(1)
+                << std::setw(11) << uploadBytes(baseVertices, baseIndices) / 1024.0
+                << std::setw(11) << uploadBytes(cache.vertexCount(), cache.indexCount()) / 1024.0
+                << std::setprecision(2)
+                << std::setw(10) << baseMs
+                << std::setw(10) << fullMs
+                << "  " << (ok ? "ok" : "FAILED") << '\n';
+      return ok;
+   }
+}
+
+int main(int argc, char **argv) {
+   std::vector<int> resolutions{};
+   for (int i = 1; i < argc; i++) resolutions.push_back(std::max(2, std::atoi(argv[i])));
+   if (resolutions.empty()) resolutions = {256, 512, 1024};
+
+   std::vector<std::pair<std::string, std::string>> meshes{};
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() == ".obj") meshes.push_back({entry.path().filename().string(), entry.path().string()});
+   }
+   const auto directory = std::filesystem::temp_directory_path() / "lve_progressive_benchmark";
+   std::filesystem::create_directories(directory);
+   for (int resolution : resolutions) {
+      const std::string path = (directory / ("grid" + std::to_string(resolution) + ".obj")).string();
+      writeGrid(path, resolution);
+      meshes.push_back({"grid " + std::to_string(resolution), path});
+   }
+
+   std::cout << std::left << std::setw(22) << "mesh" << std::right << std::setw(10) << "triangles" << std::setw(8) << "levels"
+             << std::setw(10) << "base tris" << std::setw(11) << "base KB" << std::setw(11) << "full KB"
+             << std::setw(10) << "base ms" << std::setw(10) << "full ms" << '\n';
+   bool ok = true;
+   for (const auto &mesh : meshes) ok = report(mesh.first, mesh.second) && ok;
+
+   std::filesystem::remove_all(directory);
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+//draws and bake cost of static batching for a field of vases: one draw per object vs one per chunk, at several chunk sizes.
+//full is baking every chunk of the field, rebuild is re-baking the chunk one added vase falls in (what LveStaticBatcher does
+//on add / remove). Only the CPU side, uploads are one buffer copy per chunk either way.
+//usage: static_batch_benchmark [field size]   (default 32, so 32 x 32 vases one unit apart)
+//run from the repository root so models/ resolves
+#include "vulkan_static_batcher.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace {
+   using Clock = std::chrono::high_resolution_clock;
+
+   double millisecondsSince(Clock::time_point start) {
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+   }
+}
+
+int main(int argc, char **argv) {
+   const int fieldSize = argc > 1 ? std::max(1, std::atoi(argv[1])) : 32;
+
+   lve::LveModel::MeshData meshes[2]{};
+   lve::LveModel::loadMeshData("models/smooth_vase.obj", meshes[0]);
+   lve::LveModel::loadMeshData("models/flat_vase.obj", meshes[1]);
+
+   std::vector<lve::LveStaticInstance> field{};
+   for (int z = 0; z < fieldSize; z++) {
+      for (int x = 0; x < fieldSize; x++) {
+         lve::TransformComponent transform{};
+         transform.translation = {static_cast<float>(x), 0.f, static_cast<float>(z)};
+         transform.rotation.y = 0.7f * (x + z);
+         transform.scale = glm::vec3(0.5f);
+         field.push_back({&meshes[(x + z) % 2], transform});
+      }
+   }
+   size_t objectTriangles = 0;
+   for (const auto &instance : field) objectTriangles += instance.mesh->lodCount > 0 ? instance.mesh->lods[0].indexCount / 3 : instance.mesh->indexCount / 3;
+
+   std::cout << "\n" << field.size() << " vases, " << objectTriangles << " triangles at full resolution, " << field.size() << " draws unbatched\n\n";
+   std::cout << std::setw(8) << "chunk" << std::setw(8) << "draws" << std::setw(12) << "vertices" << std::setw(12) << "LOD0 tris"
+             << std::setw(12) << "full ms" << std::setw(12) << "rebuild ms" << '\n';
+   bool ok = true;
+   for (float chunkSize : {2.f, 4.f, 8.f, 16.f, 32.f}) {
+      //same chunking as LveStaticBatcher::chunkAt
+      std::map<std::pair<int, int>, std::vector<lve::LveStaticInstance>> chunks{};
+      for (const auto &instance : field) {
+         const std::pair<int, int> key{
+            static_cast<int>(std::floor(instance.transform.translation.x / chunkSize)),
+            static_cast<int>(std::floor(instance.transform.translation.z / chunkSize))};
+         chunks[key].push_back(instance);
+      }
+
+      size_t vertices = 0, triangles = 0;
+      lve::LveModel::Builder builder{};
+      auto start = Clock::now();
+      for (const auto &chunk : chunks) {
+         lve::LveStaticBatcher::bake(chunk.second, builder);
+         vertices += builder.vertices.size();
+         triangles += builder.lods[0].indexCount / 3;
+      }
+      const double fullMs = millisecondsSince(start);
+      ok = ok && triangles == objectTriangles;
+
+      //one more vase in the first chunk
+      std::vector<lve::LveStaticInstance> changed = chunks.begin()->second;
+      changed.push_back(changed.front());
+      constexpr int RUNS = 5;
+      start = Clock::now();
+      for (int run = 0; run < RUNS; run++) lve::LveStaticBatcher::bake(changed, builder);
+      const double rebuildMs = millisecondsSince(start) / RUNS;
+
+      std::cout << std::fixed << std::setprecision(0) << std::setw(8) << chunkSize << std::setw(8) << chunks.size()
+                << std::setw(12) << vertices << std::setw(12) << triangles << std::setprecision(2)
+                << std::setw(12) << fullMs << std::setw(12) << rebuildMs << '\n';
+   }
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+//GPU bytes per model for LveModel::VertexFormat::Float32 + 32 bit indices (before) vs Compact + automatic index width (after),
+//with the worst error quantization introduces per attribute.
+//usage: vertex_quantizer_benchmark [grid resolution ...]   (default 256 1024)
+//run from the repository root so models/ resolves
+#include "benchmark_meshes.hpp"
+#include "vulkan_model.hpp"
+#include "vulkan_vertex_quantizer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+   using Vertex = lve::LveModel::Vertex;
+   using CompactVertex = lve::LveModel::CompactVertex;
+   using Quantizer = lve::LveVertexQuantizer;
+   using Clock = std::chrono::high_resolution_clock;
+
+   //the shared grid scaled up, with colors and normals that vary over it so every attribute has something to lose
+   lve::LveModel::Builder makeGrid(int resolution) {
+      lve::LveModel::Builder builder = benchmarks::makeGrid(resolution);
+      for (Vertex &vertex : builder.vertices) {
+         vertex.normal = glm::normalize(glm::vec3{vertex.normal.x, 0.3f * vertex.position.y, vertex.normal.z});
+         vertex.position *= 10.f;
+         vertex.color = {vertex.uv.x, vertex.uv.y, 0.5f};
+      }
+      return builder;
+   }
+
+   void report(const std::string &name, const lve::LveModel::Builder &builder) {
+      const uint32_t vertexCount = static_cast<uint32_t>(builder.vertices.size());
+      const size_t indexCount = builder.indices.size();
+
+      std::vector<CompactVertex> compact{};
+      const auto start = Clock::now();
+      const glm::mat4 dequantization = Quantizer::quantize(builder.vertices.data(), vertexCount, compact);
+      const double quantizeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+      //worst case errors: position relative to the bounds diagonal, normal as an angle, uv absolute
+      glm::vec3 boundsMin{1e30f}, boundsMax{-1e30f};
+      for (const auto &vertex : builder.vertices) {
+         boundsMin = glm::min(boundsMin, vertex.position);
+         boundsMax = glm::max(boundsMax, vertex.position);
+      }
+      const float diagonal = glm::length(boundsMax - boundsMin);
+      float positionError = 0.f, normalError = 0.f, uvError = 0.f;
+      for (uint32_t i = 0; i < vertexCount; i++) {
+         const Vertex &vertex = builder.vertices[i];
+         const CompactVertex &packed = compact[i];
+         const glm::vec4 quantized{
+            std::max(packed.position[0] / 32767.f, -1.f),
+            std::max(packed.position[1] / 32767.f, -1.f),
+            std::max(packed.position[2] / 32767.f, -1.f), 1.f};
+         positionError = std::max(positionError, glm::length(glm::vec3(dequantization * quantized) - vertex.position) / diagonal);
+
+         if (glm::length(vertex.normal) > 0.f) {
+            const float cosine = glm::dot(glm::normalize(vertex.normal), Quantizer::decodeOctahedral(packed.normal));
+            normalError = std::max(normalError, std::acos(std::min(cosine, 1.f)) * 57.29578f);
+         }
+         uvError = std::max(uvError, std::abs(Quantizer::fromHalf(packed.uv[0]) - vertex.uv.x));
+         uvError = std::max(uvError, std::abs(Quantizer::fromHalf(packed.uv[1]) - vertex.uv.y));
+      }
+
+      const size_t before = sizeof(Vertex) * vertexCount + sizeof(uint32_t) * indexCount;
+      const size_t indexSize = vertexCount <= 65536 ? sizeof(uint16_t) : sizeof(uint32_t);
+      const size_t after = sizeof(CompactVertex) * vertexCount + indexSize * indexCount;
+
+      std::cout << std::left << std::setw(20) << name << std::right << std::setw(10) << vertexCount
+                << std::fixed << std::setprecision(2)
+                << std::setw(12) << before / 1024.0 << std::setw(12) << after / 1024.0
+                << std::setw(8) << static_cast<double>(before) / after << std::setw(8) << indexSize * 8
+                << std::scientific << std::setprecision(1) << std::setw(11) << positionError
+                << std::fixed << std::setprecision(3) << std::setw(11) << normalError
+                << std::scientific << std::setprecision(1) << std::setw(11) << uvError
+                << std::fixed << std::setprecision(2) << std::setw(9) << quantizeMs << '\n';
+   }
+}
+
+int main(int argc, char **argv) {
+   std::vector<int> resolutions{};
+   for (int i = 1; i < argc; i++) resolutions.push_back(std::atoi(argv[i]));
+   if (resolutions.empty()) resolutions = {256, 1024};
+
+   std::cout << std::left << std::setw(20) << "mesh" << std::right << std::setw(10) << "vertices"
+             << std::setw(12) << "fp32 KiB" << std::setw(12) << "compact KiB" << std::setw(8) << "ratio" << std::setw(8) << "index"
+             << std::setw(11) << "pos err" << std::setw(11) << "nrm (deg)" << std::setw(11) << "uv err" << std::setw(9) << "ms" << '\n';
+
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() != ".obj") continue;
+      lve::LveModel::Builder builder{};
+      builder.loadModel(entry.path().string());
+      report(entry.path().filename().string(), builder);
+   }
+   for (int resolution : resolutions) {
+      report("grid " + std::to_string(resolution), makeGrid(resolution));
+   }
+   return 0;
+}
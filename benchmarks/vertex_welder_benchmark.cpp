@@ -0,0 +1,116 @@
+//vertex dedup: the previous std::unordered_map path (count() + operator[], hashCombine over glm hashes) against LveVertexWelder.
+//corners are expanded to vertices up front so only the dedup itself is timed.
+//usage: vertex_welder_benchmark [grid resolution ...]   (default 512 1024, grids from benchmark_meshes.hpp)
+//run from the repository root so models/ resolves
+#include "benchmark_meshes.hpp"
+#include "vulkan_model.hpp"
+#include "vulkan_obj_loader.hpp"
+#include "vulkan_utils.hpp"
+#include "vulkan_vertex_welder.hpp"
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace std {
+   template<>
+   struct hash<lve::LveModel::Vertex> {
+      size_t operator()(lve::LveModel::Vertex const &vertex) const {
+         size_t seed = 0;
+         lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+         return seed;
+      }
+   };
+}
+
+namespace {
+   using Vertex = lve::LveModel::Vertex;
+   using Clock = std::chrono::high_resolution_clock;
+
+   std::vector<Vertex> expandCorners(const lve::LveObjData &obj) {
+      std::vector<Vertex> corners(obj.corners.size());
+      for (size_t i = 0; i < obj.corners.size(); i++) {
+         const auto &corner = obj.corners[i];
+         Vertex &vertex = corners[i];
+         vertex.position = {obj.positions[3 * corner.position + 0], obj.positions[3 * corner.position + 1], obj.positions[3 * corner.position + 2]};
+         vertex.color = {obj.colors[3 * corner.position + 0], obj.colors[3 * corner.position + 1], obj.colors[3 * corner.position + 2]};
+         if (corner.normal >= 0) vertex.normal = {obj.normals[3 * corner.normal + 0], obj.normals[3 * corner.normal + 1], obj.normals[3 * corner.normal + 2]};
+         if (corner.texcoord >= 0) vertex.uv = {obj.texcoords[2 * corner.texcoord + 0], obj.texcoords[2 * corner.texcoord + 1]};
+      }
+      return corners;
+   }
+
+   template <typename Fn>
+   double millisecondsFor(Fn fn) {
+      const auto start = Clock::now();
+      fn();
+      return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+   }
+
+   void benchmark(const std::string &path) {
+      const std::vector<Vertex> corners = expandCorners(lve::LveObjLoader::load(path));
+
+      std::vector<Vertex> mapVertices{};
+      std::vector<uint32_t> mapIndices{};
+      const double mapMs = millisecondsFor([&] {
+         std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+         for (const auto &vertex : corners) {
+            if (uniqueVertices.count(vertex) == 0) {
+               uniqueVertices[vertex] = static_cast<uint32_t>(mapVertices.size());
+               mapVertices.push_back(vertex);
+            }
+            mapIndices.push_back(uniqueVertices[vertex]);
+         }
+      });
+
+      std::vector<Vertex> weldVertices{};
+      std::vector<uint32_t> weldIndices{};
+      const double weldMs = millisecondsFor([&] {
+         lve::LveVertexWelder<Vertex> welder{corners.size()};
+         weldIndices.reserve(corners.size());
+         for (const auto &vertex : corners) {
+            weldIndices.push_back(welder.weld(vertex, weldVertices));
+         }
+      });
+
+      std::vector<Vertex> snapVertices{};
+      const double snapMs = millisecondsFor([&] {
+         lve::LveVertexWelder<Vertex> welder{corners.size(), 1e-5f};
+         for (const auto &vertex : corners) {
+            welder.weld(vertex, snapVertices);
+         }
+      });
+
+      const bool same = mapIndices == weldIndices && mapVertices.size() == weldVertices.size();
+      std::cout << std::left << std::setw(24) << std::filesystem::path(path).filename().string() << std::right
+                << std::setw(10) << corners.size() << std::setw(10) << weldVertices.size() << std::setw(10) << snapVertices.size()
+                << std::fixed << std::setprecision(2) << std::setw(12) << mapMs << std::setw(12) << weldMs << std::setw(12) << snapMs
+                << std::setprecision(1) << std::setw(9) << mapMs / weldMs << "x" << std::setw(6) << (same ? "yes" : "NO") << '\n';
+   }
+}
+
+int main(int argc, char **argv) {
+   std::vector<int> resolutions{};
+   for (int i = 1; i < argc; i++) resolutions.push_back(std::atoi(argv[i]));
+   if (resolutions.empty()) resolutions = {512, 1024};
+
+   std::cout << std::left << std::setw(24) << "file" << std::right << std::setw(10) << "corners" << std::setw(10) << "unique"
+             << std::setw(10) << "snapped" << std::setw(12) << "map (ms)" << std::setw(12) << "weld (ms)" << std::setw(12) << "snap (ms)"
+             << std::setw(10) << "speedup" << std::setw(6) << "same" << '\n';
+
+   for (const auto &entry : std::filesystem::directory_iterator("models")) {
+      if (entry.path().extension() == ".obj") benchmark(entry.path().string());
+   }
+   for (int resolution : resolutions) {
+      benchmark(benchmarks::gridObjPath(resolution));
+   }
+   return 0;
+}
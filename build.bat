@@ -11,4 +11,4 @@ SET defines=/D DEBUG
 echo "Building main..."
 
 REM how to handle errors / crashes
-cl /Zi /EHsc /MD %includes% %defines% *.cpp %links% /OUT:main.exe
\ No newline at end of file
+cl /Zi /EHsc /MD /std:c++17 %includes% %defines% *.cpp %links% /OUT:main.exe
\ No newline at end of file
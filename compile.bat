@@ -1,4 +1,6 @@
 C:\VulkanSDK\1.3.280.0\Bin\glslc.exe shaders\simple_shader.vert -o shaders\simple_shader.vert.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe shaders\simple_shader_compact.vert -o shaders\simple_shader_compact.vert.spv
 C:\VulkanSDK\1.3.280.0\Bin\glslc.exe shaders\simple_shader.frag -o shaders\simple_shader.frag.spv
+C:\VulkanSDK\1.3.280.0\Bin\glslc.exe shaders\depth_prepass.vert -o shaders\depth_prepass.vert.spv
 pause
 REM double click in file explorer to run
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "first_app.hpp"
 #include "render_system.hpp"
+#include "vulkan_archive.hpp"
 #include "vulkan_camera.hpp"
+#include "vulkan_mesh_cache.hpp"
 
 #include "movement_controller.hpp"
 
@@ -12,12 +14,71 @@
 #include <stdexcept>
 //time library to get current system time
 #include <chrono>
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <filesystem>
+#include <iostream>
 
 namespace lve {
 
-	FirstApp::FirstApp() {
+   namespace {
+      LveStaticBatcher::Settings staticBatchSettings() {
+         LveStaticBatcher::Settings settings{};
+         settings.chunkSize = 4.f;
+         settings.vertexFormat = LveModel::VertexFormat::CompactSplit;
+         return settings;
+      }
+
+      LveWorldPartition::Settings worldSettings() {
+         LveWorldPartition::Settings settings{};
+         settings.cellSize = 4.f;
+         settings.loadRadius = 12.f;
+         settings.unloadRadius = 16.f;
+         return settings;
+      }
+
+      //how a ripple on the pond spreads and fades, in grid cells, model units and seconds
+      constexpr float RIPPLE_SPEED = 10.f;
+      constexpr float RIPPLE_LIFETIME = 0.9f;
+      constexpr float RIPPLE_WIDTH = 2.5f;
+      constexpr float RIPPLE_HEIGHT = 0.05f;
+
+      //an endless field of vases: every cell but the one at the origin gets a few, placed from a hash of its coordinates so a
+      //cell looks the same each time it comes back
+      std::vector<LveCellObject> describeCell(LveCellCoord coord) {
+         std::vector<LveCellObject> objects{};
+         if (coord.x == 0 && coord.z == 0) return objects;
+
+         uint32_t random = static_cast<uint32_t>(coord.x) * 73856093u ^ static_cast<uint32_t>(coord.z) * 19349663u;
+         auto next = [&random]() {
+            //xorshift, only has to look scattered
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            return static_cast<float>(random & 0xFFFF) / 65535.f;
+         };
+         const int count = 1 + static_cast<int>(next() * 3.f);
+         for (int i = 0; i < count; i++) {
+            LveCellObject object{};
+            object.modelPath = next() < 0.5f ? "models/smooth_vase.obj" : "models/flat_vase.obj";
+            object.vertexFormat = LveModel::VertexFormat::CompactSplit;
+            object.transform.translation = {(coord.x + next()) * 4.f, 0.5f, (coord.z + next()) * 4.f};
+            object.transform.scale = glm::vec3(1.f + next());
+            objects.push_back(std::move(object));
+         }
+         return objects;
+      }
+   }
+
+	FirstApp::FirstApp() : world{assetRegistry, describeCell, worldSettings()}, staticBatcher{lveDevice, staticBatchSettings()} {
+      //packed builds ship one archive (see pack.bat) instead of loose models/ and shaders/.
+      //everything needed at startup is decompressed up front, on all cores at once
+      if (std::filesystem::exists(ARCHIVE_PATH)) {
+         LveArchive::mount(ARCHIVE_PATH);
+         LveArchive::mounted()->prefetch({LveMeshCache::cachePathFor("models/smooth_vase.obj"), "shaders/"});
+      }
+      modelLoader.setUploadBudget(UPLOAD_BUDGET);
       loadGameObjects();
 	}
 
@@ -37,6 +98,12 @@ namespace lve {
 
       //high precision clock
       auto currentTime = std::chrono::high_resolution_clock::now();
+      //toggles on the key going down, not every frame it is held
+      bool prepassKeyWasDown = false;
+      //what the pond's updates cost, reported once a second against rewriting its whole vertex buffer every frame
+      VkDeviceSize pondUpdateBytes = 0;
+      int pondFrames = 0;
+      float pondReportTime = 0.f;
 
 		while (!lveWindow.shouldClose()) {
 			//keystrokes, exit clicks, etc.
@@ -49,6 +116,15 @@ namespace lve {
 
          //update viewer object's transform component based on keyboard input, propotional to amount of time elapsed since last frame
          cameraController.moveInPlaneXZ(lveWindow.getGLFWwindow(), frameTime, viewerObject);
+         const bool prepassKeyDown = glfwGetKey(lveWindow.getGLFWwindow(), DEPTH_PREPASS_KEY) == GLFW_PRESS;
+         if (prepassKeyDown && !prepassKeyWasDown) {
+            simpleRenderSystem.setDepthPrepass(!simpleRenderSystem.getDepthPrepass());
+            std::cout << "Depth prepass " << (simpleRenderSystem.getDepthPrepass() ? "on" : "off") << '\n';
+         }
+         prepassKeyWasDown = prepassKeyDown;
+         updateModels();
+         updatePond(frameTime);
+         world.update(viewerObject.transform.translation, cameraController.velocity);
          camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
 
          //using aspect ratio will keep the image from being stretched
@@ -57,32 +133,192 @@ namespace lve {
          //camera.setOrthographicProjection(-aspect, aspect, -1, 1, -1, 1);
          //common values are between 45 and 60 degrees
          camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 10.f);
+         simpleRenderSystem.setLodPixelError(1.f, lveRenderer.getSwapChainExtent().height);
          
          if (auto commandBuffer = lveRenderer.beginFrame()) {
+            //dynamic meshes copy what changed into this frame's buffers, outside of any render pass
+            for (auto &obj : gameObjects) {
+               if (obj.model && obj.model->isDynamic()) obj.model->updateDynamic(commandBuffer, lveRenderer.getFrameIndex());
+            }
+            pondUpdateBytes += pond->getDynamicUpdateBytes();
+            pondFrames++;
             
             //begin offscreen shadow pass
             // render shadow casting objects
             //end offscreen shadow pass
             
             lveRenderer.beginSwapChainRenderPass(commandBuffer);
+            //every object's depth first, then shading only the visible surfaces
+            if (simpleRenderSystem.getDepthPrepass()) {
+               simpleRenderSystem.renderDepthPrepass(commandBuffer, gameObjects, camera);
+               simpleRenderSystem.renderDepthPrepass(commandBuffer, staticBatcher.getChunkObjects(), camera);
+               world.forEachCell([&](std::vector<LveGameObject> &objects) {
+                  simpleRenderSystem.renderDepthPrepass(commandBuffer, objects, camera);
+               });
+            }
             simpleRenderSystem.renderGameObjects(commandBuffer, gameObjects, camera);
+            simpleRenderSystem.renderGameObjects(commandBuffer, staticBatcher.getChunkObjects(), camera);
+            world.forEachCell([&](std::vector<LveGameObject> &objects) {
+               simpleRenderSystem.renderGameObjects(commandBuffer, objects, camera);
+            });
             lveRenderer.endSwapChainRenderPass(commandBuffer);
             lveRenderer.endFrame();
          }
+
+         pondReportTime += frameTime;
+         if (pondReportTime >= 1.f && pondFrames > 0) {
+            std::cout << "Pond: " << pondUpdateBytes / pondFrames << " of " << pondVertices.size() * sizeof(LveModel::Vertex)
+                      << " vertex bytes rewritten per frame\n";
+            pondUpdateBytes = 0;
+            pondFrames = 0;
+            pondReportTime = 0.f;
+         }
 		}
 	}
 
    void FirstApp::loadGameObjects() {
       //viewing box: -1<x<1, -1<y<1, 0<z<1
       //only things that are inside the box will be rendered
-      std::shared_ptr<LveModel> lveModel = LveModel::createModelFromFile(lveDevice, "models/smooth_vase.obj");
+      //compact vertices: 20 instead of 44 bytes per vertex, plus 16 bit indices since the vase has fewer than 65536 vertices.
+      //split, so the depth prepass reads 8 of them. Loaded in the background, the window opens right away with a placeholder cube in its place
+      LveModelHandle lveModel = assetRegistry.load("models/smooth_vase.obj", LveModel::VertexFormat::CompactSplit);
 
       auto gameObj = LveGameObject::createGameObject();
-      gameObj.model = lveModel;
+      gameObj.model = modelLoader.placeholder();
+      pendingModels.push_back({gameObj.getId(), lveModel});
       //translations of x, y, and z (z for depth)
       gameObj.transform.translation = {0.f, 0.f, 2.5f};
       gameObj.transform.scale = glm::vec3(0.3f);
       gameObjects.push_back(std::move(gameObj));
+
+      //a ring of small vases around it that never moves: baked into the two chunks it straddles, two draws instead of one per vase
+      constexpr int RING_COUNT = 24;
+      for (int i = 0; i < RING_COUNT; i++) {
+         const float angle = glm::two_pi<float>() * i / RING_COUNT;
+         auto vase = LveGameObject::createGameObject();
+         vase.isStatic = true;
+         vase.transform.translation = {1.2f * glm::cos(angle), 0.f, 2.5f + 1.2f * glm::sin(angle)};
+         vase.transform.rotation.y = angle;
+         vase.transform.scale = glm::vec3(0.15f);
+         staticBatcher.add(vase, i % 2 == 0 ? "models/flat_vase.obj" : "models/smooth_vase.obj");
+      }
+
+      //a flat pond behind them, -1 to 1 on x and z, that ripples where drops land. Float32: a quantized format would clamp the
+      //ripples to the flat initial bounds
+      LveModel::Builder pondBuilder{};
+      const float step = 2.f / (POND_RESOLUTION - 1);
+      for (int z = 0; z < POND_RESOLUTION; z++) {
+         for (int x = 0; x < POND_RESOLUTION; x++) {
+            LveModel::Vertex vertex{};
+            vertex.position = {x * step - 1.f, 0.f, z * step - 1.f};
+            vertex.color = {0.1f, 0.3f, 0.6f};
+            vertex.normal = {0.f, -1.f, 0.f};
+            vertex.uv = {x * step * 0.5f, z * step * 0.5f};
+            pondBuilder.vertices.push_back(vertex);
+         }
+      }
+      for (uint32_t z = 0; z + 1 < POND_RESOLUTION; z++) {
+         for (uint32_t x = 0; x + 1 < POND_RESOLUTION; x++) {
+            const uint32_t a = z * POND_RESOLUTION + x, b = a + 1, c = a + POND_RESOLUTION, d = c + 1;
+            pondBuilder.indices.insert(pondBuilder.indices.end(), {a, b, d, a, d, c});
+         }
+      }
+      pondVertices = pondBuilder.vertices;
+      pond = LveModel::createDynamic(lveDevice, pondBuilder);
+
+      auto pondObj = LveGameObject::createGameObject();
+      pondObj.model = pond;
+      pondObj.transform.translation = {0.f, 0.5f, 5.5f};
+      pondObj.transform.scale = glm::vec3(1.5f);
+      gameObjects.push_back(std::move(pondObj));
+   }
+
+   void FirstApp::updatePond(float frameTime) {
+      //sum of every ripple's ring at a point of the grid, up being -y
+      auto heightAt = [&](float x, float z) {
+         float height = 0.f;
+         for (const auto &ripple : pondRipples) {
+            const float offset = glm::distance(glm::vec2{x, z}, ripple.center) - RIPPLE_SPEED * ripple.age;
+            if (glm::abs(offset) >= RIPPLE_WIDTH) continue;
+            const float amplitude = RIPPLE_HEIGHT * (1.f - ripple.age / RIPPLE_LIFETIME);
+            height += amplitude * 0.5f * (1.f + glm::cos(glm::pi<float>() * offset / RIPPLE_WIDTH)) *
+                      glm::cos(glm::two_pi<float>() * offset / RIPPLE_WIDTH);
+         }
+         return height;
+      };
+
+      //squares of grid cells around the ripples, as far as they reach this frame (and so also as far as they did last frame),
+      //plus one for the normals. Only these are rewritten, each row of one is its own range of vertices
+      struct Region {
+         int minX, minZ, maxX, maxZ;
+      };
+      std::vector<Region> regions{};
+      auto addRegion = [&](glm::vec2 center, float radius) {
+         const float reach = radius + RIPPLE_WIDTH + 1.f;
+         auto cell = [](float value) { return std::clamp(static_cast<int>(value), 0, POND_RESOLUTION - 1); };
+         regions.push_back({cell(center.x - reach), cell(center.y - reach), cell(center.x + reach + 1.f), cell(center.y + reach + 1.f)});
+      };
+      for (auto &ripple : pondRipples) {
+         ripple.age += frameTime;
+         addRegion(ripple.center, RIPPLE_SPEED * glm::min(ripple.age, RIPPLE_LIFETIME));
+      }
+      //faded ripples still get their region this frame, so the water they leave behind is flattened
+      pondRipples.erase(
+         std::remove_if(pondRipples.begin(), pondRipples.end(), [](const PondRipple &ripple) { return ripple.age >= RIPPLE_LIFETIME; }),
+         pondRipples.end());
+
+      pondNextDrop -= frameTime;
+      if (pondNextDrop <= 0.f) {
+         pondNextDrop = POND_DROP_INTERVAL;
+         auto next = [this]() {
+            //xorshift, only has to look scattered
+            pondRandom ^= pondRandom << 13;
+            pondRandom ^= pondRandom >> 17;
+            pondRandom ^= pondRandom << 5;
+            return static_cast<float>(pondRandom & 0xFFFF) / 65535.f;
+         };
+         const glm::vec2 center{next() * (POND_RESOLUTION - 1), next() * (POND_RESOLUTION - 1)};
+         pondRipples.push_back({center, 0.f});
+         addRegion(center, 0.f);
+      }
+
+      const float step = 2.f / (POND_RESOLUTION - 1);
+      for (const auto &region : regions) {
+         for (int z = region.minZ; z <= region.maxZ; z++) {
+            for (int x = region.minX; x <= region.maxX; x++) {
+               LveModel::Vertex &vertex = pondVertices[z * POND_RESOLUTION + x];
+               const float fx = static_cast<float>(x), fz = static_cast<float>(z);
+               vertex.position.y = -heightAt(fx, fz);
+               //central differences, the surface is y = -height
+               const float slopeX = (heightAt(fx + 1.f, fz) - heightAt(fx - 1.f, fz)) / (2.f * step);
+               const float slopeZ = (heightAt(fx, fz + 1.f) - heightAt(fx, fz - 1.f)) / (2.f * step);
+               vertex.normal = glm::normalize(glm::vec3{-slopeX, -1.f, -slopeZ});
+            }
+            const uint32_t first = z * POND_RESOLUTION + region.minX;
+            pond->setVertices(first, &pondVertices[first], region.maxX - region.minX + 1);
+         }
+      }
+   }
+
+   void FirstApp::updateModels() {
+      modelLoader.update();
+      assetRegistry.update();
+      staticBatcher.update();
+
+      for (auto pending = pendingModels.begin(); pending != pendingModels.end();) {
+         const LveModelHandle &handle = pending->second;
+         if (handle.status() == LveModelHandle::Status::Loading) {
+            ++pending;
+            continue;
+         }
+         //a failed load keeps its placeholder, the loader already reported why
+         if (handle.ready()) {
+            for (auto &obj : gameObjects) {
+               if (obj.getId() == pending->first) obj.model = handle.get();
+            }
+         }
+         pending = pendingModels.erase(pending);
+      }
    }
 
 
@@ -2,7 +2,11 @@
 
 #include "vulkan_window.hpp"
 #include "game_object.hpp"
+#include "vulkan_asset_registry.hpp"
+#include "vulkan_model_loader.hpp"
 #include "vulkan_renderer.hpp"
+#include "vulkan_static_batcher.hpp"
+#include "vulkan_world_partition.hpp"
 
 #include <memory>
 #include <vector>
@@ -13,6 +17,16 @@ namespace lve {
 		public:
 			static constexpr int WIDTH = 800;
 			static constexpr int HEIGHT = 600;
+         static constexpr const char *ARCHIVE_PATH = "assets.lvepak";
+         //device memory kept for cached models, unreferenced ones are freed beyond this
+         static constexpr VkDeviceSize MODEL_MEMORY_BUDGET = 256 * 1024 * 1024;
+         //bytes of new models uploaded per frame, the rest waits for the next one
+         static constexpr VkDeviceSize UPLOAD_BUDGET = 16 * 1024 * 1024;
+         //turns the depth prepass on and off, to compare frame times with and without it
+         static constexpr int DEPTH_PREPASS_KEY = GLFW_KEY_P;
+         //vertices along each side of the pond, and how often a drop lands in it
+         static constexpr int POND_RESOLUTION = 64;
+         static constexpr float POND_DROP_INTERVAL = 0.35f;
 
          FirstApp();
          ~FirstApp();
@@ -24,14 +38,38 @@ namespace lve {
 
 		private:
          void loadGameObjects();
+         //swaps in models that finished loading since the last frame, lets the registry evict
+         void updateModels();
+         //ages the pond's ripples, drops a new one now and then and rewrites only the vertices around them
+         void updatePond(float frameTime);
 
 			LveWindow lveWindow{ WIDTH, HEIGHT, "Hello Vulkan" };
          LveDevice lveDevice{lveWindow};
          LveRenderer lveRenderer{lveWindow, lveDevice};
+         LveModelLoader modelLoader{lveDevice};
+         LveAssetRegistry assetRegistry{modelLoader, MODEL_MEMORY_BUDGET};
+         //cells of vases around the camera, out to a bit beyond the far plane
+         LveWorldPartition world;
+         //static scenery, drawn a chunk at a time
+         LveStaticBatcher staticBatcher;
          //order matters, initialized from top to bottom and destructed from bottom to top
          //using unique pointer rather than stack allocated variable, can easily create new swap chain with updated width and height by constructing new object. Has small performance cost
          //using this also means in implimentation file (.cpp), we can use -> operator to access members, not . operator (this.that vs this->that)
          //smart pointer, simulates pointer with automatic memory management
          std::vector<LveGameObject> gameObjects;
+         //objects still drawing the loader's placeholder, by id
+         std::vector<std::pair<LveGameObject::id_t, LveModelHandle>> pendingModels;
+
+         //ring spreading from where a drop landed, in grid cells and seconds
+         struct PondRipple {
+            glm::vec2 center;
+            float age;
+         };
+         //dynamic model, also drawn through its game object. pondVertices mirrors its contents
+         std::shared_ptr<LveModel> pond{};
+         std::vector<LveModel::Vertex> pondVertices{};
+         std::vector<PondRipple> pondRipples{};
+         float pondNextDrop = 0.f;
+         uint32_t pondRandom = 2463534242u;
 	};
 }
@@ -43,6 +43,8 @@ namespace lve {
       std::shared_ptr<LveModel> model{};
       glm::vec3 color{};
       TransformComponent transform{};
+      //never moves once placed, so it can be baked into an LveStaticBatcher instead of being drawn on its own
+      bool isStatic = false;
 
       private:
       LveGameObject(id_t objId) : id(objId) {}
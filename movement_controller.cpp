@@ -38,8 +38,10 @@ namespace lve {
         if (glfwGetKey(window, keys.moveDown) == GLFW_PRESS) moveDir -= upDir;
 
         //normalize vector so diagonal movement isn't faster (just like Unity)
+        velocity = glm::vec3{0.f};
         if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon()) {
-            gameObject.transform.translation += moveSpeed * dt * glm::normalize(moveDir);
+            velocity = moveSpeed * glm::normalize(moveDir);
+            gameObject.transform.translation += dt * velocity;
         }
     }
 }
\ No newline at end of file
@@ -27,5 +27,7 @@ namespace lve {
             KeyMappings keys{};
             float moveSpeed{3.f};
             float lookSpeed{1.5f};
+            //world space units per second of the last move, lets streaming (LveWorldPartition) load ahead of the viewer
+            glm::vec3 velocity{0.f};
     };
 }
\ No newline at end of file
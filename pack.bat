@@ -0,0 +1,22 @@
+@echo off
+
+REM builds the asset packer against the engine sources and packs models\ and shaders\ into assets.lvepak.
+REM main.exe mounts assets.lvepak when it finds it next to itself, delete the archive to go back to loose files
+call "C:\Program Files\Microsoft Visual Studio\2022\Community\VC\Auxiliary\Build\vcvars64.bat"
+
+SET includes=/I. /I%VULKAN_SDK%/Include /I"C:/Users/Matthew/glfw-3.3.9.bin.WIN64/glfw-3.3.9.bin.WIN64/include" /I"C:/Users/Matthew/tinyobjloader"
+SET links=/link /LIBPATH:%VULKAN_SDK%/Lib /LIBPATH:"C:/Users/Matthew/glfw-3.3.9.bin.WIN64/glfw-3.3.9.bin.WIN64/lib-vc2022" vulkan-1.lib glfw3.lib User32.lib Gdi32.lib Shell32.lib
+SET defines=/D NDEBUG
+
+if not exist tools\obj mkdir tools\obj
+
+echo "Building engine objects..."
+cl /c /O2 /EHsc /MD /std:c++17 %includes% %defines% *.cpp /Fotools\obj\
+REM the packer has its own main
+del tools\obj\main.obj
+
+echo "Building asset_packer..."
+cl /O2 /EHsc /MD /std:c++17 %includes% %defines% tools\asset_packer.cpp tools\obj\*.obj /Fotools\obj\asset_packer.obj %links% /OUT:tools\asset_packer.exe
+
+echo "Packing..."
+tools\asset_packer.exe --verify assets.lvepak models shaders
@@ -17,6 +17,22 @@ namespace lve {
       glm::mat4 normalMatrix{1.f};
    };
 
+   //screen space error: an object space error e at view depth z covers e * scale * projection[1][1] / w of the viewport height (2 in NDC),
+   //where w is the clip space w (z for perspective, 1 for orthographic). The nearest point of the bounding sphere gives the largest value
+   static uint32_t selectLod(const LveModel &model, const glm::mat4 &objectMatrix, const glm::vec3 &scale, const glm::mat4 &projection, const glm::mat4 &view, float lodScreenError) {
+      if (model.getLodCount() <= 1) return 0;
+
+      const float maxScale = glm::max(glm::abs(scale.x), glm::max(glm::abs(scale.y), glm::abs(scale.z)));
+      const glm::vec4 center = view * objectMatrix * glm::vec4{model.getBoundsCenter(), 1.f};
+      const float nearestDepth = center.z - model.getBoundsRadius() * maxScale;
+      const float w = projection[2][3] * nearestDepth + projection[3][3];
+      //the camera is inside the bounds
+      if (w <= 0.f) return 0;
+
+      const float projectedScale = glm::abs(projection[1][1]) * maxScale / w;
+      return model.selectLod(projectedScale, lodScreenError);
+   }
+
    //: lveDevice{device} initializes lveDevice with device
 	SimpleRenderSystem::SimpleRenderSystem(LveDevice& device, VkRenderPass renderPass) : lveDevice{device} {
 		createPipelineLayout();
@@ -54,11 +70,35 @@ namespace lve {
       LvePipeline::defaultPipelineConfigInfo(pipelineConfig);
 		pipelineConfig.renderPass = renderPass;
 		pipelineConfig.pipelineLayout = pipelineLayout;
-		lvePipeline = std::make_unique<LvePipeline>(lveDevice, "shaders/simple_shader.vert.spv", "shaders/simple_shader.frag.spv", pipelineConfig);
 
-		if (!lvePipeline) {
-			throw std::runtime_error("failed to create graphics pipeline");
-		}
+      for (size_t format = 0; format < LveModel::VERTEX_FORMAT_COUNT; format++) {
+         const auto vertexFormat = static_cast<LveModel::VertexFormat>(format);
+         //formats only differ in the vertex input state and in how the vertex shader unpacks normals
+         LveModel::withVertexType(vertexFormat, [&](auto type) { pipelineConfig.setVertexLayout<typename decltype(type)::type>(); });
+         const bool compact = vertexFormat == LveModel::VertexFormat::Compact || vertexFormat == LveModel::VertexFormat::CompactSplit;
+         const char *vertexShader = compact ? "shaders/simple_shader_compact.vert.spv" : "shaders/simple_shader.vert.spv";
+
+         pipelineConfig.depthStencilInfo.depthWriteEnable = VK_TRUE;
+         pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+         pipelineConfig.colorBlendAttachment.colorWriteMask =
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+         lvePipelines[format] = std::make_unique<LvePipeline>(lveDevice, vertexShader, "shaders/simple_shader.frag.spv", pipelineConfig);
+
+         //the prepass already wrote the nearest depth, only the surface that left it passes
+         pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+         pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+         prepassShadingPipelines[format] = std::make_unique<LvePipeline>(lveDevice, vertexShader, "shaders/simple_shader.frag.spv", pipelineConfig);
+
+         //reflection strips every attribute but the position, split formats then only bind their position stream
+         pipelineConfig.depthStencilInfo.depthWriteEnable = VK_TRUE;
+         pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+         pipelineConfig.colorBlendAttachment.colorWriteMask = 0;
+         depthPipelines[format] = std::make_unique<LvePipeline>(lveDevice, "shaders/depth_prepass.vert.spv", "", pipelineConfig);
+
+         if (!lvePipelines[format] || !prepassShadingPipelines[format] || !depthPipelines[format]) {
+            throw std::runtime_error("failed to create graphics pipeline");
+         }
+      }
 	}
 
    //in vulkan, you can't execute commands directly with function calls.
@@ -68,14 +108,44 @@ namespace lve {
    //specify target output frame buffer
 
 
+   void SimpleRenderSystem::setLodPixelError(float pixelError, uint32_t viewportHeight) {
+      lodScreenError = 2.f * pixelError / static_cast<float>(viewportHeight);
+   }
+
    void SimpleRenderSystem::renderGameObjects(VkCommandBuffer commandBuffer, std::vector<LveGameObject>& gameObjects, const LveCamera &camera) {
-      lvePipeline->bind(commandBuffer);
+      recordObjects(commandBuffer, gameObjects, camera, depthPrepass ? prepassShadingPipelines : lvePipelines);
+   }
+
+   void SimpleRenderSystem::renderDepthPrepass(VkCommandBuffer commandBuffer, std::vector<LveGameObject>& gameObjects, const LveCamera &camera) {
+      //same LOD selection and culling as the shading pass, so both draw the same triangles
+      recordObjects(commandBuffer, gameObjects, camera, depthPipelines);
+   }
 
-      auto projectionView = camera.getProjection() * camera.getView();
+   void SimpleRenderSystem::recordObjects(
+      VkCommandBuffer commandBuffer,
+      std::vector<LveGameObject>& gameObjects,
+      const LveCamera &camera,
+      Pipelines &pipelines) {
+      const auto &projection = camera.getProjection();
+      const auto &view = camera.getView();
+      auto projectionView = projection * view;
+
+      //only rebind when the vertex format changes between objects
+      LvePipeline *boundPipeline = nullptr;
+      //models in the geometry arena share their buffers, so consecutive ones of a vertex format and index type bind them once
+      const LveModel *boundModel = nullptr;
 
       for (auto& obj : gameObjects) {
+         LvePipeline *pipeline = pipelines[static_cast<size_t>(obj.model->getVertexFormat())].get();
+         if (pipeline != boundPipeline) {
+            pipeline->bind(commandBuffer);
+            boundPipeline = pipeline;
+         }
+
          SimplePushConstantData push{};
-         auto modelMatrix = obj.transform.mat4();
+         const auto objectMatrix = obj.transform.mat4();
+         //dequantization goes first: quantized positions -> object space -> world space
+         auto modelMatrix = objectMatrix * obj.model->getDequantizationMatrix();
          push.transform = projectionView * modelMatrix;
          //glm will automatically convert mat3 to a padded mat4 (1 on last diagonal)
          push.normalMatrix = obj.transform.normalMatrix();
@@ -87,8 +157,50 @@ namespace lve {
             0, 
             sizeof(SimplePushConstantData), 
             &push);
-         obj.model->bind(commandBuffer);
-         obj.model->draw(commandBuffer);
+         //one binding for every material, they are ranges of the same buffers
+         LveModel &model = *obj.model;
+         if (boundModel == nullptr || !model.sharesBindingsWith(*boundModel)) {
+            model.bind(commandBuffer);
+            boundModel = &model;
+         }
+         const uint32_t lod = selectLod(model, objectMatrix, obj.transform.scale, projection, view, lodScreenError);
+         const bool cullMeshlets = lod == 0 && !model.getMeshlets().empty();
+         if (!cullMeshlets && model.getSubmeshCount() == 0) {
+            model.draw(commandBuffer, lod);
+            continue;
+         }
+
+         //full resolution: only the meshlets that can be visible. Culling happens in object space, see LveMeshletCuller::cull
+         LveFrustum frustum{};
+         glm::vec3 cameraPosition{0.f};
+         if (cullMeshlets) {
+            frustum = LveFrustum::fromMatrix(projectionView * objectMatrix);
+            cameraPosition = glm::vec3{glm::inverse(objectMatrix) * glm::vec4{camera.getPosition(), 1.f}};
+         }
+         if (model.getSubmeshCount() == 0) {
+            drawRanges.clear();
+            LveMeshletCuller::cull(model.getMeshlets(), frustum, cameraPosition, meshletConeCulling, drawRanges);
+            for (const auto &range : drawRanges) {
+               model.drawRange(commandBuffer, range.firstIndex, range.indexCount);
+            }
+            continue;
+         }
+
+         //one draw per material, meshlets never span two so the culled ranges stay within their submesh
+         for (uint32_t i = 0; i < model.getSubmeshCount(); i++) {
+            const LveModel::Submesh &submesh = model.getSubmesh(lod, i);
+            if (submesh.indexCount == 0) continue;
+            if (!cullMeshlets) {
+               model.drawRange(commandBuffer, submesh.firstIndex, submesh.indexCount);
+               continue;
+            }
+            drawRanges.clear();
+            LveMeshletCuller::cull(
+               model.getMeshlets().data() + submesh.firstMeshlet, submesh.meshletCount, frustum, cameraPosition, meshletConeCulling, drawRanges);
+            for (const auto &range : drawRanges) {
+               model.drawRange(commandBuffer, range.firstIndex, range.indexCount);
+            }
+         }
       }
    }
 
@@ -1,9 +1,11 @@
 #pragma once
 
 #include "vulkan_camera.hpp"
+#include "vulkan_meshlets.hpp"
 #include "vulkan_pipeline.hpp"
 #include "game_object.hpp"
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -18,15 +20,44 @@ namespace lve {
          SimpleRenderSystem(const SimpleRenderSystem&) = delete;
 		   SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
 
+         //with the depth prepass on, only shades the pixels renderDepthPrepass left the depth of
          void renderGameObjects(VkCommandBuffer commandBuffer, std::vector<LveGameObject>& gameObjects, const LveCamera &camera);
+         //position only draws of the same objects, filling the depth buffer. With the depth prepass on, call it for everything the
+         //frame draws before the first renderGameObjects, so each pixel is shaded once however many surfaces cover it
+         void renderDepthPrepass(VkCommandBuffer commandBuffer, std::vector<LveGameObject>& gameObjects, const LveCamera &camera);
+         //switches renderGameObjects between depth testing with LESS and writing depth, and testing with EQUAL against the
+         //prepass's depth without writing it. Can change between frames
+         void setDepthPrepass(bool enabled) { depthPrepass = enabled; }
+         bool getDepthPrepass() const { return depthPrepass; }
+
+         //each object is drawn with the coarsest LOD whose simplification error covers at most pixelError pixels of a viewport viewportHeight pixels high
+         void setLodPixelError(float pixelError, uint32_t viewportHeight);
+         //drop meshlets whose triangles all face away from the camera. Off by default: the pipeline doesn't cull back faces,
+         //so open meshes (the vases) show their inside through the opening
+         void setMeshletConeCulling(bool enabled) { meshletConeCulling = enabled; }
 
 
 		private:
+         using Pipelines = std::array<std::unique_ptr<LvePipeline>, LveModel::VERTEX_FORMAT_COUNT>;
+
          void createPipelineLayout();
          void createPipeline(VkRenderPass renderPass);
+         //LOD selection, meshlet culling and the draws, with the pipeline of each object's vertex format
+         void recordObjects(VkCommandBuffer commandBuffer, std::vector<LveGameObject>& gameObjects, const LveCamera &camera, Pipelines &pipelines);
 
          LveDevice &lveDevice;
-			std::unique_ptr<LvePipeline> lvePipeline;
+         //one pipeline per LveModel::VertexFormat, indexed by the enum value
+			Pipelines lvePipelines;
+         //same shaders testing depth with EQUAL and not writing it, used after a depth prepass
+         Pipelines prepassShadingPipelines;
+         //vertex stage only, reading positions alone
+         Pipelines depthPipelines;
+         bool depthPrepass = false;
          VkPipelineLayout pipelineLayout;
+         //LOD threshold in normalized device coordinates (the viewport is 2 high). 1 pixel at 600 pixels by default
+         float lodScreenError = 2.f / 600.f;
+         bool meshletConeCulling = false;
+         //reused every object, every frame
+         std::vector<LveMeshletCuller::DrawRange> drawRanges;
 	};
 }
@@ -0,0 +1,18 @@
+//position only vertex shader of the depth prepass, for every vertex format: the attribute format unpacks compact positions and the
+//dequantization is part of push.transform. Fetches location 0 and nothing else, with a split format that is 12 or 8 bytes a vertex
+#version 450
+
+layout(location = 0) in vec3 position;
+
+//same block as the shading shaders, they share the pipeline layout
+layout(push_constant) uniform Push {
+	mat4 transform;
+	mat4 normalMatrix;
+} push;
+
+//the shading pass tests against this depth with EQUAL, so both have to compute gl_Position bit for bit the same
+invariant gl_Position;
+
+void main() {
+	gl_Position = push.transform * vec4(position, 1.0);
+}
@@ -5,10 +5,13 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 color;
 layout(location = 2) in vec3 normal;
-layout(location = 3) in vec3 uv;
+layout(location = 3) in vec2 uv;
 
 layout(location = 0) out vec3 fragColor;
 
+//identical to depth_prepass.vert's, so a depth prepass leaves exactly the depth this shader's EQUAL test expects
+invariant gl_Position;
+
 //ordering important
 layout(push_constant) uniform Push {
 	mat4 transform; //projection * view * model
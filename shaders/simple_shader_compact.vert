@@ -0,0 +1,43 @@
+//variant of simple_shader.vert for LveModel::CompactVertex
+#version 450
+
+//the attribute formats unpack these to floats: position is snorm16 (-1 to 1 inside the model's bounds), color unorm8, uv half
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+//octahedral encoded, snorm16
+layout(location = 2) in vec2 normal;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec3 fragColor;
+
+//identical to depth_prepass.vert's, so a depth prepass leaves exactly the depth this shader's EQUAL test expects
+invariant gl_Position;
+
+//ordering important
+layout(push_constant) uniform Push {
+	mat4 transform; //projection * view * model * dequantization
+	mat4 normalMatrix;
+} push;
+
+const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, -1.0));
+const float AMBIENT = 0.02;
+
+//inverse of LveVertexQuantizer::encodeOctahedral: unfold the lower half of the octahedron back under the square
+vec3 decodeOctahedral(vec2 encoded) {
+	vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -fold : fold;
+	n.y += n.y >= 0.0 ? -fold : fold;
+	return normalize(n);
+}
+
+void main() {
+	//the dequantization matrix is folded into push.transform, so quantized positions go in as is
+	gl_Position = push.transform * vec4(position, 1.0);
+
+	vec3 normalWorldSpace = normalize(mat3(push.normalMatrix) * decodeOctahedral(normal));
+
+	float lightIntensity = AMBIENT + max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
+
+	fragColor = lightIntensity * color;
+}
@@ -0,0 +1,106 @@
+//packs directories into one asset archive for LveArchive::mount, see pack.bat.
+//usage: asset_packer [--store] [--verify] [output=assets.lvepak] [directories=models shaders]
+//run from the repository root: paths in the archive are relative to the current directory, the same paths the loaders open.
+//every .obj also gets its processed mesh cache packed next to it (optimized, LODs, meshlets), so a packed build never imports OBJ at startup
+#include "vulkan_archive.hpp"
+#include "vulkan_mesh_cache.hpp"
+#include "vulkan_model.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+   std::vector<char> readWholeFile(const std::filesystem::path &path) {
+      std::ifstream file(path, std::ios::binary);
+      if (!file.is_open()) throw std::runtime_error("failed to open file: " + path.string());
+      return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+   }
+
+   //the same steps LveModel::createModelFromFile takes on a cache miss, leaving the cache next to the source
+   void buildMeshCache(const std::string &path) {
+      lve::LveMeshCache cache{};
+      if (cache.open(path)) return;
+
+      lve::LveModel::Builder builder{};
+      builder.loadModel(path);
+      builder.optimize();
+      builder.generateLods();
+      builder.buildMeshlets();
+      builder.makeProgressive();
+      lve::LveMeshCache::write(path, builder);
+   }
+}
+
+int main(int argc, char **argv) {
+   bool compress = true;
+   bool verify = false;
+   std::string output{};
+   std::vector<std::string> directories{};
+   for (int i = 1; i < argc; i++) {
+      const std::string arg = argv[i];
+      if (arg == "--store") compress = false;
+      else if (arg == "--verify") verify = true;
+      else if (output.empty()) output = arg;
+      else directories.push_back(arg);
+   }
+   if (output.empty()) output = "assets.lvepak";
+   if (directories.empty()) directories = {"models", "shaders"};
+
+   try {
+      const auto start = std::chrono::high_resolution_clock::now();
+      std::vector<lve::LveArchive::Source> sources{};
+      uint64_t totalBytes = 0;
+
+      for (const auto &directory : directories) {
+         for (const auto &entry : std::filesystem::recursive_directory_iterator(directory)) {
+            if (!entry.is_regular_file()) continue;
+            const auto extension = entry.path().extension();
+            //caches are packed along with their source below, leftovers of interrupted writes not at all
+            if (extension == ".lvemesh" || extension == ".tmp") continue;
+
+            const std::string path = entry.path().generic_string();
+            sources.push_back({path, readWholeFile(entry.path())});
+            totalBytes += sources.back().contents.size();
+
+            if (extension == ".obj") {
+               buildMeshCache(path);
+               const std::string cachePath = lve::LveMeshCache::cachePathFor(path);
+               sources.push_back({cachePath, readWholeFile(cachePath)});
+               totalBytes += sources.back().contents.size();
+            }
+         }
+      }
+
+      lve::LveArchive::write(output, std::move(sources), compress);
+      const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+      lve::LveArchive archive{output};
+      const uint64_t archiveBytes = std::filesystem::file_size(output);
+      std::cout << output << ": " << archive.entryCount() << " entries, " << totalBytes << " -> " << archiveBytes << " bytes ("
+                << std::fixed << std::setprecision(1) << 100.0 * archiveBytes / std::max<uint64_t>(totalBytes, 1) << "%) in "
+                << std::setprecision(2) << seconds << " s\n";
+
+      if (verify) {
+         std::vector<const lve::LveArchiveEntry *> entries{};
+         for (uint32_t e = 0; e < archive.entryCount(); e++) entries.push_back(&archive.entry(e));
+         const auto contents = archive.readAll(entries);
+         for (size_t e = 0; e < entries.size(); e++) {
+            if (!lve::LveArchive::verify(*entries[e], contents[e])) {
+               std::cerr << "verify failed: " << archive.name(*entries[e]) << '\n';
+               return 1;
+            }
+         }
+         std::cout << "verified " << entries.size() << " entries\n";
+      }
+   } catch (const std::exception &e) {
+      std::cerr << e.what() << '\n';
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,264 @@
+#include "vulkan_archive.hpp"
+#include "vulkan_lz4.hpp"
+#include "vulkan_utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+namespace lve {
+
+   namespace {
+      constexpr char MAGIC[4] = {'L', 'P', 'A', 'K'};
+
+      std::unique_ptr<LveArchive> &mountedArchive() {
+         static std::unique_ptr<LveArchive> archive{};
+         return archive;
+      }
+
+      //runs fn(i) for every i in [0, count) on up to threadCount threads (the calling thread is one of them), taking the next index as each finishes
+      template <typename Fn>
+      void runParallel(size_t count, unsigned threadCount, Fn fn) {
+         if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+         threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, count));
+
+         std::atomic<size_t> next{0};
+         auto worker = [&next, count, &fn]() {
+            for (size_t i = next++; i < count; i = next++) fn(i);
+         };
+         std::vector<std::thread> threads{};
+         threads.reserve(threadCount > 0 ? threadCount - 1 : 0);
+         for (unsigned t = 1; t < threadCount; t++) threads.emplace_back(worker);
+         worker();
+         for (auto &thread : threads) thread.join();
+      }
+
+      //archive paths always use '/', without a leading "./"
+      std::string normalize(std::string path) {
+         std::replace(path.begin(), path.end(), '\\', '/');
+         while (path.size() >= 2 && path[0] == '.' && path[1] == '/') path.erase(0, 2);
+         return path;
+      }
+   }
+
+   LveArchive::LveArchive(const std::string &filepath) : file{filepath} {
+      if (file.size() < sizeof(LveArchiveHeader)) throw std::runtime_error("not an asset archive: " + filepath);
+      header = reinterpret_cast<const LveArchiveHeader *>(file.data());
+      if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) throw std::runtime_error("not an asset archive: " + filepath);
+      if (header->version != VERSION) throw std::runtime_error("asset archive " + filepath + " is version " + std::to_string(header->version) + ", expected " + std::to_string(VERSION));
+
+      //tables are used in place, so they have to fit before anything points into them
+      const uint64_t entryBytes = uint64_t{header->entryCount} * sizeof(LveArchiveEntry);
+      const uint64_t blockBytes = uint64_t{header->blockCount} * sizeof(LveArchiveBlock);
+      if (header->entryOffset + entryBytes > file.size() ||
+         header->blockOffset + blockBytes > file.size() ||
+         header->nameOffset + header->nameBytes > file.size()) {
+         throw std::runtime_error("truncated asset archive: " + filepath);
+      }
+      entries = reinterpret_cast<const LveArchiveEntry *>(file.data() + header->entryOffset);
+      blocks = reinterpret_cast<const LveArchiveBlock *>(file.data() + header->blockOffset);
+      names = reinterpret_cast<const char *>(file.data() + header->nameOffset);
+
+      for (uint32_t e = 0; e < header->entryCount; e++) {
+         const LveArchiveEntry &entry = entries[e];
+         if (uint64_t{entry.nameOffset} + entry.nameLength > header->nameBytes ||
+            uint64_t{entry.firstBlock} + entry.blockCount > header->blockCount) {
+            throw std::runtime_error("corrupt entry table in asset archive: " + filepath);
+         }
+      }
+      for (uint32_t b = 0; b < header->blockCount; b++) {
+         if (blocks[b].offset + blocks[b].compressedSize > file.size() || blocks[b].size > header->blockSize) {
+            throw std::runtime_error("corrupt block table in asset archive: " + filepath);
+         }
+      }
+   }
+
+   std::string LveArchive::name(const LveArchiveEntry &entry) const {
+      return std::string(names + entry.nameOffset, entry.nameLength);
+   }
+
+   const LveArchiveEntry *LveArchive::find(const std::string &path) const {
+      const std::string key = normalize(path);
+      const LveArchiveEntry *end = entries + header->entryCount;
+      const LveArchiveEntry *found = std::lower_bound(entries, end, key, [this](const LveArchiveEntry &entry, const std::string &value) {
+         return std::string_view(names + entry.nameOffset, entry.nameLength) < value;
+      });
+      if (found == end || std::string_view(names + found->nameOffset, found->nameLength) != key) return nullptr;
+      return found;
+   }
+
+   std::vector<char> LveArchive::read(const std::string &path, unsigned threadCount) {
+      const LveArchiveEntry *entry = find(path);
+      if (entry == nullptr) throw std::runtime_error("asset archive has no entry: " + path);
+
+      {
+         std::lock_guard<std::mutex> lock{prefetchMutex};
+         auto it = prefetched.find(entry);
+         if (it != prefetched.end()) {
+            std::vector<char> contents = std::move(it->second);
+            prefetched.erase(it);
+            return contents;
+         }
+      }
+      return std::move(readAll({entry}, threadCount)[0]);
+   }
+
+   std::vector<std::vector<char>> LveArchive::readAll(const std::vector<const LveArchiveEntry *> &wanted, unsigned threadCount) const {
+      struct Task {
+         size_t entry;
+         uint32_t block;
+         uint64_t outputOffset;
+      };
+
+      std::vector<std::vector<char>> contents(wanted.size());
+      std::vector<Task> tasks{};
+      for (size_t e = 0; e < wanted.size(); e++) {
+         contents[e].resize(wanted[e]->size);
+         uint64_t outputOffset = 0;
+         for (uint32_t b = wanted[e]->firstBlock; b < wanted[e]->firstBlock + wanted[e]->blockCount; b++) {
+            tasks.push_back({e, b, outputOffset});
+            outputOffset += blocks[b].size;
+         }
+         if (outputOffset != wanted[e]->size) throw std::runtime_error("asset archive blocks don't add up to entry size: " + name(*wanted[e]));
+      }
+
+      //first bad block, reported after every thread has joined
+      std::atomic<bool> failed{false};
+      std::atomic<size_t> failedEntry{0};
+      runParallel(tasks.size(), threadCount, [&](size_t t) {
+         const Task &task = tasks[t];
+         const LveArchiveBlock &block = blocks[task.block];
+         const unsigned char *src = file.data() + block.offset;
+         char *dst = contents[task.entry].data() + task.outputOffset;
+         if (block.compressedSize == block.size) {
+            std::memcpy(dst, src, block.size);
+         } else if (!LveLz4::decompress(src, block.compressedSize, dst, block.size)) {
+            if (!failed.exchange(true)) failedEntry = task.entry;
+         }
+      });
+      if (failed) throw std::runtime_error("corrupt block in asset archive entry: " + name(*wanted[failedEntry]));
+      return contents;
+   }
+
+   void LveArchive::prefetch(const std::vector<std::string> &prefixes, unsigned threadCount) {
+      std::vector<const LveArchiveEntry *> wanted{};
+      for (const auto &prefix : prefixes) {
+         //entries are sorted, so everything sharing the prefix is one run starting at its lower bound
+         const std::string key = normalize(prefix);
+         const LveArchiveEntry *end = entries + header->entryCount;
+         const LveArchiveEntry *it = std::lower_bound(entries, end, key, [this](const LveArchiveEntry &entry, const std::string &value) {
+            return std::string_view(names + entry.nameOffset, entry.nameLength) < value;
+         });
+         for (; it != end && std::string_view(names + it->nameOffset, it->nameLength).compare(0, key.size(), key) == 0; it++) {
+            if (std::find(wanted.begin(), wanted.end(), it) == wanted.end()) wanted.push_back(it);
+         }
+      }
+
+      std::vector<std::vector<char>> contents = readAll(wanted, threadCount);
+      std::lock_guard<std::mutex> lock{prefetchMutex};
+      for (size_t i = 0; i < wanted.size(); i++) prefetched[wanted[i]] = std::move(contents[i]);
+   }
+
+   bool LveArchive::verify(const LveArchiveEntry &entry, const std::vector<char> &contents) {
+      return contents.size() == entry.size && hashBytes(contents.data(), contents.size()) == entry.contentHash;
+   }
+
+   void LveArchive::write(const std::string &filepath, std::vector<Source> sources, bool compress, unsigned threadCount) {
+      for (auto &source : sources) source.path = normalize(source.path);
+      std::sort(sources.begin(), sources.end(), [](const Source &a, const Source &b) { return a.path < b.path; });
+      for (size_t i = 1; i < sources.size(); i++) {
+         if (sources[i].path == sources[i - 1].path) throw std::runtime_error("duplicate archive path: " + sources[i].path);
+      }
+
+      std::vector<LveArchiveEntry> entryTable(sources.size());
+      std::vector<LveArchiveBlock> blockTable{};
+      std::string nameTable{};
+      //source and offset of every block, for compressing them in parallel
+      std::vector<std::pair<size_t, size_t>> blockSources{};
+      for (size_t s = 0; s < sources.size(); s++) {
+         const auto &contents = sources[s].contents;
+         LveArchiveEntry &entry = entryTable[s];
+         entry.contentHash = hashBytes(contents.data(), contents.size());
+         entry.size = contents.size();
+         entry.nameOffset = static_cast<uint32_t>(nameTable.size());
+         entry.nameLength = static_cast<uint32_t>(sources[s].path.size());
+         entry.firstBlock = static_cast<uint32_t>(blockTable.size());
+         nameTable += sources[s].path;
+
+         for (size_t offset = 0; offset < contents.size(); offset += BLOCK_SIZE) {
+            blockTable.push_back({0, 0, static_cast<uint32_t>(std::min<size_t>(BLOCK_SIZE, contents.size() - offset))});
+            blockSources.emplace_back(s, offset);
+         }
+         entry.blockCount = static_cast<uint32_t>(blockTable.size() - entry.firstBlock);
+      }
+
+      std::vector<std::vector<char>> payloads(blockTable.size());
+      runParallel(blockTable.size(), threadCount, [&](size_t b) {
+         const char *src = sources[blockSources[b].first].contents.data() + blockSources[b].second;
+         const uint32_t size = blockTable[b].size;
+         if (compress) {
+            payloads[b].resize(LveLz4::compressBound(size));
+            payloads[b].resize(LveLz4::compress(src, size, payloads[b].data(), payloads[b].size()));
+         }
+         //compressedSize == size is how readers tell a stored block apart
+         if (!compress || payloads[b].size() >= size) payloads[b].assign(src, src + size);
+      });
+
+      LveArchiveHeader header{};
+      memcpy(header.magic, MAGIC, sizeof(MAGIC));
+      header.version = VERSION;
+      header.entryCount = static_cast<uint32_t>(entryTable.size());
+      header.blockCount = static_cast<uint32_t>(blockTable.size());
+      header.blockSize = BLOCK_SIZE;
+      header.entryOffset = sizeof(LveArchiveHeader);
+      header.blockOffset = header.entryOffset + entryTable.size() * sizeof(LveArchiveEntry);
+      header.nameOffset = header.blockOffset + blockTable.size() * sizeof(LveArchiveBlock);
+      header.nameBytes = nameTable.size();
+
+      uint64_t offset = header.nameOffset + header.nameBytes;
+      for (size_t b = 0; b < blockTable.size(); b++) {
+         blockTable[b].offset = offset;
+         blockTable[b].compressedSize = static_cast<uint32_t>(payloads[b].size());
+         offset += payloads[b].size();
+      }
+      for (auto &entry : entryTable) {
+         entry.compression = LveCompression::None;
+         for (uint32_t b = entry.firstBlock; b < entry.firstBlock + entry.blockCount; b++) {
+            if (blockTable[b].compressedSize != blockTable[b].size) entry.compression = LveCompression::Lz4;
+         }
+      }
+
+      //same as the mesh cache: temporary file and rename, so a half written archive is never picked up
+      const std::string tempPath = filepath + ".tmp";
+      {
+         std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+         if (!out.is_open()) throw std::runtime_error("failed to open asset archive for writing: " + tempPath);
+         out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+         out.write(reinterpret_cast<const char *>(entryTable.data()), entryTable.size() * sizeof(LveArchiveEntry));
+         out.write(reinterpret_cast<const char *>(blockTable.data()), blockTable.size() * sizeof(LveArchiveBlock));
+         out.write(nameTable.data(), nameTable.size());
+         for (const auto &payload : payloads) out.write(payload.data(), payload.size());
+         if (!out) throw std::runtime_error("failed to write asset archive: " + tempPath);
+      }
+      std::filesystem::rename(tempPath, filepath);
+   }
+
+   void LveArchive::mount(const std::string &filepath) {
+      mountedArchive() = std::make_unique<LveArchive>(filepath);
+   }
+
+   void LveArchive::unmount() {
+      mountedArchive().reset();
+   }
+
+   LveArchive *LveArchive::mounted() {
+      return mountedArchive().get();
+   }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "vulkan_mapped_file.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+   //layout of a .lvepak file: this header, the entry table (sorted by path), the block table, the path strings, then the payloads.
+   //every entry is split into BLOCK_SIZE blocks that are compressed on their own, so even one large file decompresses on several threads
+   struct LveArchiveHeader {
+      char magic[4];
+      uint32_t version;
+      uint32_t entryCount;
+      uint32_t blockCount;
+      uint32_t blockSize;
+      uint32_t padding;
+      //byte offsets from the start of the file
+      uint64_t entryOffset;
+      uint64_t blockOffset;
+      uint64_t nameOffset;
+      uint64_t nameBytes;
+   };
+
+   enum class LveCompression : uint32_t {
+      None = 0,
+      Lz4 = 1
+   };
+
+   struct LveArchiveEntry {
+      //hashBytes of the uncompressed contents
+      uint64_t contentHash;
+      uint64_t size;
+      //path relative to the packed directory's root, '/' separated, not null terminated
+      uint32_t nameOffset;
+      uint32_t nameLength;
+      uint32_t firstBlock;
+      uint32_t blockCount;
+      LveCompression compression;
+      uint32_t padding;
+   };
+
+   struct LveArchiveBlock {
+      uint64_t offset;
+      //equal to size when the block didn't compress and is stored as is
+      uint32_t compressedSize;
+      uint32_t size;
+   };
+
+   //read side of a packed archive. The file is mapped, the tables are used in place and payloads are only touched when read
+   class LveArchive {
+      public:
+      //bump whenever the layout changes
+      static constexpr uint32_t VERSION = 1;
+      static constexpr uint32_t BLOCK_SIZE = 256 << 10;
+
+      //a file going into the archive, path as it will be looked up at runtime
+      struct Source {
+         std::string path;
+         std::vector<char> contents;
+      };
+
+      //throws std::runtime_error if the file is missing or isn't a valid archive
+      LveArchive(const std::string &filepath);
+
+      LveArchive(const LveArchive &) = delete;
+      LveArchive &operator=(const LveArchive &) = delete;
+
+      uint32_t entryCount() const { return header->entryCount; }
+      const LveArchiveEntry &entry(uint32_t index) const { return entries[index]; }
+      std::string name(const LveArchiveEntry &entry) const;
+      //binary search by path, '\' and a leading "./" are accepted too. nullptr if the archive doesn't have it
+      const LveArchiveEntry *find(const std::string &path) const;
+
+      //uncompressed contents of path, throws if the archive doesn't have it. Prefetched contents are handed out (once) without any work
+      std::vector<char> read(const std::string &path, unsigned threadCount = 0);
+      //decompresses every block of every entry on a shared set of threads. threadCount 0 means one per hardware thread
+      std::vector<std::vector<char>> readAll(const std::vector<const LveArchiveEntry *> &wanted, unsigned threadCount = 0) const;
+      //decompresses every entry whose path starts with one of the prefixes ahead of time, so the loaders' read() calls are just a move
+      void prefetch(const std::vector<std::string> &prefixes, unsigned threadCount = 0);
+      //true if contents hash to what the packer recorded
+      static bool verify(const LveArchiveEntry &entry, const std::vector<char> &contents);
+
+      //packs sources into filepath. Blocks that LZ4 can't shrink are stored as is, as is everything when compress is false
+      static void write(const std::string &filepath, std::vector<Source> sources, bool compress = true, unsigned threadCount = 0);
+
+      //process wide archive. While one is mounted the model and pipeline loaders read from it before they fall back to loose files
+      static void mount(const std::string &filepath);
+      static void unmount();
+      static LveArchive *mounted();
+
+      private:
+      LveMappedFile file;
+      const LveArchiveHeader *header = nullptr;
+      const LveArchiveEntry *entries = nullptr;
+      const LveArchiveBlock *blocks = nullptr;
+      const char *names = nullptr;
+
+      std::mutex prefetchMutex{};
+      std::unordered_map<const LveArchiveEntry *, std::vector<char>> prefetched{};
+   };
+}
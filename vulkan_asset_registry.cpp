@@ -0,0 +1,137 @@
+#include "vulkan_asset_registry.hpp"
+#include "vulkan_swap_chain.hpp"
+#include "vulkan_utils.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace lve {
+
+   LveAssetRegistry::LveAssetRegistry(LveModelLoader &loader, VkDeviceSize budgetBytes) : loader{loader}, budget{budgetBytes} {
+      //finished loads whose content is already in memory share it instead of being uploaded again
+      loader.setContentLookup([this](uint64_t contentHash, LveModel::VertexFormat vertexFormat) -> std::shared_ptr<LveModel> {
+         auto found = byContent.find(contentKey(contentHash, vertexFormat));
+         if (found != byContent.end()) return assets.at(found->second).model;
+         //finished in an earlier loader update, but not registered by update() yet
+         for (const auto &entry : entries) {
+            const LveModelHandle &handle = entry.second.handle;
+            if (handle.ready() && handle.contentHash() == contentHash && handle.get()->getVertexFormat() == vertexFormat) return handle.get();
+         }
+         return nullptr;
+      });
+   }
+
+   LveAssetRegistry::~LveAssetRegistry() {
+      loader.setContentLookup(nullptr);
+   }
+
+   std::string LveAssetRegistry::entryKey(const std::string &path, LveModel::VertexFormat vertexFormat) {
+      return path + '|' + std::to_string(static_cast<int>(vertexFormat));
+   }
+
+   size_t LveAssetRegistry::contentKey(uint64_t contentHash, LveModel::VertexFormat vertexFormat) {
+      size_t key = static_cast<size_t>(contentHash);
+      hashCombine(key, static_cast<int>(vertexFormat));
+      return key;
+   }
+
+   LveModelHandle LveAssetRegistry::load(const std::string &path, LveModel::VertexFormat vertexFormat) {
+      const std::string key = entryKey(path, vertexFormat);
+      auto found = entries.find(key);
+      if (found != entries.end() && !found->second.handle.failed()) {
+         stats.pathHits++;
+         return found->second.handle;
+      }
+      Entry &entry = entries[key];
+      entry.handle = loader.load(path, vertexFormat);
+      entry.registered = false;
+      return entry.handle;
+   }
+
+   std::shared_ptr<LveModel> LveAssetRegistry::get(const std::string &path, LveModel::VertexFormat vertexFormat) {
+      return loader.wait(load(path, vertexFormat));
+   }
+
+   void LveAssetRegistry::update() {
+      frame++;
+      stats.loading = 0;
+      for (auto &asset : assets) {
+         asset.second.handles = 0;
+         asset.second.referenced = false;
+      }
+
+      for (auto it = entries.begin(); it != entries.end();) {
+         Entry &entry = it->second;
+         const LveModelHandle &handle = entry.handle;
+         if (handle.status() == LveModelHandle::Status::Loading) {
+            stats.loading++;
+            ++it;
+            continue;
+         }
+         //the loader reported the error, a later load starts over
+         if (handle.failed()) {
+            it = entries.erase(it);
+            continue;
+         }
+
+         std::shared_ptr<LveModel> model = handle.get();
+         if (!entry.registered) {
+            entry.registered = true;
+            auto existing = assets.find(model.get());
+            if (existing != assets.end()) {
+               stats.contentHits++;
+            } else {
+               const size_t key = contentKey(handle.contentHash(), model->getVertexFormat());
+               assets[model.get()] = {model, key, model->getMemoryBytes(), frame, 0, true};
+               byContent[key] = model.get();
+               stats.memoryBytes += model->getMemoryBytes();
+            }
+         }
+
+         Asset &asset = assets.at(model.get());
+         asset.handles++;
+         asset.referenced = asset.referenced || handle.shared();
+         ++it;
+      }
+
+      //every registry handle holds one reference through its state, plus the asset's own. Anything beyond that is a user
+      for (auto &pair : assets) {
+         Asset &asset = pair.second;
+         if (asset.model.use_count() > static_cast<long>(asset.handles) + 1) asset.referenced = true;
+         if (asset.referenced) asset.lastUsedFrame = frame;
+      }
+      stats.assets = static_cast<uint32_t>(assets.size());
+
+      if (budget > 0 && stats.memoryBytes > budget) evict();
+   }
+
+   void LveAssetRegistry::evict() {
+      std::vector<Asset *> candidates{};
+      for (auto &pair : assets) {
+         Asset &asset = pair.second;
+         if (!asset.referenced && frame - asset.lastUsedFrame > LveSwapChain::MAX_FRAMES_IN_FLIGHT) candidates.push_back(&asset);
+      }
+      std::sort(candidates.begin(), candidates.end(), [](const Asset *a, const Asset *b) { return a->lastUsedFrame < b->lastUsedFrame; });
+
+      for (Asset *asset : candidates) {
+         if (stats.memoryBytes <= budget) break;
+         const LveModel *model = asset->model.get();
+         for (auto it = entries.begin(); it != entries.end();) {
+            if (it->second.registered && it->second.handle.get().get() == model) {
+               std::cout << "Evicted " << it->second.handle.path() << " (" << asset->memoryBytes / 1024 << " KB)\n";
+               it = entries.erase(it);
+            } else {
+               ++it;
+            }
+         }
+         stats.memoryBytes -= asset->memoryBytes;
+         stats.evictions++;
+         stats.evictedBytes += asset->memoryBytes;
+         byContent.erase(asset->contentKey);
+         //last reference, the buffers are freed here
+         assets.erase(model);
+      }
+      stats.assets = static_cast<uint32_t>(assets.size());
+   }
+}
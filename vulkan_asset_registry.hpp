@@ -0,0 +1,77 @@
+#pragma once
+
+#include "vulkan_model_loader.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace lve {
+
+   //hands out shared model handles keyed by path, and by content hash so identical meshes under different paths share one set of buffers.
+   //loaded models stay cached after the last reference is gone. While the device memory of all cached models is over budget,
+   //unreferenced ones are freed, least recently used first. A model counts as referenced while anything outside the registry
+   //holds it (a game object) or a copy of its handle
+   class LveAssetRegistry {
+      public:
+      struct Stats {
+         uint32_t assets = 0;
+         uint32_t loading = 0;
+         VkDeviceSize memoryBytes = 0;
+         //load calls answered by an existing handle
+         uint64_t pathHits = 0;
+         //loads that finished as a copy of an asset already in memory and shared it
+         uint64_t contentHits = 0;
+         uint64_t evictions = 0;
+         VkDeviceSize evictedBytes = 0;
+      };
+
+      //budgetBytes 0 never evicts
+      explicit LveAssetRegistry(LveModelLoader &loader, VkDeviceSize budgetBytes = 0);
+      ~LveAssetRegistry();
+
+      LveAssetRegistry(const LveAssetRegistry &) = delete;
+      LveAssetRegistry &operator=(const LveAssetRegistry &) = delete;
+
+      //the handle already loading or loaded for path and vertexFormat, or a new load. Failed loads are retried
+      LveModelHandle load(const std::string &path, LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float32);
+      //blocks until loaded, null on failure
+      std::shared_ptr<LveModel> get(const std::string &path, LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float32);
+
+      //once per frame, after LveModelLoader::update and before recording: registers finished loads, marks referenced assets as used
+      //this frame and evicts while over budget. Only assets unused for more than MAX_FRAMES_IN_FLIGHT frames are evicted, so no
+      //command buffer still in flight can be drawing them
+      void update();
+
+      void setBudget(VkDeviceSize budgetBytes) { budget = budgetBytes; }
+      VkDeviceSize getBudget() const { return budget; }
+      const Stats &getStats() const { return stats; }
+
+      private:
+      //one per set of GPU buffers, however many paths share it
+      struct Asset {
+         std::shared_ptr<LveModel> model;
+         size_t contentKey;
+         VkDeviceSize memoryBytes;
+         uint64_t lastUsedFrame;
+         //filled by update: handles of this asset held by the registry, and whether anything else references it
+         uint32_t handles;
+         bool referenced;
+      };
+      struct Entry {
+         LveModelHandle handle;
+         bool registered = false;
+      };
+
+      static std::string entryKey(const std::string &path, LveModel::VertexFormat vertexFormat);
+      static size_t contentKey(uint64_t contentHash, LveModel::VertexFormat vertexFormat);
+      void evict();
+
+      LveModelLoader &loader;
+      VkDeviceSize budget;
+      uint64_t frame = 0;
+      Stats stats{};
+      std::unordered_map<std::string, Entry> entries{};
+      std::unordered_map<const LveModel *, Asset> assets{};
+      std::unordered_map<size_t, const LveModel *> byContent{};
+   };
+}
@@ -27,6 +27,7 @@ namespace lve {
    }
 
    void LveCamera::setViewDirection(glm::vec3 position, glm::vec3 direction, glm::vec3 up) {
+      this->position = position;
       //orthonormal basis. Use the basis to create rotation matrix
       const glm::vec3 w{glm::normalize(direction)};
       const glm::vec3 u{glm::normalize(glm::cross(w, up))};
@@ -54,6 +55,7 @@ namespace lve {
    }
 
    void LveCamera::setViewYXZ(glm::vec3 position, glm::vec3 rotation) {
+      this->position = position;
       //combine inverse of rotation matrix with translation matrix (we want inverse to rotate from camera's current orientation back to the canonical orientation)
       //for this implimentation, instead of using inverse, we can use negative angle values
       //rotation matrices are special because their inverse is their transpose
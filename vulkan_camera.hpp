@@ -28,9 +28,15 @@ namespace lve {
          return viewMatrix;
       }
 
+      //world space position the view was last set from
+      const glm::vec3& getPosition() const {
+         return position;
+      }
+
       private:
       //{1.f} is identity matrix
       glm::mat4 projectionMatrix{1.f};
       glm::mat4 viewMatrix{1.f};
+      glm::vec3 position{0.f};
    };
 } 
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include "vulkan_device.hpp"
+#include "vulkan_geometry_arena.hpp"
+#include "vulkan_staging_ring.hpp"
+#include "vulkan_upload_manager.hpp"
 #include <vulkan/vulkan.h>
 // std headers
 #include <cstring>
@@ -60,9 +63,21 @@ LveDevice::LveDevice(LveWindow &window) : window{window} {
   createLogicalDevice();
   //command buffer allocation (memory allocation)
   createCommandPool();
+  //device memory for buffers and images, sub-allocated from a few big blocks
+  memoryAllocator = std::make_unique<LveMemoryAllocator>(device_, physicalDevice);
+  //buffers are only created once the first model needs them
+  geometryArena_ = std::make_unique<LveGeometryArena>(*this);
+  //uploads on the transfer queue, if there is one
+  uploadManager_ = std::make_unique<LveUploadManager>(*this);
+  //staging and per-frame data, mapped once for good
+  stagingRing_ = std::make_unique<LveStagingRing>(*this);
 }
 
 LveDevice::~LveDevice() {
+  stagingRing_.reset();
+  uploadManager_.reset();
+  geometryArena_.reset();
+  memoryAllocator.reset();
   vkDestroyCommandPool(device_, commandPool, nullptr);
   vkDestroyDevice(device_, nullptr);
 
@@ -85,7 +100,14 @@ void LveDevice::createInstance() {
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "No Engine";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+  //1.1 where the loader has it, importing host memory (LveHostImport) builds on its external memory support
   appInfo.apiVersion = VK_API_VERSION_1_0;
+  auto enumerateInstanceVersion = reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+      vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+  uint32_t loaderVersion = VK_API_VERSION_1_0;
+  if (enumerateInstanceVersion != nullptr) enumerateInstanceVersion(&loaderVersion);
+  if (loaderVersion >= VK_API_VERSION_1_1) appInfo.apiVersion = VK_API_VERSION_1_1;
+  instanceVersion = appInfo.apiVersion;
 
   VkInstanceCreateInfo createInfo = {};
   createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -144,6 +166,7 @@ void LveDevice::createLogicalDevice() {
 
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
   std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+  if (indices.transferFamilyHasValue) uniqueQueueFamilies.insert(indices.transferFamily);
 
   float queuePriority = 1.0f;
   for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -164,9 +187,14 @@ void LveDevice::createLogicalDevice() {
   createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
   createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
+  //optional ones only where supported
+  std::vector<const char *> enabledExtensions = deviceExtensions;
+  const VkDeviceSize hostImportAlignment = queryHostImportAlignment(physicalDevice);
+  if (hostImportAlignment > 0) enabledExtensions.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+
   createInfo.pEnabledFeatures = &deviceFeatures;
-  createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-  createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+  createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+  createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
   // might not really be necessary anymore because device specific validation layers
   // have been deprecated
@@ -183,6 +211,56 @@ void LveDevice::createLogicalDevice() {
 
   vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
   vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+  transferQueue_ = graphicsQueue_;
+  if (indices.transferFamilyHasValue) {
+    vkGetDeviceQueue(device_, indices.transferFamily, 0, &transferQueue_);
+  }
+
+  if (hostImportAlignment > 0) {
+    getMemoryHostPointerProperties = reinterpret_cast<PFN_vkGetMemoryHostPointerPropertiesEXT>(
+        vkGetDeviceProcAddr(device_, "vkGetMemoryHostPointerPropertiesEXT"));
+    if (getMemoryHostPointerProperties != nullptr) hostImportAlignment_ = hostImportAlignment;
+  }
+  std::cout << "host memory import: " << (hostImportAlignment_ > 0 ? "yes" : "no, uploads are staged") << std::endl;
+}
+
+VkDeviceSize LveDevice::queryHostImportAlignment(VkPhysicalDevice device) {
+  //the extension needs external memory, core in 1.1, and its limit is read through vkGetPhysicalDeviceProperties2
+  VkPhysicalDeviceProperties deviceProperties;
+  vkGetPhysicalDeviceProperties(device, &deviceProperties);
+  if (instanceVersion < VK_API_VERSION_1_1 || deviceProperties.apiVersion < VK_API_VERSION_1_1) return 0;
+
+  uint32_t extensionCount;
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+  std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+  vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+  bool available = false;
+  for (const auto &extension : availableExtensions) {
+    if (strcmp(extension.extensionName, VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME) == 0) available = true;
+  }
+  if (!available) return 0;
+
+  VkPhysicalDeviceExternalMemoryHostPropertiesEXT hostProperties = {};
+  hostProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+  VkPhysicalDeviceProperties2 properties2 = {};
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = &hostProperties;
+  vkGetPhysicalDeviceProperties2(device, &properties2);
+  return hostProperties.minImportedHostPointerAlignment;
+}
+
+uint32_t LveDevice::hostPointerMemoryTypes(const void *pointer) {
+  if (hostImportAlignment_ == 0) return 0;
+  VkMemoryHostPointerPropertiesEXT hostPointerProperties = {};
+  hostPointerProperties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+  if (getMemoryHostPointerProperties(
+          device_,
+          VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT,
+          pointer,
+          &hostPointerProperties) != VK_SUCCESS) {
+    return 0;
+  }
+  return hostPointerProperties.memoryTypeBits;
 }
 
 void LveDevice::createCommandPool() {
@@ -351,6 +429,18 @@ QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device) {
     i++;
   }
 
+  //copies there run alongside rendering. A family that only transfers is preferred over one that also computes
+  for (uint32_t family = 0; family < queueFamilyCount; family++) {
+    const VkQueueFlags flags = queueFamilies[family].queueFlags;
+    if (queueFamilies[family].queueCount == 0 || !(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT)) {
+      continue;
+    }
+    if (!indices.transferFamilyHasValue || !(flags & VK_QUEUE_COMPUTE_BIT)) {
+      indices.transferFamily = family;
+      indices.transferFamilyHasValue = true;
+    }
+  }
+
   return indices;
 }
 
@@ -414,7 +504,7 @@ void LveDevice::createBuffer(
     VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties,
     VkBuffer &buffer,
-    VkDeviceMemory &bufferMemory) {
+    LveAllocation &bufferMemory) {
   VkBufferCreateInfo bufferInfo{};
   bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   bufferInfo.size = size;
@@ -428,17 +518,22 @@ void LveDevice::createBuffer(
   VkMemoryRequirements memRequirements;
   vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
 
-  //allocate memory of proper size
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate vertex buffer memory!");
+  //memory of proper size, a range of a shared block. Callers may fall back to other properties, so no buffer is left behind
+  try {
+    bufferMemory = memoryAllocator->allocate(
+        memRequirements, properties, LveMemoryAllocator::ResourceKind::Linear);
+  } catch (...) {
+    vkDestroyBuffer(device_, buffer, nullptr);
+    buffer = VK_NULL_HANDLE;
+    throw;
   }
 
-  vkBindBufferMemory(device_, buffer, bufferMemory, 0);
+  vkBindBufferMemory(device_, buffer, bufferMemory.memory, bufferMemory.offset);
+}
+
+void LveDevice::destroyBuffer(VkBuffer buffer, LveAllocation &bufferMemory) {
+  vkDestroyBuffer(device_, buffer, nullptr);
+  memoryAllocator->free(bufferMemory);
 }
 
 VkCommandBuffer LveDevice::beginSingleTimeCommands() {
@@ -516,7 +611,7 @@ void LveDevice::createImageWithInfo(
     const VkImageCreateInfo &imageInfo,
     VkMemoryPropertyFlags properties,
     VkImage &image,
-    VkDeviceMemory &imageMemory) {
+    LveAllocation &imageMemory) {
   if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS) {
     throw std::runtime_error("failed to create image!");
   }
@@ -524,18 +619,21 @@ void LveDevice::createImageWithInfo(
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(device_, image, &memRequirements);
 
-  VkMemoryAllocateInfo allocInfo{};
-  allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-  allocInfo.allocationSize = memRequirements.size;
-  allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-  if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
-    throw std::runtime_error("failed to allocate image memory!");
-  }
+  //optimal tiling images never share a block with buffers, see ResourceKind
+  imageMemory = memoryAllocator->allocate(
+      memRequirements,
+      properties,
+      imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL ? LveMemoryAllocator::ResourceKind::Optimal
+                                                  : LveMemoryAllocator::ResourceKind::Linear);
 
-  if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS) {
+  if (vkBindImageMemory(device_, image, imageMemory.memory, imageMemory.offset) != VK_SUCCESS) {
     throw std::runtime_error("failed to bind image memory!");
   }
 }
 
+void LveDevice::destroyImage(VkImage image, LveAllocation &imageMemory) {
+  vkDestroyImage(device_, image, nullptr);
+  memoryAllocator->free(imageMemory);
+}
+
 }  // namespace lve
\ No newline at end of file
@@ -1,14 +1,20 @@
 #pragma once
 
+#include "vulkan_memory_allocator.hpp"
 #include "vulkan_window.hpp"
 #include <vulkan/vulkan.h>
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace lve {
 
+class LveGeometryArena;
+class LveStagingRing;
+class LveUploadManager;
+
 struct SwapChainSupportDetails {
   VkSurfaceCapabilitiesKHR capabilities;
   std::vector<VkSurfaceFormatKHR> formats;
@@ -18,8 +24,11 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
   uint32_t graphicsFamily;
   uint32_t presentFamily;
+  //a family that can copy but not draw, usually a DMA engine. Optional
+  uint32_t transferFamily;
   bool graphicsFamilyHasValue = false;
   bool presentFamilyHasValue = false;
+  bool transferFamilyHasValue = false;
   bool isComplete() { return graphicsFamilyHasValue && presentFamilyHasValue; }
 };
 
@@ -45,6 +54,8 @@ class LveDevice {
   VkSurfaceKHR surface() { return surface_; }
   VkQueue graphicsQueue() { return graphicsQueue_; }
   VkQueue presentQueue() { return presentQueue_; }
+  //the graphics queue when there is no transfer only family
+  VkQueue transferQueue() { return transferQueue_; }
 
   SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
   uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -53,12 +64,14 @@ class LveDevice {
       const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
 
   // Buffer Helper Functions
+  //memory comes from the device's allocator, freed again with destroyBuffer
   void createBuffer(
       VkDeviceSize size,
       VkBufferUsageFlags usage,
       VkMemoryPropertyFlags properties,
       VkBuffer &buffer,
-      VkDeviceMemory &bufferMemory);
+      LveAllocation &bufferMemory);
+  void destroyBuffer(VkBuffer buffer, LveAllocation &bufferMemory);
   VkCommandBuffer beginSingleTimeCommands();
   void endSingleTimeCommands(VkCommandBuffer commandBuffer);
   void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
@@ -69,7 +82,25 @@ class LveDevice {
       const VkImageCreateInfo &imageInfo,
       VkMemoryPropertyFlags properties,
       VkImage &image,
-      VkDeviceMemory &imageMemory);
+      LveAllocation &imageMemory);
+  void destroyImage(VkImage image, LveAllocation &imageMemory);
+
+  LveMemoryAllocator::Stats getMemoryStats() const { return memoryAllocator->getStats(); }
+  //after writing to mapped memory, see LveMemoryAllocator::flush
+  void flushMemory(const LveAllocation &memory, VkDeviceSize offset, VkDeviceSize size) const {
+    memoryAllocator->flush(memory, offset, size);
+  }
+  //host memory imports (LveHostImport) have to start at and span multiples of this. 0 if the device can't import,
+  //without VK_EXT_external_memory_host
+  VkDeviceSize hostImportAlignment() const { return hostImportAlignment_; }
+  //memory types host memory at pointer can be imported as, 0 if none
+  uint32_t hostPointerMemoryTypes(const void *pointer);
+  //shared vertex and index buffers models take their ranges from
+  LveGeometryArena &geometryArena() { return *geometryArena_; }
+  //copies into buffers without stalling the graphics queue, see LveUploadBatch
+  LveUploadManager &uploadManager() { return *uploadManager_; }
+  //mapped host memory for staging and per-frame data
+  LveStagingRing &stagingRing() { return *stagingRing_; }
 
   VkPhysicalDeviceProperties properties;
 
@@ -89,9 +120,12 @@ class LveDevice {
   void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
   void hasGflwRequiredInstanceExtensions();
   bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+  //0 if the device can't import host memory
+  VkDeviceSize queryHostImportAlignment(VkPhysicalDevice device);
   SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
   VkInstance instance;
+  uint32_t instanceVersion = VK_API_VERSION_1_0;
   VkDebugUtilsMessengerEXT debugMessenger;
   VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
   LveWindow &window;
@@ -101,6 +135,17 @@ class LveDevice {
   VkSurfaceKHR surface_;
   VkQueue graphicsQueue_;
   VkQueue presentQueue_;
+  VkQueue transferQueue_;
+  VkDeviceSize hostImportAlignment_ = 0;
+  PFN_vkGetMemoryHostPointerPropertiesEXT getMemoryHostPointerProperties = nullptr;
+  //every buffer and image is placed through it, destroyed before the device
+  std::unique_ptr<LveMemoryAllocator> memoryAllocator;
+  //its buffers come from memoryAllocator, so it goes first
+  std::unique_ptr<LveGeometryArena> geometryArena_;
+  //waits for its uploads before it is gone, so it goes before both
+  std::unique_ptr<LveUploadManager> uploadManager_;
+  //waits for uploads reading from it through uploadManager_, so it goes first
+  std::unique_ptr<LveStagingRing> stagingRing_;
 
   const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
   const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -0,0 +1,100 @@
+#include "vulkan_geometry_arena.hpp"
+
+#include <iostream>
+
+namespace lve {
+
+   LveGeometryArena::LveGeometryArena(LveDevice &device) : lveDevice{device} {}
+
+   LveGeometryArena::~LveGeometryArena() {
+      for (auto &pool : vertexPools) destroyPool(pool);
+      destroyPool(indexPool);
+   }
+
+   uint32_t LveGeometryArena::allocateVertices(LveModel::VertexFormat vertexFormat, uint32_t count, uint32_t &firstVertex) {
+      Pool &pool = vertexPools[index(vertexFormat)];
+      if (!pool.ranges) {
+         //ranges count whole vertices, every stream gets a region of the buffer big enough for all of them
+         const VkDeviceSize stride = LveModel::getVertexStride(vertexFormat);
+         const VkDeviceSize capacity = (VERTEX_BUFFER_SIZE / stride) & ~(LveTlsf::MIN_ALIGNMENT - 1);
+         createPool(pool, capacity * stride, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+         pool.ranges = std::make_unique<LveTlsf>(capacity);
+         pool.unitBytes = stride;
+         uint32_t stream = 0;
+         VkDeviceSize offset = 0;
+         LveModel::withVertexType(vertexFormat, [&](auto type) {
+            for (const auto &binding : LveVertexLayout<typename decltype(type)::type>::BINDINGS) {
+               pool.streamOffsets[stream++] = offset;
+               offset += capacity * binding.stride;
+            }
+         });
+      }
+      return allocate(pool, count, 1, firstVertex, "vertex");
+   }
+
+   uint32_t LveGeometryArena::allocateIndices(VkIndexType indexType, uint32_t count, uint32_t &firstIndex) {
+      if (!indexPool.ranges) {
+         createPool(indexPool, INDEX_BUFFER_SIZE, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+         indexPool.ranges = std::make_unique<LveTlsf>(INDEX_BUFFER_SIZE);
+      }
+      //aligned to the index size, so the first index is a whole number of indices into the buffer bound at offset 0
+      const VkDeviceSize indexSize = indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+      return allocate(indexPool, indexSize * count, indexSize, firstIndex, "index");
+   }
+
+   void LveGeometryArena::freeVertices(LveModel::VertexFormat vertexFormat, uint32_t handle) {
+      vertexPools[index(vertexFormat)].ranges->free(handle);
+   }
+
+   void LveGeometryArena::freeIndices(uint32_t handle) {
+      indexPool.ranges->free(handle);
+   }
+
+   VkDeviceSize LveGeometryArena::getCapacityBytes() const {
+      VkDeviceSize bytes = 0;
+      for (const auto &pool : vertexPools) {
+         if (pool.ranges) bytes += pool.ranges->size() * pool.unitBytes;
+      }
+      if (indexPool.ranges) bytes += indexPool.ranges->size();
+      return bytes;
+   }
+
+   VkDeviceSize LveGeometryArena::getUsedBytes() const {
+      VkDeviceSize bytes = 0;
+      for (const auto &pool : vertexPools) {
+         if (pool.ranges) bytes += (pool.ranges->size() - pool.ranges->freeBytes()) * pool.unitBytes;
+      }
+      if (indexPool.ranges) bytes += indexPool.ranges->size() - indexPool.ranges->freeBytes();
+      return bytes;
+   }
+
+   void LveGeometryArena::createPool(Pool &pool, VkDeviceSize size, VkBufferUsageFlags usage) {
+      lveDevice.createBuffer(
+         size,
+         usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+         pool.buffer,
+         pool.memory);
+   }
+
+   uint32_t LveGeometryArena::allocate(Pool &pool, VkDeviceSize size, VkDeviceSize alignment, uint32_t &first, const char *name) {
+      VkDeviceSize offset = 0;
+      const uint32_t handle = pool.ranges->allocate(size, alignment, offset);
+      if (handle == LveTlsf::INVALID) {
+         if (!pool.reportedFull) {
+            std::cout << "Geometry arena " << name << " buffer is full, models get buffers of their own\n";
+            pool.reportedFull = true;
+         }
+         return handle;
+      }
+      first = static_cast<uint32_t>(offset / alignment);
+      return handle;
+   }
+
+   void LveGeometryArena::destroyPool(Pool &pool) {
+      if (pool.buffer == VK_NULL_HANDLE) return;
+      lveDevice.destroyBuffer(pool.buffer, pool.memory);
+      pool.buffer = VK_NULL_HANDLE;
+      pool.ranges.reset();
+   }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "vulkan_model.hpp"
+
+#include <array>
+
+namespace lve {
+
+   //every model's vertices and indices in a few shared device local buffers instead of two buffers per model: one index buffer,
+   //and one vertex buffer per vertex format, since formats differ in stride and streams while a draw's vertexOffset counts
+   //vertices. A model gets a range of each (its first vertex and first index), so consecutive models of one format draw with the
+   //same bindings, and any of their draws can be written as a VkDrawIndexedIndirectCommand into the same buffers. Ranges come
+   //from an LveTlsf per buffer. Owned by LveDevice, used from the main thread like the rest of model creation
+   class LveGeometryArena {
+      public:
+      //of each vertex format's buffer, created when the first model of the format arrives
+      static constexpr VkDeviceSize VERTEX_BUFFER_SIZE = 32 * 1024 * 1024;
+      //16 and 32 bit indices both live in it
+      static constexpr VkDeviceSize INDEX_BUFFER_SIZE = 32 * 1024 * 1024;
+
+      explicit LveGeometryArena(LveDevice &device);
+      ~LveGeometryArena();
+
+      LveGeometryArena(const LveGeometryArena &) = delete;
+      LveGeometryArena &operator=(const LveGeometryArena &) = delete;
+
+      //handle of count vertices starting at firstVertex. LveTlsf::INVALID when the buffer has no room left, the model has to fall
+      //back to buffers of its own then
+      uint32_t allocateVertices(LveModel::VertexFormat vertexFormat, uint32_t count, uint32_t &firstVertex);
+      //same for indices, firstIndex counted in indexType's size
+      uint32_t allocateIndices(VkIndexType indexType, uint32_t count, uint32_t &firstIndex);
+      void freeVertices(LveModel::VertexFormat vertexFormat, uint32_t handle);
+      void freeIndices(uint32_t handle);
+
+      //the format's vertex buffer and where each of its streams starts, bound once for every model of the format
+      VkBuffer getVertexBuffer(LveModel::VertexFormat vertexFormat) const { return vertexPools[index(vertexFormat)].buffer; }
+      const VkDeviceSize *getStreamOffsets(LveModel::VertexFormat vertexFormat) const { return vertexPools[index(vertexFormat)].streamOffsets; }
+      VkBuffer getIndexBuffer() const { return indexPool.buffer; }
+
+      //bytes of the created buffers, and how much of them models take
+      VkDeviceSize getCapacityBytes() const;
+      VkDeviceSize getUsedBytes() const;
+
+      private:
+      struct Pool {
+         VkBuffer buffer = VK_NULL_HANDLE;
+         LveAllocation memory{};
+         std::unique_ptr<LveTlsf> ranges;
+         //bytes per unit the ranges count in: a vertex of every stream, or a byte of indices
+         VkDeviceSize unitBytes = 1;
+         VkDeviceSize streamOffsets[LveModel::MAX_VERTEX_STREAMS]{};
+         //so a full buffer is only reported once
+         bool reportedFull = false;
+      };
+
+      static size_t index(LveModel::VertexFormat vertexFormat) { return static_cast<size_t>(vertexFormat); }
+      void createPool(Pool &pool, VkDeviceSize size, VkBufferUsageFlags usage);
+      //size units aligned to alignment units, first is counted in units of alignment
+      uint32_t allocate(Pool &pool, VkDeviceSize size, VkDeviceSize alignment, uint32_t &first, const char *name);
+      void destroyPool(Pool &pool);
+
+      LveDevice &lveDevice;
+      std::array<Pool, LveModel::VERTEX_FORMAT_COUNT> vertexPools{};
+      Pool indexPool{};
+   };
+}
@@ -0,0 +1,443 @@
+#include "vulkan_gltf_loader.hpp"
+#include "vulkan_archive.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+
+   namespace {
+      constexpr uint32_t GLB_MAGIC = 0x46546C67;
+      constexpr uint32_t GLB_VERSION = 2;
+      constexpr uint32_t CHUNK_JSON = 0x4E4F534A;
+      constexpr uint32_t CHUNK_BIN = 0x004E4942;
+
+      constexpr uint32_t COMPONENT_BYTE = 5120;
+      constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+      constexpr uint32_t COMPONENT_SHORT = 5122;
+      constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+      constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125;
+      constexpr uint32_t COMPONENT_FLOAT = 5126;
+
+      constexpr uint32_t MODE_TRIANGLES = 4;
+
+      uint32_t readU32(const unsigned char *data) {
+         //glb is little endian, like every platform this builds for
+         uint32_t value;
+         std::memcpy(&value, data, sizeof(value));
+         return value;
+      }
+
+      //non negative integer property, glTF stores indices, counts and offsets as json numbers
+      size_t integer(const LveJson &value) {
+         const double number = value.number();
+         if (number < 0.0 || number != std::floor(number)) throw std::runtime_error("glTF property is not a non negative integer");
+         return static_cast<size_t>(number);
+      }
+
+      size_t integerOr(const LveJson &object, const char *key, size_t fallback) {
+         const LveJson *value = object.find(key);
+         return value == nullptr ? fallback : integer(*value);
+      }
+
+      uint32_t componentSize(uint32_t componentType) {
+         switch (componentType) {
+            case COMPONENT_BYTE:
+            case COMPONENT_UNSIGNED_BYTE: return 1;
+            case COMPONENT_SHORT:
+            case COMPONENT_UNSIGNED_SHORT: return 2;
+            case COMPONENT_UNSIGNED_INT:
+            case COMPONENT_FLOAT: return 4;
+            default: throw std::runtime_error("unknown glTF component type " + std::to_string(componentType));
+         }
+      }
+
+      uint32_t componentCount(const std::string &type) {
+         if (type == "SCALAR") return 1;
+         if (type == "VEC2") return 2;
+         if (type == "VEC3") return 3;
+         if (type == "VEC4") return 4;
+         throw std::runtime_error("unsupported glTF accessor type " + type);
+      }
+
+      //count elements of `components` values each, from src (srcStride bytes apart) into dst (dstStride bytes apart).
+      //one loop per component type so the conversion inside is branch free
+      template <typename T>
+      void convertElements(const unsigned char *src, size_t srcStride, uint32_t count, uint32_t components, float scale, unsigned char *dst, size_t dstStride) {
+         for (uint32_t i = 0; i < count; i++) {
+            T values[4];
+            std::memcpy(values, src + i * srcStride, sizeof(T) * components);
+            float *out = reinterpret_cast<float *>(dst + i * dstStride);
+            for (uint32_t c = 0; c < components; c++) {
+               //signed normalized values have one more negative than positive step, -128 and -127 both map to -1
+               out[c] = std::max(static_cast<float>(values[c]) * scale, -1.f);
+            }
+         }
+      }
+
+      template <typename T>
+      void widenIndices(const unsigned char *src, size_t srcStride, uint32_t count, uint32_t baseVertex, uint32_t *dst) {
+         for (uint32_t i = 0; i < count; i++) {
+            T value;
+            std::memcpy(&value, src + i * srcStride, sizeof(T));
+            dst[i] = baseVertex + static_cast<uint32_t>(value);
+         }
+      }
+
+      glm::mat4 nodeMatrix(const LveJson &node) {
+         if (const LveJson *matrix = node.find("matrix")) {
+            if (matrix->size() != 16) throw std::runtime_error("glTF node matrix needs 16 values");
+            glm::mat4 result{1.f};
+            //column major, same as glm
+            for (int i = 0; i < 16; i++) result[i / 4][i % 4] = static_cast<float>(matrix->at(i).number());
+            return result;
+         }
+
+         glm::vec3 translation{0.f};
+         glm::vec4 rotation{0.f, 0.f, 0.f, 1.f};
+         glm::vec3 scale{1.f};
+         if (const LveJson *t = node.find("translation")) {
+            for (int i = 0; i < 3; i++) translation[i] = static_cast<float>(t->at(i).number());
+         }
+         if (const LveJson *r = node.find("rotation")) {
+            for (int i = 0; i < 4; i++) rotation[i] = static_cast<float>(r->at(i).number());
+         }
+         if (const LveJson *s = node.find("scale")) {
+            for (int i = 0; i < 3; i++) scale[i] = static_cast<float>(s->at(i).number());
+         }
+
+         //T * R * S, with R from the unit quaternion (x, y, z, w)
+         const float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+         glm::mat4 result{1.f};
+         result[0] = glm::vec4{1.f - 2.f * (y * y + z * z), 2.f * (x * y + w * z), 2.f * (x * z - w * y), 0.f} * scale.x;
+         result[1] = glm::vec4{2.f * (x * y - w * z), 1.f - 2.f * (x * x + z * z), 2.f * (y * z + w * x), 0.f} * scale.y;
+         result[2] = glm::vec4{2.f * (x * z + w * y), 2.f * (y * z - w * x), 1.f - 2.f * (x * x + y * y), 0.f} * scale.z;
+         result[3] = glm::vec4{translation, 1.f};
+         return result;
+      }
+   }
+
+   LveGltfFile::LveGltfFile(const std::string &filepath) : filepath{filepath} {
+      LveArchive *archive = LveArchive::mounted();
+      if (archive != nullptr && archive->find(filepath) != nullptr) {
+         packed = archive->read(filepath);
+      } else {
+         file = std::make_unique<LveMappedFile>(filepath);
+      }
+      const unsigned char *data = file ? file->data() : reinterpret_cast<const unsigned char *>(packed.data());
+      const size_t size = file ? file->size() : packed.size();
+      if (size < 20 || readU32(data) != GLB_MAGIC) throw std::runtime_error(filepath + " is not a binary glTF file");
+      if (readU32(data + 4) != GLB_VERSION) throw std::runtime_error(filepath + ": only glTF 2.0 is supported");
+      const size_t length = std::min<size_t>(readU32(data + 8), size);
+
+      //JSON chunk first, then an optional BIN chunk. Unknown chunks are skipped as the spec asks
+      size_t offset = 12;
+      bool hasJson = false;
+      while (offset + 8 <= length) {
+         const size_t chunkLength = readU32(data + offset);
+         const uint32_t chunkType = readU32(data + offset + 4);
+         const unsigned char *chunk = data + offset + 8;
+         if (chunkLength > length - offset - 8) throw std::runtime_error(filepath + ": glb chunk runs past the end of the file");
+
+         if (!hasJson) {
+            if (chunkType != CHUNK_JSON) throw std::runtime_error(filepath + ": first glb chunk must be JSON");
+            json = LveJson::parse(reinterpret_cast<const char *>(chunk), reinterpret_cast<const char *>(chunk + chunkLength));
+            hasJson = true;
+         } else if (chunkType == CHUNK_BIN && bin == nullptr) {
+            bin = chunk;
+            binSize = chunkLength;
+         }
+         //chunks are 4 byte aligned
+         offset += 8 + ((chunkLength + 3) & ~size_t{3});
+      }
+      if (!hasJson) throw std::runtime_error(filepath + ": glb has no JSON chunk");
+
+      if (const LveJson *meshes = json.find("meshes")) meshCount_ = static_cast<uint32_t>(meshes->size());
+
+      const LveJson *nodes = json.find("nodes");
+      const LveJson *scenes = json.find("scenes");
+      if (scenes != nullptr && scenes->size() > 0) {
+         const LveJson &scene = scenes->at(integerOr(json, "scene", 0));
+         if (const LveJson *roots = scene.find("nodes")) {
+            for (const auto &root : roots->items()) collectInstances(static_cast<uint32_t>(integer(root)), glm::mat4{1.f}, 0);
+         }
+      } else if (nodes != nullptr) {
+         //no scene: every node that isn't somebody's child is a root
+         std::vector<char> isChild(nodes->size(), 0);
+         for (const auto &node : nodes->items()) {
+            if (const LveJson *children = node.find("children")) {
+               for (const auto &child : children->items()) isChild.at(integer(child)) = 1;
+            }
+         }
+         for (uint32_t n = 0; n < nodes->size(); n++) {
+            if (!isChild[n]) collectInstances(n, glm::mat4{1.f}, 0);
+         }
+      } else {
+         //meshes without any nodes are shown as they are
+         for (uint32_t m = 0; m < meshCount_; m++) instances_.push_back({m, glm::mat4{1.f}});
+      }
+   }
+
+   void LveGltfFile::collectInstances(uint32_t index, const glm::mat4 &parent, int depth) {
+      const LveJson &nodes = json.at("nodes");
+      //a tree can't be deeper than it has nodes, deeper means a cycle
+      if (depth > static_cast<int>(nodes.size())) throw std::runtime_error(filepath + ": glTF node hierarchy has a cycle");
+
+      const LveJson &node = nodes.at(index);
+      const glm::mat4 world = parent * nodeMatrix(node);
+      if (const LveJson *mesh = node.find("mesh")) {
+         const size_t meshIndex = integer(*mesh);
+         if (meshIndex >= meshCount_) throw std::runtime_error(filepath + ": glTF node references a missing mesh");
+         instances_.push_back({static_cast<uint32_t>(meshIndex), world});
+      }
+      if (const LveJson *children = node.find("children")) {
+         for (const auto &child : children->items()) collectInstances(static_cast<uint32_t>(integer(child)), world, depth + 1);
+      }
+   }
+
+   LveGltfFile::Accessor LveGltfFile::accessor(uint32_t index) const {
+      const LveJson &object = json.at("accessors").at(index);
+      if (object.find("sparse") != nullptr) throw std::runtime_error(filepath + ": sparse glTF accessors are not supported");
+      const LveJson *viewIndex = object.find("bufferView");
+      if (viewIndex == nullptr) throw std::runtime_error(filepath + ": glTF accessors without a buffer view are not supported");
+
+      const LveJson &view = json.at("bufferViews").at(integer(*viewIndex));
+      //buffer 0 without a uri is the BIN chunk, the only buffer a self contained .glb has
+      const size_t buffer = integer(view.at("buffer"));
+      if (buffer != 0 || json.at("buffers").at(0).find("uri") != nullptr || bin == nullptr) {
+         throw std::runtime_error(filepath + ": only buffers embedded in the .glb are supported");
+      }
+
+      Accessor result{};
+      result.componentType = static_cast<uint32_t>(integer(object.at("componentType")));
+      result.components = componentCount(object.at("type").string());
+      result.count = static_cast<uint32_t>(integer(object.at("count")));
+      result.normalized = object.find("normalized") != nullptr && object.at("normalized").boolean();
+
+      const size_t elementSize = componentSize(result.componentType) * result.components;
+      result.stride = integerOr(view, "byteStride", 0);
+      if (result.stride == 0) result.stride = elementSize;
+
+      const size_t viewOffset = integerOr(view, "byteOffset", 0);
+      const size_t viewLength = integer(view.at("byteLength"));
+      const size_t accessorOffset = integerOr(object, "byteOffset", 0);
+      if (viewOffset > binSize || viewLength > binSize - viewOffset) throw std::runtime_error(filepath + ": glTF buffer view runs past the BIN chunk");
+      if (result.count > 0 && (accessorOffset > viewLength || (result.count - 1) * result.stride + elementSize > viewLength - accessorOffset)) {
+         throw std::runtime_error(filepath + ": glTF accessor runs past its buffer view");
+      }
+
+      result.data = bin + viewOffset + accessorOffset;
+      return result;
+   }
+
+   const LveJson &LveGltfFile::primitives(uint32_t mesh) const {
+      const LveJson &list = json.at("meshes").at(mesh).at("primitives");
+      for (const auto &primitive : list.items()) {
+         if (integerOr(primitive, "mode", MODE_TRIANGLES) != MODE_TRIANGLES) {
+            throw std::runtime_error(filepath + ": only triangle list glTF primitives are supported");
+         }
+      }
+      return list;
+   }
+
+   int LveGltfFile::attribute(const LveJson &primitive, const char *name) const {
+      const LveJson *index = primitive.at("attributes").find(name);
+      return index == nullptr ? -1 : static_cast<int>(integer(*index));
+   }
+
+   bool LveGltfFile::mapMesh(uint32_t mesh, MappedMesh &mapped) const {
+      const LveJson &list = primitives(mesh);
+      if (list.size() != 1) return false;
+      const LveJson &primitive = list.at(0);
+
+      const int position = attribute(primitive, "POSITION");
+      const int color = attribute(primitive, "COLOR_0");
+      const int normal = attribute(primitive, "NORMAL");
+      const int uv = attribute(primitive, "TEXCOORD_0");
+      if (position < 0 || color < 0 || normal < 0 || uv < 0) return false;
+
+      //every attribute float, one buffer view interleaved exactly like Vertex
+      const Accessor p = accessor(position);
+      const Accessor attributes[3] = {accessor(color), accessor(normal), accessor(uv)};
+      const size_t offsets[3] = {offsetof(LveModel::Vertex, color), offsetof(LveModel::Vertex, normal), offsetof(LveModel::Vertex, uv)};
+      const uint32_t components[3] = {3, 3, 2};
+
+      if (p.componentType != COMPONENT_FLOAT || p.components != 3 || p.stride != sizeof(LveModel::Vertex)) return false;
+      if (reinterpret_cast<uintptr_t>(p.data) % alignof(LveModel::Vertex) != 0) return false;
+      for (int a = 0; a < 3; a++) {
+         if (attributes[a].componentType != COMPONENT_FLOAT || attributes[a].components != components[a]) return false;
+         if (attributes[a].stride != p.stride || attributes[a].count != p.count || attributes[a].data != p.data + offsets[a]) return false;
+      }
+      mapped.vertices = reinterpret_cast<const LveModel::Vertex *>(p.data);
+      mapped.vertexCount = p.count;
+
+      //uint32 indices are used in place as well, narrower ones are widened
+      mapped.indices = nullptr;
+      mapped.indexCount = 0;
+      if (const LveJson *indexAccessor = primitive.find("indices")) {
+         const Accessor source = accessor(static_cast<uint32_t>(integer(*indexAccessor)));
+         mapped.indexCount = source.count;
+         if (source.componentType == COMPONENT_UNSIGNED_INT && source.stride == sizeof(uint32_t) && reinterpret_cast<uintptr_t>(source.data) % alignof(uint32_t) == 0) {
+            mapped.indices = reinterpret_cast<const uint32_t *>(source.data);
+         } else {
+            mapped.widened.resize(source.count);
+            switch (source.componentType) {
+               case COMPONENT_UNSIGNED_BYTE: widenIndices<uint8_t>(source.data, source.stride, source.count, 0, mapped.widened.data()); break;
+               case COMPONENT_UNSIGNED_SHORT: widenIndices<uint16_t>(source.data, source.stride, source.count, 0, mapped.widened.data()); break;
+               case COMPONENT_UNSIGNED_INT: widenIndices<uint32_t>(source.data, source.stride, source.count, 0, mapped.widened.data()); break;
+               default: throw std::runtime_error(filepath + ": unsupported glTF index component type");
+            }
+            mapped.indices = mapped.widened.data();
+         }
+         for (uint32_t i = 0; i < mapped.indexCount; i++) {
+            if (mapped.indices[i] >= mapped.vertexCount) throw std::runtime_error(filepath + ": glTF index out of range");
+         }
+      }
+      return true;
+   }
+
+   std::unique_ptr<LveModel> LveGltfFile::createModel(LveDevice &device, uint32_t mesh, LveModel::VertexFormat vertexFormat) const {
+      MappedMesh mapped{};
+      if (mapMesh(mesh, mapped)) {
+         std::cout << "Vertex count: " << mapped.vertexCount << " (glb, mapped)\n";
+         return std::make_unique<LveModel>(device, mapped.vertices, mapped.vertexCount, mapped.indices, mapped.indexCount, nullptr, 0, nullptr, 0, vertexFormat);
+      }
+
+      LveModel::Builder builder{};
+      appendMesh(mesh, glm::mat4{1.f}, builder);
+      std::cout << "Vertex count: " << builder.vertices.size() << " (glb, converted)\n";
+      return std::make_unique<LveModel>(device, builder, vertexFormat);
+   }
+
+   void LveGltfFile::appendMesh(uint32_t mesh, const glm::mat4 &transform, LveModel::Builder &builder) const {
+      //normals go through the cofactor matrix, the inverse transpose scaled by the determinant. The sign is put back below
+      const glm::vec3 column0{transform[0]}, column1{transform[1]}, column2{transform[2]};
+      const glm::mat3 cofactor{glm::cross(column1, column2), glm::cross(column2, column0), glm::cross(column0, column1)};
+      const float determinant = glm::dot(column0, glm::cross(column1, column2));
+      const bool transformed = transform != glm::mat4{1.f};
+
+      for (const auto &primitive : primitives(mesh).items()) {
+         const int position = attribute(primitive, "POSITION");
+         if (position < 0) throw std::runtime_error(filepath + ": glTF primitive has no POSITION");
+         const Accessor positions = accessor(position);
+
+         const uint32_t baseVertex = static_cast<uint32_t>(builder.vertices.size());
+         const uint32_t vertexCount = positions.count;
+         //white, like OBJ files without vertex colors
+         LveModel::Vertex blank{};
+         blank.color = glm::vec3{1.f};
+         builder.vertices.resize(baseVertex + vertexCount, blank);
+         unsigned char *base = reinterpret_cast<unsigned char *>(builder.vertices.data() + baseVertex);
+
+         //one strided pass per attribute straight into the interleaved vertices
+         auto convert = [&](int index, size_t offset, uint32_t maxComponents) {
+            if (index < 0) return;
+            const Accessor source = accessor(index);
+            if (source.count != vertexCount) throw std::runtime_error(filepath + ": glTF attribute counts don't match");
+            const uint32_t components = std::min(source.components, maxComponents);
+            unsigned char *dst = base + offset;
+            const size_t dstStride = sizeof(LveModel::Vertex);
+            switch (source.componentType) {
+               case COMPONENT_FLOAT:
+                  for (uint32_t i = 0; i < vertexCount; i++) std::memcpy(dst + i * dstStride, source.data + i * source.stride, sizeof(float) * components);
+                  break;
+               case COMPONENT_BYTE: convertElements<int8_t>(source.data, source.stride, vertexCount, components, source.normalized ? 1.f / 127.f : 1.f, dst, dstStride); break;
+               case COMPONENT_UNSIGNED_BYTE: convertElements<uint8_t>(source.data, source.stride, vertexCount, components, source.normalized ? 1.f / 255.f : 1.f, dst, dstStride); break;
+               case COMPONENT_SHORT: convertElements<int16_t>(source.data, source.stride, vertexCount, components, source.normalized ? 1.f / 32767.f : 1.f, dst, dstStride); break;
+               case COMPONENT_UNSIGNED_SHORT: convertElements<uint16_t>(source.data, source.stride, vertexCount, components, source.normalized ? 1.f / 65535.f : 1.f, dst, dstStride); break;
+               default: throw std::runtime_error(filepath + ": unsupported glTF vertex component type");
+            }
+         };
+         convert(position, offsetof(LveModel::Vertex, position), 3);
+         //COLOR_0 may be VEC4, alpha is dropped
+         convert(attribute(primitive, "COLOR_0"), offsetof(LveModel::Vertex, color), 3);
+         convert(attribute(primitive, "NORMAL"), offsetof(LveModel::Vertex, normal), 3);
+         convert(attribute(primitive, "TEXCOORD_0"), offsetof(LveModel::Vertex, uv), 2);
+
+         const uint32_t firstIndex = static_cast<uint32_t>(builder.indices.size());
+         if (const LveJson *indexAccessor = primitive.find("indices")) {
+            const Accessor source = accessor(static_cast<uint32_t>(integer(*indexAccessor)));
+            builder.indices.resize(firstIndex + source.count);
+            uint32_t *dst = builder.indices.data() + firstIndex;
+            switch (source.componentType) {
+               case COMPONENT_UNSIGNED_BYTE: widenIndices<uint8_t>(source.data, source.stride, source.count, baseVertex, dst); break;
+               case COMPONENT_UNSIGNED_SHORT: widenIndices<uint16_t>(source.data, source.stride, source.count, baseVertex, dst); break;
+               case COMPONENT_UNSIGNED_INT: widenIndices<uint32_t>(source.data, source.stride, source.count, baseVertex, dst); break;
+               default: throw std::runtime_error(filepath + ": unsupported glTF index component type");
+            }
+            for (uint32_t i = 0; i < source.count; i++) {
+               if (dst[i] - baseVertex >= vertexCount) throw std::runtime_error(filepath + ": glTF index out of range");
+            }
+         } else {
+            //non indexed primitives still need indices once they share a buffer with other primitives
+            builder.indices.resize(firstIndex + vertexCount);
+            for (uint32_t i = 0; i < vertexCount; i++) builder.indices[firstIndex + i] = baseVertex + i;
+         }
+
+         if (!transformed) continue;
+         for (uint32_t v = baseVertex; v < baseVertex + vertexCount; v++) {
+            auto &vertex = builder.vertices[v];
+            vertex.position = glm::vec3{transform * glm::vec4{vertex.position, 1.f}};
+            const glm::vec3 normal = cofactor * vertex.normal;
+            const float length = glm::length(normal);
+            if (length > 0.f) vertex.normal = normal * (determinant < 0.f ? -1.f / length : 1.f / length);
+         }
+         //a mirroring transform turns the triangles inside out, swap two corners to keep the winding
+         if (determinant < 0.f) {
+            for (size_t i = firstIndex; i + 2 < builder.indices.size(); i += 3) std::swap(builder.indices[i + 1], builder.indices[i + 2]);
+         }
+      }
+   }
+
+   std::vector<LveGameObject> LveGltfLoader::loadGameObjects(LveDevice &device, const std::string &filepath, LveModel::VertexFormat vertexFormat) {
+      LveGltfFile file{filepath};
+
+      std::vector<std::shared_ptr<LveModel>> models(file.meshCount());
+      std::vector<LveGameObject> gameObjects{};
+      gameObjects.reserve(file.instances().size());
+      for (const auto &instance : file.instances()) {
+         //uploaded on first use, so meshes no node references are skipped
+         if (!models[instance.mesh]) models[instance.mesh] = file.createModel(device, instance.mesh, vertexFormat);
+
+         auto gameObject = LveGameObject::createGameObject();
+         gameObject.model = models[instance.mesh];
+         gameObject.transform = decompose(instance.world);
+         gameObjects.push_back(std::move(gameObject));
+      }
+      std::cout << filepath << ": " << gameObjects.size() << " objects\n";
+      return gameObjects;
+   }
+
+   TransformComponent LveGltfLoader::decompose(const glm::mat4 &matrix) {
+      TransformComponent transform{};
+      transform.translation = glm::vec3{matrix[3]};
+
+      glm::vec3 columns[3] = {glm::vec3{matrix[0]}, glm::vec3{matrix[1]}, glm::vec3{matrix[2]}};
+      for (int i = 0; i < 3; i++) {
+         transform.scale[i] = glm::length(columns[i]);
+         if (transform.scale[i] > 0.f) columns[i] /= transform.scale[i];
+      }
+      //a mirror can't be a rotation, fold it into the x scale
+      if (glm::dot(columns[0], glm::cross(columns[1], columns[2])) < 0.f) {
+         transform.scale.x = -transform.scale.x;
+         columns[0] = -columns[0];
+      }
+
+      //TransformComponent::mat4() builds the rotation's third column as (c2 s1, -s2, c1 c2) and the second row as (c2 s3, c2 c3, -s2)
+      const float s2 = std::clamp(-columns[2].y, -1.f, 1.f);
+      transform.rotation.x = std::asin(s2);
+      if (std::sqrt(1.f - s2 * s2) > 1e-6f) {
+         transform.rotation.y = std::atan2(columns[2].x, columns[2].z);
+         transform.rotation.z = std::atan2(columns[0].y, columns[1].y);
+      } else {
+         //gimbal lock: only y + z or y - z is defined, put all of it into y. The first column is then (c1, 0, -s1)
+         transform.rotation.y = std::atan2(-columns[0].z, columns[0].x);
+         transform.rotation.z = 0.f;
+      }
+      return transform;
+   }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "game_object.hpp"
+#include "vulkan_json.hpp"
+#include "vulkan_mapped_file.hpp"
+#include "vulkan_model.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+   //binary glTF 2.0 (.glb) with the buffer embedded in the file. The file stays mapped while this object lives, so accessors
+   //whose layout already matches LveModel::Vertex / uint32 indices are handed to LveModel as pointers into the mapping and go
+   //straight into the staging buffers. Everything else is converted in one strided pass per attribute.
+   //supports triangle list primitives with POSITION, NORMAL, COLOR_0 and TEXCOORD_0 in float or normalized integer formats.
+   //no external buffers, sparse accessors, morph targets or skins. Texture coordinates keep glTF's top left origin
+   class LveGltfFile {
+      public:
+      //a mesh placed in the scene: world is the product of the node's and all of its parents' local transforms
+      struct Instance {
+         uint32_t mesh;
+         glm::mat4 world;
+      };
+
+      //throws std::runtime_error if the file isn't a valid .glb. Read from the mounted archive if it has the file
+      LveGltfFile(const std::string &filepath);
+
+      LveGltfFile(const LveGltfFile &) = delete;
+      LveGltfFile &operator=(const LveGltfFile &) = delete;
+
+      uint32_t meshCount() const { return meshCount_; }
+      //every node with a mesh in the default scene, parents before children
+      const std::vector<Instance> &instances() const { return instances_; }
+
+      //a mesh whose vertices are used in place. indices point into the file too if they are uint32, else into widened
+      struct MappedMesh {
+         const LveModel::Vertex *vertices = nullptr;
+         uint32_t vertexCount = 0;
+         const uint32_t *indices = nullptr;
+         uint32_t indexCount = 0;
+         std::vector<uint32_t> widened{};
+      };
+
+      //fills mapped and returns true if the mesh is one primitive whose vertex buffer view is interleaved exactly like LveModel::Vertex
+      bool mapMesh(uint32_t mesh, MappedMesh &mapped) const;
+      //the mapped file, what mapMesh points into, null if the file was read out of the archive
+      std::shared_ptr<const LveMappedFile> mappedFile() const { return file; }
+      //one model holding every primitive of the mesh, in the mesh's own space
+      std::unique_ptr<LveModel> createModel(LveDevice &device, uint32_t mesh, LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float32) const;
+      //converts every primitive of the mesh and appends it to the builder, with positions and normals transformed by transform
+      void appendMesh(uint32_t mesh, const glm::mat4 &transform, LveModel::Builder &builder) const;
+
+      private:
+      //one accessor resolved against its buffer view, bounds checked
+      struct Accessor {
+         const unsigned char *data;
+         size_t stride;
+         uint32_t count;
+         uint32_t componentType;
+         uint32_t components;
+         bool normalized;
+      };
+
+      Accessor accessor(uint32_t index) const;
+      const LveJson &primitives(uint32_t mesh) const;
+      //index of the named attribute of a primitive, -1 if it has none
+      int attribute(const LveJson &primitive, const char *name) const;
+      void collectInstances(uint32_t node, const glm::mat4 &parent, int depth);
+
+      //either the mapped file or the contents read out of the archive
+      std::shared_ptr<LveMappedFile> file;
+      std::vector<char> packed{};
+      LveJson json{};
+      const unsigned char *bin = nullptr;
+      size_t binSize = 0;
+      uint32_t meshCount_ = 0;
+      std::vector<Instance> instances_{};
+      std::string filepath;
+   };
+
+   class LveGltfLoader {
+      public:
+      //one game object per mesh instance, with the node's world transform. Models are shared between instances of the same mesh.
+      //TransformComponent has no shear, so non uniform scale under a rotated parent is approximated
+      static std::vector<LveGameObject> loadGameObjects(LveDevice &device, const std::string &filepath, LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float32);
+
+      //translation, scale and the Y(1), X(2), Z(3) Tait-Bryan angles TransformComponent::mat4() would turn back into matrix
+      static TransformComponent decompose(const glm::mat4 &matrix);
+   };
+}
@@ -0,0 +1,78 @@
+#include "vulkan_host_import.hpp"
+
+#include <cstdint>
+
+namespace lve {
+
+   std::unique_ptr<LveHostImport> LveHostImport::create(LveDevice &device, std::shared_ptr<const LveMappedFile> file) {
+      const VkDeviceSize alignment = device.hostImportAlignment();
+      if (alignment == 0 || file == nullptr || file->data() == nullptr) return nullptr;
+      //mappings start on a page, the alignment is rarely bigger than one
+      if (reinterpret_cast<uintptr_t>(file->data()) % alignment != 0) return nullptr;
+      const VkDeviceSize size = file->mappedSize() / alignment * alignment;
+      if (size == 0) return nullptr;
+      const uint32_t hostTypes = device.hostPointerMemoryTypes(file->data());
+      if (hostTypes == 0) return nullptr;
+
+      VkExternalMemoryBufferCreateInfo externalInfo{};
+      externalInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+      externalInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+      VkBufferCreateInfo bufferInfo{};
+      bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+      bufferInfo.pNext = &externalInfo;
+      bufferInfo.size = size;
+      bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+      bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+      VkBuffer buffer = VK_NULL_HANDLE;
+      if (vkCreateBuffer(device.device(), &bufferInfo, nullptr, &buffer) != VK_SUCCESS) return nullptr;
+
+      //the buffer has to fit the imported range and take one of the memory types the pages can become
+      VkMemoryRequirements requirements;
+      vkGetBufferMemoryRequirements(device.device(), buffer, &requirements);
+      const uint32_t memoryTypes = requirements.memoryTypeBits & hostTypes;
+      if (memoryTypes == 0 || requirements.size > size) {
+         vkDestroyBuffer(device.device(), buffer, nullptr);
+         return nullptr;
+      }
+      uint32_t memoryType = 0;
+      while ((memoryTypes & (1u << memoryType)) == 0) memoryType++;
+
+      VkImportMemoryHostPointerInfoEXT importInfo{};
+      importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+      importInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+      //only ever read, by the copies
+      importInfo.pHostPointer = const_cast<unsigned char *>(file->data());
+      VkMemoryAllocateInfo allocInfo{};
+      allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+      allocInfo.pNext = &importInfo;
+      allocInfo.allocationSize = size;
+      allocInfo.memoryTypeIndex = memoryType;
+      VkDeviceMemory memory = VK_NULL_HANDLE;
+      if (vkAllocateMemory(device.device(), &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+         vkDestroyBuffer(device.device(), buffer, nullptr);
+         return nullptr;
+      }
+      if (vkBindBufferMemory(device.device(), buffer, memory, 0) != VK_SUCCESS) {
+         vkDestroyBuffer(device.device(), buffer, nullptr);
+         vkFreeMemory(device.device(), memory, nullptr);
+         return nullptr;
+      }
+      return std::unique_ptr<LveHostImport>(new LveHostImport(device, std::move(file), size, buffer, memory));
+   }
+
+   LveHostImport::LveHostImport(
+      LveDevice &device, std::shared_ptr<const LveMappedFile> file, VkDeviceSize size, VkBuffer buffer, VkDeviceMemory memory)
+      : lveDevice{device}, file{std::move(file)}, size_{size}, buffer_{buffer}, memory{memory} {}
+
+   LveHostImport::~LveHostImport() {
+      //the memory goes before the file is unmapped, file is released after this body
+      vkDestroyBuffer(lveDevice.device(), buffer_, nullptr);
+      vkFreeMemory(lveDevice.device(), memory, nullptr);
+   }
+
+   bool LveHostImport::contains(const void *data, VkDeviceSize size) const {
+      const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+      const uintptr_t start = reinterpret_cast<uintptr_t>(file->data());
+      return begin >= start && begin - start + size <= size_;
+   }
+}
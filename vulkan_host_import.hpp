@@ -0,0 +1,39 @@
+#pragma once
+
+#include "vulkan_device.hpp"
+#include "vulkan_mapped_file.hpp"
+
+#include <memory>
+
+namespace lve {
+
+   //a mapped file imported as host memory through VK_EXT_external_memory_host: a buffer over the file's pages that copies read
+   //from directly, so uploads of data stored exactly as the buffers hold it skip the copy into the staging ring. Keeps the file
+   //mapped while it exists, and has to exist until the copies from it completed
+   class LveHostImport {
+      public:
+      //imports the whole multiples of LveDevice::hostImportAlignment at the start of the mapping. Null if the device can't import
+      //or the driver refuses the pages (some only take writable memory), uploads go through the staging ring then
+      static std::unique_ptr<LveHostImport> create(LveDevice &device, std::shared_ptr<const LveMappedFile> file);
+      ~LveHostImport();
+
+      LveHostImport(const LveHostImport &) = delete;
+      LveHostImport &operator=(const LveHostImport &) = delete;
+
+      VkBuffer buffer() const { return buffer_; }
+      //true if [data, data + size) is in the imported range
+      bool contains(const void *data, VkDeviceSize size) const;
+      //where data is in buffer()
+      VkDeviceSize offsetOf(const void *data) const { return static_cast<VkDeviceSize>(static_cast<const unsigned char *>(data) - file->data()); }
+      VkDeviceSize size() const { return size_; }
+
+      private:
+      LveHostImport(LveDevice &device, std::shared_ptr<const LveMappedFile> file, VkDeviceSize size, VkBuffer buffer, VkDeviceMemory memory);
+
+      LveDevice &lveDevice;
+      std::shared_ptr<const LveMappedFile> file;
+      VkDeviceSize size_;
+      VkBuffer buffer_;
+      VkDeviceMemory memory;
+   };
+}
@@ -0,0 +1,260 @@
+#include "vulkan_json.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+
+   //recursive descent over the text, the cursor only ever moves forward
+   class LveJsonParser {
+      public:
+      LveJsonParser(const char *begin, const char *end) : begin{begin}, cursor{begin}, end{end} {}
+
+      LveJson document() {
+         LveJson value = parseValue(0);
+         skipWhitespace();
+         if (cursor != end) fail("trailing characters");
+         return value;
+      }
+
+      private:
+      //deeper than any glTF file goes, keeps malformed input from blowing the stack
+      static constexpr int MAX_DEPTH = 128;
+
+      [[noreturn]] void fail(const char *what) const {
+         throw std::runtime_error("invalid json at byte " + std::to_string(cursor - begin) + ": " + what);
+      }
+
+      void skipWhitespace() {
+         while (cursor != end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r')) cursor++;
+      }
+
+      void expect(const char *literal) {
+         const size_t length = std::strlen(literal);
+         if (static_cast<size_t>(end - cursor) < length || std::memcmp(cursor, literal, length) != 0) fail("unexpected token");
+         cursor += length;
+      }
+
+      LveJson parseValue(int depth) {
+         if (depth > MAX_DEPTH) fail("nested too deep");
+         skipWhitespace();
+         if (cursor == end) fail("unexpected end");
+
+         LveJson value{};
+         switch (*cursor) {
+            case '{':
+               value.type_ = LveJson::Type::Object;
+               cursor++;
+               skipWhitespace();
+               if (cursor != end && *cursor == '}') {
+                  cursor++;
+                  return value;
+               }
+               while (true) {
+                  skipWhitespace();
+                  if (cursor == end || *cursor != '"') fail("expected a key");
+                  std::string key = parseString();
+                  skipWhitespace();
+                  if (cursor == end || *cursor != ':') fail("expected ':'");
+                  cursor++;
+                  value.members_.emplace_back(std::move(key), parseValue(depth + 1));
+                  skipWhitespace();
+                  if (cursor != end && *cursor == ',') {
+                     cursor++;
+                     continue;
+                  }
+                  if (cursor == end || *cursor != '}') fail("expected ',' or '}'");
+                  cursor++;
+                  return value;
+               }
+            case '[':
+               value.type_ = LveJson::Type::Array;
+               cursor++;
+               skipWhitespace();
+               if (cursor != end && *cursor == ']') {
+                  cursor++;
+                  return value;
+               }
+               while (true) {
+                  value.items_.push_back(parseValue(depth + 1));
+                  skipWhitespace();
+                  if (cursor != end && *cursor == ',') {
+                     cursor++;
+                     continue;
+                  }
+                  if (cursor == end || *cursor != ']') fail("expected ',' or ']'");
+                  cursor++;
+                  return value;
+               }
+            case '"':
+               value.type_ = LveJson::Type::String;
+               value.string_ = parseString();
+               return value;
+            case 't':
+               expect("true");
+               value.type_ = LveJson::Type::Boolean;
+               value.boolean_ = true;
+               return value;
+            case 'f':
+               expect("false");
+               value.type_ = LveJson::Type::Boolean;
+               return value;
+            case 'n':
+               expect("null");
+               return value;
+            default:
+               value.type_ = LveJson::Type::Number;
+               value.number_ = parseNumber();
+               return value;
+         }
+      }
+
+      double parseNumber() {
+         //strtod needs a terminated string, numbers are short so copy it out
+         const char *start = cursor;
+         //strchr would also match the terminator, so rule out '\0' first
+         while (cursor != end && *cursor != '\0' && std::strchr("+-0123456789.eE", *cursor) != nullptr) cursor++;
+         if (cursor == start || cursor - start > 64) fail("expected a value");
+
+         char buffer[65];
+         std::memcpy(buffer, start, cursor - start);
+         buffer[cursor - start] = '\0';
+         char *parsed = nullptr;
+         const double number = std::strtod(buffer, &parsed);
+         if (parsed != buffer + (cursor - start)) fail("malformed number");
+         return number;
+      }
+
+      uint32_t parseHex4() {
+         if (end - cursor < 4) fail("short unicode escape");
+         uint32_t code = 0;
+         for (int i = 0; i < 4; i++) {
+            const char c = *cursor++;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else fail("bad unicode escape");
+         }
+         return code;
+      }
+
+      void appendUtf8(std::string &out, uint32_t code) {
+         if (code < 0x80) {
+            out += static_cast<char>(code);
+         } else if (code < 0x800) {
+            out += static_cast<char>(0xc0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+         } else if (code < 0x10000) {
+            out += static_cast<char>(0xe0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+         } else {
+            out += static_cast<char>(0xf0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (code & 0x3f));
+         }
+      }
+
+      std::string parseString() {
+         cursor++;
+         std::string out{};
+         while (true) {
+            if (cursor == end) fail("unterminated string");
+            const char c = *cursor++;
+            if (c == '"') return out;
+            if (c != '\\') {
+               out += c;
+               continue;
+            }
+            if (cursor == end) fail("unterminated string");
+            switch (*cursor++) {
+               case '"': out += '"'; break;
+               case '\\': out += '\\'; break;
+               case '/': out += '/'; break;
+               case 'b': out += '\b'; break;
+               case 'f': out += '\f'; break;
+               case 'n': out += '\n'; break;
+               case 'r': out += '\r'; break;
+               case 't': out += '\t'; break;
+               case 'u': {
+                  uint32_t code = parseHex4();
+                  //surrogate pair
+                  if (code >= 0xd800 && code < 0xdc00 && end - cursor >= 6 && cursor[0] == '\\' && cursor[1] == 'u') {
+                     cursor += 2;
+                     const uint32_t low = parseHex4();
+                     code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                  }
+                  appendUtf8(out, code);
+                  break;
+               }
+               default: fail("bad escape");
+            }
+         }
+      }
+
+      const char *begin;
+      const char *cursor;
+      const char *end;
+   };
+
+   LveJson LveJson::parse(const char *begin, const char *end) {
+      return LveJsonParser{begin, end}.document();
+   }
+
+   bool LveJson::boolean() const {
+      if (type_ != Type::Boolean) throw std::runtime_error("json value is not a boolean");
+      return boolean_;
+   }
+
+   double LveJson::number() const {
+      if (type_ != Type::Number) throw std::runtime_error("json value is not a number");
+      return number_;
+   }
+
+   const std::string &LveJson::string() const {
+      if (type_ != Type::String) throw std::runtime_error("json value is not a string");
+      return string_;
+   }
+
+   const std::vector<LveJson> &LveJson::items() const {
+      if (type_ != Type::Array) throw std::runtime_error("json value is not an array");
+      return items_;
+   }
+
+   const std::vector<std::pair<std::string, LveJson>> &LveJson::members() const {
+      if (type_ != Type::Object) throw std::runtime_error("json value is not an object");
+      return members_;
+   }
+
+   const LveJson *LveJson::find(const std::string &key) const {
+      //glTF objects have a handful of members, a linear scan beats building a map
+      for (const auto &member : members_) {
+         if (member.first == key) return &member.second;
+      }
+      return nullptr;
+   }
+
+   const LveJson &LveJson::at(const std::string &key) const {
+      const LveJson *value = find(key);
+      if (value == nullptr) throw std::runtime_error("json object has no member '" + key + "'");
+      return *value;
+   }
+
+   const LveJson &LveJson::at(size_t index) const {
+      const auto &elements = items();
+      if (index >= elements.size()) throw std::runtime_error("json array index " + std::to_string(index) + " out of range");
+      return elements[index];
+   }
+
+   size_t LveJson::size() const {
+      return type_ == Type::Array ? items_.size() : members_.size();
+   }
+
+   double LveJson::numberOr(const std::string &key, double fallback) const {
+      const LveJson *value = find(key);
+      return value == nullptr ? fallback : value->number();
+   }
+}
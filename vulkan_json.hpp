@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lve {
+
+   //minimal JSON document, enough for glTF: parsed in one go into a tree of values
+   class LveJson {
+      public:
+      enum class Type { Null, Boolean, Number, String, Array, Object };
+
+      //throws std::runtime_error with the byte offset of the problem if the text isn't valid JSON
+      static LveJson parse(const char *begin, const char *end);
+
+      Type type() const { return type_; }
+      bool isNull() const { return type_ == Type::Null; }
+      bool isNumber() const { return type_ == Type::Number; }
+      bool isString() const { return type_ == Type::String; }
+      bool isArray() const { return type_ == Type::Array; }
+      bool isObject() const { return type_ == Type::Object; }
+
+      //these throw if the value has a different type
+      bool boolean() const;
+      double number() const;
+      const std::string &string() const;
+      //elements of an array
+      const std::vector<LveJson> &items() const;
+      //members of an object, in file order
+      const std::vector<std::pair<std::string, LveJson>> &members() const;
+
+      //member of an object, nullptr if missing (or if this isn't an object)
+      const LveJson *find(const std::string &key) const;
+      //member that has to be there, throws naming the key if it isn't
+      const LveJson &at(const std::string &key) const;
+      const LveJson &at(size_t index) const;
+      size_t size() const;
+
+      //number member or fallback if missing, the common case for optional glTF properties
+      double numberOr(const std::string &key, double fallback) const;
+
+      private:
+      Type type_ = Type::Null;
+      bool boolean_ = false;
+      double number_ = 0.0;
+      std::string string_{};
+      std::vector<LveJson> items_{};
+      std::vector<std::pair<std::string, LveJson>> members_{};
+
+      friend class LveJsonParser;
+   };
+}
@@ -0,0 +1,197 @@
+#include "vulkan_lz4.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace lve {
+
+   namespace {
+      constexpr size_t MIN_MATCH = 4;
+      //the last 5 bytes are always literals and the last match has to start at least 12 bytes before the end
+      constexpr size_t LAST_LITERALS = 5;
+      constexpr size_t MF_LIMIT = 12;
+      constexpr size_t MAX_DISTANCE = 65535;
+      constexpr int HASH_LOG = 16;
+      //every 2^SKIP_TRIGGER bytes without a match the search steps one byte further, so incompressible data is skipped quickly
+      constexpr int SKIP_TRIGGER = 6;
+
+      uint32_t read32(const unsigned char *p) {
+         uint32_t value;
+         std::memcpy(&value, p, sizeof(value));
+         return value;
+      }
+
+      uint32_t hash(uint32_t sequence) {
+         return (sequence * 2654435761u) >> (32 - HASH_LOG);
+      }
+
+      //15 in the token, then 255 per byte until the remainder fits
+      unsigned char *writeLength(unsigned char *out, size_t length) {
+         while (length >= 255) {
+            *out++ = 255;
+            length -= 255;
+         }
+         *out++ = static_cast<unsigned char>(length);
+         return out;
+      }
+
+      unsigned char *writeSequence(unsigned char *out, const unsigned char *literals, size_t literalLength, size_t offset, size_t matchLength) {
+         unsigned char *token = out++;
+         *token = static_cast<unsigned char>((literalLength >= 15 ? 15 : literalLength) << 4);
+         if (literalLength >= 15) out = writeLength(out, literalLength - 15);
+         if (literalLength > 0) std::memcpy(out, literals, literalLength);
+         out += literalLength;
+
+         //the final sequence is literals only
+         if (matchLength == 0) return out;
+
+         *out++ = static_cast<unsigned char>(offset & 0xff);
+         *out++ = static_cast<unsigned char>(offset >> 8);
+         const size_t code = matchLength - MIN_MATCH;
+         *token |= static_cast<unsigned char>(code >= 15 ? 15 : code);
+         if (code >= 15) out = writeLength(out, code - 15);
+         return out;
+      }
+   }
+
+   size_t LveLz4::compressBound(size_t size) {
+      return size + size / 255 + 16;
+   }
+
+   size_t LveLz4::compress(const void *srcData, size_t size, void *dstData, size_t capacity) {
+      if (capacity < compressBound(size)) throw std::runtime_error("lz4 destination smaller than compressBound");
+
+      const auto *src = static_cast<const unsigned char *>(srcData);
+      auto *dst = static_cast<unsigned char *>(dstData);
+      unsigned char *out = dst;
+
+      size_t anchor = 0;
+      if (size >= MF_LIMIT + 1) {
+         //positions + 1, 0 means empty
+         std::vector<uint32_t> table(size_t{1} << HASH_LOG, 0);
+         const size_t matchLimit = size - LAST_LITERALS;
+         size_t position = 0;
+         size_t searched = 0;
+
+         while (position + MF_LIMIT <= size) {
+            const uint32_t sequence = read32(src + position);
+            const uint32_t h = hash(sequence);
+            const size_t candidate = table[h];
+            table[h] = static_cast<uint32_t>(position + 1);
+
+            if (candidate == 0 || position - (candidate - 1) > MAX_DISTANCE || read32(src + candidate - 1) != sequence) {
+               position += 1 + (searched++ >> SKIP_TRIGGER);
+               continue;
+            }
+            searched = 0;
+
+            size_t match = candidate - 1;
+            //catch the bytes before the hash hit that match too
+            while (position > anchor && match > 0 && src[position - 1] == src[match - 1]) {
+               position--;
+               match--;
+            }
+            size_t length = MIN_MATCH;
+            while (position + length < matchLimit && src[position + length] == src[match + length]) length++;
+
+            out = writeSequence(out, src + anchor, position - anchor, position - match, length);
+            position += length;
+            anchor = position;
+
+            //seed the table inside the match so the next search has a recent candidate
+            if (position >= 2 && position - 2 + MF_LIMIT <= size) {
+               table[hash(read32(src + position - 2))] = static_cast<uint32_t>(position - 2 + 1);
+            }
+         }
+      }
+
+      out = writeSequence(out, src + anchor, size - anchor, 0, 0);
+      return static_cast<size_t>(out - dst);
+   }
+
+   bool LveLz4::decompress(const void *srcData, size_t compressedSize, void *dstData, size_t size) {
+      const auto *in = static_cast<const unsigned char *>(srcData);
+      const unsigned char *const inEnd = in + compressedSize;
+      auto *const dst = static_cast<unsigned char *>(dstData);
+      unsigned char *out = dst;
+      unsigned char *const outEnd = dst + size;
+
+      auto readLength = [&in, inEnd](size_t &length) {
+         unsigned char byte;
+         do {
+            if (in == inEnd) return false;
+            byte = *in++;
+            length += byte;
+         } while (byte == 255);
+         return true;
+      };
+
+      while (true) {
+         if (in == inEnd) return false;
+         const unsigned char token = *in++;
+
+         //fast path for the typical short sequence (under 15 literals, match under 19 bytes) well away from both ends:
+         //fixed size copies only, the next sequence overwrites whatever they overshoot
+         if ((token >> 4) != 15 && (token & 15) != 15 && inEnd - in >= 16 + 2 && outEnd - out >= 16 + 18) {
+            const size_t literalLength = token >> 4;
+            std::memcpy(out, in, 16);
+            in += literalLength;
+            out += literalLength;
+
+            const size_t offset = in[0] | (size_t{in[1]} << 8);
+            if (offset >= 8 && offset <= static_cast<size_t>(out - dst)) {
+               in += 2;
+               const unsigned char *match = out - offset;
+               std::memcpy(out, match, 8);
+               std::memcpy(out + 8, match + 8, 8);
+               std::memcpy(out + 16, match + 16, 2);
+               out += (token & 15) + MIN_MATCH;
+               continue;
+            }
+            //close overlapping or invalid offset: let the general path below deal with the match
+            in -= literalLength;
+            out -= literalLength;
+         }
+
+         size_t literalLength = token >> 4;
+         if (literalLength == 15 && !readLength(literalLength)) return false;
+         if (literalLength > static_cast<size_t>(inEnd - in) || literalLength > static_cast<size_t>(outEnd - out)) return false;
+         //short runs are the common case: one fixed 16 byte copy when there is room to overshoot, the next sequence overwrites the excess
+         if (literalLength <= 16 && inEnd - in >= 16 && outEnd - out >= 16) {
+            std::memcpy(out, in, 16);
+         } else if (literalLength > 0) {
+            std::memcpy(out, in, literalLength);
+         }
+         in += literalLength;
+         out += literalLength;
+
+         //the block ends right after the last literals
+         if (in == inEnd) return out == outEnd;
+
+         if (inEnd - in < 2) return false;
+         const size_t offset = in[0] | (size_t{in[1]} << 8);
+         in += 2;
+         if (offset == 0 || offset > static_cast<size_t>(out - dst)) return false;
+
+         size_t matchLength = token & 15;
+         if (matchLength == 15 && !readLength(matchLength)) return false;
+         matchLength += MIN_MATCH;
+         if (matchLength > static_cast<size_t>(outEnd - out)) return false;
+
+         const unsigned char *match = out - offset;
+         if (offset >= 8 && static_cast<size_t>(outEnd - out) >= matchLength + 8) {
+            //8 byte steps never read bytes this copy hasn't written yet once the offset is at least 8
+            for (size_t i = 0; i < matchLength; i += 8) std::memcpy(out + i, match + i, 8);
+            out += matchLength;
+         } else if (offset >= matchLength) {
+            std::memcpy(out, match, matchLength);
+            out += matchLength;
+         } else {
+            //overlapping copy repeats the last offset bytes, it has to go front to back
+            for (size_t i = 0; i < matchLength; i++) *out++ = match[i];
+         }
+      }
+   }
+}
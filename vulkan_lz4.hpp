@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+namespace lve {
+
+   //LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), written from the spec so there is no
+   //extra dependency. Blocks are compatible with the reference LZ4_compress_default / LZ4_decompress_safe
+   class LveLz4 {
+      public:
+      //worst case compressed size for size bytes of input
+      static size_t compressBound(size_t size);
+
+      //greedy single hash table compressor. dst needs room for compressBound(size) bytes, returns the compressed size
+      static size_t compress(const void *src, size_t size, void *dst, size_t capacity);
+
+      //decompresses exactly size bytes into dst. Never reads or writes out of bounds, returns false if the block is
+      //malformed or doesn't decompress to exactly size bytes
+      static bool decompress(const void *src, size_t compressedSize, void *dst, size_t size);
+   };
+}
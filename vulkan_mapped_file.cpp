@@ -0,0 +1,88 @@
+#include "vulkan_mapped_file.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lve {
+
+#ifdef _WIN32
+   LveMappedFile::LveMappedFile(const std::string &filepath) {
+      HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (file == INVALID_HANDLE_VALUE) {
+         throw std::runtime_error("failed to open file: " + filepath);
+      }
+      fileHandle = file;
+
+      LARGE_INTEGER fileSize;
+      if (!GetFileSizeEx(file, &fileSize)) {
+         CloseHandle(file);
+         throw std::runtime_error("failed to get size of file: " + filepath);
+      }
+      size_ = static_cast<size_t>(fileSize.QuadPart);
+      //mapping a 0 byte file fails, leave data_ null instead
+      if (size_ == 0) return;
+
+      HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping == nullptr) {
+         CloseHandle(file);
+         throw std::runtime_error("failed to create file mapping: " + filepath);
+      }
+      mappingHandle = mapping;
+
+      data_ = static_cast<const unsigned char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+      if (data_ == nullptr) {
+         CloseHandle(mapping);
+         CloseHandle(file);
+         throw std::runtime_error("failed to map file: " + filepath);
+      }
+      SYSTEM_INFO systemInfo;
+      GetSystemInfo(&systemInfo);
+      mappedSize_ = (size_ + systemInfo.dwPageSize - 1) / systemInfo.dwPageSize * systemInfo.dwPageSize;
+   }
+
+   LveMappedFile::~LveMappedFile() {
+      if (data_ != nullptr) UnmapViewOfFile(data_);
+      if (mappingHandle != nullptr) CloseHandle(static_cast<HANDLE>(mappingHandle));
+      if (fileHandle != nullptr) CloseHandle(static_cast<HANDLE>(fileHandle));
+   }
+#else
+   LveMappedFile::LveMappedFile(const std::string &filepath) {
+      fileDescriptor = open(filepath.c_str(), O_RDONLY);
+      if (fileDescriptor < 0) {
+         throw std::runtime_error("failed to open file: " + filepath);
+      }
+
+      struct stat fileStat;
+      if (fstat(fileDescriptor, &fileStat) != 0) {
+         close(fileDescriptor);
+         throw std::runtime_error("failed to get size of file: " + filepath);
+      }
+      size_ = static_cast<size_t>(fileStat.st_size);
+      if (size_ == 0) return;
+
+      void *mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+      if (mapped == MAP_FAILED) {
+         close(fileDescriptor);
+         throw std::runtime_error("failed to map file: " + filepath);
+      }
+      data_ = static_cast<const unsigned char *>(mapped);
+      const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+      mappedSize_ = (size_ + pageSize - 1) / pageSize * pageSize;
+   }
+
+   LveMappedFile::~LveMappedFile() {
+      if (data_ != nullptr) munmap(const_cast<unsigned char *>(data_), size_);
+      if (fileDescriptor >= 0) close(fileDescriptor);
+   }
+#endif
+}
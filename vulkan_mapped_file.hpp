@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace lve {
+
+   //read only view of a whole file mapped into the address space. The OS pages data in on demand,
+   //so nothing is read until it is touched and there is no intermediate copy into a std::vector
+   class LveMappedFile {
+      public:
+      LveMappedFile(const std::string &filepath);
+      ~LveMappedFile();
+
+      LveMappedFile(const LveMappedFile &) = delete;
+      LveMappedFile &operator=(const LveMappedFile &) = delete;
+
+      const unsigned char *data() const { return data_; }
+      size_t size() const { return size_; }
+      //bytes readable from data() on: size() rounded up to whole pages, the rest of the last page reads as zeros
+      size_t mappedSize() const { return mappedSize_; }
+
+      private:
+      const unsigned char *data_ = nullptr;
+      size_t size_ = 0;
+      size_t mappedSize_ = 0;
+
+#ifdef _WIN32
+      void *fileHandle = nullptr;
+      void *mappingHandle = nullptr;
+#else
+      int fileDescriptor = -1;
+#endif
+   };
+}
@@ -0,0 +1,357 @@
+#include "vulkan_memory_allocator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace lve {
+
+   namespace {
+      VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+         return (value + alignment - 1) & ~(alignment - 1);
+      }
+
+      //index of the highest set bit, value must not be 0
+      uint32_t floorLog2(uint64_t value) {
+         uint32_t log = 0;
+         for (uint32_t shift = 32; shift > 0; shift /= 2) {
+            if (value >> shift) {
+               value >>= shift;
+               log += shift;
+            }
+         }
+         return log;
+      }
+
+      uint32_t lowestBit(uint64_t value) {
+         return floorLog2(value & (~value + 1));
+      }
+   }
+
+   LveTlsf::LveTlsf(VkDeviceSize size) : size_{size & ~(MIN_ALIGNMENT - 1)}, freeBytes_{size_} {
+      for (auto &lists : freeLists) std::fill(std::begin(lists), std::end(lists), INVALID);
+      if (size_ > 0) insertFree(newRange(0, size_));
+   }
+
+   void LveTlsf::mapping(VkDeviceSize size, uint32_t &firstLevel, uint32_t &secondLevel) {
+      if (size < (VkDeviceSize{1} << SMALL_LOG)) {
+         firstLevel = 0;
+         secondLevel = static_cast<uint32_t>(size >> (SMALL_LOG - SECOND_LEVEL_BITS));
+         return;
+      }
+      const uint32_t log = floorLog2(size);
+      firstLevel = log - SMALL_LOG + 1;
+      secondLevel = static_cast<uint32_t>(size >> (log - SECOND_LEVEL_BITS)) - SECOND_LEVEL_COUNT;
+   }
+
+   uint32_t LveTlsf::newRange(VkDeviceSize offset, VkDeviceSize size) {
+      uint32_t index;
+      if (!unusedRanges.empty()) {
+         index = unusedRanges.back();
+         unusedRanges.pop_back();
+      } else {
+         index = static_cast<uint32_t>(ranges.size());
+         ranges.emplace_back();
+      }
+      ranges[index] = {offset, size, INVALID, INVALID, INVALID, INVALID, false};
+      return index;
+   }
+
+   void LveTlsf::insertFree(uint32_t range) {
+      uint32_t firstLevel, secondLevel;
+      mapping(ranges[range].size, firstLevel, secondLevel);
+      uint32_t &head = freeLists[firstLevel][secondLevel];
+      ranges[range].free = true;
+      ranges[range].previousFree = INVALID;
+      ranges[range].nextFree = head;
+      if (head != INVALID) ranges[head].previousFree = range;
+      head = range;
+      firstLevelBitmap |= uint64_t{1} << firstLevel;
+      secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+      freeRangeCount_++;
+   }
+
+   void LveTlsf::removeFree(uint32_t range) {
+      Range &removed = ranges[range];
+      if (removed.previousFree != INVALID) ranges[removed.previousFree].nextFree = removed.nextFree;
+      if (removed.nextFree != INVALID) ranges[removed.nextFree].previousFree = removed.previousFree;
+
+      uint32_t firstLevel, secondLevel;
+      mapping(removed.size, firstLevel, secondLevel);
+      uint32_t &head = freeLists[firstLevel][secondLevel];
+      if (head == range) {
+         head = removed.nextFree;
+         //the list ran empty
+         if (head == INVALID) {
+            secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+            if (secondLevelBitmaps[firstLevel] == 0) firstLevelBitmap &= ~(uint64_t{1} << firstLevel);
+         }
+      }
+      removed.free = false;
+      freeRangeCount_--;
+   }
+
+   void LveTlsf::mergeNext(uint32_t range) {
+      const uint32_t next = ranges[range].next;
+      ranges[range].size += ranges[next].size;
+      ranges[range].next = ranges[next].next;
+      if (ranges[range].next != INVALID) ranges[ranges[range].next].previous = range;
+      unusedRanges.push_back(next);
+   }
+
+   uint32_t LveTlsf::allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset) {
+      alignment = std::max(alignment, MIN_ALIGNMENT);
+      size = alignUp(std::max(size, VkDeviceSize{1}), MIN_ALIGNMENT);
+      //offsets are multiples of MIN_ALIGNMENT, so a range this big fits size at any alignment
+      VkDeviceSize search = size + alignment - MIN_ALIGNMENT;
+      if (search > size_) return INVALID;
+
+      //ranges in the request's own size class may be too small, but the head of its list is worth a look: it is where a range
+      //freed by a resource of the same size ends up, and reusing it keeps the rest unsplit
+      uint32_t firstLevel, secondLevel;
+      mapping(search, firstLevel, secondLevel);
+      uint32_t range = freeLists[firstLevel][secondLevel];
+      if (range == INVALID || alignUp(ranges[range].offset, alignment) + size > ranges[range].offset + ranges[range].size) {
+         //rounded up to the next size class: every range in that list and above is big enough, the first one found is taken
+         if (search >= (VkDeviceSize{1} << SMALL_LOG)) search += (VkDeviceSize{1} << (floorLog2(search) - SECOND_LEVEL_BITS)) - 1;
+         mapping(search, firstLevel, secondLevel);
+         uint32_t secondMap = firstLevel < FIRST_LEVEL_COUNT ? secondLevelBitmaps[firstLevel] & (~0u << secondLevel) : 0;
+         if (secondMap == 0) {
+            const uint64_t firstMap = firstLevel + 1 < 64 ? firstLevelBitmap & (~uint64_t{0} << (firstLevel + 1)) : 0;
+            if (firstMap == 0) return INVALID;
+            firstLevel = lowestBit(firstMap);
+            secondMap = secondLevelBitmaps[firstLevel];
+         }
+         secondLevel = lowestBit(secondMap);
+         range = freeLists[firstLevel][secondLevel];
+      }
+      removeFree(range);
+
+      //padding in front and whatever is left behind go back as free ranges of their own. Neither can have a free neighbour,
+      //free ranges are always merged
+      const VkDeviceSize aligned = alignUp(ranges[range].offset, alignment);
+      if (aligned > ranges[range].offset) {
+         const uint32_t front = newRange(ranges[range].offset, aligned - ranges[range].offset);
+         ranges[front].previous = ranges[range].previous;
+         ranges[front].next = range;
+         if (ranges[front].previous != INVALID) ranges[ranges[front].previous].next = front;
+         ranges[range].previous = front;
+         ranges[range].offset = aligned;
+         ranges[range].size -= ranges[front].size;
+         insertFree(front);
+      }
+      if (ranges[range].size > size) {
+         const uint32_t back = newRange(aligned + size, ranges[range].size - size);
+         ranges[back].previous = range;
+         ranges[back].next = ranges[range].next;
+         if (ranges[back].next != INVALID) ranges[ranges[back].next].previous = back;
+         ranges[range].next = back;
+         ranges[range].size = size;
+         insertFree(back);
+      }
+
+      freeBytes_ -= size;
+      allocationCount_++;
+      offset = aligned;
+      return range;
+   }
+
+   void LveTlsf::free(uint32_t handle) {
+      assert(handle < ranges.size() && !ranges[handle].free && "Range is not allocated");
+      freeBytes_ += ranges[handle].size;
+      allocationCount_--;
+
+      uint32_t range = handle;
+      const uint32_t next = ranges[range].next;
+      if (next != INVALID && ranges[next].free) {
+         removeFree(next);
+         mergeNext(range);
+      }
+      const uint32_t previous = ranges[range].previous;
+      if (previous != INVALID && ranges[previous].free) {
+         removeFree(previous);
+         mergeNext(previous);
+         range = previous;
+      }
+      insertFree(range);
+   }
+
+   struct LveMemoryBlock {
+      LveMemoryBlock(VkDeviceMemory memory, void *mapped, uint32_t memoryType, VkDeviceSize size, LveMemoryAllocator::ResourceKind kind)
+         : memory{memory}, mapped{static_cast<char *>(mapped)}, memoryType{memoryType}, kind{kind}, tlsf{size} {}
+
+      VkDeviceMemory memory;
+      char *mapped;
+      uint32_t memoryType;
+      //only changes while the block is empty
+      LveMemoryAllocator::ResourceKind kind;
+      LveTlsf tlsf;
+   };
+
+   LveMemoryAllocator::LveMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice) : device{device} {
+      vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+      VkPhysicalDeviceProperties properties{};
+      vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+      maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+      nonCoherentAtomSize = std::max(properties.limits.nonCoherentAtomSize, VkDeviceSize{1});
+   }
+
+   LveMemoryAllocator::~LveMemoryAllocator() {
+      for (auto &typeBlocks : blocks) {
+         for (auto &block : typeBlocks) vkFreeMemory(device, block->memory, nullptr);
+      }
+   }
+
+   VkDeviceSize LveMemoryAllocator::blockSize(uint32_t memoryType) const {
+      const VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryType].heapIndex].size;
+      return std::min(BLOCK_SIZE, heapSize / 8) & ~(LveTlsf::MIN_ALIGNMENT - 1);
+   }
+
+   uint32_t LveMemoryAllocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+      for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+         if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+         }
+      }
+      throw std::runtime_error("failed to find suitable memory type!");
+   }
+
+   VkDeviceMemory LveMemoryAllocator::allocateDeviceMemory(uint32_t memoryType, VkDeviceSize size, void *&mapped) {
+      if (stats.deviceAllocations >= maxAllocationCount) {
+         throw std::runtime_error("device memory allocation count limit reached");
+      }
+
+      VkMemoryAllocateInfo allocInfo{};
+      allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+      allocInfo.allocationSize = size;
+      allocInfo.memoryTypeIndex = memoryType;
+      VkDeviceMemory memory = VK_NULL_HANDLE;
+      if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) return VK_NULL_HANDLE;
+
+      //mapped once for good, a memory object can't be mapped twice and every resource in the block may need it
+      mapped = nullptr;
+      if (memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+         vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+      }
+      stats.deviceAllocations++;
+      stats.totalDeviceAllocations++;
+      return memory;
+   }
+
+   void LveMemoryAllocator::freeDeviceMemory(VkDeviceMemory memory) {
+      //freeing unmaps
+      vkFreeMemory(device, memory, nullptr);
+      stats.deviceAllocations--;
+   }
+
+   LveAllocation LveMemoryAllocator::allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, ResourceKind kind) {
+      std::lock_guard<std::mutex> lock{mutex};
+      const uint32_t memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+      const VkDeviceSize blockBytes = blockSize(memoryType);
+      auto &typeBlocks = blocks[memoryType];
+
+      LveAllocation allocation{};
+      allocation.propertyFlags = memoryProperties.memoryTypes[memoryType].propertyFlags;
+      auto place = [&](LveMemoryBlock &block) {
+         VkDeviceSize offset = 0;
+         const uint32_t range = block.tlsf.allocate(requirements.size, requirements.alignment, offset);
+         if (range == LveTlsf::INVALID) return false;
+         block.kind = kind;
+         allocation.memory = block.memory;
+         allocation.offset = offset;
+         allocation.size = requirements.size;
+         allocation.mapped = block.mapped != nullptr ? block.mapped + offset : nullptr;
+         allocation.block = &block;
+         allocation.range = range;
+         return true;
+      };
+
+      //big resources would leave most of a block unusable for anything else
+      if (requirements.size < blockBytes / 2) {
+         for (auto &block : typeBlocks) {
+            if (block->kind != kind && !block->tlsf.empty()) continue;
+            if (place(*block)) return allocation;
+         }
+
+         void *mapped = nullptr;
+         const VkDeviceMemory memory = allocateDeviceMemory(memoryType, blockBytes, mapped);
+         //out of memory for a whole block, there may still be room for the resource alone
+         if (memory != VK_NULL_HANDLE) {
+            typeBlocks.push_back(std::make_unique<LveMemoryBlock>(memory, mapped, memoryType, blockBytes, kind));
+            stats.blocks++;
+            stats.blockBytes += blockBytes;
+            if (place(*typeBlocks.back())) return allocation;
+         }
+      }
+
+      void *mapped = nullptr;
+      allocation.memory = allocateDeviceMemory(memoryType, requirements.size, mapped);
+      if (allocation.memory == VK_NULL_HANDLE) {
+         throw std::runtime_error("failed to allocate device memory!");
+      }
+      allocation.size = requirements.size;
+      allocation.mapped = mapped;
+      stats.dedicatedAllocations++;
+      stats.dedicatedBytes += requirements.size;
+      return allocation;
+   }
+
+   void LveMemoryAllocator::free(LveAllocation &allocation) {
+      if (allocation.memory == VK_NULL_HANDLE) return;
+      std::lock_guard<std::mutex> lock{mutex};
+
+      LveMemoryBlock *block = allocation.block;
+      if (block == nullptr) {
+         freeDeviceMemory(allocation.memory);
+         stats.dedicatedAllocations--;
+         stats.dedicatedBytes -= allocation.size;
+         allocation = {};
+         return;
+      }
+
+      block->tlsf.free(allocation.range);
+      allocation = {};
+      if (!block->tlsf.empty()) return;
+
+      auto &typeBlocks = blocks[block->memoryType];
+      const auto emptyBlocks = std::count_if(
+         typeBlocks.begin(), typeBlocks.end(), [](const std::unique_ptr<LveMemoryBlock> &candidate) { return candidate->tlsf.empty(); });
+      if (emptyBlocks < 2) return;
+      stats.blocks--;
+      stats.blockBytes -= block->tlsf.size();
+      freeDeviceMemory(block->memory);
+      typeBlocks.erase(std::find_if(
+         typeBlocks.begin(), typeBlocks.end(), [block](const std::unique_ptr<LveMemoryBlock> &candidate) { return candidate.get() == block; }));
+   }
+
+   void LveMemoryAllocator::flush(const LveAllocation &allocation, VkDeviceSize offset, VkDeviceSize size) const {
+      if (allocation.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) return;
+
+      //ranges are in the memory object and go from and to multiples of nonCoherentAtomSize, a power of two. Rounding out never
+      //passes the end of a block, they are much bigger, but may pass the end of dedicated memory: that flushes to its end
+      const VkDeviceSize begin = (allocation.offset + offset) & ~(nonCoherentAtomSize - 1);
+      const VkDeviceSize end = alignUp(allocation.offset + offset + size, nonCoherentAtomSize);
+
+      VkMappedMemoryRange range{};
+      range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+      range.memory = allocation.memory;
+      range.offset = begin;
+      range.size = allocation.block == nullptr && end > allocation.offset + allocation.size ? VK_WHOLE_SIZE : end - begin;
+      if (vkFlushMappedMemoryRanges(device, 1, &range) != VK_SUCCESS) {
+         throw std::runtime_error("failed to flush mapped memory!");
+      }
+   }
+
+   LveMemoryAllocator::Stats LveMemoryAllocator::getStats() const {
+      std::lock_guard<std::mutex> lock{mutex};
+      Stats result = stats;
+      for (const auto &typeBlocks : blocks) {
+         for (const auto &block : typeBlocks) {
+            result.subAllocations += block->tlsf.allocationCount();
+            result.usedBlockBytes += block->tlsf.size() - block->tlsf.freeBytes();
+            result.freeRanges += block->tlsf.freeRangeCount();
+         }
+      }
+      return result;
+   }
+}
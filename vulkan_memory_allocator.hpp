@@ -0,0 +1,152 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+
+   //two level segregated fit allocator over a range of offsets. Free ranges are kept in lists by size class: the first level is
+   //the power of two, the second splits it into SECOND_LEVEL_COUNT steps. Two bitmaps find the first list with a range big
+   //enough, so allocating and freeing take constant time however fragmented the range is, and neighbouring free ranges are
+   //merged on free. Only bookkeeping, it never touches what it hands out, so it works for device memory
+   class LveTlsf {
+      public:
+      static constexpr uint32_t INVALID = UINT32_MAX;
+      //every size and offset is a multiple of this
+      static constexpr VkDeviceSize MIN_ALIGNMENT = 16;
+
+      explicit LveTlsf(VkDeviceSize size);
+
+      //handle of size bytes at an offset aligned to alignment (a power of two), INVALID if no free range is big enough
+      uint32_t allocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize &offset);
+      void free(uint32_t handle);
+
+      VkDeviceSize size() const { return size_; }
+      VkDeviceSize freeBytes() const { return freeBytes_; }
+      uint32_t allocationCount() const { return allocationCount_; }
+      bool empty() const { return allocationCount_ == 0; }
+      //1 while nothing is fragmented, 0 when full
+      uint32_t freeRangeCount() const { return freeRangeCount_; }
+
+      private:
+      static constexpr uint32_t SECOND_LEVEL_BITS = 5;
+      static constexpr uint32_t SECOND_LEVEL_COUNT = 1u << SECOND_LEVEL_BITS;
+      //sizes below this share the first list, split linearly
+      static constexpr uint32_t SMALL_LOG = 8;
+      static constexpr uint32_t FIRST_LEVEL_COUNT = 64 - SMALL_LOG + 1;
+
+      //a range of the whole, free or allocated, in offset order with its neighbours
+      struct Range {
+         VkDeviceSize offset;
+         VkDeviceSize size;
+         uint32_t previous;
+         uint32_t next;
+         //links of its free list, only while free
+         uint32_t previousFree;
+         uint32_t nextFree;
+         bool free;
+      };
+
+      static void mapping(VkDeviceSize size, uint32_t &firstLevel, uint32_t &secondLevel);
+      uint32_t newRange(VkDeviceSize offset, VkDeviceSize size);
+      void insertFree(uint32_t range);
+      void removeFree(uint32_t range);
+      //absorbs range's next neighbour, which has to be free and out of its list
+      void mergeNext(uint32_t range);
+
+      VkDeviceSize size_;
+      VkDeviceSize freeBytes_;
+      uint32_t allocationCount_ = 0;
+      uint32_t freeRangeCount_ = 0;
+      std::vector<Range> ranges{};
+      //ranges entries that were merged away, reused first
+      std::vector<uint32_t> unusedRanges{};
+      uint64_t firstLevelBitmap = 0;
+      uint32_t secondLevelBitmaps[FIRST_LEVEL_COUNT]{};
+      uint32_t freeLists[FIRST_LEVEL_COUNT][SECOND_LEVEL_COUNT];
+   };
+
+   struct LveMemoryBlock;
+
+   //the memory a buffer or image is bound to: a range of a shared block, or a VkDeviceMemory of its own
+   struct LveAllocation {
+      VkDeviceMemory memory = VK_NULL_HANDLE;
+      VkDeviceSize offset = 0;
+      VkDeviceSize size = 0;
+      //host visible memory stays mapped while it is allocated, this points at offset. nullptr for memory the host can't see
+      void *mapped = nullptr;
+      //of the memory type it came from: without HOST_COHERENT, host writes have to be flushed
+      VkMemoryPropertyFlags propertyFlags = 0;
+
+      //for LveMemoryAllocator::free: the block and its range, no block for a dedicated allocation
+      LveMemoryBlock *block = nullptr;
+      uint32_t range = LveTlsf::INVALID;
+   };
+
+   //places buffers and images in a few big VkDeviceMemory blocks per memory type instead of one allocation each, so creating and
+   //freeing them is bookkeeping instead of a driver call, and maxMemoryAllocationCount is never close. Owned by LveDevice
+   class LveMemoryAllocator {
+      public:
+      //blocks are this big, an eighth of the heap on smaller heaps
+      static constexpr VkDeviceSize BLOCK_SIZE = 64 * 1024 * 1024;
+
+      //buffers and linear images vs optimal images. bufferImageGranularity only applies between the two, and they never share
+      //a block, so neighbours never need padding
+      enum class ResourceKind { Linear, Optimal };
+
+      struct Stats {
+         //vkAllocateMemory allocations alive: blocks plus dedicated ones
+         uint32_t deviceAllocations = 0;
+         uint32_t blocks = 0;
+         uint32_t dedicatedAllocations = 0;
+         //resources placed in blocks
+         uint32_t subAllocations = 0;
+         VkDeviceSize blockBytes = 0;
+         //of blockBytes, what the resources in them take
+         VkDeviceSize usedBlockBytes = 0;
+         VkDeviceSize dedicatedBytes = 0;
+         //free ranges over all blocks, more of them for the same free bytes means more fragmentation
+         uint32_t freeRanges = 0;
+         //vkAllocateMemory calls since creation
+         uint64_t totalDeviceAllocations = 0;
+      };
+
+      LveMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice);
+      //every allocation has to be freed before
+      ~LveMemoryAllocator();
+
+      LveMemoryAllocator(const LveMemoryAllocator &) = delete;
+      LveMemoryAllocator &operator=(const LveMemoryAllocator &) = delete;
+
+      //memory for a resource with these requirements, in a block unless it would take at least half of one. Throws when the
+      //memory type has none left or maxMemoryAllocationCount is reached
+      LveAllocation allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, ResourceKind kind);
+      //resets allocation. An emptied block is freed unless it is the type's only empty one, kept so a resource that comes and
+      //goes every frame doesn't allocate every frame
+      void free(LveAllocation &allocation);
+      //makes host writes to [offset, offset + size) of allocation visible to the device. Nothing to do for coherent memory
+      void flush(const LveAllocation &allocation, VkDeviceSize offset, VkDeviceSize size) const;
+
+      Stats getStats() const;
+
+      private:
+      VkDeviceSize blockSize(uint32_t memoryType) const;
+      uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+      //vkAllocateMemory, mapped if host visible
+      VkDeviceMemory allocateDeviceMemory(uint32_t memoryType, VkDeviceSize size, void *&mapped);
+      void freeDeviceMemory(VkDeviceMemory memory);
+
+      VkDevice device;
+      VkPhysicalDeviceMemoryProperties memoryProperties{};
+      uint32_t maxAllocationCount;
+      VkDeviceSize nonCoherentAtomSize;
+      //any thread may create or free resources
+      mutable std::mutex mutex{};
+      std::vector<std::unique_ptr<LveMemoryBlock>> blocks[VK_MAX_MEMORY_TYPES];
+      Stats stats{};
+   };
+}
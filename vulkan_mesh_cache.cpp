@@ -0,0 +1,385 @@
+#include "vulkan_mesh_cache.hpp"
+#include "vulkan_archive.hpp"
+#include "vulkan_mesh_codec.hpp"
+#include "vulkan_utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace lve {
+
+   namespace {
+      constexpr char MAGIC[4] = {'L', 'V', 'E', 'M'};
+      //blobs start on a cache line so vertices() and indices() are always suitably aligned
+      constexpr uint64_t BLOB_ALIGNMENT = 64;
+
+      uint64_t alignUp(uint64_t value, uint64_t alignment) {
+         return (value + alignment - 1) & ~(alignment - 1);
+      }
+
+      int64_t modificationTime(const std::filesystem::path &path) {
+         return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+      }
+
+      //[offset, offset + bytes) inside a file of size bytes, written so a hostile header can't wrap the sum around
+      bool fits(uint64_t offset, uint64_t bytes, uint64_t size) {
+         return offset <= size && bytes <= size - offset;
+      }
+
+      uint64_t hashFile(const std::string &filepath) {
+         LveMappedFile source{filepath};
+         return hashBytes(source.data(), source.size());
+      }
+
+      //a failed write only means the next open hashes the source again
+      void patchSourceMtime(const std::string &cachePath, int64_t sourceMtime) {
+         std::fstream cache{cachePath, std::ios::binary | std::ios::in | std::ios::out};
+         cache.seekp(offsetof(LveMeshCacheHeader, sourceMtime));
+         cache.write(reinterpret_cast<const char *>(&sourceMtime), sizeof(sourceMtime));
+      }
+   }
+
+   std::string LveMeshCache::cachePathFor(const std::string &sourcePath) {
+      return sourcePath + ".lvemesh";
+   }
+
+   bool LveMeshCache::isValid(const unsigned char *data, size_t size) {
+      if (size < sizeof(LveMeshCacheHeader)) return false;
+
+      const auto *header = reinterpret_cast<const LveMeshCacheHeader *>(data);
+      if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+         header->version != VERSION ||
+         header->vertexStride != sizeof(LveModel::Vertex)) {
+         return false;
+      }
+
+      //a truncated or partially written file must never be handed to memcpy
+      const uint64_t vertexBytes = uint64_t{header->vertexCount} * header->vertexStride;
+      const uint64_t indexBytes = uint64_t{header->indexCount} * sizeof(uint32_t);
+      if (header->encoding == LveMeshEncoding::Raw) {
+         if (header->vertexBytes != vertexBytes || header->indexBytes != indexBytes) return false;
+      } else if (header->encoding != LveMeshEncoding::Codec || header->vertexBytes > size || header->indexBytes > size) {
+         return false;
+      }
+      const uint64_t lodBytes = uint64_t{header->lodCount} * sizeof(LveModel::Lod);
+      const uint64_t meshletBytes = uint64_t{header->meshletCount} * sizeof(LveModel::Meshlet);
+      const uint64_t segmentBytes = uint64_t{header->segmentCount} * sizeof(LveMeshCacheSegment);
+      const uint64_t submeshBytes = uint64_t{header->submeshCount} * sizeof(LveModel::Submesh);
+      if (!fits(header->vertexOffset, header->vertexBytes, size) ||
+         !fits(header->indexOffset, header->indexBytes, size) ||
+         !fits(header->lodOffset, lodBytes, size) ||
+         !fits(header->meshletOffset, meshletBytes, size) ||
+         !fits(header->segmentOffset, segmentBytes, size) ||
+         !fits(header->submeshOffset, submeshBytes, size) ||
+         header->submeshCount % std::max(header->lodCount, 1u) != 0 ||
+         header->segmentCount == 0) {
+         return false;
+      }
+
+      //segments have to tile both blobs exactly, raw ones at their plain size
+      const auto *segments = reinterpret_cast<const LveMeshCacheSegment *>(data + header->segmentOffset);
+      uint64_t vertexCount = 0, indexCount = 0, segmentVertexBytes = 0, segmentIndexBytes = 0;
+      for (uint32_t i = 0; i < header->segmentCount; i++) {
+         const LveMeshCacheSegment &segment = segments[i];
+         if (header->encoding == LveMeshEncoding::Raw &&
+            (segment.vertexBytes != uint64_t{segment.vertexCount} * header->vertexStride ||
+               segment.indexBytes != uint64_t{segment.indexCount} * sizeof(uint32_t))) {
+            return false;
+         }
+         //compared before adding, so the sums can't wrap around to the header's totals either
+         if (segment.vertexBytes > header->vertexBytes - segmentVertexBytes || segment.indexBytes > header->indexBytes - segmentIndexBytes) {
+            return false;
+         }
+         vertexCount += segment.vertexCount;
+         indexCount += segment.indexCount;
+         segmentVertexBytes += segment.vertexBytes;
+         segmentIndexBytes += segment.indexBytes;
+      }
+      return vertexCount == header->vertexCount && indexCount == header->indexCount &&
+         segmentVertexBytes == header->vertexBytes && segmentIndexBytes == header->indexBytes;
+   }
+
+   bool LveMeshCache::decode(bool decodeAll) {
+      if (header_->encoding == LveMeshEncoding::Raw) {
+         decodedSegments.store(header_->segmentCount, std::memory_order_release);
+         return true;
+      }
+
+      //sized once up front, so pointers handed out stay valid while the other segments decode. Left uninitialized: zeroing a big
+      //mesh would cost more than decoding its first level
+      decodedVertices.reset(new unsigned char[size_t{header_->vertexCount} * sizeof(LveModel::Vertex)]);
+      decodedIndices.reset(new uint32_t[header_->indexCount]);
+      if (!decodeNextSegment()) return false;
+      while (decodeAll && !decoded()) {
+         if (!decodeNextSegment()) return false;
+      }
+      return true;
+   }
+
+   bool LveMeshCache::decodeNextSegment() {
+      const uint32_t segment = decodedSegments.load(std::memory_order_relaxed);
+      if (segment == header_->segmentCount) return false;
+
+      const LveMeshCacheSegment *table = segments();
+      uint64_t vertexOffset = header_->vertexOffset, indexOffset = header_->indexOffset;
+      uint32_t firstVertex = 0, firstIndex = 0;
+      for (uint32_t i = 0; i < segment; i++) {
+         vertexOffset += table[i].vertexBytes;
+         indexOffset += table[i].indexBytes;
+         firstVertex += table[i].vertexCount;
+         firstIndex += table[i].indexCount;
+      }
+
+      //each segment's indices were coded expecting new vertices right after the previous segments' ones
+      const LveMeshCacheSegment &current = table[segment];
+      const bool ok = LveMeshCodec::decodeVertices(
+            data + vertexOffset, current.vertexBytes, reinterpret_cast<LveModel::Vertex *>(decodedVertices.get()) + firstVertex, current.vertexCount, sizeof(LveModel::Vertex)) &&
+         LveMeshCodec::decodeIndices(data + indexOffset, current.indexBytes, decodedIndices.get() + firstIndex, current.indexCount, firstVertex);
+      if (!ok) return false;
+      decodedSegments.store(segment + 1, std::memory_order_release);
+      return true;
+   }
+
+   uint32_t LveMeshCache::decodedVertexCount() const {
+      const uint32_t decoded = decodedSegments.load(std::memory_order_acquire);
+      uint32_t count = 0;
+      for (uint32_t i = 0; i < decoded; i++) count += segments()[i].vertexCount;
+      return count;
+   }
+
+   uint32_t LveMeshCache::decodedIndexCount() const {
+      const uint32_t decoded = decodedSegments.load(std::memory_order_acquire);
+      uint32_t count = 0;
+      for (uint32_t i = 0; i < decoded; i++) count += segments()[i].indexCount;
+      return count;
+   }
+
+   uint64_t LveMeshCache::hashSource(const std::string &sourcePath) {
+      if (LveArchive *archive = LveArchive::mounted()) {
+         if (const LveArchiveEntry *entry = archive->find(sourcePath)) return entry->contentHash;
+      }
+      return hashFile(sourcePath);
+   }
+
+   bool LveMeshCache::open(const std::string &sourcePath, bool decodeAll) {
+      file.reset();
+      packed.clear();
+      data = nullptr;
+      header_ = nullptr;
+      decodedVertices.reset();
+      decodedIndices.reset();
+      decodedSegments.store(0, std::memory_order_relaxed);
+
+      std::error_code error;
+      const std::string cachePath = cachePathFor(sourcePath);
+
+      if (LveArchive *archive = LveArchive::mounted()) {
+         if (archive->find(cachePath) != nullptr) {
+            std::vector<char> contents = archive->read(cachePath);
+            if (!isValid(reinterpret_cast<const unsigned char *>(contents.data()), contents.size())) return false;
+            packed = std::move(contents);
+            data = reinterpret_cast<const unsigned char *>(packed.data());
+            header_ = reinterpret_cast<const LveMeshCacheHeader *>(data);
+            return decode(decodeAll);
+         }
+      }
+
+      if (!std::filesystem::exists(cachePath, error)) return false;
+
+      const uint64_t sourceSize = std::filesystem::file_size(sourcePath, error);
+      if (error) return false;
+
+      std::unique_ptr<LveMappedFile> mapped;
+      try {
+         mapped = std::make_unique<LveMappedFile>(cachePath);
+      } catch (const std::exception &) {
+         //an unreadable cache is just a cache miss
+         return false;
+      }
+      if (!isValid(mapped->data(), mapped->size())) return false;
+
+      const auto *header = reinterpret_cast<const LveMeshCacheHeader *>(mapped->data());
+      if (header->sourceSize != sourceSize) return false;
+      const int64_t sourceMtime = modificationTime(sourcePath);
+      if (header->sourceMtime != sourceMtime) {
+         //touched but maybe not changed (checkout, copy): only now is it worth reading the source
+         if (header->sourceHash != hashFile(sourcePath)) return false;
+         //unchanged, so the cache takes the new time and the next open gets by with the size and time again. Unmapped while
+         //patching, Windows doesn't let a file mapped read only be written
+         mapped.reset();
+         patchSourceMtime(cachePath, sourceMtime);
+         try {
+            mapped = std::make_unique<LveMappedFile>(cachePath);
+         } catch (const std::exception &) {
+            return false;
+         }
+         if (!isValid(mapped->data(), mapped->size())) return false;
+         header = reinterpret_cast<const LveMeshCacheHeader *>(mapped->data());
+      }
+
+      file = std::move(mapped);
+      data = file->data();
+      header_ = header;
+      return decode(decodeAll);
+   }
+
+   uint64_t LveMeshCache::write(const std::string &sourcePath, const LveModel::Builder &builder, LveMeshEncoding encoding) {
+      if (builder.vertices.size() > std::numeric_limits<uint32_t>::max() ||
+         builder.indices.size() > std::numeric_limits<uint32_t>::max()) {
+         throw std::runtime_error("mesh too large to cache: " + sourcePath);
+      }
+
+      LveMeshCacheHeader header{};
+      memcpy(header.magic, MAGIC, sizeof(MAGIC));
+      header.version = VERSION;
+      header.vertexStride = sizeof(LveModel::Vertex);
+      header.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+      header.indexCount = static_cast<uint32_t>(builder.indices.size());
+      header.lodCount = static_cast<uint32_t>(builder.lods.size());
+      header.meshletCount = static_cast<uint32_t>(builder.meshlets.size());
+      header.submeshCount = static_cast<uint32_t>(builder.submeshes.size());
+      header.sourceSize = std::filesystem::file_size(sourcePath);
+      header.sourceMtime = modificationTime(sourcePath);
+      header.sourceHash = hashFile(sourcePath);
+
+      //one segment per level for progressive meshes so they can be decoded coarsest first, one for everything otherwise
+      std::vector<LveMeshCacheSegment> segments{};
+      if (LveModel::isProgressive(builder.lods.data(), header.lodCount, header.vertexCount, header.indexCount)) {
+         uint32_t vertexCount = 0;
+         for (size_t lod = builder.lods.size(); lod-- > 0;) {
+            segments.push_back({builder.lods[lod].vertexCount - vertexCount, builder.lods[lod].indexCount, 0, 0});
+            vertexCount = builder.lods[lod].vertexCount;
+         }
+      } else {
+         segments.push_back({header.vertexCount, header.indexCount, 0, 0});
+      }
+      header.segmentCount = static_cast<uint32_t>(segments.size());
+
+      //raw blobs are written straight from the builder, encoded ones from these
+      const char *vertexBlob = reinterpret_cast<const char *>(builder.vertices.data());
+      const char *indexBlob = reinterpret_cast<const char *>(builder.indices.data());
+      uint64_t vertexBytes = uint64_t{header.vertexCount} * header.vertexStride;
+      uint64_t indexBytes = uint64_t{header.indexCount} * sizeof(uint32_t);
+      std::vector<unsigned char> encodedVertices{}, encodedIndices{};
+      uint32_t firstVertex = 0, firstIndex = 0;
+      for (auto &segment : segments) {
+         if (encoding == LveMeshEncoding::Codec) {
+            const size_t vertexStart = encodedVertices.size(), indexStart = encodedIndices.size();
+            LveMeshCodec::encodeVertices(builder.vertices.data() + firstVertex, segment.vertexCount, sizeof(LveModel::Vertex), encodedVertices);
+            LveMeshCodec::encodeIndices(builder.indices.data() + firstIndex, segment.indexCount, encodedIndices, firstVertex);
+            segment.vertexBytes = encodedVertices.size() - vertexStart;
+            segment.indexBytes = encodedIndices.size() - indexStart;
+         } else {
+            segment.vertexBytes = uint64_t{segment.vertexCount} * header.vertexStride;
+            segment.indexBytes = uint64_t{segment.indexCount} * sizeof(uint32_t);
+         }
+         firstVertex += segment.vertexCount;
+         firstIndex += segment.indexCount;
+      }
+      if (encoding == LveMeshEncoding::Codec) {
+         vertexBlob = reinterpret_cast<const char *>(encodedVertices.data());
+         indexBlob = reinterpret_cast<const char *>(encodedIndices.data());
+         vertexBytes = encodedVertices.size();
+         indexBytes = encodedIndices.size();
+      }
+      header.encoding = encoding;
+      header.vertexBytes = vertexBytes;
+      header.indexBytes = indexBytes;
+      header.vertexOffset = alignUp(sizeof(LveMeshCacheHeader), BLOB_ALIGNMENT);
+      header.indexOffset = alignUp(header.vertexOffset + vertexBytes, BLOB_ALIGNMENT);
+      const uint64_t lodBytes = uint64_t{header.lodCount} * sizeof(LveModel::Lod);
+      header.lodOffset = alignUp(header.indexOffset + indexBytes, BLOB_ALIGNMENT);
+      const uint64_t meshletBytes = uint64_t{header.meshletCount} * sizeof(LveModel::Meshlet);
+      header.meshletOffset = alignUp(header.lodOffset + lodBytes, BLOB_ALIGNMENT);
+      const uint64_t segmentBytes = uint64_t{header.segmentCount} * sizeof(LveMeshCacheSegment);
+      header.segmentOffset = alignUp(header.meshletOffset + meshletBytes, BLOB_ALIGNMENT);
+      const uint64_t submeshBytes = uint64_t{header.submeshCount} * sizeof(LveModel::Submesh);
+      header.submeshOffset = alignUp(header.segmentOffset + segmentBytes, BLOB_ALIGNMENT);
+
+      glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+      glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+      for (const auto &vertex : builder.vertices) {
+         boundsMin = glm::min(boundsMin, vertex.position);
+         boundsMax = glm::max(boundsMax, vertex.position);
+      }
+      if (builder.vertices.empty()) {
+         boundsMin = boundsMax = glm::vec3{0.f};
+      }
+      for (int i = 0; i < 3; i++) {
+         header.boundsMin[i] = boundsMin[i];
+         header.boundsMax[i] = boundsMax[i];
+      }
+
+      //write to a temporary file and rename, so a crash mid-write never leaves a cache that looks valid
+      const std::string cachePath = cachePathFor(sourcePath);
+      //numbered, so two threads loading the same model at once (LveModelLoader) don't write into the same temporary file
+      static std::atomic<uint32_t> writeCount{0};
+      const std::string tempPath = cachePath + "." + std::to_string(writeCount++) + ".tmp";
+      {
+         std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+         if (!out.is_open()) {
+            throw std::runtime_error("failed to open mesh cache for writing: " + tempPath);
+         }
+
+         const std::vector<char> zeros(BLOB_ALIGNMENT, 0);
+         out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+         out.write(zeros.data(), header.vertexOffset - sizeof(header));
+         out.write(vertexBlob, vertexBytes);
+         out.write(zeros.data(), header.indexOffset - (header.vertexOffset + vertexBytes));
+         out.write(indexBlob, indexBytes);
+         out.write(zeros.data(), header.lodOffset - (header.indexOffset + indexBytes));
+         out.write(reinterpret_cast<const char *>(builder.lods.data()), lodBytes);
+         out.write(zeros.data(), header.meshletOffset - (header.lodOffset + lodBytes));
+         out.write(reinterpret_cast<const char *>(builder.meshlets.data()), meshletBytes);
+         out.write(zeros.data(), header.segmentOffset - (header.meshletOffset + meshletBytes));
+         out.write(reinterpret_cast<const char *>(segments.data()), segmentBytes);
+         out.write(zeros.data(), header.submeshOffset - (header.segmentOffset + segmentBytes));
+         out.write(reinterpret_cast<const char *>(builder.submeshes.data()), submeshBytes);
+
+         if (!out) {
+            throw std::runtime_error("failed to write mesh cache: " + tempPath);
+         }
+      }
+
+      std::filesystem::rename(tempPath, cachePath);
+      return header.sourceHash;
+   }
+
+   const LveModel::Vertex *LveMeshCache::vertices() const {
+      if (header_->encoding == LveMeshEncoding::Codec) return reinterpret_cast<const LveModel::Vertex *>(decodedVertices.get());
+      return reinterpret_cast<const LveModel::Vertex *>(data + header_->vertexOffset);
+   }
+
+   const uint32_t *LveMeshCache::indices() const {
+      if (header_->encoding == LveMeshEncoding::Codec) return decodedIndices.get();
+      return reinterpret_cast<const uint32_t *>(data + header_->indexOffset);
+   }
+
+   std::shared_ptr<const LveMappedFile> LveMeshCache::mappedFile() const {
+      if (header_ == nullptr || header_->encoding != LveMeshEncoding::Raw) return nullptr;
+      return file;
+   }
+
+   const LveModel::Lod *LveMeshCache::lods() const {
+      return reinterpret_cast<const LveModel::Lod *>(data + header_->lodOffset);
+   }
+
+   const LveModel::Meshlet *LveMeshCache::meshlets() const {
+      return reinterpret_cast<const LveModel::Meshlet *>(data + header_->meshletOffset);
+   }
+
+   const LveMeshCacheSegment *LveMeshCache::segments() const {
+      return reinterpret_cast<const LveMeshCacheSegment *>(data + header_->segmentOffset);
+   }
+
+   const LveModel::Submesh *LveMeshCache::submeshes() const {
+      return reinterpret_cast<const LveModel::Submesh *>(data + header_->submeshOffset);
+   }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "vulkan_mapped_file.hpp"
+#include "vulkan_model.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+   //how the vertex and index blobs are stored
+   enum class LveMeshEncoding : uint32_t {
+      //exactly as they go into the staging buffer, a cache hit is just a memcpy
+      Raw = 0,
+      //LveMeshCodec, decoded on open. Several times smaller, for archives and slow or network storage
+      Codec = 1
+   };
+
+   //part of the vertex and index blobs that decodes on its own: the next vertexCount vertices and indexCount indices after the
+   //segments before it. A progressive mesh (LveModel::isProgressive) has one per LOD level, coarsest first, anything else just one
+   struct LveMeshCacheSegment {
+      uint32_t vertexCount;
+      uint32_t indexCount;
+      //stored sizes
+      uint64_t vertexBytes;
+      uint64_t indexBytes;
+   };
+
+   //layout of a .lvemesh file: this header, then the vertex blob, the index blob (every LOD level, back to back), the LOD table,
+   //the meshlet table, the segment table and the submesh table
+   struct LveMeshCacheHeader {
+      char magic[4];
+      uint32_t version;
+      uint32_t vertexStride;
+      uint32_t vertexCount;
+      uint32_t indexCount;
+      uint32_t lodCount;
+      uint32_t meshletCount;
+      LveMeshEncoding encoding;
+      uint32_t segmentCount;
+      uint32_t submeshCount;
+      //used to detect a stale cache: size and mtime are checked first, the hash only if mtime changed
+      uint64_t sourceSize;
+      int64_t sourceMtime;
+      uint64_t sourceHash;
+      //byte offsets from the start of the file
+      uint64_t vertexOffset;
+      uint64_t indexOffset;
+      uint64_t lodOffset;
+      uint64_t meshletOffset;
+      uint64_t segmentOffset;
+      uint64_t submeshOffset;
+      //stored sizes of the vertex and index blobs, smaller than count * size when encoded
+      uint64_t vertexBytes;
+      uint64_t indexBytes;
+      float boundsMin[3];
+      float boundsMax[3];
+   };
+
+   class LveMeshCache {
+      public:
+      //bump whenever the vertex layout or the importer output changes, older caches are then rebuilt
+      static constexpr uint32_t VERSION = 8;
+
+      static std::string cachePathFor(const std::string &sourcePath);
+
+      //maps the cache belonging to sourcePath, returns false if it is missing, stale, from another version or fails to decode.
+      //a cache packed into the mounted archive is used first, it was built from the packed source so it is never stale.
+      //with decodeAll false only the first segment of an encoded cache is decoded, decodeNextSegment does the others
+      bool open(const std::string &sourcePath, bool decodeAll = true);
+      //writes the cache for sourcePath next to it (sourcePath + ".lvemesh"). Returns the source hash it recorded, what hashSource
+      //returns for the file, so the caller doesn't read the source a second time for it
+      static uint64_t write(const std::string &sourcePath, const LveModel::Builder &builder, LveMeshEncoding encoding = LveMeshEncoding::Codec);
+      //what header().sourceHash holds for an up to date cache: the hash of the source, read from the mounted archive if it has it
+      static uint64_t hashSource(const std::string &sourcePath);
+
+      //decodes the next segment, false if it is malformed or there is none left. May run on one thread while another reads the
+      //decoded counts and the vertices / indices below them
+      bool decodeNextSegment();
+      uint32_t segmentCount() const { return header_->segmentCount; }
+      uint32_t decodedSegmentCount() const { return decodedSegments.load(std::memory_order_acquire); }
+      bool decoded() const { return decodedSegmentCount() == header_->segmentCount; }
+      //vertices and indices from the start that are ready to use
+      uint32_t decodedVertexCount() const;
+      uint32_t decodedIndexCount() const;
+
+      const LveMeshCacheHeader &header() const { return *header_; }
+      const LveModel::Vertex *vertices() const;
+      const uint32_t *indices() const;
+      const LveModel::Lod *lods() const;
+      const LveModel::Meshlet *meshlets() const;
+      const LveMeshCacheSegment *segments() const;
+      const LveModel::Submesh *submeshes() const;
+      uint32_t vertexCount() const { return header_->vertexCount; }
+      uint32_t indexCount() const { return header_->indexCount; }
+      uint32_t lodCount() const { return header_->lodCount; }
+      uint32_t meshletCount() const { return header_->meshletCount; }
+      uint32_t submeshCount() const { return header_->submeshCount; }
+      //the mapped cache file if vertices() and indices() point into it (raw blobs, not read out of the archive), null otherwise.
+      //shared so an LveHostImport of it can keep it mapped
+      std::shared_ptr<const LveMappedFile> mappedFile() const;
+
+      private:
+      //magic, version, that every blob is inside size and that the segments add up to the blobs
+      static bool isValid(const unsigned char *data, size_t size);
+      //sizes the decode targets and decodes the first segment, or all of them
+      bool decode(bool decodeAll);
+
+      //either the mapped cache file or the contents read out of the archive
+      std::shared_ptr<LveMappedFile> file;
+      std::vector<char> packed{};
+      const unsigned char *data = nullptr;
+      const LveMeshCacheHeader *header_ = nullptr;
+      //filled by open and decodeNextSegment when the blobs are encoded
+      std::unique_ptr<unsigned char[]> decodedVertices{};
+      std::unique_ptr<uint32_t[]> decodedIndices{};
+      //segments that can be read, every one for raw blobs
+      std::atomic<uint32_t> decodedSegments{0};
+   };
+}
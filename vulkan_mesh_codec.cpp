@@ -0,0 +1,562 @@
+#include "vulkan_mesh_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+
+namespace lve {
+
+   namespace {
+      constexpr unsigned char INDEX_VERSION = 1;
+      constexpr unsigned char VERTEX_VERSION = 1;
+
+      //how far back shared edges and reused vertices are looked for. Index 15 of the edge FIFO is the code for "no shared edge"
+      constexpr uint32_t FIFO_SIZE = 16;
+      constexpr uint32_t EDGE_MISS = 15;
+      //low nibble of an edge hit: 0 is the next new vertex, 1..14 a recent vertex, 15 an explicit delta
+      constexpr uint32_t VERTEX_FIFO_CODES = 14;
+      constexpr uint32_t EXPLICIT_VERTEX = 15;
+
+      constexpr int MAX_CODE_LENGTH = 12;
+      constexpr size_t CODE_LENGTH_BYTES = 128;
+
+      constexpr size_t GROUP_SIZE = 16;
+
+      uint32_t zigzag(uint32_t delta) {
+         return (delta << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(delta) >> 31);
+      }
+
+      uint32_t unzigzag(uint32_t value) {
+         return (value >> 1) ^ (0u - (value & 1));
+      }
+
+      void writeVarint(std::vector<unsigned char> &out, uint32_t value) {
+         while (value >= 0x80) {
+            out.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+         }
+         out.push_back(static_cast<unsigned char>(value));
+      }
+
+      bool readVarint(const unsigned char *&p, const unsigned char *end, uint32_t &value) {
+         value = 0;
+         for (int shift = 0; shift < 35; shift += 7) {
+            if (p == end) return false;
+            const unsigned char byte = *p++;
+            value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+            if (byte < 0x80) return true;
+         }
+         return false;
+      }
+
+      //the state both sides keep in sync: recently seen directed edges and vertices, the next vertex never seen before,
+      //and the last explicitly coded vertex that deltas are taken against
+      struct IndexState {
+         uint32_t edges[FIFO_SIZE][2];
+         uint32_t vertices[FIFO_SIZE];
+         uint32_t edgeOffset = 0;
+         uint32_t vertexOffset = 0;
+         uint32_t next = 0;
+         uint32_t last = 0;
+
+         explicit IndexState(uint32_t firstVertex) : next{firstVertex}, last{firstVertex} {
+            //nothing real ever matches these
+            for (uint32_t i = 0; i < FIFO_SIZE; i++) {
+               edges[i][0] = edges[i][1] = UINT32_MAX;
+               vertices[i] = UINT32_MAX;
+            }
+         }
+
+         //i = 0 is the most recent entry
+         const uint32_t *edge(uint32_t i) const { return edges[(edgeOffset - 1 - i) & (FIFO_SIZE - 1)]; }
+         uint32_t vertex(uint32_t i) const { return vertices[(vertexOffset - 1 - i) & (FIFO_SIZE - 1)]; }
+
+         void pushEdge(uint32_t a, uint32_t b) {
+            edges[edgeOffset & (FIFO_SIZE - 1)][0] = a;
+            edges[edgeOffset & (FIFO_SIZE - 1)][1] = b;
+            edgeOffset++;
+         }
+
+         void pushVertex(uint32_t v) {
+            vertices[vertexOffset & (FIFO_SIZE - 1)] = v;
+            vertexOffset++;
+         }
+
+         //neighbours share an edge in the opposite direction, so that is what gets looked up. A triangle that came in
+         //through ab has already used the only neighbour across it
+         void pushTriangle(uint32_t a, uint32_t b, uint32_t c, bool sharedEdge) {
+            if (!sharedEdge) pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+         }
+
+         int findVertex(uint32_t v) const {
+            for (uint32_t i = 0; i < VERTEX_FIFO_CODES; i++) {
+               if (vertex(i) == v) return static_cast<int>(i);
+            }
+            return -1;
+         }
+      };
+
+      //Huffman code lengths of at most MAX_CODE_LENGTH bits. Frequencies are halved until the tree is shallow enough
+      void buildCodeLengths(const uint32_t (&frequencies)[256], uint8_t (&lengths)[256]) {
+         std::memset(lengths, 0, sizeof(lengths));
+         uint32_t scaled[256];
+         std::memcpy(scaled, frequencies, sizeof(scaled));
+
+         int used = 0;
+         for (int s = 0; s < 256; s++) used += scaled[s] > 0;
+         if (used == 0) return;
+         if (used == 1) {
+            for (int s = 0; s < 256; s++) if (scaled[s] > 0) lengths[s] = 1;
+            return;
+         }
+
+         while (true) {
+            //leaves are 0..255, inner nodes follow
+            std::vector<int> parent(512, -1);
+            using Node = std::pair<uint64_t, int>;
+            std::priority_queue<Node, std::vector<Node>, std::greater<Node>> queue{};
+            for (int s = 0; s < 256; s++) {
+               if (scaled[s] > 0) queue.push({scaled[s], s});
+            }
+            int nextNode = 256;
+            while (queue.size() > 1) {
+               const Node a = queue.top();
+               queue.pop();
+               const Node b = queue.top();
+               queue.pop();
+               parent[a.second] = parent[b.second] = nextNode;
+               queue.push({a.first + b.first, nextNode++});
+            }
+
+            int longest = 0;
+            for (int s = 0; s < 256; s++) {
+               if (scaled[s] == 0) continue;
+               int depth = 0;
+               for (int node = s; parent[node] >= 0; node = parent[node]) depth++;
+               lengths[s] = static_cast<uint8_t>(depth);
+               longest = std::max(longest, depth);
+            }
+            if (longest <= MAX_CODE_LENGTH) return;
+            for (auto &frequency : scaled) {
+               if (frequency > 0) frequency = (frequency + 1) / 2;
+            }
+         }
+      }
+
+      //canonical codes, bit reversed because the bit stream is read from the least significant bit up
+      void buildCodes(const uint8_t (&lengths)[256], uint32_t (&codes)[256]) {
+         uint32_t code = 0;
+         for (int length = 1; length <= MAX_CODE_LENGTH; length++) {
+            for (int s = 0; s < 256; s++) {
+               if (lengths[s] != length) continue;
+               uint32_t reversed = 0;
+               for (int bit = 0; bit < length; bit++) reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+               codes[s] = reversed;
+               code++;
+            }
+            code <<= 1;
+         }
+      }
+
+      class BitWriter {
+         public:
+         explicit BitWriter(std::vector<unsigned char> &out) : out{out} {}
+
+         void write(uint32_t bits, int count) {
+            buffer |= static_cast<uint64_t>(bits) << used;
+            used += count;
+            while (used >= 8) {
+               out.push_back(static_cast<unsigned char>(buffer));
+               buffer >>= 8;
+               used -= 8;
+            }
+         }
+
+         void flush() {
+            if (used > 0) out.push_back(static_cast<unsigned char>(buffer));
+            buffer = 0;
+            used = 0;
+         }
+
+         private:
+         std::vector<unsigned char> &out;
+         uint64_t buffer = 0;
+         int used = 0;
+      };
+
+      class BitReader {
+         public:
+         BitReader(const unsigned char *data, size_t size) : data{data}, size{size} {}
+
+         uint32_t peek(int count) {
+            if (available < count) refill();
+            return static_cast<uint32_t>(buffer & ((uint64_t{1} << count) - 1));
+         }
+
+         void consume(int count) {
+            buffer >>= count;
+            available -= count;
+            consumed += count;
+         }
+
+         //false if more bits were consumed than the stream holds
+         bool valid() const { return consumed <= size * 8; }
+
+         private:
+         void refill() {
+            if (position + 8 <= size) {
+               //whole bytes that fit above the bits already buffered
+               uint64_t word;
+               std::memcpy(&word, data + position, sizeof(word));
+               buffer |= word << available;
+               position += (63 - available) >> 3;
+               available |= 56;
+               return;
+            }
+            //the tail reads zeros past the end, valid() catches a stream that actually needed them
+            while (available <= 56) {
+               const uint64_t byte = position < size ? data[position] : 0;
+               position++;
+               buffer |= byte << available;
+               available += 8;
+            }
+         }
+
+         const unsigned char *data;
+         size_t size;
+         size_t position = 0;
+         uint64_t buffer = 0;
+         int available = 0;
+         size_t consumed = 0;
+      };
+
+      //16 values at 0, 2, 4 or 8 bits each, whichever is the smallest that fits all of them
+      int groupMode(const unsigned char *values) {
+         unsigned char largest = 0;
+         for (size_t i = 0; i < GROUP_SIZE; i++) largest = std::max(largest, values[i]);
+         if (largest == 0) return 0;
+         if (largest < 4) return 1;
+         if (largest < 16) return 2;
+         return 3;
+      }
+
+      //header: 2 bits of mode per group, then every group's payload
+      void encodeByteStream(const unsigned char *values, size_t count, std::vector<unsigned char> &out) {
+         const size_t groups = count / GROUP_SIZE;
+         const size_t headerOffset = out.size();
+         out.resize(out.size() + (groups + 3) / 4, 0);
+         for (size_t g = 0; g < groups; g++) {
+            const unsigned char *group = values + g * GROUP_SIZE;
+            const int mode = groupMode(group);
+            out[headerOffset + g / 4] |= static_cast<unsigned char>(mode << ((g % 4) * 2));
+            if (mode == 3) {
+               out.insert(out.end(), group, group + GROUP_SIZE);
+            } else if (mode > 0) {
+               const int bits = mode == 1 ? 2 : 4;
+               const int perByte = 8 / bits;
+               for (size_t i = 0; i < GROUP_SIZE; i += perByte) {
+                  unsigned char packed = 0;
+                  for (int j = 0; j < perByte; j++) packed |= static_cast<unsigned char>(group[i + j] << (j * bits));
+                  out.push_back(packed);
+               }
+            }
+         }
+      }
+
+      //every packed byte expanded to the 4 (2 bit) or 2 (4 bit) bytes it holds
+      struct UnpackTables {
+         uint32_t twoBit[256];
+         uint16_t fourBit[256];
+
+         UnpackTables() {
+            for (uint32_t byte = 0; byte < 256; byte++) {
+               twoBit[byte] = (byte & 3) | ((byte >> 2 & 3) << 8) | ((byte >> 4 & 3) << 16) | ((byte >> 6 & 3) << 24);
+               fourBit[byte] = static_cast<uint16_t>((byte & 15) | ((byte >> 4) << 8));
+            }
+         }
+      };
+
+      const unsigned char *decodeByteStream(const unsigned char *p, const unsigned char *end, unsigned char *values, size_t count) {
+         static const UnpackTables tables{};
+         const size_t groups = count / GROUP_SIZE;
+         const size_t headerBytes = (groups + 3) / 4;
+         if (static_cast<size_t>(end - p) < headerBytes) return nullptr;
+         const unsigned char *header = p;
+         p += headerBytes;
+
+         for (size_t g = 0; g < groups; g++) {
+            unsigned char *group = values + g * GROUP_SIZE;
+            const int mode = (header[g / 4] >> ((g % 4) * 2)) & 3;
+            switch (mode) {
+               case 0:
+                  std::memset(group, 0, GROUP_SIZE);
+                  break;
+               case 1:
+                  if (end - p < 4) return nullptr;
+                  for (size_t i = 0; i < 4; i++) std::memcpy(group + 4 * i, &tables.twoBit[p[i]], 4);
+                  p += 4;
+                  break;
+               case 2:
+                  if (end - p < 8) return nullptr;
+                  for (size_t i = 0; i < 8; i++) std::memcpy(group + 2 * i, &tables.fourBit[p[i]], 2);
+                  p += 8;
+                  break;
+               default:
+                  if (end - p < 16) return nullptr;
+                  std::memcpy(group, p, GROUP_SIZE);
+                  p += 16;
+                  break;
+            }
+         }
+         return p;
+      }
+   }
+
+   void LveMeshCodec::encodeIndices(const uint32_t *indices, size_t indexCount, std::vector<unsigned char> &out, uint32_t firstVertex) {
+      if (indexCount % 3 != 0) throw std::runtime_error("index codec needs a triangle list");
+
+      std::vector<unsigned char> codes{};
+      std::vector<unsigned char> explicitVertices{};
+      codes.reserve(indexCount / 3);
+      IndexState state{firstVertex};
+
+      auto writeExplicit = [&](uint32_t v) {
+         writeVarint(explicitVertices, zigzag(v - state.last));
+         state.last = v;
+      };
+
+      for (size_t i = 0; i < indexCount; i += 3) {
+         uint32_t a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
+
+         //rotate the triangle so the shared edge comes first
+         uint32_t edge = EDGE_MISS;
+         for (uint32_t e = 0; e < EDGE_MISS && edge == EDGE_MISS; e++) {
+            const uint32_t *fifo = state.edge(e);
+            for (int rotation = 0; rotation < 3; rotation++) {
+               if (fifo[0] == a && fifo[1] == b) {
+                  edge = e;
+                  break;
+               }
+               const uint32_t t = a;
+               a = b;
+               b = c;
+               c = t;
+            }
+         }
+
+         if (edge != EDGE_MISS) {
+            uint32_t third;
+            const int recent = state.findVertex(c);
+            if (c == state.next) {
+               third = 0;
+               state.next++;
+               state.pushVertex(c);
+            } else if (recent >= 0) {
+               third = 1 + static_cast<uint32_t>(recent);
+            } else {
+               third = EXPLICIT_VERTEX;
+               writeExplicit(c);
+               state.pushVertex(c);
+            }
+            codes.push_back(static_cast<unsigned char>((edge << 4) | third));
+         } else {
+            //no shared edge: one bit per corner for "next new vertex", the rest are explicit
+            unsigned char flags = 0;
+            const uint32_t corners[3] = {a, b, c};
+            for (int k = 0; k < 3; k++) {
+               if (corners[k] == state.next) {
+                  flags |= static_cast<unsigned char>(1 << k);
+                  state.next++;
+               } else {
+                  writeExplicit(corners[k]);
+               }
+               state.pushVertex(corners[k]);
+            }
+            codes.push_back(static_cast<unsigned char>((EDGE_MISS << 4) | flags));
+         }
+         state.pushTriangle(a, b, c, edge != EDGE_MISS);
+      }
+
+      //layout: version, 256 code lengths as nibbles, size of the Huffman coded codes, the codes, the explicit vertex deltas
+      uint32_t frequencies[256] = {};
+      for (unsigned char code : codes) frequencies[code]++;
+      uint8_t lengths[256];
+      buildCodeLengths(frequencies, lengths);
+      uint32_t huffman[256] = {};
+      buildCodes(lengths, huffman);
+
+      out.push_back(INDEX_VERSION);
+      for (size_t s = 0; s < 256; s += 2) out.push_back(static_cast<unsigned char>(lengths[s] | (lengths[s + 1] << 4)));
+
+      std::vector<unsigned char> bits{};
+      BitWriter writer{bits};
+      for (unsigned char code : codes) writer.write(huffman[code], lengths[code]);
+      writer.flush();
+
+      const uint32_t bitBytes = static_cast<uint32_t>(bits.size());
+      const size_t sizeOffset = out.size();
+      out.resize(out.size() + sizeof(bitBytes));
+      std::memcpy(out.data() + sizeOffset, &bitBytes, sizeof(bitBytes));
+      out.insert(out.end(), bits.begin(), bits.end());
+      out.insert(out.end(), explicitVertices.begin(), explicitVertices.end());
+   }
+
+   bool LveMeshCodec::decodeIndices(const unsigned char *data, size_t size, uint32_t *indices, size_t indexCount, uint32_t firstVertex) {
+      if (indexCount % 3 != 0) return false;
+      if (size < 1 + CODE_LENGTH_BYTES + sizeof(uint32_t) || data[0] != INDEX_VERSION) return false;
+      const unsigned char *end = data + size;
+
+      //lookup table over MAX_CODE_LENGTH bits: symbol in the low byte, code length in the high byte
+      uint8_t lengths[256];
+      for (size_t s = 0; s < 256; s += 2) {
+         lengths[s] = data[1 + s / 2] & 15;
+         lengths[s + 1] = data[1 + s / 2] >> 4;
+      }
+      uint32_t kraft = 0;
+      for (int s = 0; s < 256; s++) {
+         if (lengths[s] > MAX_CODE_LENGTH) return false;
+         if (lengths[s] > 0) kraft += 1u << (MAX_CODE_LENGTH - lengths[s]);
+      }
+      //a complete prefix code fills the table exactly, a single symbol code half of it
+      if (kraft > (1u << MAX_CODE_LENGTH)) return false;
+
+      uint32_t huffman[256] = {};
+      buildCodes(lengths, huffman);
+      std::vector<uint16_t> table(size_t{1} << MAX_CODE_LENGTH, 0);
+      for (int s = 0; s < 256; s++) {
+         if (lengths[s] == 0) continue;
+         for (uint32_t fill = 0; fill < (1u << (MAX_CODE_LENGTH - lengths[s])); fill++) {
+            table[huffman[s] | (fill << lengths[s])] = static_cast<uint16_t>(s | (lengths[s] << 8));
+         }
+      }
+
+      uint32_t bitBytes;
+      std::memcpy(&bitBytes, data + 1 + CODE_LENGTH_BYTES, sizeof(bitBytes));
+      const unsigned char *bits = data + 1 + CODE_LENGTH_BYTES + sizeof(bitBytes);
+      if (bitBytes > static_cast<size_t>(end - bits)) return false;
+      const unsigned char *explicitVertices = bits + bitBytes;
+
+      BitReader reader{bits, bitBytes};
+      IndexState state{firstVertex};
+      auto readExplicit = [&](uint32_t &v) {
+         uint32_t value;
+         if (!readVarint(explicitVertices, end, value)) return false;
+         v = state.last + unzigzag(value);
+         state.last = v;
+         return true;
+      };
+
+      for (size_t i = 0; i < indexCount; i += 3) {
+         const uint16_t entry = table[reader.peek(MAX_CODE_LENGTH)];
+         //entries no code maps to have length 0
+         if ((entry >> 8) == 0) return false;
+         reader.consume(entry >> 8);
+         const uint32_t code = entry & 0xff;
+
+         uint32_t a, b, c;
+         const uint32_t edge = code >> 4;
+         if (edge != EDGE_MISS) {
+            const uint32_t *shared = state.edge(edge);
+            a = shared[0];
+            b = shared[1];
+            const uint32_t third = code & 15;
+            if (third == 0) {
+               c = state.next++;
+               state.pushVertex(c);
+            } else if (third != EXPLICIT_VERTEX) {
+               c = state.vertex(third - 1);
+            } else {
+               if (!readExplicit(c)) return false;
+               state.pushVertex(c);
+            }
+         } else {
+            uint32_t corners[3];
+            for (int k = 0; k < 3; k++) {
+               if (code & (1 << k)) {
+                  corners[k] = state.next++;
+               } else if (!readExplicit(corners[k])) {
+                  return false;
+               }
+               state.pushVertex(corners[k]);
+            }
+            a = corners[0];
+            b = corners[1];
+            c = corners[2];
+         }
+
+         indices[i + 0] = a;
+         indices[i + 1] = b;
+         indices[i + 2] = c;
+         state.pushTriangle(a, b, c, edge != EDGE_MISS);
+      }
+      return reader.valid() && explicitVertices == end;
+   }
+
+   void LveMeshCodec::encodeVertices(const void *vertices, size_t vertexCount, size_t stride, std::vector<unsigned char> &out) {
+      if (stride % 4 != 0 || stride == 0 || stride > 256) throw std::runtime_error("vertex codec needs a stride that is a multiple of 4, up to 256");
+      const size_t words = stride / 4;
+      const auto *bytes = static_cast<const unsigned char *>(vertices);
+
+      out.push_back(VERTEX_VERSION);
+      //previous vertex, carried across blocks
+      uint32_t previous[64] = {};
+      std::vector<unsigned char> transposed(stride * VERTEX_BLOCK_SIZE);
+
+      for (size_t first = 0; first < vertexCount; first += VERTEX_BLOCK_SIZE) {
+         const size_t count = std::min(VERTEX_BLOCK_SIZE, vertexCount - first);
+         const size_t padded = (count + GROUP_SIZE - 1) / GROUP_SIZE * GROUP_SIZE;
+         std::fill(transposed.begin(), transposed.end(), 0);
+
+         for (size_t i = 0; i < count; i++) {
+            for (size_t w = 0; w < words; w++) {
+               uint32_t value;
+               std::memcpy(&value, bytes + (first + i) * stride + w * 4, sizeof(value));
+               const uint32_t delta = zigzag(value - previous[w]);
+               previous[w] = value;
+               for (size_t k = 0; k < 4; k++) transposed[(w * 4 + k) * VERTEX_BLOCK_SIZE + i] = static_cast<unsigned char>(delta >> (8 * k));
+            }
+         }
+         for (size_t p = 0; p < stride; p++) encodeByteStream(transposed.data() + p * VERTEX_BLOCK_SIZE, padded, out);
+      }
+   }
+
+   bool LveMeshCodec::decodeVertices(const unsigned char *data, size_t size, void *vertices, size_t vertexCount, size_t stride) {
+      if (stride % 4 != 0 || stride == 0 || stride > 256) return false;
+      if (size < 1 || data[0] != VERTEX_VERSION) return false;
+      const unsigned char *p = data + 1;
+      const unsigned char *end = data + size;
+      const size_t words = stride / 4;
+      auto *bytes = static_cast<unsigned char *>(vertices);
+
+      uint32_t previous[64] = {};
+      //on the stack: 64 KB at the largest stride, one block's worth of byte streams
+      alignas(16) unsigned char transposed[256 * VERTEX_BLOCK_SIZE];
+
+      for (size_t first = 0; first < vertexCount; first += VERTEX_BLOCK_SIZE) {
+         const size_t count = std::min(VERTEX_BLOCK_SIZE, vertexCount - first);
+         const size_t padded = (count + GROUP_SIZE - 1) / GROUP_SIZE * GROUP_SIZE;
+         for (size_t s = 0; s < stride; s++) {
+            p = decodeByteStream(p, end, transposed + s * VERTEX_BLOCK_SIZE, padded);
+            if (p == nullptr) return false;
+         }
+
+         //one word at a time: four sequential streams in, a strided store out
+         unsigned char *out = bytes + first * stride;
+         for (size_t w = 0; w < words; w++) {
+            const unsigned char *stream = transposed + w * 4 * VERTEX_BLOCK_SIZE;
+            uint32_t value = previous[w];
+            for (size_t i = 0; i < count; i++) {
+               const uint32_t delta = stream[i] | (stream[VERTEX_BLOCK_SIZE + i] << 8) | (stream[2 * VERTEX_BLOCK_SIZE + i] << 16) |
+                  (uint32_t{stream[3 * VERTEX_BLOCK_SIZE + i]} << 24);
+               value += unzigzag(delta);
+               std::memcpy(out + i * stride + w * 4, &value, sizeof(value));
+            }
+            previous[w] = value;
+         }
+      }
+      return p == end;
+   }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+   //lossless compression for mesh data on disk, see LveMeshCache.
+   //indices: each triangle becomes one code byte describing how it connects to recent triangles (shared edge, new vertex,
+   //recently used vertex), Huffman coded, plus zigzag deltas for the vertices that can't be predicted.
+   //vertices: 32 bit words are delta encoded against the previous vertex, then split into one byte stream per byte of the
+   //vertex so the mostly zero high bytes end up together, and packed 16 at a time into 0, 2, 4 or 8 bits per byte
+   class LveMeshCodec {
+      public:
+      //vertices are encoded in blocks of this many, small enough that the transposed block stays in L1
+      static constexpr size_t VERTEX_BLOCK_SIZE = 256;
+
+      //appends the encoded triangle list to out, indexCount has to be a multiple of 3. Works best on indices that went through
+      //LveMeshOptimizer (vertex cache and fetch order). Triangles decode in the same order, but each one may start at a
+      //different corner (same winding), so ranges of triangles such as LOD levels and meshlets stay valid.
+      //firstVertex is the first vertex the triangles are expected to introduce, for lists that continue an earlier one
+      //(e.g. one level of a progressive mesh). Decoding has to pass the same value
+      static void encodeIndices(const uint32_t *indices, size_t indexCount, std::vector<unsigned char> &out, uint32_t firstVertex = 0);
+      //returns false if data is malformed or doesn't hold exactly indexCount indices
+      static bool decodeIndices(const unsigned char *data, size_t size, uint32_t *indices, size_t indexCount, uint32_t firstVertex = 0);
+
+      //appends the encoded vertices to out, lossless. stride has to be a multiple of 4 and at most 256
+      static void encodeVertices(const void *vertices, size_t vertexCount, size_t stride, std::vector<unsigned char> &out);
+      //returns false if data is malformed or doesn't hold exactly vertexCount vertices
+      static bool decodeVertices(const unsigned char *data, size_t size, void *vertices, size_t vertexCount, size_t stride);
+   };
+}
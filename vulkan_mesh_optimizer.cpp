@@ -0,0 +1,267 @@
+#include "vulkan_mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace lve {
+
+   namespace {
+      //triangles touching each vertex, stored as one flat array with per-vertex ranges
+      struct TriangleAdjacency {
+         std::vector<uint32_t> offsets{};
+         std::vector<uint32_t> counts{};
+         std::vector<uint32_t> triangles{};
+      };
+
+      TriangleAdjacency buildAdjacency(const std::vector<uint32_t> &indices, size_t vertexCount) {
+         TriangleAdjacency adjacency{};
+         adjacency.counts.assign(vertexCount, 0);
+         for (uint32_t index : indices) {
+            adjacency.counts[index]++;
+         }
+
+         adjacency.offsets.resize(vertexCount);
+         uint32_t offset = 0;
+         for (size_t v = 0; v < vertexCount; v++) {
+            adjacency.offsets[v] = offset;
+            offset += adjacency.counts[v];
+         }
+
+         adjacency.triangles.resize(indices.size());
+         std::vector<uint32_t> fill = adjacency.offsets;
+         for (size_t i = 0; i < indices.size(); i++) {
+            adjacency.triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+         }
+         return adjacency;
+      }
+
+      //FIFO cache simulated with timestamps: a vertex is cached if fewer than cacheSize vertices were inserted after it.
+      //returns how many of the triangle's vertices had to be transformed
+      uint32_t simulateTriangle(const uint32_t *triangle, std::vector<uint32_t> &cacheTime, uint32_t &time, uint32_t cacheSize) {
+         uint32_t misses = 0;
+         for (int k = 0; k < 3; k++) {
+            const uint32_t v = triangle[k];
+            if (time - cacheTime[v] > cacheSize) {
+               cacheTime[v] = time++;
+               misses++;
+            }
+         }
+         return misses;
+      }
+   }
+
+   LveMeshOptimizer::VertexCacheStatistics LveMeshOptimizer::analyzeVertexCache(const std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize) {
+      VertexCacheStatistics statistics{};
+      const size_t triangleCount = indices.size() / 3;
+      if (triangleCount == 0) return statistics;
+
+      std::vector<uint32_t> cacheTime(vertexCount, 0);
+      std::vector<char> referenced(vertexCount, 0);
+      uint32_t time = cacheSize + 1;
+      size_t misses = 0;
+      for (size_t t = 0; t < triangleCount; t++) {
+         misses += simulateTriangle(&indices[3 * t], cacheTime, time, cacheSize);
+      }
+      for (uint32_t index : indices) {
+         referenced[index] = 1;
+      }
+
+      const size_t referencedCount = std::count(referenced.begin(), referenced.end(), 1);
+      statistics.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+      statistics.atvr = static_cast<float>(misses) / static_cast<float>(referencedCount);
+      return statistics;
+   }
+
+   void LveMeshOptimizer::optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize) {
+      const size_t triangleCount = indices.size() / 3;
+      if (triangleCount == 0) return;
+
+      const TriangleAdjacency adjacency = buildAdjacency(indices, vertexCount);
+      //live: triangles around the vertex that haven't been emitted yet
+      std::vector<uint32_t> live = adjacency.counts;
+      std::vector<uint32_t> cacheTime(vertexCount, 0);
+      std::vector<char> emitted(triangleCount, 0);
+      //recently referenced vertices, where to continue when the current fan runs out
+      std::vector<uint32_t> deadEnd{};
+      deadEnd.reserve(indices.size());
+      std::vector<uint32_t> candidates{};
+      std::vector<uint32_t> output{};
+      output.reserve(indices.size());
+
+      uint32_t time = cacheSize + 1;
+      size_t cursor = 0;
+
+      auto skipDeadEnd = [&]() -> int64_t {
+         while (!deadEnd.empty()) {
+            const uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) return v;
+         }
+         //nothing recent left, jump to the next vertex in input order that still has triangles
+         while (cursor < vertexCount) {
+            if (live[cursor] > 0) return static_cast<int64_t>(cursor);
+            cursor++;
+         }
+         return -1;
+      };
+
+      int64_t fanning = skipDeadEnd();
+      while (fanning >= 0) {
+         candidates.clear();
+
+         //emit every remaining triangle around the fanning vertex
+         const uint32_t begin = adjacency.offsets[fanning];
+         const uint32_t end = begin + adjacency.counts[fanning];
+         for (uint32_t a = begin; a < end; a++) {
+            const uint32_t t = adjacency.triangles[a];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+
+            for (int k = 0; k < 3; k++) {
+               const uint32_t v = indices[3 * t + k];
+               output.push_back(v);
+               deadEnd.push_back(v);
+               candidates.push_back(v);
+               live[v]--;
+               if (time - cacheTime[v] > cacheSize) {
+                  cacheTime[v] = time++;
+               }
+            }
+         }
+
+         //prefer the oldest candidate that will still be cached after fanning around it
+         int64_t best = -1;
+         int64_t bestPriority = -1;
+         for (uint32_t v : candidates) {
+            if (live[v] == 0) continue;
+            int64_t priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= cacheSize) {
+               priority = time - cacheTime[v];
+            }
+            if (priority > bestPriority) {
+               bestPriority = priority;
+               best = v;
+            }
+         }
+         fanning = best >= 0 ? best : skipDeadEnd();
+      }
+
+      indices.swap(output);
+   }
+
+   void LveMeshOptimizer::optimizeOverdraw(std::vector<uint32_t> &indices, const glm::vec3 *positions, size_t stride, size_t vertexCount, float threshold) {
+      const size_t triangleCount = indices.size() / 3;
+      if (triangleCount == 0) return;
+
+      auto position = [positions, stride](uint32_t v) -> const glm::vec3 & {
+         return *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const char *>(positions) + v * stride);
+      };
+
+      //cache misses per triangle in the current (cache optimized) order
+      std::vector<uint32_t> misses(triangleCount);
+      {
+         std::vector<uint32_t> cacheTime(vertexCount, 0);
+         uint32_t time = CACHE_SIZE + 1;
+         for (size_t t = 0; t < triangleCount; t++) {
+            misses[t] = simulateTriangle(&indices[3 * t], cacheTime, time, CACHE_SIZE);
+         }
+      }
+
+      //hard boundaries: a triangle missing all 3 vertices starts from a cold cache anyway, so cutting there is free
+      std::vector<size_t> hardStarts{0};
+      for (size_t t = 1; t < triangleCount; t++) {
+         if (misses[t] == 3) hardStarts.push_back(t);
+      }
+      hardStarts.push_back(triangleCount);
+
+      //soft boundaries: inside a hard cluster, cut as soon as the part so far, drawn from a cold cache, is within threshold of the mesh ACMR.
+      //every cluster may end up after any other one, so its own misses have to be counted as if nothing was cached before it
+      const float meshAcmr = static_cast<float>(std::accumulate(misses.begin(), misses.end(), size_t{0})) / triangleCount;
+      std::vector<size_t> clusterStarts{};
+      {
+         std::vector<uint32_t> cacheTime(vertexCount, 0);
+         uint32_t time = CACHE_SIZE + 1;
+         for (size_t h = 0; h + 1 < hardStarts.size(); h++) {
+            const size_t begin = hardStarts[h];
+            const size_t end = hardStarts[h + 1];
+
+            clusterStarts.push_back(begin);
+            //advancing time past the cache size evicts everything
+            time += CACHE_SIZE + 1;
+            uint32_t runningMisses = 0;
+            size_t runningCount = 0;
+            for (size_t t = begin; t + 1 < end; t++) {
+               runningMisses += simulateTriangle(&indices[3 * t], cacheTime, time, CACHE_SIZE);
+               runningCount++;
+               if (static_cast<float>(runningMisses) / runningCount <= threshold * meshAcmr) {
+                  clusterStarts.push_back(t + 1);
+                  time += CACHE_SIZE + 1;
+                  runningMisses = 0;
+                  runningCount = 0;
+               }
+            }
+         }
+      }
+      clusterStarts.push_back(triangleCount);
+
+      //center of the mesh bounds, the reference point for "facing outwards"
+      glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+      glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+      for (uint32_t index : indices) {
+         boundsMin = glm::min(boundsMin, position(index));
+         boundsMax = glm::max(boundsMax, position(index));
+      }
+      const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+
+      //area weighted centroid and normal per cluster, sorted by how far the cluster faces away from the center
+      const size_t clusterCount = clusterStarts.size() - 1;
+      std::vector<float> sortKeys(clusterCount);
+      for (size_t c = 0; c < clusterCount; c++) {
+         glm::vec3 centroid{0.f};
+         glm::vec3 normal{0.f};
+         float area = 0.f;
+         for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+            const glm::vec3 &p0 = position(indices[3 * t + 0]);
+            const glm::vec3 &p1 = position(indices[3 * t + 1]);
+            const glm::vec3 &p2 = position(indices[3 * t + 2]);
+            const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            const float triangleArea = glm::length(cross);
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.f);
+            normal += cross;
+            area += triangleArea;
+         }
+
+         const float normalLength = glm::length(normal);
+         if (area > 0.f && normalLength > 0.f) {
+            sortKeys[c] = glm::dot(centroid / area - center, normal / normalLength);
+         } else {
+            sortKeys[c] = 0.f;
+         }
+      }
+
+      std::vector<size_t> order(clusterCount);
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+      std::vector<uint32_t> output{};
+      output.reserve(indices.size());
+      for (size_t c : order) {
+         output.insert(output.end(), indices.begin() + 3 * clusterStarts[c], indices.begin() + 3 * clusterStarts[c + 1]);
+      }
+      indices.swap(output);
+   }
+
+   std::vector<uint32_t> LveMeshOptimizer::buildFetchRemap(const std::vector<uint32_t> &indices, size_t vertexCount) {
+      std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+      uint32_t next = 0;
+      for (uint32_t index : indices) {
+         if (remap[index] == UINT32_MAX) remap[index] = next++;
+      }
+      return remap;
+   }
+
+   size_t LveMeshOptimizer::fetchCount(const std::vector<uint32_t> &remap) {
+      return static_cast<size_t>(std::count_if(remap.begin(), remap.end(), [](uint32_t index) { return index != UINT32_MAX; }));
+   }
+}
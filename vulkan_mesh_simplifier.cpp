@@ -0,0 +1,365 @@
+#include "vulkan_mesh_simplifier.hpp"
+#include "vulkan_vertex_welder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+
+namespace lve {
+
+   namespace {
+      //symmetric 4x4 matrix of the summed squared plane distances, plus the summed plane weights so costs come out as mean squared distances
+      struct Quadric {
+         double aa = 0, ab = 0, ac = 0, ad = 0;
+         double bb = 0, bc = 0, bd = 0;
+         double cc = 0, cd = 0;
+         double dd = 0;
+         double weight = 0;
+
+         void addPlane(double a, double b, double c, double d, double planeWeight) {
+            aa += planeWeight * a * a; ab += planeWeight * a * b; ac += planeWeight * a * c; ad += planeWeight * a * d;
+            bb += planeWeight * b * b; bc += planeWeight * b * c; bd += planeWeight * b * d;
+            cc += planeWeight * c * c; cd += planeWeight * c * d;
+            dd += planeWeight * d * d;
+            weight += planeWeight;
+         }
+
+         void add(const Quadric &other) {
+            aa += other.aa; ab += other.ab; ac += other.ac; ad += other.ad;
+            bb += other.bb; bc += other.bc; bd += other.bd;
+            cc += other.cc; cd += other.cd;
+            dd += other.dd;
+            weight += other.weight;
+         }
+
+         //mean squared distance of p to the planes
+         double evaluate(const glm::vec3 &p) const {
+            if (weight <= 0) return 0;
+            const double x = p.x, y = p.y, z = p.z;
+            const double error =
+               aa * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+               bb * y * y + 2 * bc * y * z + 2 * bd * y +
+               cc * z * z + 2 * cd * z +
+               dd;
+            return std::max(error, 0.0) / weight;
+         }
+      };
+
+      struct Collapse {
+         double cost;
+         uint32_t from;
+         uint32_t to;
+         //the quadrics the cost was computed from, stale once either endpoint changed
+         uint32_t fromStamp;
+         uint32_t toStamp;
+
+         bool operator>(const Collapse &other) const { return cost > other.cost; }
+      };
+
+   }
+
+   std::vector<uint32_t> LveMeshSimplifier::simplify(
+      const std::vector<uint32_t> &indices,
+      const glm::vec3 *positions,
+      const glm::vec3 *normals,
+      size_t stride,
+      size_t vertexCount,
+      size_t targetIndexCount,
+      float maxError,
+      float *resultError,
+      const uint32_t *triangleGroups,
+      std::vector<uint32_t> *resultGroups) {
+      if (resultError) *resultError = 0.f;
+      if (resultGroups) resultGroups->clear();
+      if (indices.size() <= targetIndexCount) {
+         if (resultGroups && triangleGroups) resultGroups->assign(triangleGroups, triangleGroups + indices.size() / 3);
+         return indices;
+      }
+
+      auto vertexPosition = [positions, stride](uint32_t v) -> const glm::vec3 & {
+         return *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const char *>(positions) + v * stride);
+      };
+      auto vertexNormal = [normals, stride](uint32_t v) -> const glm::vec3 & {
+         return *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const char *>(normals) + v * stride);
+      };
+
+      //collapses work on positions: vertices that only differ in normal or uv (seams, flat shading) move together
+      std::vector<glm::vec3> points{};
+      std::vector<uint32_t> pointOf(vertexCount);
+      {
+         LveVertexWelder<glm::vec3> welder{vertexCount};
+         for (uint32_t v = 0; v < vertexCount; v++) {
+            pointOf[v] = welder.weld(vertexPosition(v), points);
+         }
+      }
+      const size_t pointCount = points.size();
+
+      //corners keep vertex indices, points are looked up through pointOf
+      std::vector<uint32_t> corners = indices;
+      const size_t triangleCount = corners.size() / 3;
+      auto point = [&](size_t t, int k) { return pointOf[corners[3 * t + k]]; };
+
+      std::vector<char> dead(triangleCount, 0);
+      std::vector<std::vector<uint32_t>> trianglesAround(pointCount);
+      size_t liveTriangles = 0;
+      for (size_t t = 0; t < triangleCount; t++) {
+         //zero area after welding, these draw nothing
+         if (point(t, 0) == point(t, 1) || point(t, 1) == point(t, 2) || point(t, 0) == point(t, 2)) {
+            dead[t] = 1;
+            continue;
+         }
+         for (int k = 0; k < 3; k++) trianglesAround[point(t, k)].push_back(static_cast<uint32_t>(t));
+         liveTriangles++;
+      }
+
+      //open edges belong to one triangle, non-manifold edges to more than two. Non-manifold points never move
+      auto edgeUses = [&](uint32_t a, uint32_t b) {
+         uint32_t uses = 0;
+         for (uint32_t t : trianglesAround[a]) {
+            if (!dead[t] && (point(t, 0) == b || point(t, 1) == b || point(t, 2) == b)) uses++;
+         }
+         return uses;
+      };
+      //true if the triangles on the edge belong to different groups
+      auto crossesGroups = [&](uint32_t a, uint32_t b) {
+         if (!triangleGroups) return false;
+         uint32_t group = UINT32_MAX;
+         for (uint32_t t : trianglesAround[a]) {
+            if (dead[t] || (point(t, 0) != b && point(t, 1) != b && point(t, 2) != b)) continue;
+            if (group == UINT32_MAX) group = triangleGroups[t];
+            else if (triangleGroups[t] != group) return true;
+         }
+         return false;
+      };
+
+      std::vector<char> border(pointCount, 0);
+      std::vector<char> locked(pointCount, 0);
+      std::vector<Quadric> quadrics(pointCount);
+      for (size_t t = 0; t < triangleCount; t++) {
+         if (dead[t]) continue;
+         const glm::vec3 &p0 = points[point(t, 0)];
+         const glm::vec3 &p1 = points[point(t, 1)];
+         const glm::vec3 &p2 = points[point(t, 2)];
+         const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+         const float length = glm::length(cross);
+         if (length <= 0.f) continue;
+         const glm::vec3 normal = cross / length;
+
+         //weighted by area, so large faces dominate small ones around the same point
+         Quadric face{};
+         face.addPlane(normal.x, normal.y, normal.z, -glm::dot(normal, p0), 0.5 * length);
+         for (int k = 0; k < 3; k++) quadrics[point(t, k)].add(face);
+
+         for (int k = 0; k < 3; k++) {
+            const uint32_t a = point(t, k);
+            const uint32_t b = point(t, (k + 1) % 3);
+            const uint32_t uses = edgeUses(a, b);
+            if (uses > 2) {
+               locked[a] = locked[b] = 1;
+            } else if (uses == 1 || crossesGroups(a, b)) {
+               border[a] = border[b] = 1;
+               //plane through the edge, perpendicular to the face: moving along the border is cheap, moving off it is not
+               const glm::vec3 edge = points[b] - points[a];
+               const glm::vec3 edgeNormal = glm::cross(edge, normal);
+               const float edgeLength = glm::length(edgeNormal);
+               if (edgeLength <= 0.f) continue;
+               const glm::vec3 planeNormal = edgeNormal / edgeLength;
+               Quadric borderPlane{};
+               borderPlane.addPlane(planeNormal.x, planeNormal.y, planeNormal.z, -glm::dot(planeNormal, points[a]), glm::dot(edge, edge) * BORDER_WEIGHT);
+               quadrics[a].add(borderPlane);
+               quadrics[b].add(borderPlane);
+            }
+         }
+      }
+
+      //where three groups meet, sliding along one group border would drag the third group's outline along
+      if (triangleGroups) {
+         std::vector<uint32_t> groups{};
+         for (uint32_t p = 0; p < pointCount; p++) {
+            groups.clear();
+            for (uint32_t t : trianglesAround[p]) groups.push_back(triangleGroups[t]);
+            std::sort(groups.begin(), groups.end());
+            if (std::unique(groups.begin(), groups.end()) - groups.begin() > 2) locked[p] = 1;
+         }
+      }
+
+      std::vector<uint32_t> stamps(pointCount, 0);
+      std::vector<char> collapsed(pointCount, 0);
+      std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue{};
+
+      std::vector<uint32_t> fromNeighbours{};
+      std::vector<uint32_t> toNeighbours{};
+      auto gatherNeighbours = [&](uint32_t p, std::vector<uint32_t> &neighbours) {
+         neighbours.clear();
+         for (uint32_t t : trianglesAround[p]) {
+            if (dead[t]) continue;
+            for (int k = 0; k < 3; k++) {
+               if (point(t, k) != p) neighbours.push_back(point(t, k));
+            }
+         }
+         std::sort(neighbours.begin(), neighbours.end());
+         neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+      };
+
+      //one queue entry per edge, in whichever direction is allowed and cheaper
+      auto pushEdge = [&](uint32_t a, uint32_t b) {
+         auto allowed = [&](uint32_t from, uint32_t to) { return !locked[from] && (!border[from] || border[to]); };
+         auto cost = [&](uint32_t from, uint32_t to) {
+            Quadric merged = quadrics[from];
+            merged.add(quadrics[to]);
+            return merged.evaluate(points[to]);
+         };
+         const bool ab = allowed(a, b);
+         const bool ba = allowed(b, a);
+         if (!ab && !ba) return;
+         const double costAB = ab ? cost(a, b) : 0;
+         const double costBA = ba ? cost(b, a) : 0;
+         if (ab && (!ba || costAB <= costBA)) {
+            queue.push({costAB, a, b, stamps[a], stamps[b]});
+         } else {
+            queue.push({costBA, b, a, stamps[b], stamps[a]});
+         }
+      };
+      std::vector<uint32_t> neighbours{};
+      auto pushEdgesAround = [&](uint32_t p, bool onlyGreater) {
+         gatherNeighbours(p, neighbours);
+         for (uint32_t other : neighbours) {
+            if (!onlyGreater || other > p) pushEdge(p, other);
+         }
+      };
+
+      for (uint32_t p = 0; p < pointCount; p++) {
+         pushEdgesAround(p, true);
+      }
+
+      //topology and geometry checks that depend on the current state of the mesh, not just on the two quadrics
+      auto canCollapse = [&](uint32_t from, uint32_t to) {
+         const uint32_t shared = edgeUses(from, to);
+         //no longer an edge
+         if (shared == 0) return false;
+         //border points only slide along their own border, or along the one between their groups
+         if (border[from] && shared != 1 && !crossesGroups(from, to)) return false;
+
+         //link condition: the only points next to both ends are the tips of the triangles on the edge, anything else would pinch the surface
+         gatherNeighbours(from, fromNeighbours);
+         gatherNeighbours(to, toNeighbours);
+         size_t common = 0;
+         for (size_t i = 0, j = 0; i < fromNeighbours.size() && j < toNeighbours.size();) {
+            if (fromNeighbours[i] < toNeighbours[j]) i++;
+            else if (fromNeighbours[i] > toNeighbours[j]) j++;
+            else { common++; i++; j++; }
+         }
+         if (common > shared) return false;
+
+         //no triangle that survives may flip or turn sharply
+         for (uint32_t t : trianglesAround[from]) {
+            if (dead[t]) continue;
+            glm::vec3 before[3];
+            glm::vec3 after[3];
+            bool hasTo = false;
+            for (int k = 0; k < 3; k++) {
+               const uint32_t p = point(t, k);
+               hasTo = hasTo || p == to;
+               before[k] = points[p];
+               after[k] = p == from ? points[to] : points[p];
+            }
+            if (hasTo) continue;
+            const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if (glm::dot(normalBefore, normalAfter) <= 0.2f * glm::length(normalBefore) * glm::length(normalAfter)) return false;
+         }
+         return true;
+      };
+
+      std::vector<std::pair<uint32_t, uint32_t>> vertexMap{};
+      std::vector<uint32_t> toVertices{};
+      auto collapse = [&](uint32_t from, uint32_t to) {
+         //vertices of `to` that corners of `from` can move to: the corner across the collapsed edge if there is one, else the closest normal
+         vertexMap.clear();
+         toVertices.clear();
+         for (uint32_t t : trianglesAround[to]) {
+            if (dead[t]) continue;
+            for (int k = 0; k < 3; k++) {
+               if (point(t, k) == to) toVertices.push_back(corners[3 * t + k]);
+            }
+         }
+         std::sort(toVertices.begin(), toVertices.end());
+         toVertices.erase(std::unique(toVertices.begin(), toVertices.end()), toVertices.end());
+
+         for (uint32_t t : trianglesAround[from]) {
+            if (dead[t]) continue;
+            int fromCorner = -1, toCorner = -1;
+            for (int k = 0; k < 3; k++) {
+               if (point(t, k) == from) fromCorner = k;
+               if (point(t, k) == to) toCorner = k;
+            }
+            if (toCorner < 0) continue;
+            vertexMap.push_back({corners[3 * t + fromCorner], corners[3 * t + toCorner]});
+            dead[t] = 1;
+            liveTriangles--;
+         }
+
+         for (uint32_t t : trianglesAround[from]) {
+            if (dead[t]) continue;
+            for (int k = 0; k < 3; k++) {
+               if (point(t, k) != from) continue;
+               const uint32_t vertex = corners[3 * t + k];
+               uint32_t target = vertexMap.front().second;
+               auto mapped = std::find_if(vertexMap.begin(), vertexMap.end(), [vertex](const auto &pair) { return pair.first == vertex; });
+               if (mapped != vertexMap.end()) {
+                  target = mapped->second;
+               } else if (normals) {
+                  float best = -2.f;
+                  for (uint32_t candidate : toVertices) {
+                     const float similarity = glm::dot(vertexNormal(vertex), vertexNormal(candidate));
+                     if (similarity > best) {
+                        best = similarity;
+                        target = candidate;
+                     }
+                  }
+               }
+               corners[3 * t + k] = target;
+            }
+            trianglesAround[to].push_back(t);
+         }
+
+         quadrics[to].add(quadrics[from]);
+         collapsed[from] = 1;
+         trianglesAround[from].clear();
+
+         auto &around = trianglesAround[to];
+         around.erase(std::remove_if(around.begin(), around.end(), [&dead](uint32_t t) { return dead[t] != 0; }), around.end());
+         //every edge around `to` changed cost, and its old entries are stale now
+         stamps[to]++;
+         pushEdgesAround(to, false);
+      };
+
+      const double maxCost = static_cast<double>(maxError) * maxError;
+      double largestCost = 0;
+      while (liveTriangles * 3 > targetIndexCount && !queue.empty()) {
+         const Collapse candidate = queue.top();
+         queue.pop();
+
+         if (collapsed[candidate.from] || collapsed[candidate.to]) continue;
+         if (stamps[candidate.from] != candidate.fromStamp || stamps[candidate.to] != candidate.toStamp) continue;
+         //the queue is ordered by cost, everything after this is too expensive as well
+         if (candidate.cost > maxCost) break;
+         if (!canCollapse(candidate.from, candidate.to)) continue;
+
+         collapse(candidate.from, candidate.to);
+         largestCost = std::max(largestCost, candidate.cost);
+      }
+
+      std::vector<uint32_t> result{};
+      result.reserve(liveTriangles * 3);
+      for (size_t t = 0; t < triangleCount; t++) {
+         if (dead[t]) continue;
+         result.insert(result.end(), {corners[3 * t + 0], corners[3 * t + 1], corners[3 * t + 2]});
+         if (resultGroups && triangleGroups) resultGroups->push_back(triangleGroups[t]);
+      }
+
+      if (resultError) *resultError = static_cast<float>(std::sqrt(largestCost));
+      return result;
+   }
+}
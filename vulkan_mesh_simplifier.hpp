@@ -0,0 +1,39 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+   //quadric error metric edge collapse (Garland, Heckbert 1997), used to build LOD levels.
+   //vertices only ever collapse onto existing vertices, so every level indexes into the original vertex buffer
+   class LveMeshSimplifier {
+      public:
+      //border edges get a perpendicular plane this many times stronger than a regular face, so open outlines keep their shape
+      static constexpr float BORDER_WEIGHT = 10.f;
+
+      //collapses edges, cheapest first, until at most targetIndexCount indices are left or the next collapse would move the
+      //surface further than maxError (object space units, RMS distance to the original planes).
+      //positions and normals are read from stride byte steps. normals may be nullptr, they only decide which vertex of an
+      //attribute seam (same position, different normal/uv) a corner moves to.
+      //resultError receives the largest error of any collapse that was made.
+      //triangleGroups (one per triangle, e.g. the material) keeps groups apart: edges between two groups are treated like borders,
+      //and points where more than two groups meet never move. Surviving triangles keep their order, so groups sorted on the way in
+      //are still sorted on the way out, and resultGroups receives the group of each of them
+      static std::vector<uint32_t> simplify(
+         const std::vector<uint32_t> &indices,
+         const glm::vec3 *positions,
+         const glm::vec3 *normals,
+         size_t stride,
+         size_t vertexCount,
+         size_t targetIndexCount,
+         float maxError,
+         float *resultError = nullptr,
+         const uint32_t *triangleGroups = nullptr,
+         std::vector<uint32_t> *resultGroups = nullptr);
+   };
+}
@@ -0,0 +1,244 @@
+#include "vulkan_meshlets.hpp"
+#include "vulkan_vertex_welder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lve {
+
+   namespace {
+      //bounding sphere around the center of the meshlet's bounds, and the narrowest cone around the average face normal
+      void computeBounds(LveModel::Meshlet &meshlet, const std::vector<uint32_t> &indices, const glm::vec3 *positions, size_t stride) {
+         auto position = [positions, stride](uint32_t v) -> const glm::vec3 & {
+            return *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const char *>(positions) + v * stride);
+         };
+
+         const uint32_t begin = meshlet.firstIndex;
+         const uint32_t end = begin + meshlet.triangleCount * 3;
+
+         glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+         glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+         for (uint32_t i = begin; i < end; i++) {
+            boundsMin = glm::min(boundsMin, position(indices[i]));
+            boundsMax = glm::max(boundsMax, position(indices[i]));
+         }
+         meshlet.center = (boundsMin + boundsMax) * 0.5f;
+         meshlet.radius = 0.f;
+         for (uint32_t i = begin; i < end; i++) {
+            meshlet.radius = std::max(meshlet.radius, glm::length(position(indices[i]) - meshlet.center));
+         }
+
+         //unit normals, so large and small triangles count the same when averaging
+         std::vector<glm::vec3> normals{};
+         glm::vec3 axis{0.f};
+         for (uint32_t i = begin; i < end; i += 3) {
+            const glm::vec3 &p0 = position(indices[i + 0]);
+            const glm::vec3 &p1 = position(indices[i + 1]);
+            const glm::vec3 &p2 = position(indices[i + 2]);
+            const glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+            const float length = glm::length(cross);
+            if (length <= 0.f) continue;
+            normals.push_back(cross / length);
+            axis += normals.back();
+         }
+
+         //no cone: the normals spread over more than a hemisphere, or there are no usable triangles
+         meshlet.coneAxis = glm::vec3{0.f, 0.f, 1.f};
+         meshlet.coneCos = 0.f;
+         meshlet.coneSin = 1.f;
+         const float axisLength = glm::length(axis);
+         if (normals.empty() || axisLength <= 0.f) return;
+
+         meshlet.coneAxis = axis / axisLength;
+         float minimum = 1.f;
+         for (const auto &normal : normals) {
+            minimum = std::min(minimum, glm::dot(normal, meshlet.coneAxis));
+         }
+         if (minimum <= 0.f) return;
+
+         meshlet.coneCos = minimum;
+         meshlet.coneSin = std::sqrt(std::max(0.f, 1.f - minimum * minimum));
+      }
+   }
+
+   std::vector<LveModel::Meshlet> LveMeshletBuilder::build(
+      std::vector<uint32_t> &indices,
+      uint32_t indexCount,
+      const glm::vec3 *positions,
+      size_t stride,
+      size_t vertexCount) {
+      std::vector<LveModel::Meshlet> meshlets{};
+      const uint32_t triangleCount = indexCount / 3;
+      if (triangleCount == 0) return meshlets;
+
+      auto position = [positions, stride](uint32_t v) -> const glm::vec3 & {
+         return *reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const char *>(positions) + v * stride);
+      };
+
+      //neighbouring triangles by position: flat shaded meshes share no vertices between faces
+      std::vector<glm::vec3> points{};
+      std::vector<uint32_t> pointOf(vertexCount);
+      {
+         LveVertexWelder<glm::vec3> welder{vertexCount};
+         for (uint32_t v = 0; v < vertexCount; v++) {
+            pointOf[v] = welder.weld(position(v), points);
+         }
+      }
+
+      //triangles around each point, one flat array with per-point ranges
+      std::vector<uint32_t> offsets(points.size() + 1, 0);
+      for (uint32_t i = 0; i < indexCount; i++) offsets[pointOf[indices[i]] + 1]++;
+      for (size_t p = 0; p < points.size(); p++) offsets[p + 1] += offsets[p];
+      std::vector<uint32_t> around(indexCount);
+      {
+         std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+         for (uint32_t i = 0; i < indexCount; i++) around[fill[pointOf[indices[i]]]++] = i / 3;
+      }
+
+      std::vector<char> emitted(triangleCount, 0);
+      //per vertex / triangle: id + 1 of the last meshlet that used it, so nothing has to be cleared between meshlets
+      std::vector<uint32_t> vertexStamp(vertexCount, 0);
+      std::vector<uint32_t> candidateStamp(triangleCount, 0);
+      std::vector<uint32_t> candidates{};
+      std::vector<uint32_t> output{};
+      output.reserve(indexCount);
+
+      uint32_t cursor = 0;
+      while (true) {
+         while (cursor < triangleCount && emitted[cursor]) cursor++;
+         if (cursor == triangleCount) break;
+
+         const uint32_t stamp = static_cast<uint32_t>(meshlets.size()) + 1;
+         LveModel::Meshlet meshlet{};
+         meshlet.firstIndex = static_cast<uint32_t>(output.size());
+         candidates.clear();
+
+         auto newVertices = [&](uint32_t t) {
+            uint32_t count = 0;
+            for (int k = 0; k < 3; k++) {
+               const uint32_t v = indices[3 * t + k];
+               //a triangle can use the same vertex twice, count it once
+               bool repeated = false;
+               for (int j = 0; j < k; j++) repeated = repeated || indices[3 * t + j] == v;
+               if (vertexStamp[v] != stamp && !repeated) count++;
+            }
+            return count;
+         };
+
+         uint32_t next = cursor;
+         while (true) {
+            emitted[next] = 1;
+            for (int k = 0; k < 3; k++) {
+               const uint32_t v = indices[3 * next + k];
+               if (vertexStamp[v] != stamp) {
+                  vertexStamp[v] = stamp;
+                  meshlet.vertexCount++;
+               }
+               output.push_back(v);
+
+               const uint32_t p = pointOf[v];
+               for (uint32_t a = offsets[p]; a < offsets[p + 1]; a++) {
+                  const uint32_t t = around[a];
+                  if (!emitted[t] && candidateStamp[t] != stamp) {
+                     candidateStamp[t] = stamp;
+                     candidates.push_back(t);
+                  }
+               }
+            }
+            meshlet.triangleCount++;
+            if (meshlet.triangleCount == MAX_TRIANGLES) break;
+
+            //the neighbour adding the fewest vertices, earliest found on ties so the meshlet stays compact
+            uint32_t best = UINT32_MAX;
+            uint32_t bestCost = UINT32_MAX;
+            size_t live = 0;
+            for (size_t c = 0; c < candidates.size(); c++) {
+               const uint32_t t = candidates[c];
+               if (emitted[t]) continue;
+               candidates[live++] = t;
+               const uint32_t cost = newVertices(t);
+               if (cost < bestCost) {
+                  bestCost = cost;
+                  best = t;
+               }
+            }
+            candidates.resize(live);
+
+            if (best == UINT32_MAX || meshlet.vertexCount + bestCost > MAX_VERTICES) break;
+            next = best;
+         }
+
+         computeBounds(meshlet, output, positions, stride);
+         meshlets.push_back(meshlet);
+      }
+
+      std::copy(output.begin(), output.end(), indices.begin());
+      return meshlets;
+   }
+
+   LveFrustum LveFrustum::fromMatrix(const glm::mat4 &matrix) {
+      //glm is column major: row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+      auto row = [&matrix](int i) { return glm::vec4{matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]}; };
+
+      LveFrustum frustum{};
+      frustum.planes[0] = row(3) + row(0);
+      frustum.planes[1] = row(3) - row(0);
+      frustum.planes[2] = row(3) + row(1);
+      frustum.planes[3] = row(3) - row(1);
+      //depth goes from 0 to 1, not -1 to 1 like opengl
+      frustum.planes[4] = row(2);
+      frustum.planes[5] = row(3) - row(2);
+
+      for (auto &plane : frustum.planes) {
+         const float length = glm::length(glm::vec3{plane});
+         if (length > 0.f) plane /= length;
+      }
+      return frustum;
+   }
+
+   bool LveFrustum::intersectsSphere(const glm::vec3 &center, float radius) const {
+      for (const auto &plane : planes) {
+         if (glm::dot(glm::vec3{plane}, center) + plane.w < -radius) return false;
+      }
+      return true;
+   }
+
+   bool LveMeshletCuller::isBackFacing(const LveModel::Meshlet &meshlet, const glm::vec3 &cameraPosition) {
+      if (meshlet.coneCos <= 0.f) return false;
+
+      //a triangle faces away if its normal points away from the camera. With the normals within the cone's half angle a of the axis and the axis
+      //at angle b to the direction from the camera to the center, every normal is within a + b of that direction, and the sphere
+      //is entirely on the far side if distance * cos(a + b) > radius
+      const glm::vec3 direction = meshlet.center - cameraPosition;
+      const float distance = glm::length(direction);
+      if (distance <= meshlet.radius) return false;
+
+      const float cosB = glm::dot(direction, meshlet.coneAxis) / distance;
+      const float sinB = std::sqrt(std::max(0.f, 1.f - cosB * cosB));
+      return distance * (meshlet.coneCos * cosB - meshlet.coneSin * sinB) > meshlet.radius;
+   }
+
+   void LveMeshletCuller::cull(
+      const LveModel::Meshlet *meshlets,
+      size_t meshletCount,
+      const LveFrustum &frustum,
+      const glm::vec3 &cameraPosition,
+      bool coneCulling,
+      std::vector<DrawRange> &ranges) {
+      const size_t firstRange = ranges.size();
+      for (size_t i = 0; i < meshletCount; i++) {
+         const LveModel::Meshlet &meshlet = meshlets[i];
+         if (!frustum.intersectsSphere(meshlet.center, meshlet.radius)) continue;
+         if (coneCulling && isBackFacing(meshlet, cameraPosition)) continue;
+
+         //meshlets are stored back to back, so visible neighbours become one draw
+         const uint32_t indexCount = meshlet.triangleCount * 3;
+         if (ranges.size() > firstRange && ranges.back().firstIndex + ranges.back().indexCount == meshlet.firstIndex) {
+            ranges.back().indexCount += indexCount;
+         } else {
+            ranges.push_back({meshlet.firstIndex, indexCount});
+         }
+      }
+   }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "vulkan_model.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+   class LveMeshletBuilder {
+      public:
+      static constexpr uint32_t MAX_VERTICES = 64;
+      static constexpr uint32_t MAX_TRIANGLES = 124;
+
+      //reorders the triangles in indices[0, indexCount) so that every meshlet is one consecutive range, and returns the meshlets.
+      //meshlets grow across neighbouring triangles (by position, so flat shaded meshes cluster too) preferring triangles that add the fewest new vertices.
+      //positions are read from stride byte steps
+      static std::vector<LveModel::Meshlet> build(
+         std::vector<uint32_t> &indices,
+         uint32_t indexCount,
+         const glm::vec3 *positions,
+         size_t stride,
+         size_t vertexCount);
+   };
+
+   //6 planes (left, right, bottom, top, near, far) pointing inwards, normalized so distances come out in the space the matrix maps from
+   struct LveFrustum {
+      glm::vec4 planes[6];
+
+      //Gribb / Hartmann plane extraction for a clip space with depth between 0 and 1.
+      //pass projection * view for world space planes, projection * view * model for object space planes
+      static LveFrustum fromMatrix(const glm::mat4 &matrix);
+
+      bool intersectsSphere(const glm::vec3 &center, float radius) const;
+   };
+
+   class LveMeshletCuller {
+      public:
+      struct DrawRange {
+         uint32_t firstIndex;
+         uint32_t indexCount;
+      };
+
+      //appends the index ranges of the visible meshlets to ranges, merging neighbours into one range.
+      //everything is tested in object space: the frustum comes from projection * view * model and cameraPosition is the camera's position
+      //transformed by the inverse model matrix, which keeps both tests exact under non uniform scale.
+      //coneCulling drops meshlets whose triangles all face away from the camera. Only valid if back faces are culled or hidden anyway
+      static void cull(
+         const std::vector<LveModel::Meshlet> &meshlets,
+         const LveFrustum &frustum,
+         const glm::vec3 &cameraPosition,
+         bool coneCulling,
+         std::vector<DrawRange> &ranges) {
+         cull(meshlets.data(), meshlets.size(), frustum, cameraPosition, coneCulling, ranges);
+      }
+      //same for meshletCount meshlets from meshlets on, e.g. the ones of one submesh
+      static void cull(
+         const LveModel::Meshlet *meshlets,
+         size_t meshletCount,
+         const LveFrustum &frustum,
+         const glm::vec3 &cameraPosition,
+         bool coneCulling,
+         std::vector<DrawRange> &ranges);
+
+      //true if every triangle of the meshlet faces away from a camera at cameraPosition
+      static bool isBackFacing(const LveModel::Meshlet &meshlet, const glm::vec3 &cameraPosition);
+   };
+}
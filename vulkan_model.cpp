@@ -1,229 +1,965 @@
 #include "vulkan_model.hpp"
-#include "vulkan_utils.hpp"
-
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader.h>
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
+#include "vulkan_geometry_arena.hpp"
+#include "vulkan_gltf_loader.hpp"
+#include "vulkan_host_import.hpp"
+#include "vulkan_mesh_cache.hpp"
+#include "vulkan_mesh_optimizer.hpp"
+#include "vulkan_mesh_simplifier.hpp"
+#include "vulkan_meshlets.hpp"
+#include "vulkan_obj_loader.hpp"
+#include "vulkan_staging_ring.hpp"
+#include "vulkan_swap_chain.hpp"
+#include "vulkan_upload_batch.hpp"
+#include "vulkan_vertex_quantizer.hpp"
+#include "vulkan_vertex_welder.hpp"
 
 #include <cassert>
+#include <cstdint>
 #include <cstring>
-#include <unordered_map>
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
 
-namespace std {
-   template<>
-   struct hash<lve::LveModel::Vertex> {
-      size_t operator()(lve::LveModel::Vertex const &vertex) const {
-         size_t seed = 0;
-         lve::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-         return seed;
+namespace lve {
+   namespace {
+      //data views the builder's arrays, which have to outlive it
+      void useBuilder(const LveModel::Builder &builder, LveModel::MeshData &data) {
+         data.vertices = builder.vertices.data();
+         data.vertexCount = static_cast<uint32_t>(builder.vertices.size());
+         data.indices = builder.indices.data();
+         data.indexCount = static_cast<uint32_t>(builder.indices.size());
+         data.lods = builder.lods.data();
+         data.lodCount = static_cast<uint32_t>(builder.lods.size());
+         data.meshlets = builder.meshlets.data();
+         data.meshletCount = static_cast<uint32_t>(builder.meshlets.size());
+         data.submeshes = builder.submeshes.data();
+         data.submeshCount = static_cast<uint32_t>(builder.submeshes.size());
       }
-   };
-}
 
-namespace lve {
-   LveModel::LveModel(LveDevice &device, const LveModel::Builder &builder) : lveDevice{device} {
-      createVertexBuffers(builder.vertices);
-      createIndexBuffers(builder.indices);
+      //submeshes of each level, the builder has a single level until generateLods ran
+      size_t builderSubmeshesPerLod(const LveModel::Builder &builder) {
+         return builder.submeshes.size() / std::max<size_t>(1, builder.lods.size());
+      }
+   }
+
+   LveModel::MeshData::MeshData() = default;
+   LveModel::MeshData::~MeshData() = default;
+   LveModel::MeshData::MeshData(MeshData &&) noexcept = default;
+   LveModel::MeshData &LveModel::MeshData::operator=(MeshData &&) noexcept = default;
+
+   LveModel::LveModel(LveDevice &device, const LveModel::Builder &builder, VertexFormat vertexFormat, LveUploadBatch *batch) 
+      : lveDevice{device}, vertexFormat{vertexFormat} {
+      MeshData data{};
+      useBuilder(builder, data);
+      create(data, batch, 0);
+   }
+
+   LveModel::LveModel(LveDevice &device, const MeshData &data, VertexFormat vertexFormat, LveUploadBatch *batch, uint32_t residentLods)
+      : lveDevice{device}, vertexFormat{vertexFormat} {
+      create(data, batch, residentLods);
+   }
+
+   LveModel::LveModel(
+      LveDevice &device,
+      const Vertex *vertices,
+      uint32_t vertexCount,
+      const uint32_t *indices,
+      uint32_t indexCount,
+      const Lod *lods,
+      uint32_t lodCount,
+      const Meshlet *meshlets,
+      uint32_t meshletCount,
+      VertexFormat vertexFormat,
+      LveUploadBatch *batch) 
+      : lveDevice{device}, vertexFormat{vertexFormat} {
+      //only the arrays, nothing to own
+      MeshData data{};
+      data.vertices = vertices;
+      data.vertexCount = vertexCount;
+      data.indices = indices;
+      data.indexCount = indexCount;
+      data.lods = lods;
+      data.lodCount = lodCount;
+      data.meshlets = meshlets;
+      data.meshletCount = meshletCount;
+      create(data, batch, 0);
+   }
+
+   LveModel::LveModel(LveDevice &device, const Builder &builder, VertexFormat vertexFormat, DynamicTag)
+      : lveDevice{device}, vertexFormat{vertexFormat} {
+      assert(builder.vertices.size() >= 3 && "Vertex count must be at least 3");
+      vertexCount = static_cast<uint32_t>(builder.vertices.size());
+      indexCount = static_cast<uint32_t>(builder.indices.size());
+      lods.push_back({0, indexCount, vertexCount, 0.f});
+      finestResidentLod = finestQueuedLod = 0;
+
+      glm::vec3 boundsMin = builder.vertices[0].position;
+      glm::vec3 boundsMax = boundsMin;
+      for (const auto &vertex : builder.vertices) {
+         boundsMin = glm::min(boundsMin, vertex.position);
+         boundsMax = glm::max(boundsMax, vertex.position);
+      }
+      setBounds(boundsMin, boundsMax);
+      createDynamicBuffers();
+
+      setVertices(0, builder.vertices.data(), vertexCount);
+      if (hasIndexBuffer) setIndices(0, builder.indices.data(), indexCount);
+      //every copy gets the initial contents right away, so the model can be drawn before its first updateDynamic like any other
+      LveUploadBatch batch{lveDevice};
+      for (auto &copy : dynamicCopies) {
+         auto writer = [&](VkBuffer buffer, LveAllocation &memory, const std::vector<unsigned char> &contents) -> RangeWriter {
+            if (memory.mapped != nullptr) {
+               return [&, buffer](VkDeviceSize offset, VkDeviceSize size) {
+                  memcpy(static_cast<char *>(memory.mapped) + offset, contents.data() + offset, static_cast<size_t>(size));
+                  lveDevice.flushMemory(memory, offset, size);
+               };
+            }
+            return [&, buffer](VkDeviceSize offset, VkDeviceSize size) { batch.add(contents.data() + offset, size, buffer, offset); };
+         };
+         takeDirtyRanges(
+            copy, writer(copy.vertexBuffer, copy.vertexMemory, dynamicVertices), writer(copy.indexBuffer, copy.indexMemory, dynamicIndices));
+      }
+   }
+
+   std::unique_ptr<LveModel> LveModel::createDynamic(LveDevice &device, const Builder &builder, VertexFormat vertexFormat) {
+      return std::unique_ptr<LveModel>(new LveModel(device, builder, vertexFormat, DynamicTag{}));
+   }
+
+   void LveModel::create(const MeshData &data, LveUploadBatch *batch, uint32_t residentLods) {
+      assert(data.vertexCount >= 3 && "Vertex count must be at least 3");
+
+      //without a LOD table the whole index buffer (or vertex buffer, if there are no indices) is the only level
+      if (data.lodCount > 0) {
+         lods.assign(data.lods, data.lods + data.lodCount);
+      } else {
+         lods.push_back({0, data.indexCount, data.vertexCount, 0.f});
+      }
+      meshlets.assign(data.meshlets, data.meshlets + data.meshletCount);
+      assert(data.submeshCount % lods.size() == 0 && "Every level needs the same submeshes");
+      submeshes.assign(data.submeshes, data.submeshes + data.submeshCount);
+      submeshesPerLod = data.submeshCount / static_cast<uint32_t>(lods.size());
+
+      glm::vec3 boundsMin = data.boundsMin;
+      glm::vec3 boundsMax = data.boundsMax;
+      if (!data.hasBounds) {
+         boundsMin = boundsMax = data.vertices[0].position;
+         for (uint32_t i = 1; i < data.vertexCount; i++) {
+            boundsMin = glm::min(boundsMin, data.vertices[i].position);
+            boundsMax = glm::max(boundsMax, data.vertices[i].position);
+         }
+      }
+      createVertexBuffers(data.vertexCount, boundsMin, boundsMax);
+      createIndexBuffers(data.indexCount);
+
+      //everything at once unless asked otherwise and the layout allows appending levels later
+      const uint32_t lodCount = static_cast<uint32_t>(lods.size());
+      if (residentLods == 0 || residentLods >= lodCount || !data.hasBounds ||
+         !isProgressive(lods.data(), lodCount, data.vertexCount, data.indexCount)) {
+         residentLods = lodCount;
+      }
+      finestResidentLod = finestQueuedLod = lodCount;
+
+      //without a batch the uploads go out in one submit right here
+      LveUploadBatch localBatch{lveDevice};
+      LveUploadBatch &uploads = batch != nullptr ? *batch : localBatch;
+      if (residentLods == lodCount) {
+         uploadVertices(data.vertices, 0, vertexCount, uploads, data.hostImport.get());
+         if (hasIndexBuffer) uploadIndices(data.indices, 0, indexCount, uploads, data.hostImport.get());
+         finestQueuedLod = 0;
+      } else {
+         while (finestQueuedLod > lodCount - residentLods) streamLod(data, uploads);
+      }
+      commitStreamedLods();
    }
 
    LveModel::~LveModel() {
-      vkDestroyBuffer(lveDevice.device(), vertexBuffer, nullptr);
-      vkFreeMemory(lveDevice.device(), vertexBufferMemory, nullptr);
+      if (isDynamic()) {
+         //vertexBuffer and indexBuffer are one of these
+         for (auto &copy : dynamicCopies) {
+            lveDevice.destroyBuffer(copy.vertexBuffer, copy.vertexMemory);
+            if (hasIndexBuffer) lveDevice.destroyBuffer(copy.indexBuffer, copy.indexMemory);
+         }
+         return;
+      }
 
-      if (hasIndexBuffer) {
-         vkDestroyBuffer(lveDevice.device(), indexBuffer, nullptr);
-         vkFreeMemory(lveDevice.device(), indexBufferMemory, nullptr);
+      LveGeometryArena &arena = lveDevice.geometryArena();
+      if (vertexRange != LveTlsf::INVALID) {
+         arena.freeVertices(vertexFormat, vertexRange);
+      } else {
+         lveDevice.destroyBuffer(vertexBuffer, vertexBufferMemory);
+      }
+
+      if (indexRange != LveTlsf::INVALID) {
+         arena.freeIndices(indexRange);
+      } else if (hasIndexBuffer) {
+         lveDevice.destroyBuffer(indexBuffer, indexBufferMemory);
       }
    }
 
-   std::unique_ptr<LveModel> LveModel::createModelFromFile(LveDevice &device, const std::string &filepath) {
-      Builder builder{};
+   std::unique_ptr<LveModel> LveModel::createModelFromFile(LveDevice &device, const std::string &filepath, VertexFormat vertexFormat) {
+      MeshData data{};
+      loadMeshData(filepath, data, true, device.hostImportAlignment() > 0 ? &vertexFormat : nullptr);
+      importMappedFile(device, data, vertexFormat);
+      return std::make_unique<LveModel>(device, data, vertexFormat);
+   }
+
+   void LveModel::importMappedFile(LveDevice &device, MeshData &data, VertexFormat vertexFormat) {
+      if (data.mappedFile == nullptr || data.hostImport != nullptr) return;
+      const VkDeviceSize bytes = importableBytes(vertexFormat, data.vertexCount, data.indexCount);
+      if (bytes < HOST_IMPORT_MIN_BYTES) return;
+      data.hostImport = LveHostImport::create(device, data.mappedFile);
+      if (data.hostImport) std::cout << "Host import: " << bytes / 1024 << " KiB uploaded straight from the mapped file\n";
+   }
+
+   VkDeviceSize LveModel::importableBytes(VertexFormat vertexFormat, uint32_t vertexCount, uint32_t indexCount) {
+      VkDeviceSize bytes = 0;
+      if (vertexFormat == VertexFormat::Float32) bytes += sizeof(Vertex) * VkDeviceSize{vertexCount};
+      //see createIndexBuffers
+      if (vertexCount > 65536) bytes += sizeof(uint32_t) * VkDeviceSize{indexCount};
+      return bytes;
+   }
+
+   void LveModel::loadMeshData(const std::string &filepath, MeshData &data, bool decodeAll, const VertexFormat *importFormat) {
+      if (std::filesystem::path(filepath).extension() == ".glb") {
+         data.gltf = std::make_unique<LveGltfFile>(filepath);
+         const auto &instances = data.gltf->instances();
+         if (instances.size() == 1 && instances[0].world == glm::mat4{1.f}) {
+            LveGltfFile::MappedMesh mapped{};
+            if (data.gltf->mapMesh(instances[0].mesh, mapped)) {
+               std::cout << "Vertex count: " << mapped.vertexCount << " (glb, mapped)\n";
+               //the vector's storage moves along, so a widened indices pointer stays valid
+               data.widenedIndices = std::move(mapped.widened);
+               data.vertices = mapped.vertices;
+               data.vertexCount = mapped.vertexCount;
+               data.indices = mapped.indices;
+               data.indexCount = mapped.indexCount;
+               data.mappedFile = data.gltf->mappedFile();
+               return;
+            }
+            data.gltf->appendMesh(instances[0].mesh, glm::mat4{1.f}, data.builder);
+            std::cout << "Vertex count: " << data.builder.vertices.size() << " (glb, converted)\n";
+         } else {
+            for (const auto &instance : instances) data.gltf->appendMesh(instance.mesh, instance.world, data.builder);
+            std::cout << "Vertex count: " << data.builder.vertices.size() << " (glb, flattened)\n";
+         }
+         useBuilder(data.builder, data);
+         return;
+      }
+
+      //warm path: the cache is mapped, decoded and copied into the staging buffers, no parsing or hashing
+      data.cache = std::make_shared<LveMeshCache>();
+      LveMeshCache &cache = *data.cache;
+      if (cache.open(filepath, decodeAll)) {
+         std::cout << "Vertex count: " << cache.vertexCount() << " (cached)\n";
+         const LveMeshCacheHeader &header = cache.header();
+         data.hasBounds = true;
+         data.boundsMin = {header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]};
+         data.boundsMax = {header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]};
+         data.sourceHash = header.sourceHash;
+         data.vertices = cache.vertices();
+         data.vertexCount = cache.vertexCount();
+         data.indices = cache.indices();
+         data.indexCount = cache.indexCount();
+         data.lods = cache.lods();
+         data.lodCount = cache.lodCount();
+         data.meshlets = cache.meshlets();
+         data.meshletCount = cache.meshletCount();
+         data.submeshes = cache.submeshes();
+         data.submeshCount = cache.submeshCount();
+         data.mappedFile = cache.mappedFile();
+         return;
+      }
+      data.cache.reset();
+
+      Builder &builder = data.builder;
       builder.loadModel(filepath);
+      //paid once, the cache stores the optimized order, the LOD levels and the meshlets
+      builder.optimize();
+      builder.generateLods();
+      builder.buildMeshlets();
+      builder.makeProgressive();
+
+      //failing to write the cache only costs the next startup, so don't fail the load over it.
+      //a source that only exists in the mounted archive has nowhere to put one
+      uint64_t sourceHash = 0;
+      if (std::filesystem::exists(filepath)) {
+         const bool raw = importFormat != nullptr &&
+            importableBytes(*importFormat, static_cast<uint32_t>(builder.vertices.size()), static_cast<uint32_t>(builder.indices.size())) >=
+               HOST_IMPORT_MIN_BYTES;
+         try {
+            sourceHash = LveMeshCache::write(filepath, builder, raw ? LveMeshEncoding::Raw : LveMeshEncoding::Codec);
+         } catch (const std::exception &e) {
+            std::cerr << "Failed to write mesh cache for " << filepath << ": " << e.what() << "\n";
+         }
+      }
 
       std::cout << "Vertex count: " << builder.vertices.size() << "\n";
-      return std::make_unique<LveModel>(device, builder);
+      useBuilder(builder, data);
+      data.hasBounds = !builder.vertices.empty();
+      if (data.hasBounds) {
+         data.boundsMin = data.boundsMax = builder.vertices[0].position;
+         for (const auto &vertex : builder.vertices) {
+            data.boundsMin = glm::min(data.boundsMin, vertex.position);
+            data.boundsMax = glm::max(data.boundsMax, vertex.position);
+         }
+      }
+      //writing the cache already hashed the source, only one that couldn't be cached is read again for it
+      data.sourceHash = sourceHash != 0 ? sourceHash : LveMeshCache::hashSource(filepath);
+   }
+
+   bool LveModel::isProgressive(const Lod *lods, uint32_t lodCount, uint32_t vertexCount, uint32_t indexCount) {
+      if (lodCount < 2) return false;
+      //coarsest first and back to back, each level using at least the vertices of the one before
+      uint32_t nextIndex = 0;
+      uint32_t usedVertices = 0;
+      for (uint32_t lod = lodCount; lod-- > 0;) {
+         if (lods[lod].firstIndex != nextIndex || lods[lod].vertexCount < usedVertices) return false;
+         nextIndex += lods[lod].indexCount;
+         usedVertices = lods[lod].vertexCount;
+      }
+      return nextIndex == indexCount && usedVertices == vertexCount;
+   }
+
+   VkDeviceSize LveModel::streamLod(const MeshData &data, LveUploadBatch &batch) {
+      assert(finestQueuedLod > 0 && "Every level is already queued");
+      const uint32_t lod = finestQueuedLod - 1;
+      //vertices and indices this level adds on top of the coarser ones
+      const uint32_t firstVertex = lod + 1 < lods.size() ? lods[lod + 1].vertexCount : 0;
+      const VkDeviceSize pendingBefore = batch.pendingBytes();
+      uploadVertices(data.vertices, firstVertex, lods[lod].vertexCount - firstVertex, batch, data.hostImport.get());
+      uploadIndices(data.indices, lods[lod].firstIndex, lods[lod].indexCount, batch, data.hostImport.get());
+      finestQueuedLod = lod;
+      return batch.pendingBytes() - pendingBefore;
    }
 
    //first stage buffer, then copy to local device memory
 
-   void LveModel::createVertexBuffers(const std::vector<Vertex> &vertices) {
-      vertexCount = static_cast<uint32_t>(vertices.size());
-      assert(vertexCount >= 3 && "Vertex count must be at least 3");
-      //total number of bytes required for vertex buffer to store all vertices
-      VkDeviceSize bufferSize = sizeof(vertices[0]) * vertexCount;
+   void LveModel::setBounds(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) {
+      this->boundsMin = boundsMin;
+      this->boundsMax = boundsMax;
+      boundsCenter = (boundsMin + boundsMax) * 0.5f;
+      boundsRadius = glm::length(boundsMax - boundsMin) * 0.5f;
+   }
 
-      VkBuffer stagingBuffer;
-      VkDeviceMemory stagingBufferMemory;
+   void LveModel::createVertexBuffers(uint32_t vertexCount, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax) {
+      this->vertexCount = vertexCount;
+      setBounds(boundsMin, boundsMax);
+
+      //one buffer for every stream, each stream packed and starting where the one before ends
+      VkDeviceSize bufferSize = 0;
+      streamCount = 0;
+      withVertexType(vertexFormat, [&](auto type) {
+         for (const auto &binding : LveVertexLayout<typename decltype(type)::type>::BINDINGS) {
+            streamOffsets[streamCount++] = bufferSize;
+            bufferSize += VkDeviceSize{binding.stride} * vertexCount;
+         }
+      });
+
+      //a range of the arena's buffer for the format if it has room. Its streams are laid out the same way, only bigger
+      LveGeometryArena &arena = lveDevice.geometryArena();
+      vertexRange = arena.allocateVertices(vertexFormat, vertexCount, baseVertex);
+      if (vertexRange != LveTlsf::INVALID) {
+         vertexBuffer = arena.getVertexBuffer(vertexFormat);
+         std::copy_n(arena.getStreamOffsets(vertexFormat), streamCount, streamOffsets);
+         memoryBytes += bufferSize;
+         return;
+      }
+      createDeviceLocalBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vertexBuffer, vertexBufferMemory);
+   }
 
-      lveDevice.createBuffer(
-         bufferSize, 
-         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-         //host: CPU, device: GPU 
-         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-         stagingBuffer, 
-         stagingBufferMemory);
-
-      void* data;
-      //creates region of host memory, maps to device memory, and sets data to point to beginning of mapped memory range
-      vkMapMemory(lveDevice.device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-      memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-      vkUnmapMemory(lveDevice.device(), stagingBufferMemory);
+   VkDeviceSize LveModel::getVertexStride(VertexFormat vertexFormat) {
+      return withVertexType(vertexFormat, [](auto type) {
+         VkDeviceSize stride = 0;
+         for (const auto &binding : LveVertexLayout<typename decltype(type)::type>::BINDINGS) stride += binding.stride;
+         return stride;
+      });
+   }
 
+   void LveModel::createIndexBuffers(uint32_t indexCount) {
+      this->indexCount = indexCount;
+      //if a non empty vector of indices is provided, use index buffer for rendering model
+      hasIndexBuffer = indexCount > 0;
+
+      if (!hasIndexBuffer) return;
+
+      //primitive restart is off, so 0xFFFF is an ordinary index and 65536 vertices still fit. Indices are relative to baseVertex
+      indexType = vertexCount <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+      LveGeometryArena &arena = lveDevice.geometryArena();
+      indexRange = arena.allocateIndices(indexType, indexCount, baseIndex);
+      if (indexRange != LveTlsf::INVALID) {
+         indexBuffer = arena.getIndexBuffer();
+         memoryBytes += indexSize() * indexCount;
+         return;
+      }
+      createDeviceLocalBuffer(indexSize() * indexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, indexBuffer, indexBufferMemory);
+   }
+
+   void LveModel::createDeviceLocalBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkBuffer &buffer, LveAllocation &memory) {
       lveDevice.createBuffer(
          bufferSize, 
-         VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+         usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-         vertexBuffer, 
-         vertexBufferMemory);
+         buffer, 
+         memory);
 
-         //move contents of staging buffer to vertex buffer
-      lveDevice.copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
+      //what the allocation actually takes, alignment and padding included
+      memoryBytes += memory.size;
+   }
 
-      vkDestroyBuffer(lveDevice.device(), stagingBuffer, nullptr);
-      vkFreeMemory(lveDevice.device(), stagingBufferMemory, nullptr);
+   void LveModel::uploadVertices(
+      const Vertex *vertices, uint32_t first, uint32_t count, LveUploadBatch &batch, const LveHostImport *source) {
+      if (count == 0) return;
+      //encoded vertices aren't in source, the batch stages those
+      encodeVertices(vertices + first, first, count, [&](const void *data, VkDeviceSize size, VkDeviceSize offset) {
+         batch.add(source, data, size, vertexBuffer, offset);
+      });
+   }
 
+   void LveModel::encodeVertices(const Vertex *vertices, uint32_t first, uint32_t count, const EncodedWriter &write) {
+      withVertexType(vertexFormat, [&](auto type) { encodeVerticesAs<typename decltype(type)::type>(vertices, first, count, write); });
    }
 
-   void LveModel::createIndexBuffers(const std::vector<uint32_t> &indices) {
-      indexCount = static_cast<uint32_t>(indices.size());
-      //if a non empty vector of indices is provided, use index buffer for rendering model
-      hasIndexBuffer = indexCount > 0;
+   template <typename V>
+   void LveModel::encodeVerticesAs(const Vertex *vertices, uint32_t first, uint32_t count, const EncodedWriter &write) {
+      using Layout = LveVertexLayout<V>;
+      if constexpr (std::is_same<V, Vertex>::value) {
+         write(vertices, sizeof(Vertex) * count, streamOffsets[0] + sizeof(Vertex) * (baseVertex + first));
+      } else if constexpr (std::size(Layout::BINDINGS) == 1) {
+         //the cache keeps full precision, so encoding happens on every upload. It is a single pass over the vertices,
+         //against the whole mesh's bounds so every part shares the one dequantization matrix
+         std::vector<V> encoded{};
+         dequantization = Layout::encode(vertices, count, boundsMin, boundsMax, encoded);
+         write(encoded.data(), sizeof(V) * count, streamOffsets[0] + sizeof(V) * (baseVertex + first));
+      } else {
+         //each stream gets its part at the same vertex offset
+         using Position = typename Layout::Position;
+         using Attributes = typename Layout::Attributes;
+         std::vector<Position> positions{};
+         std::vector<Attributes> attributes{};
+         dequantization = Layout::encode(vertices, count, boundsMin, boundsMax, positions, attributes);
+         write(positions.data(), sizeof(Position) * count, streamOffsets[0] + sizeof(Position) * (baseVertex + first));
+         write(attributes.data(), sizeof(Attributes) * count, streamOffsets[1] + sizeof(Attributes) * (baseVertex + first));
+      }
+   }
 
-      if (!hasIndexBuffer) return;
-      VkDeviceSize bufferSize = sizeof(indices[0]) * indexCount;
+   void LveModel::uploadIndices(
+      const uint32_t *indices, uint32_t first, uint32_t count, LveUploadBatch &batch, const LveHostImport *source) {
+      if (count == 0) return;
+      if (indexType == VK_INDEX_TYPE_UINT16) {
+         std::vector<uint16_t> narrowed(indices + first, indices + first + count);
+         batch.add(narrowed.data(), sizeof(uint16_t) * count, indexBuffer, sizeof(uint16_t) * (baseIndex + first));
+         return;
+      }
+      batch.add(source, indices + first, sizeof(uint32_t) * count, indexBuffer, sizeof(uint32_t) * (baseIndex + first));
+   }
+
+   void LveModel::createDynamicBuffers() {
+      hasIndexBuffer = indexCount > 0;
+      indexType = vertexCount <= 65536 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+      //laid out like a buffer of the model's own, never in the arena
+      VkDeviceSize vertexBytes = 0;
+      streamCount = 0;
+      withVertexType(vertexFormat, [&](auto type) {
+         for (const auto &binding : LveVertexLayout<typename decltype(type)::type>::BINDINGS) {
+            streamStrides[streamCount] = binding.stride;
+            streamOffsets[streamCount++] = vertexBytes;
+            vertexBytes += VkDeviceSize{binding.stride} * vertexCount;
+         }
+      });
+      dynamicVertices.resize(static_cast<size_t>(vertexBytes));
+      dynamicIndices.resize(static_cast<size_t>(indexSize() * indexCount));
+
+      //device local memory the host can write (integrated GPUs, resizable BAR) takes the changes directly. Without such a type, or
+      //once its heap is full, buffers are only device local and get staged copies
+      bool direct = true;
+      auto create = [&](VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer &buffer, LveAllocation &memory) {
+         if (direct) {
+            try {
+               lveDevice.createBuffer(size, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, buffer, memory);
+               memoryBytes += memory.size;
+               return;
+            } catch (const std::runtime_error &) {
+               direct = false;
+            }
+         }
+         createDeviceLocalBuffer(size, usage, buffer, memory);
+      };
+      dynamicCopies.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+      for (auto &copy : dynamicCopies) {
+         create(vertexBytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, copy.vertexBuffer, copy.vertexMemory);
+         if (hasIndexBuffer) create(dynamicIndices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, copy.indexBuffer, copy.indexMemory);
+      }
+      vertexBuffer = dynamicCopies[0].vertexBuffer;
+      indexBuffer = dynamicCopies[0].indexBuffer;
+   }
 
-      VkBuffer stagingBuffer;
-      VkDeviceMemory stagingBufferMemory;
+   void LveModel::setVertices(uint32_t first, const Vertex *vertices, uint32_t count) {
+      assert(isDynamic() && "Only dynamic models can be changed");
+      assert(first + count <= vertexCount && "Vertices out of range");
+      if (count == 0) return;
+      encodeVertices(vertices, first, count, [&](const void *data, VkDeviceSize size, VkDeviceSize offset) {
+         memcpy(dynamicVertices.data() + offset, data, static_cast<size_t>(size));
+      });
+      for (auto &copy : dynamicCopies) markDirty(copy.dirtyVertices, first, first + count);
+   }
 
-      lveDevice.createBuffer(
-         bufferSize, 
-         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-         //host: CPU, device: GPU 
-         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-         stagingBuffer, 
-         stagingBufferMemory);
-
-      void* data;
-      //creates region of host memory, maps to device memory, and sets data to point to beginning of mapped memory range
-      vkMapMemory(lveDevice.device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-      memcpy(data, indices.data(), static_cast<size_t>(bufferSize));
-      vkUnmapMemory(lveDevice.device(), stagingBufferMemory);
+   void LveModel::setIndices(uint32_t first, const uint32_t *indices, uint32_t count) {
+      assert(isDynamic() && "Only dynamic models can be changed");
+      assert(first + count <= indexCount && "Indices out of range");
+      if (count == 0) return;
+      if (indexType == VK_INDEX_TYPE_UINT16) {
+         uint16_t *narrowed = reinterpret_cast<uint16_t *>(dynamicIndices.data()) + first;
+         std::copy(indices, indices + count, narrowed);
+      } else {
+         memcpy(dynamicIndices.data() + sizeof(uint32_t) * first, indices, sizeof(uint32_t) * count);
+      }
+      for (auto &copy : dynamicCopies) markDirty(copy.dirtyIndices, first, first + count);
+   }
 
-      lveDevice.createBuffer(
-         bufferSize, 
-         VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-         indexBuffer, 
-         indexBufferMemory);
+   void LveModel::markDirty(std::vector<DirtyRange> &ranges, uint32_t begin, uint32_t end) {
+      //ranges overlapping or touching [begin, end) are merged into it
+      auto first = std::lower_bound(ranges.begin(), ranges.end(), begin, [](const DirtyRange &range, uint32_t value) { return range.end < value; });
+      auto last = first;
+      while (last != ranges.end() && last->begin <= end) {
+         begin = std::min(begin, last->begin);
+         end = std::max(end, last->end);
+         ++last;
+      }
+      first = ranges.erase(first, last);
+      ranges.insert(first, {begin, end});
+      if (ranges.size() <= MAX_DIRTY_RANGES) return;
+
+      //too many to be worth tracking apart: the two closest become one, rewriting the few unchanged elements between them
+      size_t closest = 0;
+      for (size_t i = 1; i + 1 < ranges.size(); i++) {
+         if (ranges[i + 1].begin - ranges[i].end < ranges[closest + 1].begin - ranges[closest].end) closest = i;
+      }
+      ranges[closest].end = ranges[closest + 1].end;
+      ranges.erase(ranges.begin() + closest + 1);
+   }
 
-         //move contents of staging buffer to vertex buffer
-      lveDevice.copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+   void LveModel::takeDirtyRanges(DynamicCopy &copy, const RangeWriter &writeVertices, const RangeWriter &writeIndices) {
+      for (const auto &range : copy.dirtyVertices) {
+         for (uint32_t stream = 0; stream < streamCount; stream++) {
+            writeVertices(streamOffsets[stream] + streamStrides[stream] * range.begin, streamStrides[stream] * (range.end - range.begin));
+         }
+      }
+      for (const auto &range : copy.dirtyIndices) writeIndices(indexSize() * range.begin, indexSize() * (range.end - range.begin));
+      copy.dirtyVertices.clear();
+      copy.dirtyIndices.clear();
+   }
 
-      vkDestroyBuffer(lveDevice.device(), stagingBuffer, nullptr);
-      vkFreeMemory(lveDevice.device(), stagingBufferMemory, nullptr);
+   void LveModel::updateDynamic(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+      assert(isDynamic() && "Only dynamic models can be updated");
+      DynamicCopy &copy = dynamicCopies[frameIndex % dynamicCopies.size()];
+      vertexBuffer = copy.vertexBuffer;
+      indexBuffer = copy.indexBuffer;
+      dynamicUpdateBytes = 0;
+
+      //mapped buffers are written right here, the others collect their regions to copy from the staging ring
+      std::vector<VkBufferCopy> vertexRegions{};
+      std::vector<VkBufferCopy> indexRegions{};
+      auto writer = [&](LveAllocation &memory, const std::vector<unsigned char> &contents, std::vector<VkBufferCopy> &regions) -> RangeWriter {
+         if (memory.mapped != nullptr) {
+            return [&](VkDeviceSize offset, VkDeviceSize size) {
+               memcpy(static_cast<char *>(memory.mapped) + offset, contents.data() + offset, static_cast<size_t>(size));
+               lveDevice.flushMemory(memory, offset, size);
+               dynamicUpdateBytes += size;
+            };
+         }
+         return [&](VkDeviceSize offset, VkDeviceSize size) { regions.push_back({0, offset, size}); };
+      };
+      takeDirtyRanges(copy, writer(copy.vertexMemory, dynamicVertices, vertexRegions), writer(copy.indexMemory, dynamicIndices, indexRegions));
+      if (vertexRegions.empty() && indexRegions.empty()) return;
+
+      //every region packed into one allocation. The ring frees it once this frame's fence signals
+      VkDeviceSize stagedBytes = 0;
+      for (const auto &region : vertexRegions) stagedBytes += region.size;
+      for (const auto &region : indexRegions) stagedBytes += region.size;
+      LveStagingRing &ring = lveDevice.stagingRing();
+      const LveStagingRing::Allocation staging = ring.allocate(stagedBytes);
+      VkDeviceSize packed = 0;
+      auto pack = [&](std::vector<VkBufferCopy> &regions, const std::vector<unsigned char> &contents) {
+         for (auto &region : regions) {
+            memcpy(static_cast<char *>(staging.mapped) + packed, contents.data() + region.dstOffset, static_cast<size_t>(region.size));
+            region.srcOffset = staging.offset + packed;
+            packed += region.size;
+         }
+      };
+      pack(vertexRegions, dynamicVertices);
+      pack(indexRegions, dynamicIndices);
+      ring.flush(staging);
+      dynamicUpdateBytes += stagedBytes;
+
+      if (!vertexRegions.empty()) {
+         vkCmdCopyBuffer(commandBuffer, staging.buffer, copy.vertexBuffer, static_cast<uint32_t>(vertexRegions.size()), vertexRegions.data());
+      }
+      if (!indexRegions.empty()) {
+         vkCmdCopyBuffer(commandBuffer, staging.buffer, copy.indexBuffer, static_cast<uint32_t>(indexRegions.size()), indexRegions.data());
+      }
+      //the frame's draws read what was just copied. The previous reads of these buffers finished with the frame that last used them
+      VkMemoryBarrier barrier{};
+      barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+      barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+      vkCmdPipelineBarrier(
+         commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
    }
 
-   void LveModel::draw(VkCommandBuffer commandBuffer) {
+   void LveModel::draw(VkCommandBuffer commandBuffer, uint32_t lod) {
       if (hasIndexBuffer) {
-         //0 0 0 -> first index, vertex offset, first instance
-         vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+         //every level shares the vertex buffer, so only the index range changes
+         drawRange(commandBuffer, lods[lod].firstIndex, lods[lod].indexCount);
       } else {
-         vkCmdDraw(commandBuffer, vertexCount, 1, 0, 0);
+         vkCmdDraw(commandBuffer, vertexCount, 1, baseVertex, 0);
       }
    }
 
+   void LveModel::drawRange(VkCommandBuffer commandBuffer, uint32_t firstIndex, uint32_t indexCount) {
+      const VkDrawIndexedIndirectCommand command = getDrawCommand(firstIndex, indexCount);
+      //first index, vertex offset, first instance
+      vkCmdDrawIndexed(commandBuffer, command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+   }
+
+   VkDrawIndexedIndirectCommand LveModel::getDrawCommand(uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount, uint32_t firstInstance) const {
+      assert(hasIndexBuffer && "Index ranges need an index buffer");
+      return {indexCount, instanceCount, baseIndex + firstIndex, static_cast<int32_t>(baseVertex), firstInstance};
+   }
+
+   uint32_t LveModel::selectLod(float projectedScale, float maxError) const {
+      //errors grow with the level, so walk down until the next one would be visible. Levels still streaming in are skipped
+      uint32_t lod = finestResidentLod;
+      while (lod + 1 < lods.size() && lods[lod + 1].error * projectedScale <= maxError) {
+         lod++;
+      }
+      return lod;
+   }
+
+   bool LveModel::sharesBindingsWith(const LveModel &other) const {
+      //buffers of a model's own are never shared, the arena's are per vertex format
+      return vertexBuffer == other.vertexBuffer && streamOffsets[0] == other.streamOffsets[0] && streamCount == other.streamCount &&
+         indexBuffer == other.indexBuffer && indexType == other.indexType;
+   }
+
    void LveModel::bind(VkCommandBuffer commandBuffer) {
-      VkBuffer buffers[] = {vertexBuffer};
-      VkDeviceSize offsets[] = {0};
-      //record to command buffer to bind 1 vertex buffer starting at binding 0
-      vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+      //every stream is a range of the one vertex buffer, binding 0 for the first
+      VkBuffer buffers[MAX_VERTEX_STREAMS] = {vertexBuffer, vertexBuffer};
+      vkCmdBindVertexBuffers(commandBuffer, 0, streamCount, buffers, streamOffsets);
 
       if (hasIndexBuffer) {
-         //for smaller models, can use 16 bit indices
-          vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+         //16 bit for models with at most 65536 vertices, see createIndexBuffers
+         vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, indexType);
       }
    }
 
-   std::vector<VkVertexInputBindingDescription> LveModel::Vertex::getBindingDescriptions() {
-      std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
-      bindingDescriptions[0].binding = 0;
-      bindingDescriptions[0].stride = sizeof(Vertex);
-      bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-      return bindingDescriptions;
+   glm::mat4 LveVertexLayout<LveModel::CompactVertex>::encode(
+      const LveModel::Vertex *vertices,
+      uint32_t count,
+      const glm::vec3 &boundsMin,
+      const glm::vec3 &boundsMax,
+      std::vector<LveModel::CompactVertex> &encoded) {
+      return LveVertexQuantizer::quantize(vertices, count, boundsMin, boundsMax, encoded);
    }
 
-   std::vector<VkVertexInputAttributeDescription> LveModel::Vertex::getAttributeDescriptions() {
-      std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
-
-      attributeDescriptions.push_back({0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position)});
-      attributeDescriptions.push_back({1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color)});
-      attributeDescriptions.push_back({2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal)});
-      attributeDescriptions.push_back({3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv)});
+   static_assert(sizeof(LveModel::VertexAttributes) == 32, "split streams are expected to be tightly packed");
+   static_assert(sizeof(LveModel::CompactPosition) == 8 && sizeof(LveModel::CompactAttributes) == 12, "split streams are expected to be tightly packed");
+
+   glm::mat4 LveVertexLayout<LveModel::Split<LveModel::Vertex>>::encode(
+      const LveModel::Vertex *vertices,
+      uint32_t count,
+      const glm::vec3 &,
+      const glm::vec3 &,
+      std::vector<Position> &positions,
+      std::vector<Attributes> &attributes) {
+      positions.resize(count);
+      attributes.resize(count);
+      for (uint32_t i = 0; i < count; i++) {
+         positions[i] = vertices[i].position;
+         attributes[i] = {vertices[i].color, vertices[i].normal, vertices[i].uv};
+      }
+      return glm::mat4{1.f};
+   }
 
-      return attributeDescriptions;
+   glm::mat4 LveVertexLayout<LveModel::Split<LveModel::CompactVertex>>::encode(
+      const LveModel::Vertex *vertices,
+      uint32_t count,
+      const glm::vec3 &boundsMin,
+      const glm::vec3 &boundsMax,
+      std::vector<Position> &positions,
+      std::vector<Attributes> &attributes) {
+      //same quantization as CompactVertex, then taken apart
+      std::vector<LveModel::CompactVertex> compact{};
+      const glm::mat4 dequantization = LveVertexQuantizer::quantize(vertices, count, boundsMin, boundsMax, compact);
+      positions.resize(count);
+      attributes.resize(count);
+      for (uint32_t i = 0; i < count; i++) {
+         std::memcpy(positions[i].position, compact[i].position, sizeof(positions[i].position));
+         std::memcpy(attributes[i].color, compact[i].color, sizeof(attributes[i].color));
+         std::memcpy(attributes[i].normal, compact[i].normal, sizeof(attributes[i].normal));
+         std::memcpy(attributes[i].uv, compact[i].uv, sizeof(attributes[i].uv));
+      }
+      return dequantization;
    }
 
    void LveModel::Builder::loadModel(const std::string &filepath) {
-      //attrib stores pos, color, normal, texture coordinate data
-      tinyobj::attrib_t attrib;
-      //index values
-      std::vector<tinyobj::shape_t> shapes;
-      std::vector<tinyobj::material_t> materials;
-      std::string warn, err;
+      //parsed on several threads straight from the mapped file. Holds positions, colors, normals, texture coordinates and face corners
+      const LveObjData obj = LveObjLoader::load(filepath);
+
+      vertices.clear();
+      indices.clear();
+      submeshes.clear();
+      materials = obj.materials;
+
+      //material of every triangle, from the usemtl runs
+      const size_t triangleCount = obj.corners.size() / 3;
+      std::vector<uint32_t> triangleMaterials(triangleCount, 0);
+      for (size_t run = 0; run < obj.materialRuns.size(); run++) {
+         const size_t end = run + 1 < obj.materialRuns.size() ? obj.materialRuns[run + 1].firstCorner : obj.corners.size();
+         std::fill(triangleMaterials.begin() + obj.materialRuns[run].firstCorner / 3, triangleMaterials.begin() + end / 3, obj.materialRuns[run].material);
+      }
 
-      if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath.c_str())) {
-         throw std::runtime_error(warn + err);
+      //triangles grouped by material, in file order within each, so every material is one range of the index buffer
+      std::vector<uint32_t> triangles(triangleCount);
+      std::iota(triangles.begin(), triangles.end(), 0);
+      std::stable_sort(triangles.begin(), triangles.end(), [&triangleMaterials](uint32_t a, uint32_t b) { return triangleMaterials[a] < triangleMaterials[b]; });
+      for (size_t i = 0; i < triangleCount; i++) {
+         const uint32_t material = triangleMaterials[triangles[i]];
+         if (submeshes.empty() || submeshes.back().material != material) {
+            submeshes.push_back({static_cast<uint32_t>(3 * i), 0, material, 0, 0});
+         }
+         submeshes.back().indexCount += 3;
       }
+      //a single material needs no ranges, the levels are enough
+      if (submeshes.size() < 2) submeshes.clear();
+
+      //keeps track of the vertices that have already been added to builder.vertices vector, and the position at which each was originally added.
+      //every corner could be unique, so the table is sized for the corner count once up front
+      LveVertexWelder<Vertex> welder{obj.corners.size()};
+      indices.reserve(obj.corners.size());
+      for (size_t i = 0; i < obj.corners.size(); i++) {
+         const auto &corner = obj.corners[3 * triangles[i / 3] + i % 3];
+         Vertex vertex{};
+
+         //every corner has a position, normal and texture coordinate are optional and -1 if not present
+         vertex.position = {
+            //each vertex has 3 values. To read position, multiply by 3 and add 0 for initial component
+            obj.positions[3 * corner.position + 0],
+            obj.positions[3 * corner.position + 1],
+            obj.positions[3 * corner.position + 2]
+         };
+
+         vertex.color = {
+            obj.colors[3 * corner.position + 0],
+            obj.colors[3 * corner.position + 1],
+            obj.colors[3 * corner.position + 2]
+         };
+
+         if (corner.normal >= 0) {
+            vertex.normal = {
+               obj.normals[3 * corner.normal + 0],
+               obj.normals[3 * corner.normal + 1],
+               obj.normals[3 * corner.normal + 2]
+            };
+         }
+
+         if (corner.texcoord >= 0) {
+            vertex.uv = {
+               obj.texcoords[2 * corner.texcoord + 0],
+               obj.texcoords[2 * corner.texcoord + 1],
+            };
+         }
+
+         //add position of vertex to indices vector, appending the vertex first if it's new
+         indices.push_back(welder.weld(vertex, vertices));
+      }
+   }
+
+   void LveModel::Builder::loadGltf(const std::string &filepath) {
+      const LveGltfFile file{filepath};
 
       vertices.clear();
       indices.clear();
+      lods.clear();
+      meshlets.clear();
+      submeshes.clear();
+      materials.clear();
+      for (const auto &instance : file.instances()) file.appendMesh(instance.mesh, instance.world, *this);
+   }
 
-      //map that keeps track of the vertices that have already been added to builder.vertices vector, and store position at which the vertex was originally added
-      std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-      for (const auto &shape : shapes) {
-         for (const auto &index : shape.mesh.indices) {
-            Vertex vertex{};
-
-            //vertex index is first value of face element, says what position value to use. Optional, and negative if not present
-            if (index.vertex_index >= 0) {
-               vertex.position = {
-                  //each vertex has 3 values. To read position, multiply by 3 and add 0 for initial component
-                  attrib.vertices[3 * index.vertex_index + 0],
-                  attrib.vertices[3 * index.vertex_index + 1],
-                  attrib.vertices[3 * index.vertex_index + 2]
-               };
+   void LveModel::Builder::optimize(bool optimizeOverdraw) {
+      if (indices.empty()) return;
 
-               vertex.color = {
-                  attrib.colors[3 * index.vertex_index + 0],
-                  attrib.colors[3 * index.vertex_index + 1],
-                  attrib.colors[3 * index.vertex_index + 2]
-               };
-            }
+      const auto before = LveMeshOptimizer::analyzeVertexCache(indices, vertices.size());
 
-            if (index.normal_index >= 0) {
-               vertex.normal = {
-                  attrib.normals[3 * index.normal_index + 0],
-                  attrib.normals[3 * index.normal_index + 1],
-                  attrib.normals[3 * index.normal_index + 2]
-               };
-            }
+      //triangles can't leave their submesh, so each one is reordered on its own
+      std::vector<uint32_t> range{};
+      auto reorder = [&](uint32_t firstIndex, uint32_t indexCount) {
+         range.assign(indices.begin() + firstIndex, indices.begin() + firstIndex + indexCount);
+         LveMeshOptimizer::optimizeVertexCache(range, vertices.size());
+         if (optimizeOverdraw) {
+            //clusters are sorted relative to the center of the mesh bounds
+            LveMeshOptimizer::optimizeOverdraw(range, &vertices[0].position, sizeof(Vertex), vertices.size());
+         }
+         std::copy(range.begin(), range.end(), indices.begin() + firstIndex);
+      };
+      if (submeshes.empty()) {
+         reorder(0, static_cast<uint32_t>(indices.size()));
+      } else {
+         for (const auto &submesh : submeshes) reorder(submesh.firstIndex, submesh.indexCount);
+      }
+      LveMeshOptimizer::optimizeVertexFetch(vertices, indices);
 
-            if (index.texcoord_index >= 0) {
-               vertex.uv = {
-                  attrib.texcoords[2 * index.texcoord_index + 0],
-                  attrib.texcoords[2 * index.texcoord_index + 1],
-               };
+      const auto after = LveMeshOptimizer::analyzeVertexCache(indices, vertices.size());
+      std::cout << "ACMR: " << before.acmr << " -> " << after.acmr << ", ATVR: " << before.atvr << " -> " << after.atvr << "\n";
+   }
+
+   void LveModel::Builder::generateLods() {
+      lods.clear();
+      if (indices.empty()) return;
+
+      const uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+      lods.push_back({0, static_cast<uint32_t>(indices.size()), vertexCount, 0.f});
+
+      //limit how far any level may drift from the original surface, relative to the size of the model
+      glm::vec3 boundsMin{vertices[0].position};
+      glm::vec3 boundsMax{vertices[0].position};
+      for (const auto &vertex : vertices) {
+         boundsMin = glm::min(boundsMin, vertex.position);
+         boundsMax = glm::max(boundsMax, vertex.position);
+      }
+      const float maxError = glm::length(boundsMax - boundsMin) * 0.05f;
+
+      //with submeshes every triangle is tagged with its submesh, which the simplifier keeps apart and in order
+      const size_t materialCount = submeshes.size();
+      std::vector<uint32_t> previousGroups{};
+      for (uint32_t submesh = 0; submesh < materialCount; submesh++) {
+         previousGroups.insert(previousGroups.end(), submeshes[submesh].indexCount / 3, submesh);
+      }
+
+      //each level is simplified from the one before it, which is cheaper and keeps the levels nested
+      std::vector<uint32_t> previous = indices;
+      std::vector<uint32_t> groups{};
+      std::vector<uint32_t> range{};
+      float previousError = 0.f;
+      while (lods.size() < MAX_LODS) {
+         const size_t target = (previous.size() / 3 / 2) * 3;
+         if (target < 3) break;
+
+         float error = 0.f;
+         std::vector<uint32_t> simplified = LveMeshSimplifier::simplify(
+            previous, &vertices[0].position, &vertices[0].normal, sizeof(Vertex), vertices.size(), target, maxError, &error,
+            materialCount > 0 ? previousGroups.data() : nullptr, &groups);
+         //stop once the error budget or the topology doesn't allow meaningful progress anymore
+         if (simplified.empty() || simplified.size() > previous.size() * 9 / 10) break;
+
+         const uint32_t firstIndex = static_cast<uint32_t>(indices.size());
+         if (materialCount == 0) {
+            LveMeshOptimizer::optimizeVertexCache(simplified, vertices.size());
+         } else {
+            //the simplified triangles are still sorted by submesh, a material may have none left
+            uint32_t first = 0;
+            for (uint32_t submesh = 0; submesh < materialCount; submesh++) {
+               const uint32_t count = static_cast<uint32_t>(std::count(groups.begin(), groups.end(), submesh)) * 3;
+               range.assign(simplified.begin() + first, simplified.begin() + first + count);
+               LveMeshOptimizer::optimizeVertexCache(range, vertices.size());
+               std::copy(range.begin(), range.end(), simplified.begin() + first);
+               submeshes.push_back({firstIndex + first, count, submeshes[submesh].material, 0, 0});
+               first += count;
             }
+         }
 
-            if (uniqueVertices.count(vertex) == 0) {
-               uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-               vertices.push_back(vertex);
+         //errors add up since each level starts from the previous one, and have to grow monotonically for selectLod
+         previousError = previousError + error;
+         lods.push_back({firstIndex, static_cast<uint32_t>(simplified.size()), vertexCount, previousError});
+         indices.insert(indices.end(), simplified.begin(), simplified.end());
+         previous = std::move(simplified);
+         previousGroups.swap(groups);
+      }
+
+      std::cout << "LOD triangles:";
+      for (const auto &lod : lods) {
+         std::cout << " " << lod.indexCount / 3;
+      }
+      std::cout << "\n";
+   }
+
+   void LveModel::Builder::buildMeshlets() {
+      meshlets.clear();
+      if (indices.empty()) return;
+
+      //only the full resolution level, coarser levels are small enough to draw whole
+      if (submeshes.empty()) {
+         const uint32_t indexCount = lods.empty() ? static_cast<uint32_t>(indices.size()) : lods[0].indexCount;
+         meshlets = LveMeshletBuilder::build(indices, indexCount, &vertices[0].position, sizeof(Vertex), vertices.size());
+      } else {
+         //clustered one submesh at a time, so culling a submesh's meshlets leaves ranges of that submesh only
+         std::vector<uint32_t> range{};
+         for (size_t i = 0; i < builderSubmeshesPerLod(*this); i++) {
+            Submesh &submesh = submeshes[i];
+            range.assign(indices.begin() + submesh.firstIndex, indices.begin() + submesh.firstIndex + submesh.indexCount);
+            std::vector<Meshlet> built = LveMeshletBuilder::build(range, submesh.indexCount, &vertices[0].position, sizeof(Vertex), vertices.size());
+            std::copy(range.begin(), range.end(), indices.begin() + submesh.firstIndex);
+
+            submesh.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+            submesh.meshletCount = static_cast<uint32_t>(built.size());
+            for (auto &meshlet : built) meshlet.firstIndex += submesh.firstIndex;
+            meshlets.insert(meshlets.end(), built.begin(), built.end());
+         }
+      }
+
+      std::cout << "Meshlets: " << meshlets.size() << "\n";
+   }
+
+   void LveModel::Builder::makeProgressive() {
+      if (lods.size() < 2) return;
+
+      //index buffer coarsest level first, remembering where each level moved to
+      const uint32_t oldFirstIndex = lods[0].firstIndex;
+      std::vector<uint32_t> oldFirstIndices{};
+      for (const auto &lod : lods) oldFirstIndices.push_back(lod.firstIndex);
+      std::vector<uint32_t> ordered{};
+      ordered.reserve(indices.size());
+      for (size_t lod = lods.size(); lod-- > 0;) {
+         const auto begin = indices.begin() + lods[lod].firstIndex;
+         lods[lod].firstIndex = static_cast<uint32_t>(ordered.size());
+         ordered.insert(ordered.end(), begin, begin + lods[lod].indexCount);
+      }
+
+      //vertices in order of first use, so each level's new vertices follow the ones the coarser levels already use.
+      //LOD0 keeps the fetch order within what it adds, only the vertices shared with coarser levels move to the front
+      std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+      std::vector<Vertex> reordered{};
+      reordered.reserve(vertices.size());
+      for (size_t lod = lods.size(); lod-- > 0;) {
+         for (uint32_t i = lods[lod].firstIndex; i < lods[lod].firstIndex + lods[lod].indexCount; i++) {
+            uint32_t &index = ordered[i];
+            if (remap[index] == UINT32_MAX) {
+               remap[index] = static_cast<uint32_t>(reordered.size());
+               reordered.push_back(vertices[index]);
             }
-            
-            //add position of vertex to indices vector
-            indices.push_back(uniqueVertices[vertex]);
+            index = remap[index];
          }
+         lods[lod].vertexCount = static_cast<uint32_t>(reordered.size());
+      }
+      //vertices no triangle uses still have to go somewhere, they count towards the full resolution level
+      for (size_t v = 0; v < vertices.size(); v++) {
+         if (remap[v] == UINT32_MAX) reordered.push_back(vertices[v]);
+      }
+      lods[0].vertexCount = static_cast<uint32_t>(reordered.size());
+
+      vertices = std::move(reordered);
+      indices = std::move(ordered);
+      for (auto &meshlet : meshlets) meshlet.firstIndex = meshlet.firstIndex - oldFirstIndex + lods[0].firstIndex;
+      //submeshes move along with their level, the triangles within a level keep their order
+      const size_t perLod = builderSubmeshesPerLod(*this);
+      for (size_t i = 0; i < submeshes.size(); i++) {
+         const size_t lod = i / perLod;
+         submeshes[i].firstIndex = submeshes[i].firstIndex - oldFirstIndices[lod] + lods[lod].firstIndex;
       }
+
+      std::cout << "Progressive base: " << lods.back().indexCount / 3 << " triangles, " << lods.back().vertexCount << " vertices\n";
    }
-}
\ No newline at end of file
+}
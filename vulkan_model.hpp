@@ -8,13 +8,42 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
 #include <vector>
 #include <memory>
+#include <string>
 
 namespace lve {
+   class LveGltfFile;
+   class LveHostImport;
+   class LveMappedFile;
+   class LveMeshCache;
+   class LveUploadBatch;
+   template <typename V>
+   struct LveVertexLayout;
+
    class LveModel {
       public:
 
+      //layout of the vertex buffer, each one has its own LveVertexLayout. The split formats hold the same vertices as the ones they
+      //are named after, with the positions packed into a stream of their own ahead of the other attributes: a pass that only needs
+      //positions (depth prepass, shadows) then fetches 12 or 8 bytes per vertex instead of 44 or 20
+      enum class VertexFormat {
+         //Vertex as is, 44 bytes
+         Float32,
+         //CompactVertex, 20 bytes. Positions are dequantized through getDequantizationMatrix()
+         Compact,
+         //12 byte positions, then 32 bytes of VertexAttributes
+         Float32Split,
+         //8 byte CompactPositions, then 12 bytes of CompactAttributes
+         CompactSplit
+      };
+      static constexpr size_t VERTEX_FORMAT_COUNT = 4;
+      //streams of the split formats, each a binding of its own
+      static constexpr uint32_t MAX_VERTEX_STREAMS = 2;
+
       struct Vertex {
          //we are going to interleave the color attribute with the position attribute
          glm::vec3 position{};
@@ -23,47 +52,461 @@ namespace lve {
          //2 dimensional texture coordinates
          glm::vec2 uv{};
 
-         static std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
-         static std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
-
          bool operator==(const Vertex &other) const {
-            return position == other.position && color == other.color && uv == other.uv;
+            return position == other.position && color == other.color && normal == other.normal && uv == other.uv;
          }
       };
 
+      //quantized Vertex, filled in by LveVertexQuantizer
+      struct CompactVertex {
+         //snorm16 in the model's bounds, w is padding (3 component 16 bit formats are rarely supported for vertex input)
+         int16_t position[4];
+         //unorm8, alpha is always 1
+         uint8_t color[4];
+         //octahedral encoded snorm16
+         int16_t normal[2];
+         //half floats
+         uint16_t uv[2];
+      };
+
+      //the streams of the split formats: Vertex and CompactVertex taken apart
+      struct VertexAttributes {
+         glm::vec3 color{};
+         glm::vec3 normal{};
+         glm::vec2 uv{};
+      };
+      struct CompactPosition {
+         int16_t position[4];
+      };
+      struct CompactAttributes {
+         uint8_t color[4];
+         int16_t normal[2];
+         uint16_t uv[2];
+      };
+
+      //marks the split layout of vertex type V, see LveVertexLayout
+      template <typename V>
+      struct Split {};
+
+      template <typename V>
+      struct VertexType {
+         using type = V;
+      };
+
+      //calls function with VertexType<V> of the vertex type vertexFormat stands for. The one place the enum turns into a type,
+      //whatever depends on the format after that is resolved at compile time through LveVertexLayout<V>
+      template <typename Function>
+      static decltype(auto) withVertexType(VertexFormat vertexFormat, Function &&function) {
+         switch (vertexFormat) {
+            case VertexFormat::Compact: return function(VertexType<CompactVertex>{});
+            case VertexFormat::Float32Split: return function(VertexType<Split<Vertex>>{});
+            case VertexFormat::CompactSplit: return function(VertexType<Split<CompactVertex>>{});
+            default: return function(VertexType<Vertex>{});
+         }
+      }
+      //bytes per vertex in the vertex buffer, every stream together
+      static VkDeviceSize getVertexStride(VertexFormat vertexFormat);
+
+      //one level of detail: a range of the shared index buffer, indexing into the shared vertex buffer
+      struct Lod {
+         uint32_t firstIndex;
+         uint32_t indexCount;
+         //leading vertices this level and every coarser one index into. The whole vertex buffer unless makeProgressive ran
+         uint32_t vertexCount;
+         //how far (object space units) this level's surface may be from the full resolution mesh
+         float error;
+      };
+
+      //most levels generateLods() builds, each with about half the triangles of the one before. Enough that the coarsest level,
+      //which a progressive model is first drawn with, stays small even for big meshes
+      static constexpr uint32_t MAX_LODS = 10;
+
+      //small cluster of the full resolution level, culled on its own. Meshlets are consecutive ranges of the index buffer
+      struct Meshlet {
+         uint32_t firstIndex;
+         uint32_t triangleCount;
+         uint32_t vertexCount;
+         //bounding sphere, object space
+         glm::vec3 center;
+         float radius;
+         //every triangle normal is within the cone's half angle of its axis. coneCos <= 0 means the cone is too wide to ever cull
+         glm::vec3 coneAxis;
+         float coneCos;
+         float coneSin;
+      };
+
+      //the triangles of one material within one level, a range of the shared index buffer. Every level lists the same materials in
+      //the same order, so a model binds its buffers once and draws one range per material
+      struct Submesh {
+         uint32_t firstIndex;
+         uint32_t indexCount;
+         //index into the source's materials, in order of their first use in the file
+         uint32_t material;
+         //this range's meshlets, only set for the full resolution level
+         uint32_t firstMeshlet;
+         uint32_t meshletCount;
+      };
+
       struct Builder {
          //temporary helper object, storing vertex and index info until it can be copied over into the object's vertex and index buffer memory
          std::vector<Vertex> vertices{};
          std::vector<uint32_t> indices{};
+         //empty means a single level covering all indices
+         std::vector<Lod> lods{};
+         //clusters of the first level, empty if buildMeshlets wasn't run
+         std::vector<Meshlet> meshlets{};
+         //one per material and level, level after level. Empty unless the source uses more than one material
+         std::vector<Submesh> submeshes{};
+         //names Submesh::material refers to, "" for faces before the first usemtl. Not kept in the mesh cache
+         std::vector<std::string> materials{};
 
+         //triangles are sorted by material, each material becoming one submesh
          void loadModel(const std::string &filepath);
+         //every mesh instance of a binary glTF file's default scene, flattened into one mesh with the node transforms applied
+         void loadGltf(const std::string &filepath);
+         //reorders triangles for the post-transform vertex cache (and optionally for overdraw), then vertices into fetch order.
+         //triangles stay within their submesh. Only changes the order, prints ACMR / ATVR before and after. Has to run before generateLods
+         void optimize(bool optimizeOverdraw = true);
+         //simplifies the mesh into up to MAX_LODS - 1 coarser levels and appends their indices after the full resolution ones.
+         //borders between materials are kept, so every level has the same submeshes
+         void generateLods();
+         //reorders the triangles of the first level into meshlets and records their bounds and normal cones. A meshlet never
+         //spans two submeshes
+         void buildMeshlets();
+         //lays the mesh out for progressive streaming: levels coarsest first in the index buffer, vertices in the order those
+         //levels first use them. Every level then only adds to the ends of both buffers. Has to run after buildMeshlets
+         void makeProgressive();
+      };
+
+      //the arrays a model is created from, and whatever owns them: a decoded mesh cache, a mapped glTF file or a builder.
+      //filled by loadMeshData without touching the device, so any thread can do it
+      struct MeshData {
+         MeshData();
+         ~MeshData();
+         MeshData(MeshData &&) noexcept;
+         MeshData &operator=(MeshData &&) noexcept;
+
+         const Vertex *vertices = nullptr;
+         uint32_t vertexCount = 0;
+         const uint32_t *indices = nullptr;
+         uint32_t indexCount = 0;
+         const Lod *lods = nullptr;
+         uint32_t lodCount = 0;
+         const Meshlet *meshlets = nullptr;
+         uint32_t meshletCount = 0;
+         //a multiple of lodCount (or of 1 without a LOD table), 0 for a single material
+         const Submesh *submeshes = nullptr;
+         uint32_t submeshCount = 0;
+         //bounds of every vertex, needed up front when only part of the vertices is there yet (progressive streaming)
+         bool hasBounds = false;
+         glm::vec3 boundsMin{0.f};
+         glm::vec3 boundsMax{0.f};
+         //hash of the source file, 0 if the mesh didn't come straight from one (glb). Known before the mesh is fully decoded
+         uint64_t sourceHash = 0;
+
+         //shared with the loader's worker, which keeps decoding segments after the data itself may have been dropped
+         std::shared_ptr<LveMeshCache> cache;
+         std::unique_ptr<LveGltfFile> gltf;
+         std::vector<uint32_t> widenedIndices{};
+         Builder builder{};
+         //the mapped file vertices and indices point into as stored (a raw cache, a glb mapped in place), null otherwise
+         std::shared_ptr<const LveMappedFile> mappedFile{};
+         //mappedFile imported as host memory by importMappedFile, uploads copy straight from it. Has to outlive them
+         std::unique_ptr<LveHostImport> hostImport{};
       };
 
-      LveModel(LveDevice &device, const LveModel::Builder &builder);
+      //with a batch the uploads are only queued, the model must not be drawn before the batch is submitted
+      LveModel(LveDevice &device, const LveModel::Builder &builder, VertexFormat vertexFormat = VertexFormat::Float32, LveUploadBatch *batch = nullptr);
+      //residentLods > 0 uploads only that many of the coarsest levels of a progressive mesh (see isProgressive), data needs bounds then.
+      //the buffers are sized for the whole mesh, streamLod adds the remaining levels later
+      LveModel(
+         LveDevice &device,
+         const MeshData &data,
+         VertexFormat vertexFormat = VertexFormat::Float32,
+         LveUploadBatch *batch = nullptr,
+         uint32_t residentLods = 0);
+      //raw arrays are copied straight into the staging buffers, e.g. from a memory mapped mesh cache
+      LveModel(
+         LveDevice &device,
+         const Vertex *vertices,
+         uint32_t vertexCount,
+         const uint32_t *indices,
+         uint32_t indexCount,
+         const Lod *lods,
+         uint32_t lodCount,
+         const Meshlet *meshlets,
+         uint32_t meshletCount,
+         VertexFormat vertexFormat = VertexFormat::Float32,
+         LveUploadBatch *batch = nullptr);
       ~LveModel();
 
       LveModel(const LveModel&) = delete;
       LveModel& operator=(const LveModel &) = delete;
 
-      static std::unique_ptr<LveModel> createModelFromFile(LveDevice &device, const std::string &filepath);
+      //a model whose vertices and indices change after creation, e.g. a procedurally deformed mesh: builder's arrays are its
+      //initial contents and fix the counts, LOD levels, meshlets and submeshes are ignored. Every frame in flight draws from a copy
+      //of its own, so a frame's copy can be rewritten while earlier frames still draw theirs. Quantized formats encode against the
+      //initial bounds, positions moving out of them are clamped
+      static std::unique_ptr<LveModel> createDynamic(LveDevice &device, const Builder &builder, VertexFormat vertexFormat = VertexFormat::Float32);
+      //.obj files are optimized, get LOD levels and meshlets, and are cached. .glb files are used as authored: a single unmoved mesh
+      //laid out like Vertex is uploaded straight from the mapped file, anything else is converted and flattened
+      static std::unique_ptr<LveModel> createModelFromFile(LveDevice &device, const std::string &filepath, VertexFormat vertexFormat = VertexFormat::Float32);
+      //device side of loading data: imports data.mappedFile so its uploads copy straight out of the file instead of through the
+      //staging ring, see LveHostImport. Skipped if the device can't or less than HOST_IMPORT_MIN_BYTES would be copied from it
+      static void importMappedFile(LveDevice &device, MeshData &data, VertexFormat vertexFormat);
+      //below this an import costs more than copying through the staging ring
+      static constexpr VkDeviceSize HOST_IMPORT_MIN_BYTES = 64 * 1024;
+      //bytes of a mesh that uploads in vertexFormat copy as stored: the vertices in the fp32 layout, the indices unless they are
+      //narrowed to 16 bit. Everything else is converted on the way
+      static VkDeviceSize importableBytes(VertexFormat vertexFormat, uint32_t vertexCount, uint32_t indexCount);
+      //the CPU half of createModelFromFile: import or cache lookup, no device work. Throws on failure.
+      //with decodeAll false an encoded cache only has its coarsest level decoded, data.cache->decodeNextSegment() does the rest.
+      //importFormat is the format the model will be created in if the device can import host memory, null otherwise: a new cache
+      //is then written raw (mapped as stored, several times the size of an encoded one) when enough of it would be imported
+      static void loadMeshData(const std::string &filepath, MeshData &data, bool decodeAll = true, const VertexFormat *importFormat = nullptr);
+      //true if the LOD table is laid out by Builder::makeProgressive, so levels can be uploaded coarsest first
+      static bool isProgressive(const Lod *lods, uint32_t lodCount, uint32_t vertexCount, uint32_t indexCount);
+
+      VertexFormat getVertexFormat() const { return vertexFormat; }
+
+      bool isDynamic() const { return !dynamicCopies.empty(); }
+      //dynamic models only: replace vertices [first, first + count), or indices. Only the host copy changes, every frame's buffers
+      //pick the change up on their next updateDynamic
+      void setVertices(uint32_t first, const Vertex *vertices, uint32_t count);
+      void setIndices(uint32_t first, const uint32_t *indices, uint32_t count);
+      //brings the buffers of frame frameIndex up to date with what changed since they were last drawn and makes bind use them.
+      //call every frame the model is drawn, after LveRenderer::beginFrame and before the render pass begins: memory the host can
+      //write is written directly, anything else is copied from the device's LveStagingRing by commands recorded into commandBuffer
+      void updateDynamic(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+      //bytes the last updateDynamic wrote or copied
+      VkDeviceSize getDynamicUpdateBytes() const { return dynamicUpdateBytes; }
+      //applied before the model matrix. Identity for Float32, maps quantized positions back onto the model's bounds for Compact
+      const glm::mat4 &getDequantizationMatrix() const { return dequantization; }
 
       void bind(VkCommandBuffer commandBuffer);
-      void draw(VkCommandBuffer commandBuffer);
+      //true if bind would bind the same buffers as other's: models in the device's LveGeometryArena with the same vertex format
+      //and index type. Draws of such models can follow each other without binding in between
+      bool sharesBindingsWith(const LveModel &other) const;
+      void draw(VkCommandBuffer commandBuffer, uint32_t lod = 0);
+      //draws part of the index buffer, e.g. the meshlets that survived culling
+      void drawRange(VkCommandBuffer commandBuffer, uint32_t firstIndex, uint32_t indexCount);
+      //an index range of the model as an indirect (or instanced) draw in the buffers bind binds: firstIndex and vertexOffset are
+      //where the model sits in them. Needs an index buffer
+      VkDrawIndexedIndirectCommand getDrawCommand(uint32_t firstIndex, uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const;
+
+      uint32_t getLodCount() const { return static_cast<uint32_t>(lods.size()); }
+      const Lod &getLod(uint32_t lod) const { return lods[lod]; }
+      //coarsest level whose error, multiplied by projectedScale, stays within maxError.
+      //projectedScale converts object space units at the model's distance into the units maxError is given in.
+      //never finer than the finest resident level
+      uint32_t selectLod(float projectedScale, float maxError) const;
+
+      //levels from here to the coarsest are uploaded and can be drawn, 0 once the model is complete
+      uint32_t getFinestResidentLod() const { return finestResidentLod; }
+      //same including levels queued by streamLod but not committed yet. streamLod would queue the level before it
+      uint32_t getFinestQueuedLod() const { return finestQueuedLod; }
+      //queues the upload of the next finer level onto batch, taken from data (the arrays the model was created from), and returns
+      //its size in bytes. It is appended after what is already resident, so draws of the resident levels can keep going
+      VkDeviceSize streamLod(const MeshData &data, LveUploadBatch &batch);
+      //makes the queued levels drawable, call once the batch they were queued on is submitted
+      void commitStreamedLods() { commitStreamedLods(finestQueuedLod); }
+      //same for the levels up to lod: getFinestQueuedLod() when their batch was submitted without waiting, finer ones may be
+      //queued on a later batch by the time it completes
+      void commitStreamedLods(uint32_t lod) { finestResidentLod = std::min(finestResidentLod, lod); }
+
+      const std::vector<Meshlet> &getMeshlets() const { return meshlets; }
+
+      //submeshes per level, 0 for a single material model, which draws whole levels instead
+      uint32_t getSubmeshCount() const { return submeshesPerLod; }
+      const Submesh &getSubmesh(uint32_t lod, uint32_t submesh) const { return submeshes[lod * submeshesPerLod + submesh]; }
+
+      //device memory held by the vertex and index buffers, or by the model's ranges of the geometry arena
+      VkDeviceSize getMemoryBytes() const { return memoryBytes; }
+
+      //bounding sphere in object space, around the bounds center
+      const glm::vec3 &getBoundsCenter() const { return boundsCenter; }
+      float getBoundsRadius() const { return boundsRadius; }
 
       private:
+      //a range of vertices or indices, [begin, end)
+      struct DirtyRange {
+         uint32_t begin;
+         uint32_t end;
+      };
+      //one frame in flight's buffers of a dynamic model, and the ranges written since they were last brought up to date
+      struct DynamicCopy {
+         VkBuffer vertexBuffer = VK_NULL_HANDLE;
+         LveAllocation vertexMemory{};
+         VkBuffer indexBuffer = VK_NULL_HANDLE;
+         LveAllocation indexMemory{};
+         std::vector<DirtyRange> dirtyVertices{};
+         std::vector<DirtyRange> dirtyIndices{};
+      };
+      //more ranges per copy than this are merged where the gap between them is smallest
+      static constexpr size_t MAX_DIRTY_RANGES = 16;
+      //where the bytes of a vertex or index range go in the buffers, write(offset, size) per stream
+      using RangeWriter = std::function<void(VkDeviceSize offset, VkDeviceSize size)>;
+      //encoded vertex data and its offset in the vertex buffer
+      using EncodedWriter = std::function<void(const void *data, VkDeviceSize size, VkDeviceSize offset)>;
+
+      struct DynamicTag {};
+      LveModel(LveDevice &device, const Builder &builder, VertexFormat vertexFormat, DynamicTag);
+
+      void create(const MeshData &data, LveUploadBatch *batch, uint32_t residentLods);
+      void setBounds(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+      //buffers for the whole mesh, nothing uploaded yet
+      void createVertexBuffers(uint32_t vertexCount, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax);
+      void createIndexBuffers(uint32_t indexCount);
+      void createDeviceLocalBuffer(VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkBuffer &buffer, LveAllocation &memory);
+      //bytes per index in indexBuffer
+      VkDeviceSize indexSize() const { return indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t); }
+      //vertices [first, first + count) converted to the vertex format and queued at their place in the buffer, same for indices
+      //source is the host import vertices or indices may lie in, or null
+      void uploadVertices(const Vertex *vertices, uint32_t first, uint32_t count, LveUploadBatch &batch, const LveHostImport *source = nullptr);
+      void uploadIndices(const uint32_t *indices, uint32_t first, uint32_t count, LveUploadBatch &batch, const LveHostImport *source = nullptr);
+      //count vertices converted to the vertex format and placed at vertex first, write(data, size, offset) for each stream's part
+      //with its offset in the vertex buffer
+      void encodeVertices(const Vertex *vertices, uint32_t first, uint32_t count, const EncodedWriter &write);
+      template <typename V>
+      void encodeVerticesAs(const Vertex *vertices, uint32_t first, uint32_t count, const EncodedWriter &write);
 
-      void createVertexBuffers(const std::vector<Vertex>& vertices);
-      void createIndexBuffers(const std::vector<uint32_t>& indices);
+      //the buffers of every frame's copy, with the initial contents
+      void createDynamicBuffers();
+      //adds [begin, end) to ranges, which stay sorted and apart
+      static void markDirty(std::vector<DirtyRange> &ranges, uint32_t begin, uint32_t end);
+      //the byte ranges of copy's vertex buffer, then of its index buffer, that are out of date, and forgets them
+      void takeDirtyRanges(DynamicCopy &copy, const RangeWriter &writeVertices, const RangeWriter &writeIndices);
       //device reference
       LveDevice& lveDevice;
+      //ranges of the device's LveGeometryArena, unless it had no room left: then buffers of the model's own.
       //note these are 2 separate objects: in control of memory management
-      VkBuffer vertexBuffer;
-      VkDeviceMemory vertexBufferMemory;
+      VkBuffer vertexBuffer = VK_NULL_HANDLE;
+      LveAllocation vertexBufferMemory{};
+      //arena handle of the vertices, LveTlsf::INVALID with a buffer of the model's own
+      uint32_t vertexRange = LveTlsf::INVALID;
+      //where the model's vertices start in vertexBuffer, every draw's vertexOffset
+      uint32_t baseVertex = 0;
       uint32_t vertexCount;
+      VertexFormat vertexFormat;
+      //the streams of the format in vertexBuffer, each holding every vertex of the buffer. Bound to bindings 0 and up
+      uint32_t streamCount = 0;
+      VkDeviceSize streamOffsets[MAX_VERTEX_STREAMS]{};
+      glm::mat4 dequantization{1.f};
+      glm::vec3 boundsMin{0.f};
+      glm::vec3 boundsMax{0.f};
+      glm::vec3 boundsCenter{0.f};
+      float boundsRadius = 0.f;
 
       bool hasIndexBuffer = false;
-      VkBuffer indexBuffer;
-      VkDeviceMemory indexBufferMemory;
+      VkBuffer indexBuffer = VK_NULL_HANDLE;
+      LveAllocation indexBufferMemory{};
+      uint32_t indexRange = LveTlsf::INVALID;
+      //added to every firstIndex, the index buffer is bound at offset 0
+      uint32_t baseIndex = 0;
       uint32_t indexCount;
+      //UINT16 whenever every vertex can be addressed with 16 bits, halving the index buffer
+      VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+      VkDeviceSize memoryBytes = 0;
+      std::vector<Lod> lods{};
+      uint32_t finestResidentLod = 0;
+      uint32_t finestQueuedLod = 0;
+      std::vector<Meshlet> meshlets{};
+      std::vector<Submesh> submeshes{};
+      uint32_t submeshesPerLod = 0;
+
+      //dynamic models: the contents in the buffers' layout, one copy per frame in flight (empty for static models) and the copy
+      //vertexBuffer and indexBuffer are. Every stream is laid out for all vertices, streamStrides apart
+      std::vector<unsigned char> dynamicVertices{};
+      std::vector<unsigned char> dynamicIndices{};
+      std::vector<DynamicCopy> dynamicCopies{};
+      VkDeviceSize streamStrides[MAX_VERTEX_STREAMS]{};
+      VkDeviceSize dynamicUpdateBytes = 0;
+   };
+
+   //compile time layout of a vertex type: its format, its bindings (one per stream) and the attributes a pipeline reads it with.
+   //the arrays are static, so pipelines point at them instead of building descriptions at runtime. Attribute locations match the
+   //shaders, every format has the same four. Formats that aren't Vertex as is also have an encode, filling their streams from
+   //LveModel::Vertex and returning the dequantization matrix. Split layouts name their two stream types Position and Attributes
+
+   template <>
+   struct LveVertexLayout<LveModel::Vertex> {
+      static constexpr LveModel::VertexFormat FORMAT = LveModel::VertexFormat::Float32;
+      static constexpr VkVertexInputBindingDescription BINDINGS[] = {
+         {0, sizeof(LveModel::Vertex), VK_VERTEX_INPUT_RATE_VERTEX}};
+      //we are going to interleave the color attribute with the position attribute
+      static constexpr VkVertexInputAttributeDescription ATTRIBUTES[] = {
+         {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(LveModel::Vertex, position)},
+         {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(LveModel::Vertex, color)},
+         {2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(LveModel::Vertex, normal)},
+         {3, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(LveModel::Vertex, uv)}};
+   };
+
+   //same locations as Vertex, the formats do the unpacking. Only the normal needs decoding in the shader
+   template <>
+   struct LveVertexLayout<LveModel::CompactVertex> {
+      static constexpr LveModel::VertexFormat FORMAT = LveModel::VertexFormat::Compact;
+      static constexpr VkVertexInputBindingDescription BINDINGS[] = {
+         {0, sizeof(LveModel::CompactVertex), VK_VERTEX_INPUT_RATE_VERTEX}};
+      static constexpr VkVertexInputAttributeDescription ATTRIBUTES[] = {
+         {0, 0, VK_FORMAT_R16G16B16A16_SNORM, offsetof(LveModel::CompactVertex, position)},
+         {1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(LveModel::CompactVertex, color)},
+         {2, 0, VK_FORMAT_R16G16_SNORM, offsetof(LveModel::CompactVertex, normal)},
+         {3, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(LveModel::CompactVertex, uv)}};
+
+      //quantized against the given bounds, so every part of a mesh shares one dequantization matrix
+      static glm::mat4 encode(
+         const LveModel::Vertex *vertices,
+         uint32_t count,
+         const glm::vec3 &boundsMin,
+         const glm::vec3 &boundsMax,
+         std::vector<LveModel::CompactVertex> &encoded);
+   };
+
+   //position at binding 0, everything else at binding 1
+   template <>
+   struct LveVertexLayout<LveModel::Split<LveModel::Vertex>> {
+      using Position = glm::vec3;
+      using Attributes = LveModel::VertexAttributes;
+      static constexpr LveModel::VertexFormat FORMAT = LveModel::VertexFormat::Float32Split;
+      static constexpr VkVertexInputBindingDescription BINDINGS[] = {
+         {0, sizeof(Position), VK_VERTEX_INPUT_RATE_VERTEX},
+         {1, sizeof(Attributes), VK_VERTEX_INPUT_RATE_VERTEX}};
+      static constexpr VkVertexInputAttributeDescription ATTRIBUTES[] = {
+         {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+         {1, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Attributes, color)},
+         {2, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Attributes, normal)},
+         {3, 1, VK_FORMAT_R32G32_SFLOAT, offsetof(Attributes, uv)}};
+
+      static glm::mat4 encode(
+         const LveModel::Vertex *vertices,
+         uint32_t count,
+         const glm::vec3 &boundsMin,
+         const glm::vec3 &boundsMax,
+         std::vector<Position> &positions,
+         std::vector<Attributes> &attributes);
+   };
+
+   //CompactVertex's formats, split the same way
+   template <>
+   struct LveVertexLayout<LveModel::Split<LveModel::CompactVertex>> {
+      using Position = LveModel::CompactPosition;
+      using Attributes = LveModel::CompactAttributes;
+      static constexpr LveModel::VertexFormat FORMAT = LveModel::VertexFormat::CompactSplit;
+      static constexpr VkVertexInputBindingDescription BINDINGS[] = {
+         {0, sizeof(Position), VK_VERTEX_INPUT_RATE_VERTEX},
+         {1, sizeof(Attributes), VK_VERTEX_INPUT_RATE_VERTEX}};
+      static constexpr VkVertexInputAttributeDescription ATTRIBUTES[] = {
+         {0, 0, VK_FORMAT_R16G16B16A16_SNORM, 0},
+         {1, 1, VK_FORMAT_R8G8B8A8_UNORM, offsetof(Attributes, color)},
+         {2, 1, VK_FORMAT_R16G16_SNORM, offsetof(Attributes, normal)},
+         {3, 1, VK_FORMAT_R16G16_SFLOAT, offsetof(Attributes, uv)}};
+
+      static glm::mat4 encode(
+         const LveModel::Vertex *vertices,
+         uint32_t count,
+         const glm::vec3 &boundsMin,
+         const glm::vec3 &boundsMax,
+         std::vector<Position> &positions,
+         std::vector<Attributes> &attributes);
    };
-}
\ No newline at end of file
+}
@@ -0,0 +1,240 @@
+#include "vulkan_model_loader.hpp"
+#include "vulkan_mesh_cache.hpp"
+#include "vulkan_upload_batch.hpp"
+#include "vulkan_utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+namespace lve {
+
+   namespace {
+      //unit cube around the origin, grey so it reads as "not loaded yet"
+      LveModel::Builder makePlaceholder() {
+         LveModel::Builder builder{};
+         const glm::vec3 normals[6] = {{1.f, 0.f, 0.f}, {-1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {0.f, -1.f, 0.f}, {0.f, 0.f, 1.f}, {0.f, 0.f, -1.f}};
+         for (const auto &normal : normals) {
+            //two axes spanning the face, ordered so that u x v points along the normal
+            const glm::vec3 u{normal.y, normal.z, normal.x};
+            const glm::vec3 v = glm::cross(normal, u);
+            const uint32_t first = static_cast<uint32_t>(builder.vertices.size());
+            for (int corner = 0; corner < 4; corner++) {
+               LveModel::Vertex vertex{};
+               const float su = (corner == 1 || corner == 2) ? 0.5f : -0.5f;
+               const float sv = corner >= 2 ? 0.5f : -0.5f;
+               vertex.position = normal * 0.5f + u * su + v * sv;
+               vertex.color = glm::vec3{0.5f};
+               vertex.normal = normal;
+               vertex.uv = {su + 0.5f, sv + 0.5f};
+               builder.vertices.push_back(vertex);
+            }
+            builder.indices.insert(builder.indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+         }
+         return builder;
+      }
+
+      //what creating a model from data uploads: the coarsest level of a progressive mesh, everything otherwise. fp32 layout,
+      //an estimate for the budget only
+      VkDeviceSize uploadSize(const LveModel::MeshData &data) {
+         uint32_t vertexCount = data.vertexCount, indexCount = data.indexCount;
+         if (data.hasBounds && LveModel::isProgressive(data.lods, data.lodCount, data.vertexCount, data.indexCount)) {
+            vertexCount = data.lods[data.lodCount - 1].vertexCount;
+            indexCount = data.lods[data.lodCount - 1].indexCount;
+         }
+         return sizeof(LveModel::Vertex) * VkDeviceSize{vertexCount} + sizeof(uint32_t) * VkDeviceSize{indexCount};
+      }
+
+      //the mesh codec may start a triangle at another corner, so every triangle is hashed in the same rotation.
+      //otherwise a mesh loaded from its cache wouldn't match the same mesh just imported
+      uint64_t hashContent(const LveModel::MeshData &data) {
+         uint64_t hash = hashBytes(data.vertices, sizeof(LveModel::Vertex) * data.vertexCount);
+         if (data.indexCount > 0) {
+            std::vector<uint32_t> triangles(data.indices, data.indices + data.indexCount);
+            for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+               uint32_t *t = &triangles[i];
+               //lexicographically smallest rotation, which also settles triangles repeating an index
+               const uint32_t rotations[3][3] = {{t[0], t[1], t[2]}, {t[1], t[2], t[0]}, {t[2], t[0], t[1]}};
+               const auto *smallest = std::min_element(std::begin(rotations), std::end(rotations), [](const uint32_t *a, const uint32_t *b) {
+                  return std::lexicographical_compare(a, a + 3, b, b + 3);
+               });
+               std::copy(*smallest, *smallest + 3, t);
+            }
+            hash = hashBytes(triangles.data(), sizeof(uint32_t) * triangles.size(), hash);
+         }
+         if (data.lodCount > 0) hash = hashBytes(data.lods, sizeof(LveModel::Lod) * data.lodCount, hash);
+         return hash;
+      }
+   }
+
+   LveModelLoader::LveModelLoader(LveDevice &device, unsigned threadCount)
+      : lveDevice{device}, placeholder_{std::make_shared<LveModel>(device, makePlaceholder())}, pool{threadCount} {}
+
+   LveModelLoader::~LveModelLoader() {
+      //the copies write into buffers of the models held below, they complete in order
+      if (!inFlight.empty()) lveDevice.uploadManager().wait(inFlight.back().ticket);
+   }
+
+   LveModelHandle LveModelLoader::load(const std::string &filepath, LveModel::VertexFormat vertexFormat) {
+      auto state = std::make_shared<LveModelHandle::State>();
+      state->path = filepath;
+      state->vertexFormat = vertexFormat;
+      pending++;
+
+      pool.submit([this, state]() {
+         Completed result{state, {}, {}};
+         try {
+            //only the coarsest level of an encoded cache, the rest is decoded below once the model is on its way
+            const bool canImport = lveDevice.hostImportAlignment() > 0;
+            LveModel::loadMeshData(state->path, result.data, false, canImport ? &state->vertexFormat : nullptr);
+            if (result.data.vertexCount < 3) result.error = "model has fewer than 3 vertices";
+            //the source hash is known before the mesh is decoded, the mesh itself only for .glb
+            state->contentHash = result.data.sourceHash != 0 ? result.data.sourceHash : hashContent(result.data);
+         } catch (const std::exception &e) {
+            result.error = e.what();
+         }
+         //the data is owned by update from now on, which drops it whenever the model is done with it (a duplicate, a failed
+         //upload, or the last level streamed): the worker holds on to the cache it decodes into itself
+         const std::shared_ptr<LveMeshCache> cache = result.error.empty() ? result.data.cache : nullptr;
+         const uint32_t remaining = cache != nullptr ? cache->segmentCount() - cache->decodedSegmentCount() : 0;
+         {
+            std::lock_guard<std::mutex> lock{completedMutex};
+            completed.push_back(std::move(result));
+         }
+         for (uint32_t segment = 0; segment < remaining; segment++) {
+            if (!cache->decodeNextSegment()) {
+               state->streamFailed = true;
+               break;
+            }
+         }
+      });
+      return LveModelHandle{state};
+   }
+
+   void LveModelLoader::streamLevels(LveUploadBatch &batch, VkDeviceSize budget) {
+      for (auto &entry : streaming) {
+         LveModel &model = *entry.model;
+         const LveModel::MeshData &data = entry.data;
+         //how far the worker has decoded, everything for meshes that didn't come out of an encoded cache
+         const uint32_t vertexCount = data.cache ? data.cache->decodedVertexCount() : data.vertexCount;
+         const uint32_t indexCount = data.cache ? data.cache->decodedIndexCount() : data.indexCount;
+         while (model.getFinestQueuedLod() > 0 && budget > 0) {
+            const LveModel::Lod &next = model.getLod(model.getFinestQueuedLod() - 1);
+            if (next.vertexCount > vertexCount || next.firstIndex + next.indexCount > indexCount) break;
+            const VkDeviceSize bytes = model.streamLod(data, batch);
+            budget -= std::min(bytes, budget);
+         }
+      }
+   }
+
+   uint32_t LveModelLoader::update() {
+      std::vector<Completed> finished{};
+      {
+         std::lock_guard<std::mutex> lock{completedMutex};
+         finished.swap(completed);
+      }
+
+      //over budget: the rest goes back to the front of the queue, in order, for the next update
+      if (uploadBudget > 0) {
+         VkDeviceSize bytes = 0;
+         size_t count = 0;
+         while (count < finished.size() && (count == 0 || bytes + uploadSize(finished[count].data) <= uploadBudget)) {
+            bytes += uploadSize(finished[count++].data);
+         }
+         if (count < finished.size()) {
+            std::lock_guard<std::mutex> lock{completedMutex};
+            completed.insert(completed.begin(), std::make_move_iterator(finished.begin() + count), std::make_move_iterator(finished.end()));
+            finished.resize(count);
+         }
+      }
+
+      //models are only published once the batch completed on the GPU
+      LveUploadBatch batch{lveDevice};
+      std::vector<std::shared_ptr<LveModel>> models(finished.size());
+      //content hash and vertex format of the models created in this batch
+      std::unordered_map<size_t, size_t> created{};
+      for (size_t i = 0; i < finished.size(); i++) {
+         if (!finished[i].error.empty()) continue;
+         const auto &state = *finished[i].state;
+         size_t key = static_cast<size_t>(state.contentHash);
+         hashCombine(key, static_cast<int>(state.vertexFormat));
+         auto duplicate = created.find(key);
+         if (duplicate != created.end()) {
+            models[i] = models[duplicate->second];
+            continue;
+         }
+         if (contentLookup) models[i] = contentLookup(state.contentHash, state.vertexFormat);
+         if (models[i]) continue;
+         try {
+            LveModel::MeshData &data = finished[i].data;
+            LveModel::importMappedFile(lveDevice, data, state.vertexFormat);
+            const bool progressive = data.hasBounds && LveModel::isProgressive(data.lods, data.lodCount, data.vertexCount, data.indexCount);
+            models[i] = std::make_shared<LveModel>(lveDevice, data, state.vertexFormat, &batch, progressive ? 1 : 0);
+            created[key] = i;
+            if (models[i]->getFinestQueuedLod() > 0) streaming.push_back({finished[i].state, std::move(data), models[i]});
+         } catch (const std::exception &e) {
+            finished[i].error = e.what();
+         }
+      }
+      //new models first so they can be drawn right away, finer levels of streaming ones with what is left
+      VkDeviceSize streamBudget = STREAM_BYTES_PER_UPDATE;
+      if (uploadBudget > 0) streamBudget = std::min(streamBudget, uploadBudget - std::min(uploadBudget, batch.pendingBytes()));
+      streamLevels(batch, streamBudget);
+
+      //the frame goes on while the copies run, a later update publishes them
+      InFlight uploads{batch.submitAsync(), std::move(finished), std::move(models), {}};
+      for (auto &entry : streaming) {
+         const LveModel &model = *entry.model;
+         if (model.getFinestQueuedLod() < model.getFinestResidentLod()) uploads.streamed.emplace_back(entry.model, model.getFinestQueuedLod());
+      }
+      if (!uploads.finished.empty() || !uploads.streamed.empty()) inFlight.push_back(std::move(uploads));
+      return publishUploaded();
+   }
+
+   uint32_t LveModelLoader::publishUploaded() {
+      uint32_t published = 0;
+      while (!inFlight.empty() && lveDevice.uploadManager().isComplete(inFlight.front().ticket)) {
+         InFlight &uploads = inFlight.front();
+         for (auto &[model, lod] : uploads.streamed) model->commitStreamedLods(lod);
+         for (size_t i = 0; i < uploads.finished.size(); i++) {
+            auto &state = *uploads.finished[i].state;
+            if (uploads.finished[i].error.empty()) {
+               state.model = std::move(uploads.models[i]);
+               state.status = LveModelHandle::Status::Ready;
+            } else {
+               std::cerr << "Failed to load model " << state.path << ": " << uploads.finished[i].error << "\n";
+               state.error = std::move(uploads.finished[i].error);
+               state.status = LveModelHandle::Status::Failed;
+            }
+         }
+         published += static_cast<uint32_t>(uploads.finished.size());
+         inFlight.pop_front();
+      }
+      pending -= published;
+      retireStreaming();
+      return published;
+   }
+
+   void LveModelLoader::retireStreaming() {
+      //complete models, and ones whose worker gave up with nothing more to upload, don't need the data anymore
+      streaming.erase(std::remove_if(streaming.begin(), streaming.end(), [](const Streaming &entry) {
+         const LveModel &model = *entry.model;
+         if (model.getFinestResidentLod() == 0) return true;
+         const LveMeshCache *cache = entry.data.cache.get();
+         if (!entry.state->streamFailed || cache == nullptr) return false;
+         const LveModel::Lod &next = model.getLod(model.getFinestResidentLod() - 1);
+         if (next.vertexCount <= cache->decodedVertexCount() && next.firstIndex + next.indexCount <= cache->decodedIndexCount()) return false;
+         std::cerr << "Failed to decode the finer levels of " << entry.state->path << ", keeping LOD " << model.getFinestResidentLod() << "\n";
+         return true;
+      }), streaming.end());
+   }
+
+   std::shared_ptr<LveModel> LveModelLoader::wait(const LveModelHandle &handle) {
+      while (handle.status() == LveModelHandle::Status::Loading) {
+         if (update() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      return handle.get();
+   }
+}
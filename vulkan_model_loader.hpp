@@ -0,0 +1,143 @@
+#pragma once
+
+#include "vulkan_model.hpp"
+#include "vulkan_thread_pool.hpp"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+   //future-like handle to a model LveModelLoader is loading. Copies share the same load.
+   //state changes only in LveModelLoader::update, so a handle checked on the render thread doesn't change under it mid-frame
+   class LveModelHandle {
+      public:
+      enum class Status { Loading, Ready, Failed };
+
+      LveModelHandle() = default;
+
+      bool valid() const { return state != nullptr; }
+      Status status() const { return state->status.load(); }
+      bool ready() const { return status() == Status::Ready; }
+      bool failed() const { return status() == Status::Failed; }
+      //null until ready. Progressive meshes are ready with their coarsest level, finer ones follow over the next updates
+      std::shared_ptr<LveModel> get() const { return ready() ? state->model : nullptr; }
+      //what went wrong, if failed
+      const std::string &error() const { return state->error; }
+      const std::string &path() const { return state->path; }
+      //hash of the source file (of the vertices, indices and LOD table for .glb), known once the model is ready.
+      //equal for identical meshes under different paths
+      uint64_t contentHash() const { return state->contentHash; }
+      //true if other copies of this handle exist
+      bool shared() const { return state.use_count() > 1; }
+
+      private:
+      friend class LveModelLoader;
+
+      struct State {
+         std::string path;
+         LveModel::VertexFormat vertexFormat;
+         std::atomic<Status> status{Status::Loading};
+         std::shared_ptr<LveModel> model{};
+         std::string error{};
+         uint64_t contentHash = 0;
+         //set by the worker if a later level of a progressive mesh fails to decode, the model stays at the levels it has
+         std::atomic<bool> streamFailed{false};
+      };
+
+      explicit LveModelHandle(std::shared_ptr<State> state) : state{std::move(state)} {}
+
+      std::shared_ptr<State> state{};
+   };
+
+   //loads models in the background: import / cache decode runs on a thread pool, the GPU side (buffer creation and uploads) on the
+   //thread calling update, once per frame, with every model that finished since the last call uploaded in a single batch. The
+   //batch is submitted without waiting, a later update hands its models out once the copies completed.
+   //until then objects can draw placeholder(), a small cube.
+   //progressive meshes (LveModel::isProgressive) are handed out as soon as their coarsest level is decoded and uploaded, so the
+   //first frame with the real model doesn't depend on its size. The finer levels are decoded behind it and appended to the same
+   //buffers by later updates, at most STREAM_BYTES_PER_UPDATE a frame
+   class LveModelLoader {
+      public:
+      static constexpr VkDeviceSize STREAM_BYTES_PER_UPDATE = 8 * 1024 * 1024;
+
+      //threadCount 0 picks one worker per core, minus the render thread
+      explicit LveModelLoader(LveDevice &device, unsigned threadCount = 0);
+      //models still being imported are abandoned, their handles stay Loading. Waits for uploads in flight
+      ~LveModelLoader();
+
+      LveModelLoader(const LveModelLoader &) = delete;
+      LveModelLoader &operator=(const LveModelLoader &) = delete;
+
+      //starts loading filepath (anything LveModel::createModelFromFile takes) and returns right away
+      LveModelHandle load(const std::string &filepath, LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float32);
+      //creates the models whose data is ready, queues the next levels of streaming ones and submits all uploads at once, then
+      //hands out the models (and makes the levels drawable) of every earlier submission that completed.
+      //returns how many handles finished (either way)
+      uint32_t update();
+      //caps the bytes update uploads, loads past it wait for the next update (one always goes through). 0 is no cap for new models,
+      //finer levels of streaming ones are capped by STREAM_BYTES_PER_UPDATE either way
+      void setUploadBudget(VkDeviceSize bytesPerUpdate) { uploadBudget = bytesPerUpdate; }
+      //blocks until the handle finishes, calling update in between. Returns the model, null if loading failed
+      std::shared_ptr<LveModel> wait(const LveModelHandle &handle);
+
+      //asked for every finished load before its upload: returning a model with the same content and vertex format makes the handle
+      //share it instead of uploading a copy. Identical meshes finishing in the same update are shared either way
+      using ContentLookup = std::function<std::shared_ptr<LveModel>(uint64_t contentHash, LveModel::VertexFormat vertexFormat)>;
+      void setContentLookup(ContentLookup lookup) { contentLookup = std::move(lookup); }
+
+      //loads that haven't finished yet
+      uint32_t pendingCount() const { return pending.load(); }
+      //ready models still missing finer levels
+      uint32_t streamingCount() const { return static_cast<uint32_t>(streaming.size()); }
+      const std::shared_ptr<LveModel> &placeholder() const { return placeholder_; }
+
+      private:
+      struct Completed {
+         std::shared_ptr<LveModelHandle::State> state;
+         LveModel::MeshData data;
+         //empty on success
+         std::string error;
+      };
+      //a progressive model whose finer levels are still coming, data may still be decoding on a worker
+      struct Streaming {
+         std::shared_ptr<LveModelHandle::State> state;
+         LveModel::MeshData data;
+         std::shared_ptr<LveModel> model;
+      };
+
+      //the models one update created and the levels it streamed, waiting for their uploads
+      struct InFlight {
+         uint64_t ticket;
+         std::vector<Completed> finished;
+         //null for failed ones
+         std::vector<std::shared_ptr<LveModel>> models;
+         //streaming models and their finest level queued when the batch went out
+         std::vector<std::pair<std::shared_ptr<LveModel>, uint32_t>> streamed;
+      };
+
+      //queues levels of streaming models up to budget bytes
+      void streamLevels(LveUploadBatch &batch, VkDeviceSize budget);
+      //finishes the in flight uploads that completed, in order. Returns how many handles finished
+      uint32_t publishUploaded();
+      //drops entries that have nothing left to stream
+      void retireStreaming();
+
+      LveDevice &lveDevice;
+      std::shared_ptr<LveModel> placeholder_;
+      ContentLookup contentLookup{};
+      VkDeviceSize uploadBudget = 0;
+      std::atomic<uint32_t> pending{0};
+      std::mutex completedMutex{};
+      std::vector<Completed> completed{};
+      std::vector<Streaming> streaming{};
+      std::deque<InFlight> inFlight{};
+      //last member: workers are joined before anything they touch is destroyed
+      LveThreadPool pool;
+   };
+}
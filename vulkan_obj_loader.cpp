@@ -0,0 +1,390 @@
+#include "vulkan_obj_loader.hpp"
+#include "vulkan_archive.hpp"
+#include "vulkan_mapped_file.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace lve {
+
+   namespace {
+      enum RelativeMask : uint8_t {
+         RELATIVE_POSITION = 1 << 0,
+         RELATIVE_NORMAL = 1 << 1,
+         RELATIVE_TEXCOORD = 1 << 2,
+      };
+
+      //negative face indices count back from the last element seen so far, which a chunk only knows locally.
+      //they get the chunk's base offset added once every chunk before it has been counted
+      struct RelativeCorner {
+         size_t corner;
+         uint8_t mask;
+      };
+
+      struct Chunk {
+         const char *begin = nullptr;
+         const char *end = nullptr;
+         LveObjData data{};
+         std::vector<RelativeCorner> relativeCorners{};
+         //usemtl lines: the chunk's corner count at that point and the material name. Numbered once every chunk is done
+         std::vector<std::pair<size_t, std::string>> materialUses{};
+
+         //first parse error in this chunk, reported after all threads have joined
+         const char *errorAt = nullptr;
+         std::string error{};
+
+         //offsets of this chunk's elements in the merged arrays
+         size_t positionBase = 0;
+         size_t normalBase = 0;
+         size_t texcoordBase = 0;
+         size_t cornerBase = 0;
+      };
+
+      //runs fn(0) .. fn(count - 1), each on its own thread (the calling thread takes index 0)
+      template <typename Fn>
+      void runParallel(size_t count, Fn fn) {
+         std::vector<std::thread> threads{};
+         threads.reserve(count > 0 ? count - 1 : 0);
+         for (size_t i = 1; i < count; i++) {
+            threads.emplace_back(fn, i);
+         }
+         if (count > 0) fn(0);
+         for (auto &thread : threads) {
+            thread.join();
+         }
+      }
+
+      const char *skipSpaces(const char *p, const char *end) {
+         while (p < end && (*p == ' ' || *p == '\t')) ++p;
+         return p;
+      }
+
+      //std::from_chars on float doesn't allocate or look at the locale, unlike strtof / streams
+      bool parseFloat(const char *&p, const char *end, float &value) {
+         const char *start = skipSpaces(p, end);
+         //from_chars rejects an explicit plus sign
+         if (start < end && *start == '+') ++start;
+         auto result = std::from_chars(start, end, value);
+         if (result.ptr == start) return false;
+         //magnitudes beyond float range: only underflow shows up in real files, flush it to 0
+         if (result.ec == std::errc::result_out_of_range) value = 0.f;
+         p = result.ptr;
+         return true;
+      }
+
+      bool parseIndex(const char *&p, const char *end, int32_t &value) {
+         auto result = std::from_chars(p, end, value);
+         if (result.ec != std::errc{}) return false;
+         p = result.ptr;
+         return true;
+      }
+
+      bool isSeparator(char c) {
+         return c == ' ' || c == '\t' || c == '\r';
+      }
+
+      //same defaults as tinyobj: missing components read as 0, a vertex only has a color if all 3 channels are present
+      void parseVertex(Chunk &chunk, const char *p, const char *end) {
+         float position[3] = {0.f, 0.f, 0.f};
+         for (float &component : position) {
+            parseFloat(p, end, component);
+         }
+         chunk.data.positions.insert(chunk.data.positions.end(), position, position + 3);
+
+         float color[3] = {1.f, 1.f, 1.f};
+         const char *colorStart = p;
+         if (!(parseFloat(p, end, color[0]) && parseFloat(p, end, color[1]) && parseFloat(p, end, color[2]))) {
+            color[0] = color[1] = color[2] = 1.f;
+            p = colorStart;
+         }
+         chunk.data.colors.insert(chunk.data.colors.end(), color, color + 3);
+      }
+
+      void parseNormal(Chunk &chunk, const char *p, const char *end) {
+         float normal[3] = {0.f, 0.f, 0.f};
+         for (float &component : normal) {
+            parseFloat(p, end, component);
+         }
+         chunk.data.normals.insert(chunk.data.normals.end(), normal, normal + 3);
+      }
+
+      void parseTexcoord(Chunk &chunk, const char *p, const char *end) {
+         float texcoord[2] = {0.f, 0.f};
+         for (float &component : texcoord) {
+            parseFloat(p, end, component);
+         }
+         chunk.data.texcoords.insert(chunk.data.texcoords.end(), texcoord, texcoord + 2);
+      }
+
+      //turns a 1 based (or negative, relative) OBJ index into a 0 based one. Returns false for index 0, which is invalid
+      bool resolveIndex(int32_t index, size_t localCount, int32_t &resolved, bool &relative) {
+         if (index > 0) {
+            resolved = index - 1;
+            relative = false;
+            return true;
+         }
+         if (index < 0) {
+            resolved = static_cast<int32_t>(localCount) + index;
+            relative = true;
+            return true;
+         }
+         return false;
+      }
+
+      void parseMaterialUse(Chunk &chunk, const char *p, const char *end) {
+         p = skipSpaces(p, end);
+         while (end > p && isSeparator(end[-1])) --end;
+         chunk.materialUses.push_back({chunk.data.corners.size(), std::string(p, end)});
+      }
+
+      //numbers materials in order of first use across all chunks and turns each chunk's usemtl lines into runs of global corners
+      void mergeMaterials(const std::vector<Chunk> &chunks, LveObjData &result) {
+         auto materialId = [&result](const std::string &name) {
+            const auto found = std::find(result.materials.begin(), result.materials.end(), name);
+            if (found != result.materials.end()) return static_cast<uint32_t>(found - result.materials.begin());
+            result.materials.push_back(name);
+            return static_cast<uint32_t>(result.materials.size() - 1);
+         };
+
+         for (const auto &chunk : chunks) {
+            for (const auto &use : chunk.materialUses) {
+               const size_t firstCorner = chunk.cornerBase + use.first;
+               if (result.materialRuns.empty() && firstCorner > 0) result.materialRuns.push_back({0, materialId("")});
+               const uint32_t material = materialId(use.second);
+               //a usemtl without faces after it is replaced by the next one, switching to the current material changes nothing
+               if (!result.materialRuns.empty() && result.materialRuns.back().firstCorner == firstCorner) {
+                  result.materialRuns.back().material = material;
+               } else if (result.materialRuns.empty() || result.materialRuns.back().material != material) {
+                  result.materialRuns.push_back({firstCorner, material});
+               }
+               //the replacement above can make two neighbouring runs the same
+               if (result.materialRuns.size() >= 2 && result.materialRuns[result.materialRuns.size() - 2].material == result.materialRuns.back().material) {
+                  result.materialRuns.pop_back();
+               }
+            }
+         }
+         if (!result.materialRuns.empty() && result.materialRuns.back().firstCorner == result.corners.size()) result.materialRuns.pop_back();
+      }
+
+      bool parseFace(Chunk &chunk, const char *p, const char *end, std::vector<LveObjData::Corner> &polygon, std::vector<uint8_t> &polygonMasks) {
+         polygon.clear();
+         polygonMasks.clear();
+         const size_t positionCount = chunk.data.positions.size() / 3;
+         const size_t normalCount = chunk.data.normals.size() / 3;
+         const size_t texcoordCount = chunk.data.texcoords.size() / 2;
+
+         while (true) {
+            p = skipSpaces(p, end);
+            if (p >= end || *p == '\r' || *p == '#') break;
+
+            LveObjData::Corner corner{};
+            uint8_t mask = 0;
+            bool relative = false;
+            int32_t index = 0;
+
+            //v, v/vt, v//vn or v/vt/vn
+            if (!parseIndex(p, end, index) || !resolveIndex(index, positionCount, corner.position, relative)) {
+               chunk.error = "invalid vertex index in face";
+               return false;
+            }
+            if (relative) mask |= RELATIVE_POSITION;
+
+            if (p < end && *p == '/') {
+               ++p;
+               if (p < end && *p != '/') {
+                  if (!parseIndex(p, end, index) || !resolveIndex(index, texcoordCount, corner.texcoord, relative)) {
+                     chunk.error = "invalid texture coordinate index in face";
+                     return false;
+                  }
+                  if (relative) mask |= RELATIVE_TEXCOORD;
+               }
+               if (p < end && *p == '/') {
+                  ++p;
+                  if (!parseIndex(p, end, index) || !resolveIndex(index, normalCount, corner.normal, relative)) {
+                     chunk.error = "invalid normal index in face";
+                     return false;
+                  }
+                  if (relative) mask |= RELATIVE_NORMAL;
+               }
+            }
+
+            if (p < end && !isSeparator(*p)) {
+               chunk.error = "unexpected character in face";
+               return false;
+            }
+
+            polygon.push_back(corner);
+            polygonMasks.push_back(mask);
+         }
+
+         //fan triangulation, same as tinyobj for the convex polygons exporters write. Points and lines are dropped
+         for (size_t i = 1; i + 1 < polygon.size(); i++) {
+            const size_t triangle[3] = {0, i, i + 1};
+            for (size_t k : triangle) {
+               if (polygonMasks[k] != 0) {
+                  chunk.relativeCorners.push_back({chunk.data.corners.size(), polygonMasks[k]});
+               }
+               chunk.data.corners.push_back(polygon[k]);
+            }
+         }
+         return true;
+      }
+
+      void parseChunk(Chunk &chunk) {
+         std::vector<LveObjData::Corner> polygon{};
+         std::vector<uint8_t> polygonMasks{};
+
+         const char *p = chunk.begin;
+         while (p < chunk.end) {
+            const char *lineEnd = static_cast<const char *>(memchr(p, '\n', chunk.end - p));
+            if (lineEnd == nullptr) lineEnd = chunk.end;
+
+            const char *line = skipSpaces(p, lineEnd);
+            if (lineEnd - line >= 2 && line[0] == 'v' && isSeparator(line[1])) {
+               parseVertex(chunk, line + 2, lineEnd);
+            } else if (lineEnd - line >= 3 && line[0] == 'v' && line[1] == 'n' && isSeparator(line[2])) {
+               parseNormal(chunk, line + 3, lineEnd);
+            } else if (lineEnd - line >= 3 && line[0] == 'v' && line[1] == 't' && isSeparator(line[2])) {
+               parseTexcoord(chunk, line + 3, lineEnd);
+            } else if (lineEnd - line >= 2 && line[0] == 'f' && isSeparator(line[1])) {
+               if (!parseFace(chunk, line + 2, lineEnd, polygon, polygonMasks)) {
+                  chunk.errorAt = line;
+                  return;
+               }
+            } else if (lineEnd - line >= 7 && memcmp(line, "usemtl", 6) == 0 && isSeparator(line[6])) {
+               parseMaterialUse(chunk, line + 7, lineEnd);
+            }
+            //everything else (comments, o, g, s, mtllib, ...) doesn't affect the geometry
+
+            p = lineEnd + 1;
+         }
+      }
+
+      //copies one chunk into the merged arrays and turns its indices into global ones
+      bool mergeChunk(const Chunk &chunk, LveObjData &result) {
+         const LveObjData &data = chunk.data;
+         std::copy(data.positions.begin(), data.positions.end(), result.positions.begin() + chunk.positionBase * 3);
+         std::copy(data.colors.begin(), data.colors.end(), result.colors.begin() + chunk.positionBase * 3);
+         std::copy(data.normals.begin(), data.normals.end(), result.normals.begin() + chunk.normalBase * 3);
+         std::copy(data.texcoords.begin(), data.texcoords.end(), result.texcoords.begin() + chunk.texcoordBase * 2);
+
+         LveObjData::Corner *corners = result.corners.data() + chunk.cornerBase;
+         std::copy(data.corners.begin(), data.corners.end(), corners);
+         //a relative index may point into earlier chunks, so it can only be checked once rebased. -1 means "absent" for normals and
+         //texture coordinates below, a relative one landing there (f 1/-1/1 before any vt) is out of range like any other
+         for (const auto &relative : chunk.relativeCorners) {
+            LveObjData::Corner &corner = corners[relative.corner];
+            if (relative.mask & RELATIVE_POSITION) corner.position += static_cast<int32_t>(chunk.positionBase);
+            if (relative.mask & RELATIVE_NORMAL) corner.normal += static_cast<int32_t>(chunk.normalBase);
+            if (relative.mask & RELATIVE_TEXCOORD) corner.texcoord += static_cast<int32_t>(chunk.texcoordBase);
+            if (((relative.mask & RELATIVE_NORMAL) && corner.normal < 0) || ((relative.mask & RELATIVE_TEXCOORD) && corner.texcoord < 0)) {
+               return false;
+            }
+         }
+
+         const int64_t positionCount = static_cast<int64_t>(result.positions.size() / 3);
+         const int64_t normalCount = static_cast<int64_t>(result.normals.size() / 3);
+         const int64_t texcoordCount = static_cast<int64_t>(result.texcoords.size() / 2);
+         for (size_t i = 0; i < data.corners.size(); i++) {
+            const LveObjData::Corner &corner = corners[i];
+            if (corner.position < 0 || corner.position >= positionCount ||
+               corner.normal < -1 || corner.normal >= normalCount ||
+               corner.texcoord < -1 || corner.texcoord >= texcoordCount) {
+               return false;
+            }
+         }
+         return true;
+      }
+   }
+
+   unsigned LveObjLoader::chooseThreadCount(size_t size, unsigned threadCount) {
+      if (threadCount == 0) {
+         threadCount = std::max(1u, std::thread::hardware_concurrency());
+      }
+      const size_t useful = std::max<size_t>(1, size / MIN_BYTES_PER_THREAD);
+      return static_cast<unsigned>(std::min<size_t>(threadCount, useful));
+   }
+
+   LveObjData LveObjLoader::load(const std::string &filepath, unsigned threadCount) {
+      if (LveArchive *archive = LveArchive::mounted()) {
+         if (archive->find(filepath) != nullptr) {
+            const std::vector<char> contents = archive->read(filepath);
+            return parse(contents.data(), contents.data() + contents.size(), threadCount, filepath);
+         }
+      }
+
+      LveMappedFile file{filepath};
+      const char *begin = reinterpret_cast<const char *>(file.data());
+      return parse(begin, begin + file.size(), threadCount, filepath);
+   }
+
+   LveObjData LveObjLoader::parse(const char *begin, const char *end, unsigned threadCount, const std::string &name) {
+      const size_t size = static_cast<size_t>(end - begin);
+      const unsigned chunkCount = chooseThreadCount(size, threadCount);
+
+      //split at even byte offsets, then push each split forward to the next line start so no line is cut in two
+      std::vector<Chunk> chunks(chunkCount);
+      for (unsigned i = 0; i < chunkCount; i++) {
+         const char *start = begin + size * i / chunkCount;
+         if (i > 0 && start < end) {
+            const char *newline = static_cast<const char *>(memchr(start - 1, '\n', end - (start - 1)));
+            start = newline != nullptr ? newline + 1 : end;
+         }
+         chunks[i].begin = std::max(start, i > 0 ? chunks[i - 1].begin : begin);
+      }
+      for (unsigned i = 0; i < chunkCount; i++) {
+         chunks[i].end = i + 1 < chunkCount ? chunks[i + 1].begin : end;
+      }
+
+      runParallel(chunks.size(), [&chunks](size_t i) { parseChunk(chunks[i]); });
+
+      for (const auto &chunk : chunks) {
+         if (chunk.errorAt != nullptr) {
+            const size_t line = std::count(begin, chunk.errorAt, '\n') + 1;
+            throw std::runtime_error(name + ":" + std::to_string(line) + ": " + chunk.error);
+         }
+      }
+
+      //exclusive prefix sums give every chunk its place in the merged arrays
+      size_t positionCount = 0, normalCount = 0, texcoordCount = 0, cornerCount = 0;
+      for (auto &chunk : chunks) {
+         chunk.positionBase = positionCount;
+         chunk.normalBase = normalCount;
+         chunk.texcoordBase = texcoordCount;
+         chunk.cornerBase = cornerCount;
+         positionCount += chunk.data.positions.size() / 3;
+         normalCount += chunk.data.normals.size() / 3;
+         texcoordCount += chunk.data.texcoords.size() / 2;
+         cornerCount += chunk.data.corners.size();
+      }
+      if (positionCount > static_cast<size_t>(INT32_MAX) || normalCount > static_cast<size_t>(INT32_MAX) || texcoordCount > static_cast<size_t>(INT32_MAX)) {
+         throw std::runtime_error(name + ": too many vertex attributes");
+      }
+
+      LveObjData result{};
+      result.positions.resize(positionCount * 3);
+      result.colors.resize(positionCount * 3);
+      result.normals.resize(normalCount * 3);
+      result.texcoords.resize(texcoordCount * 2);
+      result.corners.resize(cornerCount);
+
+      std::vector<char> valid(chunks.size(), 0);
+      runParallel(chunks.size(), [&](size_t i) {
+         valid[i] = mergeChunk(chunks[i], result);
+         //chunk memory isn't needed anymore, release it while the other threads are still copying
+         chunks[i].data = LveObjData{};
+      });
+
+      for (size_t i = 0; i < chunks.size(); i++) {
+         if (!valid[i]) {
+            const size_t line = std::count(begin, chunks[i].begin, '\n') + 1;
+            throw std::runtime_error(name + ": face index out of range in chunk starting at line " + std::to_string(line));
+         }
+      }
+      mergeMaterials(chunks, result);
+      return result;
+   }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lve {
+
+   //raw contents of an OBJ file: attribute arrays as they appear in the file, plus one corner per triangle vertex.
+   //polygons are fan triangulated, so corners.size() is always a multiple of 3
+   struct LveObjData {
+      struct Corner {
+         //0 based indices into the attribute arrays, -1 if the face didn't reference that attribute
+         int32_t position = -1;
+         int32_t normal = -1;
+         int32_t texcoord = -1;
+      };
+
+      //3 floats per vertex. colors always has one entry per position, white when the file has no vertex colors
+      std::vector<float> positions{};
+      std::vector<float> colors{};
+      std::vector<float> normals{};
+      //2 floats per texture coordinate
+      std::vector<float> texcoords{};
+      std::vector<Corner> corners{};
+
+      //material names in order of their first usemtl. Faces before the first usemtl get an unnamed material
+      std::vector<std::string> materials{};
+      //corners from firstCorner up to the next run use material. Empty if the file never says usemtl
+      struct MaterialRun {
+         size_t firstCorner;
+         uint32_t material;
+      };
+      std::vector<MaterialRun> materialRuns{};
+   };
+
+   class LveObjLoader {
+      public:
+      //files smaller than this per thread aren't worth splitting up
+      static constexpr size_t MIN_BYTES_PER_THREAD = 1 << 20;
+
+      //maps the file and parses line aligned chunks of it on separate threads, then stitches the chunks back together in file order.
+      //threadCount 0 means one thread per hardware thread
+      static LveObjData load(const std::string &filepath, unsigned threadCount = 0);
+      static LveObjData parse(const char *begin, const char *end, unsigned threadCount = 0, const std::string &name = "<memory>");
+
+      //number of threads parse() would use for a buffer of this size
+      static unsigned chooseThreadCount(size_t size, unsigned threadCount);
+   };
+}
@@ -1,6 +1,8 @@
 #include "vulkan_pipeline.hpp"
 
+#include "vulkan_archive.hpp"
 #include "vulkan_model.hpp"
+#include "vulkan_shader_reflection.hpp"
 
 #include <fstream>
 #include <stdexcept>
@@ -29,6 +31,10 @@ namespace lve {
    }
 
    std::vector<char> LvePipeline::readFile(const std::string& filepath) {
+      //packed builds ship their shaders in the mounted archive
+      if (LveArchive *archive = LveArchive::mounted()) {
+         if (archive->find(filepath) != nullptr) return archive->read(filepath);
+      }
 
       std::ifstream file(filepath, std::ios::ate | std::ios::binary);
 
@@ -61,15 +67,29 @@ namespace lve {
       std::cout << "Vertex shader file path: " << vertFilepath << std::endl;
       std::cout << "Fragment shader file path: " << fragFilepath << std::endl;
 
+      //no fragment shader for depth only pipelines
+      const bool hasFragmentStage = !fragFilepath.empty();
       auto vertCode = readFile(vertFilepath);
-      auto fragCode = readFile(fragFilepath);
+      auto fragCode = hasFragmentStage ? readFile(fragFilepath) : std::vector<char>{};
 
       std::cout << "vertCode size: " << vertCode.size() << '\n';
       std::cout << "fragCode size: " << fragCode.size() << '\n';
 
+      //only the attributes the vertex shader actually reads get fetched. Inputs it declares but never loads leave its interface,
+      //every input left there needs an attribute
+      const auto vertexInputs = LveShaderReflection::vertexInputs(vertCode.data(), vertCode.size());
+      vertCode = LveShaderReflection::removeUnusedInputs(vertCode);
+      const LveVertexInputState vertexInputState = LveShaderReflection::selectInputs(
+         vertexInputs,
+         configInfo.bindingDescriptions,
+         configInfo.bindingDescriptionCount,
+         configInfo.attributeDescriptions,
+         configInfo.attributeDescriptionCount);
+      std::cout << "Vertex shader reads " << vertexInputState.attributeCount << " of " << configInfo.attributeDescriptionCount << " vertex attributes\n";
+
       //& is a pointer (memory address)
       createShaderModule(vertCode, &vertShaderModule);
-      createShaderModule(fragCode, &fragShaderModule);
+      if (hasFragmentStage) createShaderModule(fragCode, &fragShaderModule);
 
       //array of 2 structs. This struct describes a shader stage in a pipeline.
       VkPipelineShaderStageCreateInfo shaderStages[2];
@@ -92,14 +112,12 @@ namespace lve {
       shaderStages[1].pSpecializationInfo = nullptr;
 
       //if you use pipelineInfo but it gets destroyed, then the pipeline will be destroyed as well
-      auto bindingDescriptions = LveModel::Vertex::getBindingDescriptions();
-      auto attributeDescriptions = LveModel::Vertex::getAttributeDescriptions();
       VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
       vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-      vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
-      vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-      vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
-      vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+      vertexInputInfo.vertexBindingDescriptionCount = vertexInputState.bindingCount;
+      vertexInputInfo.vertexAttributeDescriptionCount = vertexInputState.attributeCount;
+      vertexInputInfo.pVertexBindingDescriptions = vertexInputState.bindings;
+      vertexInputInfo.pVertexAttributeDescriptions = vertexInputState.attributes;
 
       // VkPipelineViewportStateCreateInfo viewportInfo{};
       // viewportInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
@@ -112,7 +130,7 @@ namespace lve {
       VkGraphicsPipelineCreateInfo pipelineInfo{};
       pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
       //how many programmable stages are in the pipeline
-      pipelineInfo.stageCount = 2;
+      pipelineInfo.stageCount = hasFragmentStage ? 2 : 1;
       pipelineInfo.pStages = shaderStages;
       //wire up create info to config info. Can use this code to create pipelines in the future
       pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -250,5 +268,7 @@ namespace lve {
       static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
       configInfo.dynamicStateInfo.flags = 0;
 
+      configInfo.setVertexLayout<LveModel::Vertex>();
+
    }
 }
\ No newline at end of file
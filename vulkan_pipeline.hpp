@@ -1,7 +1,9 @@
 #pragma once
 
 #include "vulkan_device.hpp"
+#include "vulkan_model.hpp"
 
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -13,6 +15,20 @@ namespace lve {
       PipelineConfigInfo& operator=(const PipelineConfigInfo&) = delete;
       PipelineConfigInfo() = default;
 
+      //vertex layout the pipeline reads, defaults to LveModel::Vertex. Points at the static arrays of an LveVertexLayout.
+      //the pipeline binds the part of it the vertex shader uses
+      const VkVertexInputBindingDescription *bindingDescriptions = nullptr;
+      uint32_t bindingDescriptionCount = 0;
+      const VkVertexInputAttributeDescription *attributeDescriptions = nullptr;
+      uint32_t attributeDescriptionCount = 0;
+
+      template <typename V>
+      void setVertexLayout() {
+         bindingDescriptions = LveVertexLayout<V>::BINDINGS;
+         bindingDescriptionCount = static_cast<uint32_t>(std::size(LveVertexLayout<V>::BINDINGS));
+         attributeDescriptions = LveVertexLayout<V>::ATTRIBUTES;
+         attributeDescriptionCount = static_cast<uint32_t>(std::size(LveVertexLayout<V>::ATTRIBUTES));
+      }
       VkPipelineViewportStateCreateInfo viewportInfo;
       VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
       VkPipelineRasterizationStateCreateInfo rasterizationInfo;
@@ -29,6 +45,7 @@ namespace lve {
 
    class LvePipeline {
       public:
+         //an empty fragFilepath makes a depth only pipeline, with the vertex stage alone
          LvePipeline(
             LveDevice& device, 
             const std::string& vertFilepath, 
@@ -58,6 +75,6 @@ namespace lve {
          //typedef pointer to a struct
          VkPipeline graphicsPipeline;
          VkShaderModule vertShaderModule;
-         VkShaderModule fragShaderModule;
+         VkShaderModule fragShaderModule = VK_NULL_HANDLE;
    };
 }
\ No newline at end of file
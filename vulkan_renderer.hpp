@@ -26,6 +26,10 @@ namespace lve {
             return lveSwapChain->extentAspectRatio();
          }
 
+         VkExtent2D getSwapChainExtent() {
+            return lveSwapChain->getSwapChainExtent();
+         }
+
          bool isFrameInProgress() { return isFrameStarted; }
 
          VkCommandBuffer getCurrentCommandBuffer() { 
@@ -0,0 +1,310 @@
+#include "vulkan_shader_reflection.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lve {
+
+   namespace {
+      //opcodes and enumerants from the SPIR-V specification
+      constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+      constexpr uint32_t HEADER_WORDS = 5;
+      constexpr uint32_t OP_ENTRY_POINT = 15;
+      constexpr uint32_t OP_TYPE_INT = 21;
+      constexpr uint32_t OP_TYPE_FLOAT = 22;
+      constexpr uint32_t OP_TYPE_VECTOR = 23;
+      constexpr uint32_t OP_TYPE_MATRIX = 24;
+      constexpr uint32_t OP_TYPE_POINTER = 32;
+      constexpr uint32_t OP_FUNCTION_CALL = 57;
+      constexpr uint32_t OP_VARIABLE = 59;
+      constexpr uint32_t OP_LOAD = 61;
+      constexpr uint32_t OP_COPY_MEMORY = 63;
+      constexpr uint32_t OP_ACCESS_CHAIN = 65;
+      constexpr uint32_t OP_IN_BOUNDS_ACCESS_CHAIN = 66;
+      constexpr uint32_t OP_PTR_ACCESS_CHAIN = 67;
+      constexpr uint32_t OP_DECORATE = 71;
+      constexpr uint32_t DECORATION_BUILT_IN = 11;
+      constexpr uint32_t DECORATION_LOCATION = 30;
+      constexpr uint32_t STORAGE_CLASS_INPUT = 1;
+      constexpr uint32_t EXECUTION_MODEL_VERTEX = 0;
+
+      struct TypeInfo {
+         enum class Kind { Other, Scalar, Vector, Matrix, Pointer };
+
+         Kind kind = Kind::Other;
+         LveShaderInput::Type scalar = LveShaderInput::Type::Float;
+         //vector size, column size of a matrix
+         uint32_t components = 1;
+         uint32_t columns = 1;
+         //what a pointer points to, or the component / column type
+         uint32_t element = 0;
+      };
+
+      //what the reflection needs from one pass over the module
+      struct Module {
+         std::vector<uint32_t> words{};
+         //word index of the entry point instruction and where its interface ids start
+         size_t entryPoint = 0;
+         size_t interfaceBegin = 0;
+         std::vector<uint32_t> interface{};
+         std::unordered_map<uint32_t, uint32_t> locations{};
+         std::unordered_set<uint32_t> builtIns{};
+         std::unordered_map<uint32_t, TypeInfo> types{};
+         //Input variables and their pointer type
+         std::unordered_map<uint32_t, uint32_t> inputVariables{};
+         //ids that an instruction reads through: loads, copies, access chains and pointers passed to functions
+         std::unordered_set<uint32_t> loaded{};
+      };
+
+      Module parse(const char *code, size_t size, const char *entryName) {
+         if (size % 4 != 0 || size < HEADER_WORDS * 4) {
+            throw std::runtime_error("shader code is not SPIR-V");
+         }
+         Module module{};
+         module.words.resize(size / 4);
+         std::memcpy(module.words.data(), code, size);
+         const std::vector<uint32_t> &words = module.words;
+         if (words[0] != SPIRV_MAGIC) {
+            throw std::runtime_error("shader code is not SPIR-V");
+         }
+
+         bool foundEntry = false;
+         for (size_t at = HEADER_WORDS; at < words.size();) {
+            const uint32_t wordCount = words[at] >> 16;
+            const uint32_t opcode = words[at] & 0xffff;
+            if (wordCount == 0 || at + wordCount > words.size()) {
+               throw std::runtime_error("malformed SPIR-V instruction");
+            }
+            const uint32_t *operands = &words[at + 1];
+            const uint32_t operandCount = wordCount - 1;
+
+            switch (opcode) {
+               case OP_ENTRY_POINT: {
+                  if (operandCount < 3 || operands[0] != EXECUTION_MODEL_VERTEX) break;
+                  //the name is a nul terminated string packed 4 characters to a word
+                  const char *name = reinterpret_cast<const char *>(operands + 2);
+                  const size_t nameBytes = (operandCount - 2) * 4;
+                  const size_t nameLength = strnlen(name, nameBytes);
+                  if (nameLength == nameBytes || std::strcmp(name, entryName) != 0) break;
+                  foundEntry = true;
+                  module.entryPoint = at;
+                  module.interfaceBegin = at + 3 + nameLength / 4 + 1;
+                  module.interface.assign(words.begin() + module.interfaceBegin, words.begin() + at + wordCount);
+                  break;
+               }
+               case OP_DECORATE:
+                  if (operandCount >= 3 && operands[1] == DECORATION_LOCATION) module.locations[operands[0]] = operands[2];
+                  if (operandCount >= 2 && operands[1] == DECORATION_BUILT_IN) module.builtIns.insert(operands[0]);
+                  break;
+               case OP_TYPE_INT:
+                  if (operandCount >= 3) {
+                     TypeInfo &type = module.types[operands[0]];
+                     type.kind = TypeInfo::Kind::Scalar;
+                     type.scalar = operands[2] ? LveShaderInput::Type::Int : LveShaderInput::Type::Uint;
+                  }
+                  break;
+               case OP_TYPE_FLOAT:
+                  if (operandCount >= 2) {
+                     TypeInfo &type = module.types[operands[0]];
+                     type.kind = TypeInfo::Kind::Scalar;
+                     type.scalar = operands[1] == 64 ? LveShaderInput::Type::Double : LveShaderInput::Type::Float;
+                  }
+                  break;
+               case OP_TYPE_VECTOR:
+               case OP_TYPE_MATRIX:
+                  if (operandCount >= 3) {
+                     TypeInfo type = module.types[operands[1]];
+                     type.kind = opcode == OP_TYPE_VECTOR ? TypeInfo::Kind::Vector : TypeInfo::Kind::Matrix;
+                     if (opcode == OP_TYPE_VECTOR) {
+                        type.components = operands[2];
+                     } else {
+                        type.columns = operands[2];
+                     }
+                     type.element = operands[1];
+                     module.types[operands[0]] = type;
+                  }
+                  break;
+               case OP_TYPE_POINTER:
+                  if (operandCount >= 3) {
+                     TypeInfo &type = module.types[operands[0]];
+                     type.kind = TypeInfo::Kind::Pointer;
+                     type.element = operands[2];
+                  }
+                  break;
+               case OP_VARIABLE:
+                  if (operandCount >= 3 && operands[2] == STORAGE_CLASS_INPUT) module.inputVariables[operands[1]] = operands[0];
+                  break;
+               case OP_LOAD:
+               case OP_ACCESS_CHAIN:
+               case OP_IN_BOUNDS_ACCESS_CHAIN:
+               case OP_PTR_ACCESS_CHAIN:
+                  if (operandCount >= 3) module.loaded.insert(operands[2]);
+                  break;
+               case OP_COPY_MEMORY:
+                  if (operandCount >= 2) module.loaded.insert(operands[1]);
+                  break;
+               case OP_FUNCTION_CALL:
+                  //whatever the callee does with it, an input passed by pointer counts as read
+                  for (uint32_t i = 3; i < operandCount; i++) module.loaded.insert(operands[i]);
+                  break;
+            }
+            at += wordCount;
+         }
+
+         if (!foundEntry) {
+            throw std::runtime_error(std::string{"SPIR-V has no vertex entry point named "} + entryName);
+         }
+         return module;
+      }
+
+      //the interface ids that are vertex inputs: Input variables with a location that aren't built-ins like gl_VertexIndex
+      bool isVertexInput(const Module &module, uint32_t id) {
+         return module.inputVariables.count(id) && !module.builtIns.count(id) && module.locations.count(id);
+      }
+   }
+
+   std::vector<LveShaderInput> LveShaderReflection::vertexInputs(const char *code, size_t size, const char *entryName) {
+      const Module module = parse(code, size, entryName);
+
+      std::vector<LveShaderInput> inputs{};
+      for (uint32_t id : module.interface) {
+         if (!isVertexInput(module, id)) continue;
+
+         const uint32_t location = module.locations.at(id);
+         const bool used = module.loaded.count(id) > 0;
+         const auto pointer = module.types.find(module.inputVariables.at(id));
+         const auto type = pointer == module.types.end() ? module.types.end() : module.types.find(pointer->second.element);
+         if (type == module.types.end() || type->second.kind == TypeInfo::Kind::Other || type->second.kind == TypeInfo::Kind::Pointer) {
+            throw std::runtime_error("vertex shader input at location " + std::to_string(location) + " has a type no vertex attribute can feed");
+         }
+
+         //a matrix takes one location per column
+         const TypeInfo &info = type->second;
+         const uint32_t columns = info.kind == TypeInfo::Kind::Matrix ? info.columns : 1;
+         for (uint32_t column = 0; column < columns; column++) {
+            inputs.push_back({location + column, info.components, info.scalar, used});
+         }
+      }
+      std::sort(inputs.begin(), inputs.end(), [](const LveShaderInput &a, const LveShaderInput &b) { return a.location < b.location; });
+      return inputs;
+   }
+
+   std::vector<char> LveShaderReflection::removeUnusedInputs(const std::vector<char> &code, const char *entryName) {
+      const Module module = parse(code.data(), code.size(), entryName);
+
+      std::vector<uint32_t> interface{};
+      for (uint32_t id : module.interface) {
+         if (!isVertexInput(module, id) || module.loaded.count(id)) interface.push_back(id);
+      }
+      if (interface.size() == module.interface.size()) return code;
+
+      //the entry point instruction shrinks, everything after it moves down
+      const std::vector<uint32_t> &words = module.words;
+      const size_t entryEnd = module.interfaceBegin + module.interface.size();
+      std::vector<uint32_t> stripped(words.begin(), words.begin() + module.interfaceBegin);
+      stripped.insert(stripped.end(), interface.begin(), interface.end());
+      stripped.insert(stripped.end(), words.begin() + entryEnd, words.end());
+      const uint32_t wordCount = static_cast<uint32_t>(module.interfaceBegin + interface.size() - module.entryPoint);
+      stripped[module.entryPoint] = (wordCount << 16) | OP_ENTRY_POINT;
+
+      std::vector<char> result(stripped.size() * 4);
+      std::memcpy(result.data(), stripped.data(), result.size());
+      return result;
+   }
+
+   LveVertexInputState LveShaderReflection::selectInputs(
+      const std::vector<LveShaderInput> &inputs,
+      const VkVertexInputBindingDescription *bindings,
+      uint32_t bindingCount,
+      const VkVertexInputAttributeDescription *attributes,
+      uint32_t attributeCount) {
+      LveVertexInputState state{};
+      for (const LveShaderInput &input : inputs) {
+         if (!input.used) continue;
+
+         const VkVertexInputAttributeDescription *attribute = std::find_if(attributes, attributes + attributeCount,
+            [&](const VkVertexInputAttributeDescription &candidate) { return candidate.location == input.location; });
+         if (attribute == attributes + attributeCount) {
+            throw std::runtime_error("vertex shader reads location " + std::to_string(input.location) + ", which the vertex layout doesn't have");
+         }
+
+         uint32_t componentCount = 0;
+         LveShaderInput::Type type{};
+         if (describeFormat(attribute->format, componentCount, type)) {
+            if (type != input.type) {
+               throw std::runtime_error("vertex shader reads location " + std::to_string(input.location) + " as another numeric type than its vertex format");
+            }
+            //valid, the missing components read as 0 and the missing alpha as 1, but more often a mistake than not
+            if (componentCount < input.componentCount) {
+               std::cout << "Vertex shader reads " << input.componentCount << " components at location " << input.location
+                         << ", the vertex format has " << componentCount << '\n';
+            }
+         }
+
+         if (state.attributeCount == LveVertexInputState::MAX_ATTRIBUTES) {
+            throw std::runtime_error("vertex shader reads more attributes than every device supports");
+         }
+         state.attributes[state.attributeCount++] = *attribute;
+
+         const auto bindingEnd = state.bindings + state.bindingCount;
+         const auto sameBinding = [&](const VkVertexInputBindingDescription &candidate) { return candidate.binding == attribute->binding; };
+         if (std::find_if(state.bindings, bindingEnd, sameBinding) != bindingEnd) continue;
+         const VkVertexInputBindingDescription *binding = std::find_if(bindings, bindings + bindingCount, sameBinding);
+         if (binding == bindings + bindingCount) {
+            throw std::runtime_error("vertex layout has no binding " + std::to_string(attribute->binding));
+         }
+         state.bindings[state.bindingCount++] = *binding;
+      }
+      return state;
+   }
+
+   bool LveShaderReflection::describeFormat(VkFormat format, uint32_t &componentCount, LveShaderInput::Type &type) {
+      using Type = LveShaderInput::Type;
+      switch (format) {
+         case VK_FORMAT_R8_UNORM: case VK_FORMAT_R8_SNORM: case VK_FORMAT_R16_UNORM: case VK_FORMAT_R16_SNORM:
+         case VK_FORMAT_R16_SFLOAT: case VK_FORMAT_R32_SFLOAT:
+            componentCount = 1; type = Type::Float; return true;
+         case VK_FORMAT_R8G8_UNORM: case VK_FORMAT_R8G8_SNORM: case VK_FORMAT_R16G16_UNORM: case VK_FORMAT_R16G16_SNORM:
+         case VK_FORMAT_R16G16_SFLOAT: case VK_FORMAT_R32G32_SFLOAT:
+            componentCount = 2; type = Type::Float; return true;
+         case VK_FORMAT_R8G8B8_UNORM: case VK_FORMAT_R8G8B8_SNORM: case VK_FORMAT_R16G16B16_UNORM: case VK_FORMAT_R16G16B16_SNORM:
+         case VK_FORMAT_R16G16B16_SFLOAT: case VK_FORMAT_R32G32B32_SFLOAT:
+            componentCount = 3; type = Type::Float; return true;
+         case VK_FORMAT_R8G8B8A8_UNORM: case VK_FORMAT_R8G8B8A8_SNORM: case VK_FORMAT_B8G8R8A8_UNORM: case VK_FORMAT_R16G16B16A16_UNORM:
+         case VK_FORMAT_R16G16B16A16_SNORM: case VK_FORMAT_R16G16B16A16_SFLOAT: case VK_FORMAT_R32G32B32A32_SFLOAT:
+         case VK_FORMAT_A2B10G10R10_UNORM_PACK32: case VK_FORMAT_A2B10G10R10_SNORM_PACK32:
+            componentCount = 4; type = Type::Float; return true;
+         case VK_FORMAT_R8_UINT: case VK_FORMAT_R16_UINT: case VK_FORMAT_R32_UINT:
+            componentCount = 1; type = Type::Uint; return true;
+         case VK_FORMAT_R8G8_UINT: case VK_FORMAT_R16G16_UINT: case VK_FORMAT_R32G32_UINT:
+            componentCount = 2; type = Type::Uint; return true;
+         case VK_FORMAT_R32G32B32_UINT:
+            componentCount = 3; type = Type::Uint; return true;
+         case VK_FORMAT_R8G8B8A8_UINT: case VK_FORMAT_R16G16B16A16_UINT: case VK_FORMAT_R32G32B32A32_UINT:
+            componentCount = 4; type = Type::Uint; return true;
+         case VK_FORMAT_R8_SINT: case VK_FORMAT_R16_SINT: case VK_FORMAT_R32_SINT:
+            componentCount = 1; type = Type::Int; return true;
+         case VK_FORMAT_R8G8_SINT: case VK_FORMAT_R16G16_SINT: case VK_FORMAT_R32G32_SINT:
+            componentCount = 2; type = Type::Int; return true;
+         case VK_FORMAT_R32G32B32_SINT:
+            componentCount = 3; type = Type::Int; return true;
+         case VK_FORMAT_R8G8B8A8_SINT: case VK_FORMAT_R16G16B16A16_SINT: case VK_FORMAT_R32G32B32A32_SINT:
+            componentCount = 4; type = Type::Int; return true;
+         case VK_FORMAT_R64_SFLOAT:
+            componentCount = 1; type = Type::Double; return true;
+         case VK_FORMAT_R64G64_SFLOAT:
+            componentCount = 2; type = Type::Double; return true;
+         case VK_FORMAT_R64G64B64_SFLOAT:
+            componentCount = 3; type = Type::Double; return true;
+         case VK_FORMAT_R64G64B64A64_SFLOAT:
+            componentCount = 4; type = Type::Double; return true;
+         default:
+            return false;
+      }
+   }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+   //a vertex shader input variable as the SPIR-V declares it
+   struct LveShaderInput {
+      enum class Type { Float, Int, Uint, Double };
+
+      uint32_t location;
+      //1 to 4, a matrix is one input per column
+      uint32_t componentCount;
+      Type type;
+      //false if the shader declares it but never loads it. glslang keeps such inputs in the entry point interface
+      bool used;
+   };
+
+   //vertex input state built from a vertex layout and the inputs of the shader that reads it. Fixed size, creating a pipeline
+   //doesn't allocate for it
+   struct LveVertexInputState {
+      //the minimum maxVertexInputAttributes and maxVertexInputBindings every device supports
+      static constexpr uint32_t MAX_ATTRIBUTES = 16;
+
+      VkVertexInputBindingDescription bindings[MAX_ATTRIBUTES];
+      uint32_t bindingCount = 0;
+      VkVertexInputAttributeDescription attributes[MAX_ATTRIBUTES];
+      uint32_t attributeCount = 0;
+   };
+
+   //reads what the pipeline needs to know straight out of SPIR-V, so the shaders stay the one place the inputs are declared
+   class LveShaderReflection {
+      public:
+      //inputs of the vertex shader entry point entryName, sorted by location. Throws if code isn't SPIR-V, has no such entry
+      //point or declares an input type a vertex buffer can't feed (arrays, structs)
+      static std::vector<LveShaderInput> vertexInputs(const char *code, size_t size, const char *entryName = "main");
+      //code with the inputs that are never loaded taken out of the entry point's interface. Every input in the interface needs an
+      //attribute, one that isn't is just an unused global and its attribute can be left out
+      static std::vector<char> removeUnusedInputs(const std::vector<char> &code, const char *entryName = "main");
+
+      //the attributes of the layout that the shader uses and the bindings they read from. Attributes the shader declares but never
+      //loads are left out, so they aren't fetched, and so is a binding left without attributes.
+      //throws if the shader uses a location the layout doesn't have or reads it as another numeric type than its format
+      static LveVertexInputState selectInputs(
+         const std::vector<LveShaderInput> &inputs,
+         const VkVertexInputBindingDescription *bindings,
+         uint32_t bindingCount,
+         const VkVertexInputAttributeDescription *attributes,
+         uint32_t attributeCount);
+
+      //components and the numeric type a shader reads a vertex format as, false for formats that aren't vertex formats
+      static bool describeFormat(VkFormat format, uint32_t &componentCount, LveShaderInput::Type &type);
+   };
+}
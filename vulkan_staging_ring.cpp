@@ -0,0 +1,118 @@
+#include "vulkan_staging_ring.hpp"
+#include "vulkan_swap_chain.hpp"
+#include "vulkan_upload_manager.hpp"
+
+#include <algorithm>
+
+namespace lve {
+
+   namespace {
+      constexpr VkBufferUsageFlags RING_USAGE =
+         VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+
+      VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+         return (value + alignment - 1) & ~(alignment - 1);
+      }
+   }
+
+   LveStagingRing::LveStagingRing(LveDevice &device)
+      : lveDevice{device}, capacity_{FRAME_SIZE * LveSwapChain::MAX_FRAMES_IN_FLIGHT} {
+      //no coherent requirement, the first host visible type is usually the fastest to write through. flush covers the rest
+      lveDevice.createBuffer(capacity_, RING_USAGE, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, buffer, memory);
+   }
+
+   LveStagingRing::~LveStagingRing() {
+      for (auto &entry : marks) {
+         if (entry.fence == VK_NULL_HANDLE) lveDevice.uploadManager().wait(entry.ticket);
+         for (auto &oneOff : entry.oneOffs) lveDevice.destroyBuffer(oneOff.buffer, oneOff.memory);
+      }
+      for (auto &oneOff : openOneOffs) lveDevice.destroyBuffer(oneOff.buffer, oneOff.memory);
+      lveDevice.destroyBuffer(buffer, memory);
+   }
+
+   LveStagingRing::Allocation LveStagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment) {
+      size = std::max(size, VkDeviceSize{1});
+      if (size <= capacity_ && alignment <= FRAME_SIZE) {
+         do {
+            //nothing in use: the whole buffer is free from its beginning
+            if (head == tail) head = tail = (head + capacity_ - 1) / capacity_ * capacity_;
+            VkDeviceSize position = alignUp(head, alignment);
+            //no room before the end of the buffer: starts over at its beginning, capacity_ is a multiple of the alignment
+            if (position % capacity_ + size > capacity_) position = (position / capacity_ + 1) * capacity_;
+            if (position + size <= tail + capacity_) {
+               head = position + size;
+               const VkDeviceSize offset = position % capacity_;
+               return {buffer, offset, size, static_cast<char *>(memory.mapped) + offset};
+            }
+         } while (reclaim(true));
+      }
+
+      OneOff oneOff{};
+      lveDevice.createBuffer(size, RING_USAGE, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, oneOff.buffer, oneOff.memory);
+      openOneOffs.push_back(oneOff);
+      return {oneOff.buffer, 0, size, oneOff.memory.mapped};
+   }
+
+   void LveStagingRing::flush(const Allocation &allocation) {
+      if (allocation.buffer == buffer) {
+         lveDevice.flushMemory(memory, allocation.offset, allocation.size);
+         return;
+      }
+      //a one-off, only ever flushed right after it was handed out
+      auto oneOff = std::find_if(
+         openOneOffs.rbegin(), openOneOffs.rend(), [&](const OneOff &candidate) { return candidate.buffer == allocation.buffer; });
+      if (oneOff != openOneOffs.rend()) lveDevice.flushMemory(oneOff->memory, allocation.offset, allocation.size);
+   }
+
+   void LveStagingRing::endUploads(uint64_t ticket) {
+      mark(VK_NULL_HANDLE, ticket);
+   }
+
+   void LveStagingRing::endFrame(VkFence fence) {
+      mark(fence, 0);
+      //cheap, and keeps one-offs from piling up while nothing needs the space
+      reclaim(false);
+   }
+
+   void LveStagingRing::releaseFence(VkFence fence) {
+      for (auto &entry : marks) {
+         if (entry.fence != fence) continue;
+         vkWaitForFences(lveDevice.device(), 1, &fence, VK_TRUE, UINT64_MAX);
+         //ticket 0 is always complete
+         entry.fence = VK_NULL_HANDLE;
+         entry.ticket = 0;
+      }
+   }
+
+   void LveStagingRing::mark(VkFence fence, uint64_t ticket) {
+      const VkDeviceSize marked = marks.empty() ? tail : marks.back().end;
+      if (head == marked && openOneOffs.empty()) return;
+      marks.push_back({head, fence, ticket, std::move(openOneOffs)});
+      openOneOffs.clear();
+   }
+
+   bool LveStagingRing::isComplete(const Mark &entry) {
+      if (entry.fence != VK_NULL_HANDLE) return vkGetFenceStatus(lveDevice.device(), entry.fence) == VK_SUCCESS;
+      return lveDevice.uploadManager().isComplete(entry.ticket);
+   }
+
+   bool LveStagingRing::reclaim(bool wait) {
+      bool reclaimed = false;
+      while (!marks.empty()) {
+         Mark &entry = marks.front();
+         if (!isComplete(entry)) {
+            if (!wait || reclaimed) break;
+            if (entry.fence != VK_NULL_HANDLE) {
+               vkWaitForFences(lveDevice.device(), 1, &entry.fence, VK_TRUE, UINT64_MAX);
+            } else {
+               lveDevice.uploadManager().wait(entry.ticket);
+            }
+         }
+         for (auto &oneOff : entry.oneOffs) lveDevice.destroyBuffer(oneOff.buffer, oneOff.memory);
+         tail = entry.end;
+         marks.pop_front();
+         reclaimed = true;
+      }
+      return reclaimed;
+   }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "vulkan_device.hpp"
+
+#include <deque>
+#include <vector>
+
+namespace lve {
+
+   //one host visible buffer, mapped for good, that staging data and per-frame data are written into instead of a buffer each.
+   //allocations are handed out in order and wrap around, the space behind them comes back once the GPU is done reading it:
+   //LveSwapChain marks the end of every frame with its in flight fence, LveUploadBatch the end of every batch with its upload
+   //ticket. A mark covers everything allocated before it, so a batch has to be submitted before the next one is and data read
+   //by a frame written before the frame is submitted.
+   //requests the ring can't take, bigger than it or with the whole ring waiting on unsubmitted data, get a buffer of their own
+   //freed at the next mark. Owned by LveDevice, used from the thread that submits frames
+   class LveStagingRing {
+      public:
+      //the ring holds this much for each frame in flight
+      static constexpr VkDeviceSize FRAME_SIZE = 16 * 1024 * 1024;
+
+      struct Allocation {
+         VkBuffer buffer = VK_NULL_HANDLE;
+         VkDeviceSize offset = 0;
+         VkDeviceSize size = 0;
+         //where to write, at offset
+         void *mapped = nullptr;
+      };
+
+      explicit LveStagingRing(LveDevice &device);
+      //waits for the uploads still reading from it, the frames are done by the time the device goes
+      ~LveStagingRing();
+
+      LveStagingRing(const LveStagingRing &) = delete;
+      LveStagingRing &operator=(const LveStagingRing &) = delete;
+
+      //size bytes at an offset aligned to alignment (a power of two). Usable as a transfer source and as vertex or index data.
+      //waits for the oldest marked work when the ring is full
+      Allocation allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+      //makes what the host wrote to allocation visible to the device, needed once after writing unless the memory is coherent
+      void flush(const Allocation &allocation);
+
+      //everything allocated so far is only read by uploads up to this LveUploadManager ticket
+      void endUploads(uint64_t ticket);
+      //everything allocated so far is only read by work submitted before the fence
+      void endFrame(VkFence fence);
+      //waits for fence and stops looking at it, for LveSwapChain before it destroys its fences
+      void releaseFence(VkFence fence);
+
+      VkDeviceSize capacity() const { return capacity_; }
+      //bytes handed out that the GPU may still read
+      VkDeviceSize usedBytes() const { return head - tail; }
+      bool isCoherent() const { return (memory.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0; }
+
+      private:
+      //a buffer for a request the ring couldn't take
+      struct OneOff {
+         VkBuffer buffer;
+         LveAllocation memory;
+      };
+      //the end of work that reads the ring up to end, waited on through the fence or, without one, the upload ticket
+      struct Mark {
+         VkDeviceSize end;
+         VkFence fence;
+         uint64_t ticket;
+         std::vector<OneOff> oneOffs;
+      };
+
+      void mark(VkFence fence, uint64_t ticket);
+      bool isComplete(const Mark &mark);
+      //frees the space of the marks from the front whose work completed, waiting for the first one if wait is set and none
+      //had. False if nothing was freed
+      bool reclaim(bool wait);
+
+      LveDevice &lveDevice;
+      VkBuffer buffer = VK_NULL_HANDLE;
+      LveAllocation memory{};
+      VkDeviceSize capacity_;
+      //positions count up forever, the buffer offset is position % capacity_. Allocations go at head, the GPU may still
+      //read everything from tail on
+      VkDeviceSize head = 0;
+      VkDeviceSize tail = 0;
+      std::deque<Mark> marks{};
+      //not covered by a mark yet
+      std::vector<OneOff> openOneOffs{};
+   };
+}
@@ -0,0 +1,218 @@
+#include "vulkan_static_batcher.hpp"
+#include "vulkan_swap_chain.hpp"
+#include "vulkan_upload_batch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+namespace lve {
+
+   //one worker: a scene has a handful of distinct static meshes, and a single thread keeps file reads sequential
+   LveStaticBatcher::LveStaticBatcher(LveDevice &device, const Settings &settings)
+      : lveDevice{device}, settings{settings}, pool{1} {
+      if (settings.chunkSize <= 0.f) {
+         throw std::runtime_error("static batcher needs a positive chunk size");
+      }
+   }
+
+   LveStaticBatcher::~LveStaticBatcher() = default;
+
+   LveCellCoord LveStaticBatcher::chunkAt(const glm::vec3 &position) const {
+      return {
+         static_cast<int32_t>(std::floor(position.x / settings.chunkSize)),
+         static_cast<int32_t>(std::floor(position.z / settings.chunkSize))};
+   }
+
+   std::shared_ptr<LveStaticBatcher::Source> LveStaticBatcher::sourceFor(const std::string &path) {
+      if (auto source = sources[path].lock()) return source;
+
+      auto source = std::make_shared<Source>();
+      source->path = path;
+      sources[path] = source;
+      pool.submit([source]() {
+         try {
+            LveModel::loadMeshData(source->path, source->data);
+            source->status.store(Source::Status::Ready, std::memory_order_release);
+         } catch (const std::exception &e) {
+            source->error = e.what();
+            source->status.store(Source::Status::Failed, std::memory_order_release);
+         }
+      });
+      return source;
+   }
+
+   void LveStaticBatcher::add(const LveGameObject &object, const std::string &modelPath) {
+      if (!object.isStatic) {
+         throw std::runtime_error("only objects flagged isStatic can be batched");
+      }
+      remove(object.getId());
+
+      const LveCellCoord coord = chunkAt(object.transform.translation);
+      objects[object.getId()] = {coord, object.transform, sourceFor(modelPath)};
+      Chunk &chunk = chunks[coord];
+      chunk.objects.push_back(object.getId());
+      chunk.dirty = true;
+   }
+
+   bool LveStaticBatcher::remove(LveGameObject::id_t id) {
+      auto found = objects.find(id);
+      if (found == objects.end()) return false;
+
+      Chunk &chunk = chunks[found->second.chunk];
+      chunk.objects.erase(std::find(chunk.objects.begin(), chunk.objects.end(), id));
+      chunk.dirty = true;
+      objects.erase(found);
+      return true;
+   }
+
+   void LveStaticBatcher::retire(std::shared_ptr<LveModel> model) {
+      if (model) retired.push_back({std::move(model), frame});
+   }
+
+   void LveStaticBatcher::removeSlot(size_t slot) {
+      retire(std::move(chunkObjects[slot].model));
+      //the last chunk object takes the free slot
+      if (slot + 1 != chunkObjects.size()) {
+         chunkObjects[slot] = std::move(chunkObjects.back());
+         slotChunks[slot] = slotChunks.back();
+         chunks[slotChunks[slot]].slot = slot;
+      }
+      chunkObjects.pop_back();
+      slotChunks.pop_back();
+   }
+
+   bool LveStaticBatcher::rebuild(const LveCellCoord &coord, Chunk &chunk, LveUploadBatch &batch) {
+      std::vector<LveStaticInstance> instances{};
+      for (LveGameObject::id_t id : chunk.objects) {
+         const Object &object = objects[id];
+         Source &source = *object.source;
+         const Source::Status status = source.status.load(std::memory_order_acquire);
+         if (status == Source::Status::Loading) return false;
+         if (status == Source::Status::Failed) {
+            //left out, the rest of the chunk still gets drawn
+            if (!source.reported) std::cerr << "Failed to load static mesh " << source.path << ": " << source.error << "\n";
+            source.reported = true;
+            continue;
+         }
+         instances.push_back({&source.data, object.transform});
+      }
+
+      LveModel::Builder builder{};
+      bake(instances, builder);
+      //an empty chunk, or one whose meshes all failed, has nothing to draw
+      if (builder.vertices.size() < 3) {
+         if (chunk.slot != SIZE_MAX) removeSlot(chunk.slot);
+         chunk.slot = SIZE_MAX;
+         return true;
+      }
+
+      auto model = std::make_shared<LveModel>(lveDevice, builder, settings.vertexFormat, &batch);
+      if (chunk.slot == SIZE_MAX) {
+         //already in world space, the identity transform is all the chunk needs
+         chunk.slot = chunkObjects.size();
+         chunkObjects.push_back(LveGameObject::createGameObject());
+         slotChunks.push_back(coord);
+      } else {
+         retire(std::move(chunkObjects[chunk.slot].model));
+      }
+      chunkObjects[chunk.slot].model = std::move(model);
+      stats.rebuilds++;
+      stats.rebuiltVertices += builder.vertices.size();
+      return true;
+   }
+
+   void LveStaticBatcher::update() {
+      frame++;
+      //a model replaced this many frames ago can't be in a command buffer anymore
+      retired.erase(
+         std::remove_if(retired.begin(), retired.end(), [this](const Retired &entry) { return frame - entry.frame > LveSwapChain::MAX_FRAMES_IN_FLIGHT; }),
+         retired.end());
+
+      LveUploadBatch batch{lveDevice};
+      for (auto entry = chunks.begin(); entry != chunks.end();) {
+         Chunk &chunk = entry->second;
+         if (chunk.dirty && rebuild(entry->first, chunk, batch)) chunk.dirty = false;
+         if (chunk.objects.empty() && chunk.slot == SIZE_MAX && !chunk.dirty) {
+            entry = chunks.erase(entry);
+         } else {
+            ++entry;
+         }
+      }
+      //the new chunk models are drawn this frame
+      batch.submit();
+
+      stats.chunks = static_cast<uint32_t>(chunkObjects.size());
+      stats.objects = static_cast<uint32_t>(objects.size());
+      stats.loading = 0;
+      for (const auto &object : objects) {
+         if (object.second.source->status.load(std::memory_order_acquire) == Source::Status::Loading) stats.loading++;
+      }
+   }
+
+   void LveStaticBatcher::bake(const std::vector<LveStaticInstance> &instances, LveModel::Builder &builder) {
+      builder = LveModel::Builder{};
+
+      //levels of an object, a mesh without a LOD table has one
+      auto levelCount = [](const LveModel::MeshData &mesh) { return std::max(mesh.lodCount, 1u); };
+      uint32_t chunkLevels = 1;
+      size_t vertexCount = 0;
+      for (const auto &instance : instances) {
+         chunkLevels = std::max(chunkLevels, levelCount(*instance.mesh));
+         vertexCount += instance.mesh->vertexCount;
+      }
+      chunkLevels = std::min(chunkLevels, LveModel::MAX_LODS);
+      if (vertexCount > UINT32_MAX) {
+         throw std::runtime_error("static batch chunk has too many vertices, use smaller chunks");
+      }
+
+      //vertices once per object, every level indexes into them
+      std::vector<uint32_t> firstVertex{};
+      builder.vertices.reserve(vertexCount);
+      for (const auto &instance : instances) {
+         TransformComponent transform = instance.transform;
+         const glm::mat4 modelMatrix = transform.mat4();
+         const glm::mat3 normalMatrix = transform.normalMatrix();
+         const LveModel::MeshData &mesh = *instance.mesh;
+
+         firstVertex.push_back(static_cast<uint32_t>(builder.vertices.size()));
+         for (uint32_t v = 0; v < mesh.vertexCount; v++) {
+            LveModel::Vertex vertex = mesh.vertices[v];
+            vertex.position = glm::vec3{modelMatrix * glm::vec4{vertex.position, 1.f}};
+            //the shader normalizes too, but quantized normals need unit length going in
+            const glm::vec3 normal = normalMatrix * vertex.normal;
+            const float length = glm::length(normal);
+            vertex.normal = length > 0.f ? normal / length : normal;
+            builder.vertices.push_back(vertex);
+         }
+      }
+
+      for (uint32_t level = 0; level < chunkLevels; level++) {
+         const uint32_t firstIndex = static_cast<uint32_t>(builder.indices.size());
+         float error = 0.f;
+         for (size_t i = 0; i < instances.size(); i++) {
+            const LveModel::MeshData &mesh = *instances[i].mesh;
+            const uint32_t base = firstVertex[i];
+            if (mesh.indexCount == 0) {
+               //drawn in vertex order
+               for (uint32_t v = 0; v < mesh.vertexCount; v++) builder.indices.push_back(base + v);
+               continue;
+            }
+
+            const uint32_t lod = std::min(level, levelCount(mesh) - 1);
+            const LveModel::Lod range = mesh.lodCount > 0 ? mesh.lods[lod] : LveModel::Lod{0, mesh.indexCount, mesh.vertexCount, 0.f};
+            for (uint32_t index = range.firstIndex; index < range.firstIndex + range.indexCount; index++) {
+               builder.indices.push_back(base + mesh.indices[index]);
+            }
+
+            //errors are in object space, the chunk's are in world space
+            const glm::vec3 &scale = instances[i].transform.scale;
+            const float maxScale = std::max(std::abs(scale.x), std::max(std::abs(scale.y), std::abs(scale.z)));
+            error = std::max(error, range.error * maxScale);
+         }
+         builder.lods.push_back({firstIndex, static_cast<uint32_t>(builder.indices.size()) - firstIndex, static_cast<uint32_t>(vertexCount), error});
+      }
+   }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "game_object.hpp"
+#include "vulkan_thread_pool.hpp"
+#include "vulkan_world_partition.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+   //an object as it goes into a static batch: the arrays of its model and where it stands
+   struct LveStaticInstance {
+      const LveModel::MeshData *mesh;
+      TransformComponent transform;
+   };
+
+   //merges objects that never move into one model per square chunk of the xz plane, with their vertices already transformed into
+   //world space. A chunk is drawn like a single object with an identity transform, so many static objects cost a push constant
+   //update, a bind and a draw per chunk instead of per object.
+   //chunks keep LOD levels: level l holds level l of every object (its coarsest one if it has fewer) and has the largest of their
+   //errors, scaled like the object. Meshlets and submeshes of the sources are dropped, a chunk level is one draw.
+   //meshes are read on a worker thread, once per path however many objects use it, and stay in memory while an object uses them so
+   //adding or removing an object only rebuilds the chunk it is in
+   class LveStaticBatcher {
+      public:
+      struct Settings {
+         float chunkSize = 16.f;
+         LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float32;
+      };
+
+      struct Stats {
+         uint32_t chunks = 0;
+         uint32_t objects = 0;
+         //objects whose mesh is still being read
+         uint32_t loading = 0;
+         uint64_t rebuilds = 0;
+         uint64_t rebuiltVertices = 0;
+      };
+
+      LveStaticBatcher(LveDevice &device, const Settings &settings);
+      //meshes still being read are abandoned
+      ~LveStaticBatcher();
+
+      LveStaticBatcher(const LveStaticBatcher &) = delete;
+      LveStaticBatcher &operator=(const LveStaticBatcher &) = delete;
+
+      //bakes object, with the model read from modelPath, at its current transform into the chunk its translation falls in. The object
+      //has to be flagged isStatic. It is drawn by the batch from the next update on, so it shouldn't be drawn on its own anymore.
+      //adding an id again moves it
+      void add(const LveGameObject &object, const std::string &modelPath);
+      //takes the object out of its chunk, false if it wasn't added
+      bool remove(LveGameObject::id_t id);
+
+      //once per frame before recording: rebuilds the chunks that changed and whose meshes are read, with one upload for all of them,
+      //and frees replaced chunk buffers once no frame in flight can be drawing them
+      void update();
+
+      //one object per chunk, for SimpleRenderSystem::renderGameObjects
+      std::vector<LveGameObject> &getChunkObjects() { return chunkObjects; }
+      LveCellCoord chunkAt(const glm::vec3 &position) const;
+      const Stats &getStats() const { return stats; }
+
+      //the CPU half of a rebuild: every instance transformed into world space and merged into builder's vertices, indices and LOD table
+      static void bake(const std::vector<LveStaticInstance> &instances, LveModel::Builder &builder);
+
+      private:
+      struct Source {
+         enum class Status { Loading, Ready, Failed };
+
+         std::string path;
+         std::atomic<Status> status{Status::Loading};
+         LveModel::MeshData data{};
+         std::string error{};
+         //a failed load is reported once, not on every rebuild
+         bool reported = false;
+      };
+
+      struct Object {
+         LveCellCoord chunk;
+         TransformComponent transform;
+         std::shared_ptr<Source> source;
+      };
+
+      struct Chunk {
+         std::vector<LveGameObject::id_t> objects{};
+         bool dirty = true;
+         //index into chunkObjects once built
+         size_t slot = SIZE_MAX;
+      };
+
+      struct Retired {
+         std::shared_ptr<LveModel> model;
+         uint64_t frame;
+      };
+
+      std::shared_ptr<Source> sourceFor(const std::string &path);
+      //false if one of the chunk's meshes is still being read
+      bool rebuild(const LveCellCoord &coord, Chunk &chunk, LveUploadBatch &batch);
+      void retire(std::shared_ptr<LveModel> model);
+      void removeSlot(size_t slot);
+
+      LveDevice &lveDevice;
+      Settings settings;
+      Stats stats{};
+      uint64_t frame = 0;
+      std::unordered_map<LveGameObject::id_t, Object> objects{};
+      std::unordered_map<LveCellCoord, Chunk, LveCellCoordHash> chunks{};
+      //sources in use, an expired one is read again
+      std::unordered_map<std::string, std::weak_ptr<Source>> sources{};
+      std::vector<LveGameObject> chunkObjects{};
+      //chunk of each chunkObjects entry
+      std::vector<LveCellCoord> slotChunks{};
+      std::vector<Retired> retired{};
+      //last member: the worker is joined before anything it touches is destroyed
+      LveThreadPool pool;
+   };
+}
@@ -1,4 +1,5 @@
 #include "vulkan_swap_chain.hpp"
+#include "vulkan_staging_ring.hpp"
 
 // std
 #include <array>
@@ -46,8 +47,7 @@ LveSwapChain::~LveSwapChain() {
 
   for (int i = 0; i < depthImages.size(); i++) {
     vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
-    vkDestroyImage(device.device(), depthImages[i], nullptr);
-    vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+    device.destroyImage(depthImages[i], depthImageMemorys[i]);
   }
 
   for (auto framebuffer : swapChainFramebuffers) {
@@ -58,6 +58,7 @@ LveSwapChain::~LveSwapChain() {
 
   // cleanup synchronization objects
   for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+    device.stagingRing().releaseFence(inFlightFences[i]);
     vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
     vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
     vkDestroyFence(device.device(), inFlightFences[i], nullptr);
@@ -111,6 +112,8 @@ VkResult LveSwapChain::submitCommandBuffers(
       VK_SUCCESS) {
     throw std::runtime_error("failed to submit draw command buffer!");
   }
+  //what the frame read from the staging ring is free again once the fence signals
+  device.stagingRing().endFrame(inFlightFences[currentFrame]);
 
   VkPresentInfoKHR presentInfo = {};
   presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -0,0 +1,44 @@
+#include "vulkan_thread_pool.hpp"
+
+#include <algorithm>
+
+namespace lve {
+
+   LveThreadPool::LveThreadPool(unsigned threadCount) {
+      if (threadCount == 0) threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+      threads.reserve(threadCount);
+      for (unsigned t = 0; t < threadCount; t++) threads.emplace_back(&LveThreadPool::work, this);
+   }
+
+   LveThreadPool::~LveThreadPool() {
+      {
+         std::lock_guard<std::mutex> lock{mutex};
+         stopping = true;
+         jobs.clear();
+      }
+      wake.notify_all();
+      for (auto &thread : threads) thread.join();
+   }
+
+   void LveThreadPool::submit(std::function<void()> job) {
+      {
+         std::lock_guard<std::mutex> lock{mutex};
+         jobs.push_back(std::move(job));
+      }
+      wake.notify_one();
+   }
+
+   void LveThreadPool::work() {
+      while (true) {
+         std::function<void()> job;
+         {
+            std::unique_lock<std::mutex> lock{mutex};
+            wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+         }
+         job();
+      }
+   }
+}
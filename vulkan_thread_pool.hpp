@@ -0,0 +1,35 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lve {
+
+   //fixed set of worker threads running submitted jobs in submission order. Jobs must not throw
+   class LveThreadPool {
+      public:
+      //0 picks one thread per core, minus one for the thread that renders
+      explicit LveThreadPool(unsigned threadCount = 0);
+      //waits for the jobs already running, drops the ones still queued
+      ~LveThreadPool();
+
+      LveThreadPool(const LveThreadPool &) = delete;
+      LveThreadPool &operator=(const LveThreadPool &) = delete;
+
+      void submit(std::function<void()> job);
+      unsigned threadCount() const { return static_cast<unsigned>(threads.size()); }
+
+      private:
+      void work();
+
+      std::vector<std::thread> threads{};
+      std::deque<std::function<void()>> jobs{};
+      std::mutex mutex{};
+      std::condition_variable wake{};
+      bool stopping = false;
+   };
+}
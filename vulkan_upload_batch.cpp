@@ -0,0 +1,55 @@
+#include "vulkan_upload_batch.hpp"
+#include "vulkan_host_import.hpp"
+#include "vulkan_staging_ring.hpp"
+
+#include <cstring>
+
+namespace lve {
+
+   namespace {
+      //keeps every copy's source offset aligned for memcpy and for the transfer
+      constexpr VkDeviceSize COPY_ALIGNMENT = 16;
+   }
+
+   LveUploadBatch::LveUploadBatch(LveDevice &device) : lveDevice{device} {}
+
+   LveUploadBatch::~LveUploadBatch() {
+      submit();
+   }
+
+   void LveUploadBatch::add(const void *data, VkDeviceSize size, VkBuffer dst, VkDeviceSize dstOffset) {
+      if (size == 0) return;
+
+      LveStagingRing &ring = lveDevice.stagingRing();
+      const LveStagingRing::Allocation staging = ring.allocate(size, COPY_ALIGNMENT);
+      memcpy(staging.mapped, data, static_cast<size_t>(size));
+      ring.flush(staging);
+      copies.push_back({staging.buffer, dst, {staging.offset, dstOffset, size}});
+      pendingBytes_ += size;
+   }
+
+   void LveUploadBatch::add(const LveHostImport *source, const void *data, VkDeviceSize size, VkBuffer dst, VkDeviceSize dstOffset) {
+      if (source == nullptr || !source->contains(data, size)) {
+         add(data, size, dst, dstOffset);
+         return;
+      }
+      if (size == 0) return;
+      copies.push_back({source->buffer(), dst, {source->offsetOf(data), dstOffset, size}});
+      pendingBytes_ += size;
+      importedBytes_ += size;
+   }
+
+   uint64_t LveUploadBatch::submitAsync() {
+      const uint64_t ticket = lveDevice.uploadManager().submit(copies);
+      lveDevice.stagingRing().endUploads(ticket);
+
+      copies.clear();
+      pendingBytes_ = 0;
+      importedBytes_ = 0;
+      return ticket;
+   }
+
+   void LveUploadBatch::submit() {
+      lveDevice.uploadManager().wait(submitAsync());
+   }
+}
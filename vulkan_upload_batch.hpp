@@ -0,0 +1,45 @@
+#pragma once
+
+#include "vulkan_upload_manager.hpp"
+
+#include <vector>
+
+namespace lve {
+
+   class LveHostImport;
+
+   //collects buffer uploads and sends them to the GPU together: one command buffer and one fence for the whole batch instead of
+   //one per buffer, through the device's LveUploadManager. Data is copied into the device's LveStagingRing right away, so the
+   //source can go out of scope, unless it is read straight from imported host memory. Submit a batch before starting another one, the ring frees its space in submission order
+   class LveUploadBatch {
+      public:
+      explicit LveUploadBatch(LveDevice &device);
+      //submits whatever is still pending, the destination buffers would be left uninitialized otherwise
+      ~LveUploadBatch();
+
+      LveUploadBatch(const LveUploadBatch &) = delete;
+      LveUploadBatch &operator=(const LveUploadBatch &) = delete;
+
+      //dst has to be created with VK_BUFFER_USAGE_TRANSFER_DST_BIT and must not be used before the next submit
+      void add(const void *data, VkDeviceSize size, VkBuffer dst, VkDeviceSize dstOffset = 0);
+      //copies straight from source when data lies in it, no staging, and like add otherwise. source may be null. It has to be
+      //kept until the copies completed
+      void add(const LveHostImport *source, const void *data, VkDeviceSize size, VkBuffer dst, VkDeviceSize dstOffset = 0);
+      //submits every pending copy without waiting and returns its LveUploadManager ticket: the destinations can be drawn from once
+      //it completed. The ring reuses the staging space then, the batch can take new copies right away
+      uint64_t submitAsync();
+      //submitAsync, then waits for the copies
+      void submit();
+
+      bool empty() const { return copies.empty(); }
+      VkDeviceSize pendingBytes() const { return pendingBytes_; }
+      //part of pendingBytes read straight from host imports
+      VkDeviceSize importedBytes() const { return importedBytes_; }
+
+      private:
+      LveDevice &lveDevice;
+      std::vector<LveUploadManager::Copy> copies{};
+      VkDeviceSize pendingBytes_ = 0;
+      VkDeviceSize importedBytes_ = 0;
+   };
+}
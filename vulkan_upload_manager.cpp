@@ -0,0 +1,210 @@
+#include "vulkan_upload_manager.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+
+namespace lve {
+
+   namespace {
+      //what draws read the uploaded buffers as
+      constexpr VkAccessFlags GEOMETRY_READS = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+   }
+
+   LveUploadManager::LveUploadManager(LveDevice &device) : lveDevice{device} {
+      const QueueFamilyIndices indices = device.findPhysicalQueueFamilies();
+      graphicsFamily = indices.graphicsFamily;
+      transferFamily = indices.transferFamilyHasValue ? indices.transferFamily : indices.graphicsFamily;
+      transferQueue = usesTransferQueue() ? device.transferQueue() : device.graphicsQueue();
+      transferPool = createCommandPool(transferFamily);
+      if (usesTransferQueue()) graphicsPool = createCommandPool(graphicsFamily);
+   }
+
+   LveUploadManager::~LveUploadManager() {
+      if (lastTicket > completed) wait(lastTicket);
+      for (auto &slot : freeSlots) {
+         vkDestroyFence(lveDevice.device(), slot.fence, nullptr);
+         if (slot.copied != VK_NULL_HANDLE) vkDestroySemaphore(lveDevice.device(), slot.copied, nullptr);
+      }
+      //frees the command buffers too
+      vkDestroyCommandPool(lveDevice.device(), transferPool, nullptr);
+      if (graphicsPool != VK_NULL_HANDLE) vkDestroyCommandPool(lveDevice.device(), graphicsPool, nullptr);
+   }
+
+   VkCommandPool LveUploadManager::createCommandPool(uint32_t queueFamily) {
+      VkCommandPoolCreateInfo poolInfo{};
+      poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+      poolInfo.queueFamilyIndex = queueFamily;
+      poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+      VkCommandPool pool;
+      if (vkCreateCommandPool(lveDevice.device(), &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+         throw std::runtime_error("failed to create upload command pool!");
+      }
+      return pool;
+   }
+
+   LveUploadManager::Slot LveUploadManager::takeSlot() {
+      if (!freeSlots.empty()) {
+         Slot slot = freeSlots.back();
+         freeSlots.pop_back();
+         return slot;
+      }
+
+      Slot slot{};
+      VkCommandBufferAllocateInfo allocInfo{};
+      allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+      allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+      allocInfo.commandPool = transferPool;
+      allocInfo.commandBufferCount = 1;
+      if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, &slot.copyCommands) != VK_SUCCESS) {
+         throw std::runtime_error("failed to allocate upload command buffer!");
+      }
+      if (usesTransferQueue()) {
+         allocInfo.commandPool = graphicsPool;
+         if (vkAllocateCommandBuffers(lveDevice.device(), &allocInfo, &slot.acquireCommands) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate upload command buffer!");
+         }
+         VkSemaphoreCreateInfo semaphoreInfo{};
+         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+         if (vkCreateSemaphore(lveDevice.device(), &semaphoreInfo, nullptr, &slot.copied) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload semaphore!");
+         }
+      }
+      VkFenceCreateInfo fenceInfo{};
+      fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+      if (vkCreateFence(lveDevice.device(), &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS) {
+         throw std::runtime_error("failed to create upload fence!");
+      }
+      return slot;
+   }
+
+   uint64_t LveUploadManager::submit(const std::vector<Copy> &copies) {
+      retire();
+      if (copies.empty()) return completed;
+
+      const Slot slot = takeSlot();
+      VkCommandBufferBeginInfo beginInfo{};
+      beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+      beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+      vkBeginCommandBuffer(slot.copyCommands, &beginInfo);
+
+      //one barrier per written range, a copy continuing the one before into the same buffer extends its range
+      std::vector<VkBufferMemoryBarrier> barriers{};
+      std::vector<VkBufferCopy> regions{};
+      for (size_t i = 0; i < copies.size(); i++) {
+         const Copy &copy = copies[i];
+         regions.push_back(copy.region);
+         if (i + 1 == copies.size() || copies[i + 1].src != copy.src || copies[i + 1].dst != copy.dst) {
+            vkCmdCopyBuffer(slot.copyCommands, copy.src, copy.dst, static_cast<uint32_t>(regions.size()), regions.data());
+            regions.clear();
+         }
+
+         if (!barriers.empty() && barriers.back().buffer == copy.dst && barriers.back().offset + barriers.back().size == copy.region.dstOffset) {
+            barriers.back().size += copy.region.size;
+            continue;
+         }
+         VkBufferMemoryBarrier barrier{};
+         barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+         barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+         barrier.dstAccessMask = GEOMETRY_READS;
+         barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+         barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+         barrier.buffer = copy.dst;
+         barrier.offset = copy.region.dstOffset;
+         barrier.size = copy.region.size;
+         barriers.push_back(barrier);
+      }
+
+      if (!usesTransferQueue()) {
+         //draws recorded after this submission read what it wrote
+         vkCmdPipelineBarrier(
+            slot.copyCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+            0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+         vkEndCommandBuffer(slot.copyCommands);
+
+         VkSubmitInfo submitInfo{};
+         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+         submitInfo.commandBufferCount = 1;
+         submitInfo.pCommandBuffers = &slot.copyCommands;
+         if (vkQueueSubmit(transferQueue, 1, &submitInfo, slot.fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload commands!");
+         }
+      } else {
+         //release: the destination ranges go from the transfer family to the graphics family. The access on the other side of a
+         //release is ignored, its barrier on the graphics queue makes the writes visible
+         for (auto &barrier : barriers) {
+            barrier.dstAccessMask = 0;
+            barrier.srcQueueFamilyIndex = transferFamily;
+            barrier.dstQueueFamilyIndex = graphicsFamily;
+         }
+         vkCmdPipelineBarrier(
+            slot.copyCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+            0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+         vkEndCommandBuffer(slot.copyCommands);
+
+         //acquire: the same ranges, chained to the semaphore wait
+         for (auto &barrier : barriers) {
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = GEOMETRY_READS;
+         }
+         vkBeginCommandBuffer(slot.acquireCommands, &beginInfo);
+         vkCmdPipelineBarrier(
+            slot.acquireCommands, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0,
+            0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+         vkEndCommandBuffer(slot.acquireCommands);
+
+         VkSubmitInfo copyInfo{};
+         copyInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+         copyInfo.commandBufferCount = 1;
+         copyInfo.pCommandBuffers = &slot.copyCommands;
+         copyInfo.signalSemaphoreCount = 1;
+         copyInfo.pSignalSemaphores = &slot.copied;
+         if (vkQueueSubmit(transferQueue, 1, &copyInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload commands!");
+         }
+
+         const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+         VkSubmitInfo acquireInfo{};
+         acquireInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+         acquireInfo.waitSemaphoreCount = 1;
+         acquireInfo.pWaitSemaphores = &slot.copied;
+         acquireInfo.pWaitDstStageMask = &waitStage;
+         acquireInfo.commandBufferCount = 1;
+         acquireInfo.pCommandBuffers = &slot.acquireCommands;
+         if (vkQueueSubmit(lveDevice.graphicsQueue(), 1, &acquireInfo, slot.fence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload commands!");
+         }
+      }
+
+      inFlight.push_back({++lastTicket, slot});
+      return lastTicket;
+   }
+
+   bool LveUploadManager::isComplete(uint64_t ticket) {
+      if (ticket > completed) retire();
+      return ticket <= completed;
+   }
+
+   void LveUploadManager::wait(uint64_t ticket) {
+      assert(ticket <= lastTicket && "Ticket was never handed out");
+      while (ticket > completed) {
+         vkWaitForFences(lveDevice.device(), 1, &inFlight.front().slot.fence, VK_TRUE, UINT64_MAX);
+         retire();
+      }
+   }
+
+   void LveUploadManager::retire() {
+      while (!inFlight.empty() && vkGetFenceStatus(lveDevice.device(), inFlight.front().slot.fence) == VK_SUCCESS) {
+         complete(inFlight.front());
+         inFlight.pop_front();
+      }
+   }
+
+   void LveUploadManager::complete(Submission &submission) {
+      vkResetFences(lveDevice.device(), 1, &submission.slot.fence);
+      //the command buffers are reset when they are begun again
+      freeSlots.push_back(submission.slot);
+      completed = submission.ticket;
+   }
+}
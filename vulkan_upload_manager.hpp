@@ -0,0 +1,75 @@
+#pragma once
+
+#include "vulkan_device.hpp"
+
+#include <deque>
+#include <vector>
+
+namespace lve {
+
+   //submits buffer copies without waiting for them. They go to a transfer only queue family when the device has one, a copy engine
+   //that runs alongside rendering, and to the graphics queue otherwise. Every submission gets a ticket, one higher than the one
+   //before, that completes when its fence signals: poll it with isComplete instead of stalling the queue.
+   //buffers stay exclusive to the graphics family. Ranges written on the transfer queue are released there and acquired by a
+   //small graphics queue submission that waits on the copies through a semaphore.
+   //owned by LveDevice, used from the thread that submits frames, queues aren't synchronized otherwise
+   class LveUploadManager {
+      public:
+      struct Copy {
+         VkBuffer src;
+         VkBuffer dst;
+         VkBufferCopy region;
+      };
+
+      explicit LveUploadManager(LveDevice &device);
+      //waits for whatever is still in flight
+      ~LveUploadManager();
+
+      LveUploadManager(const LveUploadManager &) = delete;
+      LveUploadManager &operator=(const LveUploadManager &) = delete;
+
+      //records the copies in one command buffer, submits it and returns its ticket. Consecutive copies between the same two
+      //buffers become one command. Without copies the ticket is already complete
+      uint64_t submit(const std::vector<Copy> &copies);
+      //true once the ticket's copies are done and visible to draws on the graphics queue, their sources can be reused then
+      bool isComplete(uint64_t ticket);
+      void wait(uint64_t ticket);
+      //every ticket up to this one is complete
+      uint64_t completedTicket() const { return completed; }
+      //false when copies go to the graphics queue
+      bool usesTransferQueue() const { return transferFamily != graphicsFamily; }
+
+      private:
+      //what one submission needs, reused once it completed
+      struct Slot {
+         VkCommandBuffer copyCommands;
+         //ownership acquire on the graphics queue, only with a transfer queue
+         VkCommandBuffer acquireCommands;
+         VkSemaphore copied;
+         VkFence fence;
+      };
+      struct Submission {
+         uint64_t ticket;
+         Slot slot;
+      };
+
+      VkCommandPool createCommandPool(uint32_t queueFamily);
+      Slot takeSlot();
+      //completes submissions from the front while their fence is signaled
+      void retire();
+      void complete(Submission &submission);
+
+      LveDevice &lveDevice;
+      uint32_t graphicsFamily;
+      uint32_t transferFamily;
+      VkQueue transferQueue;
+      VkCommandPool transferPool = VK_NULL_HANDLE;
+      //acquire command buffers, only with a transfer queue
+      VkCommandPool graphicsPool = VK_NULL_HANDLE;
+      //in submission order, so they complete front to back
+      std::deque<Submission> inFlight{};
+      std::vector<Slot> freeSlots{};
+      uint64_t lastTicket = 0;
+      uint64_t completed = 0;
+   };
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <functional>
 
 namespace lve {
@@ -16,4 +18,33 @@ namespace lve {
       hashCombine(seed, rest...);
    }
 
-}
\ No newline at end of file
+   //64 bit content hash over a byte range, consumes 8 bytes per step so hashing large files isn't byte-bound
+   //not cryptographic, only used to tell whether two blobs of data are the same
+   inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0) {
+      const uint64_t prime = 0x9e3779b97f4a7c15ull;
+      const unsigned char* bytes = static_cast<const unsigned char*>(data);
+      uint64_t hash = seed ^ (size * prime);
+
+      size_t i = 0;
+      for (; i + 8 <= size; i += 8) {
+         uint64_t word;
+         memcpy(&word, bytes + i, 8);
+         word *= 0xff51afd7ed558ccdull;
+         word ^= word >> 32;
+         hash = (hash ^ word) * prime;
+         hash ^= hash >> 29;
+      }
+
+      uint64_t tail = 0;
+      //data may be null for an empty input, which memcpy doesn't allow even for 0 bytes. Mixed in either way, so hashes don't change
+      if (size > i) memcpy(&tail, bytes + i, size - i);
+      hash = (hash ^ tail) * prime;
+
+      //final avalanche so nearby inputs spread over all 64 bits
+      hash ^= hash >> 33;
+      hash *= 0xc4ceb9fe1a85ec53ull;
+      hash ^= hash >> 33;
+      return hash;
+   }
+
+}
@@ -0,0 +1,148 @@
+#include "vulkan_vertex_quantizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace lve {
+
+   static_assert(sizeof(LveModel::CompactVertex) == 20, "CompactVertex is expected to be tightly packed");
+
+   glm::mat4 LveVertexQuantizer::quantize(const LveModel::Vertex *vertices, uint32_t vertexCount, std::vector<LveModel::CompactVertex> &compact) {
+      glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+      glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+      for (uint32_t i = 0; i < vertexCount; i++) {
+         boundsMin = glm::min(boundsMin, vertices[i].position);
+         boundsMax = glm::max(boundsMax, vertices[i].position);
+      }
+      return quantize(vertices, vertexCount, boundsMin, boundsMax, compact);
+   }
+
+   glm::mat4 LveVertexQuantizer::quantize(
+      const LveModel::Vertex *vertices,
+      uint32_t vertexCount,
+      const glm::vec3 &boundsMin,
+      const glm::vec3 &boundsMax,
+      std::vector<LveModel::CompactVertex> &compact) {
+      const glm::vec3 center = (boundsMin + boundsMax) * 0.5f;
+      const glm::vec3 extent = (boundsMax - boundsMin) * 0.5f;
+      //a flat axis (e.g. a quad in the xy plane) quantizes to 0 and comes back as the center
+      const glm::vec3 inverseExtent{
+         extent.x > 0.f ? 1.f / extent.x : 0.f,
+         extent.y > 0.f ? 1.f / extent.y : 0.f,
+         extent.z > 0.f ? 1.f / extent.z : 0.f};
+
+      compact.resize(vertexCount);
+      for (uint32_t i = 0; i < vertexCount; i++) {
+         const LveModel::Vertex &vertex = vertices[i];
+         LveModel::CompactVertex &packed = compact[i];
+
+         const glm::vec3 position = (vertex.position - center) * inverseExtent;
+         packed.position[0] = toSnorm16(position.x);
+         packed.position[1] = toSnorm16(position.y);
+         packed.position[2] = toSnorm16(position.z);
+         packed.position[3] = 0;
+
+         packed.color[0] = toUnorm8(vertex.color.x);
+         packed.color[1] = toUnorm8(vertex.color.y);
+         packed.color[2] = toUnorm8(vertex.color.z);
+         packed.color[3] = 255;
+
+         encodeOctahedral(vertex.normal, packed.normal);
+
+         packed.uv[0] = toHalf(vertex.uv.x);
+         packed.uv[1] = toHalf(vertex.uv.y);
+      }
+
+      //snorm16 -> object space: scale by the half size of the bounds, then move to their center
+      glm::mat4 dequantization{1.f};
+      dequantization[0][0] = extent.x;
+      dequantization[1][1] = extent.y;
+      dequantization[2][2] = extent.z;
+      dequantization[3] = glm::vec4{center, 1.f};
+      return dequantization;
+   }
+
+   uint16_t LveVertexQuantizer::toHalf(float value) {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+      const uint32_t magnitude = bits & 0x7fffffff;
+
+      //infinity and NaN keep their class
+      if (magnitude >= 0x7f800000) return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0);
+      //65520 and up round to infinity
+      if (magnitude >= 0x477ff000) return sign | 0x7c00;
+      //below 2^-14 the half is subnormal, a multiple of 2^-24. nearbyint rounds to nearest even by default
+      if (magnitude < 0x38800000) {
+         float absolute;
+         memcpy(&absolute, &magnitude, sizeof(absolute));
+         return sign | static_cast<uint16_t>(std::nearbyint(absolute * 16777216.f));
+      }
+
+      //rebias the exponent from 127 to 15, then drop 13 mantissa bits rounding to nearest even
+      const uint32_t rebiased = magnitude - 0x38000000;
+      return sign | static_cast<uint16_t>((rebiased + 0xfff + ((rebiased >> 13) & 1)) >> 13);
+   }
+
+   float LveVertexQuantizer::fromHalf(uint16_t half) {
+      const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+      const uint32_t exponent = (half >> 10) & 0x1f;
+      const uint32_t mantissa = half & 0x3ff;
+
+      uint32_t bits;
+      if (exponent == 0) {
+         const float value = static_cast<float>(mantissa) / 16777216.f;
+         memcpy(&bits, &value, sizeof(bits));
+         bits |= sign;
+      } else if (exponent == 31) {
+         bits = sign | 0x7f800000 | (mantissa << 13);
+      } else {
+         bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+      }
+
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+   }
+
+   int16_t LveVertexQuantizer::toSnorm16(float value) {
+      return static_cast<int16_t>(std::lround(std::clamp(value, -1.f, 1.f) * 32767.f));
+   }
+
+   uint8_t LveVertexQuantizer::toUnorm8(float value) {
+      return static_cast<uint8_t>(std::lround(std::clamp(value, 0.f, 1.f) * 255.f));
+   }
+
+   void LveVertexQuantizer::encodeOctahedral(const glm::vec3 &normal, int16_t encoded[2]) {
+      const float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+      //models without normals have all zero normals, those decode to +z
+      if (sum == 0.f) {
+         encoded[0] = 0;
+         encoded[1] = 0;
+         return;
+      }
+
+      float x = normal.x / sum;
+      float y = normal.y / sum;
+      if (normal.z < 0.f) {
+         const float foldedX = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+         const float foldedY = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+         x = foldedX;
+         y = foldedY;
+      }
+      encoded[0] = toSnorm16(x);
+      encoded[1] = toSnorm16(y);
+   }
+
+   glm::vec3 LveVertexQuantizer::decodeOctahedral(const int16_t encoded[2]) {
+      const float x = std::max(encoded[0] / 32767.f, -1.f);
+      const float y = std::max(encoded[1] / 32767.f, -1.f);
+      glm::vec3 normal{x, y, 1.f - std::abs(x) - std::abs(y)};
+      const float fold = std::max(-normal.z, 0.f);
+      normal.x += normal.x >= 0.f ? -fold : fold;
+      normal.y += normal.y >= 0.f ? -fold : fold;
+      return glm::normalize(normal);
+   }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "vulkan_model.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace lve {
+
+   //packs LveModel::Vertex (44 bytes of fp32) into LveModel::CompactVertex (20 bytes):
+   //  position: snorm16 relative to the model's bounds, the shader gets it back through the dequantization matrix
+   //  color:    unorm8
+   //  normal:   octahedral encoding in 2 x snorm16, decoded in simple_shader_compact.vert
+   //  uv:       half floats
+   class LveVertexQuantizer {
+      public:
+      //quantizes every vertex, returns the matrix that maps the snorm16 positions (-1 to 1) back onto the original bounds
+      static glm::mat4 quantize(const LveModel::Vertex *vertices, uint32_t vertexCount, std::vector<LveModel::CompactVertex> &compact);
+      //same against bounds known up front, which have to contain every vertex. Lets a mesh be quantized in parts (progressive
+      //streaming) with one matrix for all of them
+      static glm::mat4 quantize(
+         const LveModel::Vertex *vertices,
+         uint32_t vertexCount,
+         const glm::vec3 &boundsMin,
+         const glm::vec3 &boundsMax,
+         std::vector<LveModel::CompactVertex> &compact);
+
+      //float to IEEE half, rounded to nearest even. Out of range values become infinity
+      static uint16_t toHalf(float value);
+      static float fromHalf(uint16_t half);
+
+      static int16_t toSnorm16(float value);
+      static uint8_t toUnorm8(float value);
+
+      //maps the unit sphere onto the [-1, 1] square: project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half out over the corners
+      static void encodeOctahedral(const glm::vec3 &normal, int16_t encoded[2]);
+      //same decode as the shader, used to measure the error
+      static glm::vec3 decodeOctahedral(const int16_t encoded[2]);
+   };
+}
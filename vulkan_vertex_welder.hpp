@@ -0,0 +1,125 @@
+#pragma once
+
+#include "vulkan_utils.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace lve {
+
+   //merges identical vertices while building an index buffer. Replaces std::unordered_map<Vertex, uint32_t>:
+   //one flat open addressing table (linear probing) sized once up front, one probe sequence per vertex and no per-vertex allocation.
+   //
+   //equality always covers every attribute of the vertex:
+   //  epsilon == 0: bitwise equal (except that -0.0 and 0.0 count as the same value)
+   //  epsilon > 0:  equal after snapping every float to a grid of that step, so vertices that only differ by float noise are merged
+   template <typename V>
+   class LveVertexWelder {
+      static_assert(std::is_trivially_copyable<V>::value, "vertices are compared and hashed as raw bytes");
+      static_assert(sizeof(V) % sizeof(float) == 0, "vertices are expected to be made of 32 bit components");
+
+      public:
+      static constexpr uint32_t EMPTY = UINT32_MAX;
+      static constexpr size_t COMPONENTS = sizeof(V) / sizeof(float);
+
+      //expectedCount is an upper bound on the number of unique vertices, usually the index count
+      explicit LveVertexWelder(size_t expectedCount, float epsilon = 0.f) : epsilon{epsilon} {
+         //load factor stays at or below 0.5 so probe sequences stay short
+         size_t capacity = 16;
+         while (capacity < expectedCount * 2) capacity <<= 1;
+         slots.assign(capacity, Slot{0, EMPTY});
+      }
+
+      //returns the index of vertex in vertices, appending it first if no equal vertex was welded before
+      uint32_t weld(const V &vertex, std::vector<V> &vertices) {
+         if ((count + 1) * 2 > slots.size()) grow();
+
+         Key key = makeKey(vertex);
+         const uint32_t hash = static_cast<uint32_t>(hashBytes(key.data, keyBytes()));
+         const size_t mask = slots.size() - 1;
+
+         for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot &slot = slots[i];
+            if (slot.index == EMPTY) {
+               slot = {hash, static_cast<uint32_t>(vertices.size())};
+               vertices.push_back(vertex);
+               count++;
+               return slot.index;
+            }
+            //the stored hash rejects almost every mismatch before touching the vertex array
+            if (slot.hash == hash && sameKey(key, vertices[slot.index])) {
+               return slot.index;
+            }
+         }
+      }
+
+      size_t uniqueCount() const { return count; }
+
+      private:
+      struct Slot {
+         uint32_t hash;
+         uint32_t index;
+      };
+
+      //bits the vertex is compared and hashed by: the components as they are, or snapped to 64 bit integers so the grid has the
+      //range of any float / epsilon. Only the first keyBytes() are used
+      struct Key {
+         uint32_t data[2 * COMPONENTS];
+      };
+
+      //snapped components stay within this, far from where double stops holding integers exactly
+      static constexpr double SNAP_LIMIT = 4611686018427387904.0; //2^62
+      //components too large to snap (or not finite) keep their bits, tagged with a value no snapped component can have
+      static constexpr uint64_t UNSNAPPED = uint64_t{1} << 62;
+
+      size_t keyBytes() const { return (epsilon > 0.f ? 2 : 1) * COMPONENTS * sizeof(uint32_t); }
+
+      Key makeKey(const V &vertex) const {
+         Key key;
+         memcpy(key.data, &vertex, sizeof(V));
+         if (epsilon > 0.f) {
+            //backwards, so every component is read before the wider snapped values overwrite it
+            for (size_t i = COMPONENTS; i-- > 0;) {
+               float component;
+               memcpy(&component, &key.data[i], sizeof(float));
+               const double snapped = std::floor(static_cast<double>(component) / epsilon + 0.5);
+               //the cast is only defined in range, and at these magnitudes floats are further apart than epsilon anyway
+               uint64_t value = UNSNAPPED | key.data[i];
+               if (std::fabs(snapped) < SNAP_LIMIT) value = static_cast<uint64_t>(static_cast<int64_t>(snapped));
+               memcpy(&key.data[2 * i], &value, sizeof(value));
+            }
+         } else {
+            //-0.0 and 0.0 are the same vertex even if their bits differ
+            for (size_t i = 0; i < COMPONENTS; i++) {
+               if (key.data[i] == 0x80000000u) key.data[i] = 0;
+            }
+         }
+         return key;
+      }
+
+      bool sameKey(const Key &key, const V &vertex) const {
+         const Key other = makeKey(vertex);
+         return memcmp(key.data, other.data, keyBytes()) == 0;
+      }
+
+      //only reached if more unique vertices show up than expectedCount promised
+      void grow() {
+         std::vector<Slot> old = std::move(slots);
+         slots.assign(old.size() * 2, Slot{0, EMPTY});
+         const size_t mask = slots.size() - 1;
+         for (const Slot &slot : old) {
+            if (slot.index == EMPTY) continue;
+            size_t i = slot.hash & mask;
+            while (slots[i].index != EMPTY) i = (i + 1) & mask;
+            slots[i] = slot;
+         }
+      }
+
+      std::vector<Slot> slots{};
+      size_t count = 0;
+      float epsilon = 0.f;
+   };
+}
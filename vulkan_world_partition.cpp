@@ -0,0 +1,155 @@
+#include "vulkan_world_partition.hpp"
+#include "vulkan_utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace lve {
+
+   size_t LveCellCoordHash::operator()(const LveCellCoord &coord) const {
+      size_t seed = 0;
+      hashCombine(seed, coord.x, coord.z);
+      return seed;
+   }
+
+   //one worker: descriptions are small, and a single thread keeps file reads sequential
+   LveWorldPartition::LveWorldPartition(LveAssetRegistry &registry, CellSource source, const Settings &settings)
+      : registry{registry}, source{std::move(source)}, settings{settings}, pool{1} {
+      if (settings.cellSize <= 0.f || settings.unloadRadius <= settings.loadRadius) {
+         throw std::runtime_error("world partition needs a positive cell size and an unload radius larger than the load radius");
+      }
+   }
+
+   LveWorldPartition::~LveWorldPartition() = default;
+
+   LveCellCoord LveWorldPartition::cellAt(const glm::vec3 &position) const {
+      return {
+         static_cast<int32_t>(std::floor(position.x / settings.cellSize)),
+         static_cast<int32_t>(std::floor(position.z / settings.cellSize))};
+   }
+
+   float LveWorldPartition::distanceTo(LveCellCoord coord, const glm::vec3 &position) const {
+      const float minX = coord.x * settings.cellSize;
+      const float minZ = coord.z * settings.cellSize;
+      //nearest point of the square, the position itself if it is inside
+      const float dx = position.x - glm::clamp(position.x, minX, minX + settings.cellSize);
+      const float dz = position.z - glm::clamp(position.z, minZ, minZ + settings.cellSize);
+      return std::sqrt(dx * dx + dz * dz);
+   }
+
+   void LveWorldPartition::requestCell(LveCellCoord coord) {
+      Cell &cell = cells[coord];
+      cell.request = nextRequest++;
+      stats.cellLoads++;
+
+      pool.submit([this, coord, request = cell.request]() {
+         Described result{coord, request, source(coord)};
+         std::lock_guard<std::mutex> lock{describedMutex};
+         described.push_back(std::move(result));
+      });
+   }
+
+   void LveWorldPartition::update(const glm::vec3 &viewerPosition, const glm::vec3 &viewerVelocity) {
+      const glm::vec3 predicted = viewerPosition + viewerVelocity * settings.lookAheadSeconds;
+
+      //descriptions that came in since the last update, unless their cell was dropped (or dropped and requested again) meanwhile
+      std::vector<Described> arrived{};
+      {
+         std::lock_guard<std::mutex> lock{describedMutex};
+         arrived.swap(described);
+      }
+      for (auto &result : arrived) {
+         auto found = cells.find(result.coord);
+         if (found == cells.end() || found->second.request != result.request) continue;
+         Cell &cell = found->second;
+         cell.described = true;
+         cell.description = std::move(result.objects);
+         cell.handles.resize(cell.description.size());
+         cell.done.assign(cell.description.size(), false);
+      }
+
+      //out of range of both the viewer and where it is heading. Dropping the objects releases the models, the registry evicts them
+      //once they are over budget and no frame in flight can still draw them
+      for (auto cell = cells.begin(); cell != cells.end();) {
+         if (distanceTo(cell->first, viewerPosition) > settings.unloadRadius && distanceTo(cell->first, predicted) > settings.unloadRadius) {
+            cell = cells.erase(cell);
+            stats.cellUnloads++;
+         } else {
+            ++cell;
+         }
+      }
+
+      //missing cells in range, the ones nearest to where the viewer is heading first
+      std::vector<std::pair<float, LveCellCoord>> missing{};
+      for (const glm::vec3 &center : {viewerPosition, predicted}) {
+         const glm::vec3 reach{settings.loadRadius, 0.f, settings.loadRadius};
+         const LveCellCoord first = cellAt(center - reach);
+         const LveCellCoord last = cellAt(center + reach);
+         for (int32_t z = first.z; z <= last.z; z++) {
+            for (int32_t x = first.x; x <= last.x; x++) {
+               const LveCellCoord coord{x, z};
+               if (cells.count(coord) != 0) continue;
+               if (std::min(distanceTo(coord, viewerPosition), distanceTo(coord, predicted)) > settings.loadRadius) continue;
+               missing.push_back({distanceTo(coord, predicted), coord});
+            }
+         }
+      }
+      std::sort(missing.begin(), missing.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+      uint32_t requests = 0;
+      for (const auto &entry : missing) {
+         if (requests == settings.maxCellRequestsPerUpdate) break;
+         //both centers can find the same cell
+         if (cells.count(entry.second) != 0) continue;
+         requestCell(entry.second);
+         requests++;
+      }
+
+      //model loads, nearest cells first as well
+      std::vector<std::pair<float, Cell *>> loading{};
+      for (auto &entry : cells) {
+         if (entry.second.described && entry.second.doneCount < entry.second.description.size()) {
+            loading.push_back({distanceTo(entry.first, predicted), &entry.second});
+         }
+      }
+      std::sort(loading.begin(), loading.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+      uint32_t loads = 0;
+      for (const auto &entry : loading) {
+         Cell &cell = *entry.second;
+         for (size_t i = 0; i < cell.description.size() && loads < settings.maxModelLoadsPerUpdate; i++) {
+            if (cell.handles[i].valid()) continue;
+            cell.handles[i] = registry.load(cell.description[i].modelPath, cell.description[i].vertexFormat);
+            loads++;
+         }
+      }
+
+      //objects show up once their model is ready, a failed one is left out (the loader reported why)
+      stats.residentCells = 0;
+      stats.loadingCells = 0;
+      stats.objects = 0;
+      for (auto &entry : cells) {
+         Cell &cell = entry.second;
+         for (size_t i = 0; i < cell.handles.size(); i++) {
+            if (cell.done[i] || !cell.handles[i].valid() || cell.handles[i].status() == LveModelHandle::Status::Loading) continue;
+            if (cell.handles[i].ready()) {
+               const LveCellObject &description = cell.description[i];
+               auto obj = LveGameObject::createGameObject();
+               obj.model = cell.handles[i].get();
+               obj.transform = description.transform;
+               obj.color = description.color;
+               cell.objects.push_back(std::move(obj));
+            }
+            cell.done[i] = true;
+            cell.doneCount++;
+         }
+
+         if (cell.described && cell.doneCount == cell.description.size()) {
+            stats.residentCells++;
+         } else {
+            stats.loadingCells++;
+         }
+         stats.objects += static_cast<uint32_t>(cell.objects.size());
+      }
+   }
+}
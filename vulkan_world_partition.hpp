@@ -0,0 +1,128 @@
+#pragma once
+
+#include "game_object.hpp"
+#include "vulkan_asset_registry.hpp"
+#include "vulkan_thread_pool.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+
+   //a square of the world partition's grid on the xz plane, cell (x, z) covers [x, x + 1) * cellSize by [z, z + 1) * cellSize
+   struct LveCellCoord {
+      int32_t x;
+      int32_t z;
+
+      bool operator==(const LveCellCoord &other) const { return x == other.x && z == other.z; }
+   };
+
+   struct LveCellCoordHash {
+      size_t operator()(const LveCellCoord &coord) const;
+   };
+
+   //an object of a cell as described by the world, before its model is loaded
+   struct LveCellObject {
+      std::string modelPath;
+      LveModel::VertexFormat vertexFormat = LveModel::VertexFormat::Float32;
+      TransformComponent transform{};
+      glm::vec3 color{};
+   };
+
+   //streams the world in cells around the viewer: each cell owns its game objects and references its models through the asset
+   //registry, so dropping a cell releases them and the registry frees what is over its budget. Resident memory then depends on the
+   //load radius and the registry budget, not on the size of the world.
+   //cells are loaded when they come within loadRadius of the viewer or of where it will be lookAheadSeconds from now, and only
+   //unloaded once farther than unloadRadius from both, so moving along a cell border doesn't load and unload the same cells.
+   //descriptions come from a CellSource on a worker thread, models from the registry. Both are started nearest first, a limited
+   //number per frame; the loader's upload budget (LveModelLoader::setUploadBudget) caps what reaches the GPU
+   class LveWorldPartition {
+      public:
+      struct Settings {
+         float cellSize = 8.f;
+         float loadRadius = 16.f;
+         //has to be larger than loadRadius
+         float unloadRadius = 24.f;
+         float lookAheadSeconds = 1.f;
+         //cell descriptions requested per update
+         uint32_t maxCellRequestsPerUpdate = 2;
+         //model loads started per update
+         uint32_t maxModelLoadsPerUpdate = 8;
+      };
+
+      struct Stats {
+         uint32_t residentCells = 0;
+         //cells with a description or a model still on its way
+         uint32_t loadingCells = 0;
+         uint32_t objects = 0;
+         uint64_t cellLoads = 0;
+         uint64_t cellUnloads = 0;
+      };
+
+      //objects of a cell, called on a worker thread. May read files, must not throw and must not touch the partition.
+      //an empty cell is fine
+      using CellSource = std::function<std::vector<LveCellObject>(LveCellCoord coord)>;
+
+      LveWorldPartition(LveAssetRegistry &registry, CellSource source, const Settings &settings);
+      //descriptions still being read are abandoned
+      ~LveWorldPartition();
+
+      LveWorldPartition(const LveWorldPartition &) = delete;
+      LveWorldPartition &operator=(const LveWorldPartition &) = delete;
+
+      //once per frame, after LveAssetRegistry::update: unloads cells out of range, requests the nearest missing ones,
+      //starts model loads and places objects whose models are ready
+      void update(const glm::vec3 &viewerPosition, const glm::vec3 &viewerVelocity);
+
+      //calls function with the objects of every cell that has some, e.g. to draw them
+      template <typename Function>
+      void forEachCell(Function &&function) {
+         for (auto &entry : cells) {
+            if (!entry.second.objects.empty()) function(entry.second.objects);
+         }
+      }
+
+      LveCellCoord cellAt(const glm::vec3 &position) const;
+      const Settings &getSettings() const { return settings; }
+      const Stats &getStats() const { return stats; }
+
+      private:
+      struct Cell {
+         //the request this cell is waiting for, a cell unloaded and requested again ignores the first answer
+         uint64_t request = 0;
+         bool described = false;
+         std::vector<LveCellObject> description{};
+         //one per described object, invalid until its load is started
+         std::vector<LveModelHandle> handles{};
+         //objects placed so far, and how many of the described ones are done (placed or failed)
+         std::vector<LveGameObject> objects{};
+         std::vector<bool> done{};
+         size_t doneCount = 0;
+      };
+
+      struct Described {
+         LveCellCoord coord;
+         uint64_t request;
+         std::vector<LveCellObject> objects;
+      };
+
+      //distance on the xz plane from position to the nearest point of the cell
+      float distanceTo(LveCellCoord coord, const glm::vec3 &position) const;
+      void requestCell(LveCellCoord coord);
+
+      LveAssetRegistry &registry;
+      CellSource source;
+      Settings settings;
+      Stats stats{};
+      uint64_t nextRequest = 1;
+      std::unordered_map<LveCellCoord, Cell, LveCellCoordHash> cells{};
+      std::mutex describedMutex{};
+      std::vector<Described> described{};
+      //last member: the worker is joined before anything it touches is destroyed
+      LveThreadPool pool;
+   };
+}